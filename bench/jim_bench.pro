@@ -0,0 +1,12 @@
+# Headless benchmark harness for the editor hot paths.
+#   qmake jim_bench.pro && make && QT_QPA_PLATFORM=offscreen ./jim_bench
+# Prints JSON results to stdout (or --out FILE); --filter NAME runs a subset.
+# Exits non-zero when a check (LspTransport::check) fails.
+QT += core gui widgets network multimedia
+TARGET = jim_bench
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+include(../jim.pri)
+SOURCES += jimbench.cpp
@@ -0,0 +1,632 @@
+#include "texteditor.h"
+#include "hexeditor.h"
+#include "hexsearch.h"
+#include "checksum.h"
+#include "hexdiff.h"
+#include "hexentropy.h"
+#include "piecetable.h"
+#include "binaryinspector.h"
+#include "markdownviewer.h"
+#include "symbolindex.h"
+#include "lspclient.h"
+
+#include <QApplication>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextDocument>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  JimBench
+//  Times the editor hot paths on synthetic inputs and reports min / median /
+//  max per benchmark as JSON.  Friend of TextEditor so it can drive its
+//  private entry points directly.  Checks (pass / fail, no timing) run
+//  alongside, and a failed one makes the harness exit non-zero.
+// ─────────────────────────────────────────────────────────────────────────────
+class JimBench
+{
+public:
+    JimBench(const QString &workDir, const QString &filter)
+        : m_dir(workDir), m_filter(filter) {}
+
+    void run();
+    QJsonDocument results() const;
+    bool passed() const { return !m_failed; }
+
+private:
+    QString    m_dir;
+    QString    m_filter;
+    QJsonArray m_results;
+    bool       m_failed = false;
+
+    bool wanted(const QString &name) const
+    {
+        return m_filter.isEmpty() || name.contains(m_filter);
+    }
+
+    void measure(const QString &name, int iterations, qint64 bytes,
+                 const std::function<void()> &fn,
+                 const std::function<void()> &setup = {});
+    void check(const QString &name, const QString &error);
+
+    QString writeFile(const QString &name, const QByteArray &data) const;
+    static void closeEditorTabs(TextEditor &editor);
+
+    void benchTextEditor();
+    void benchHighlighter();
+    void benchMarkdown();
+    void benchBinaryInspector();
+    void benchHexPaint();
+    void benchSymbolIndex();
+    void checkLspTransport();
+};
+
+// ── Synthetic inputs ─────────────────────────────────────────────────────────
+
+static QByteArray repeatTo(const QByteArray &unit, qint64 bytes)
+{
+    QByteArray out;
+    out.reserve(bytes + unit.size());
+    for (int n = 0; out.size() < bytes; ++n)
+        out += QByteArray(unit).replace("@N", QByteArray::number(n));
+    return out;
+}
+
+static QByteArray sampleFor(Language lang)
+{
+    switch (lang) {
+    case Language::CPP:
+        return "// item @N\nstatic int compute_@N(const std::vector<int> &v) {\n"
+               "    int total = 0; /* sum */\n    for (int x : v) total += x * @N;\n"
+               "    return total > 0x@N ? total : -1;\n}\n";
+    case Language::Python:
+        return "# item @N\ndef compute_@N(values):\n    \"\"\"Sum values.\"\"\"\n"
+               "    return sum(v * @N for v in values if v > 0)\n\n"
+               "class Node@N:\n    pass\n";
+    case Language::JavaScript:
+        return "// item @N\nfunction compute@N(values) {\n"
+               "  const total = values.reduce((a, b) => a + b * @N, 0);\n"
+               "  return `total ${total}`;\n}\n";
+    case Language::HTML:
+        return "<div class=\"row-@N\" id=\"r@N\">\n  <!-- row @N -->\n"
+               "  <a href=\"/item/@N\">Item @N</a>\n</div>\n";
+    case Language::CSS:
+        return ".row-@N > a:hover {\n  color: #ff@N;\n  margin: @Npx 0;\n}\n";
+    case Language::Rust:
+        return "// item @N\nfn compute_@N(v: &[i32]) -> i32 {\n"
+               "    let total: i32 = v.iter().map(|x| x * @N).sum();\n"
+               "    if total > 0 { total } else { -1 }\n}\n";
+    case Language::Go:
+        return "// item @N\nfunc compute@N(v []int) int {\n\ttotal := 0\n"
+               "\tfor _, x := range v {\n\t\ttotal += x * @N\n\t}\n\treturn total\n}\n";
+    case Language::JSON:
+        return "  {\"id\": @N, \"name\": \"item @N\", \"ok\": true, \"score\": @N.5},\n";
+    case Language::YAML:
+        return "item_@N:\n  id: @N\n  name: \"item @N\"  # comment\n  enabled: true\n";
+    case Language::Markdown:
+        return "## Section @N\n\nSome *emphasis* and `code @N` with a [link](http://x/@N).\n\n"
+               "- first @N\n- second\n\n```cpp\nint x = @N;\n```\n\n";
+    case Language::PlainText:
+    default:
+        return "Line @N of plain text with a few words in it.\n";
+    }
+}
+
+static QByteArray randomBytes(qint64 size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    QRandomGenerator gen(42);   // fixed seed: identical input every run
+    gen.fillRange(reinterpret_cast<quint32 *>(data.data()), size / 4);
+    return data;
+}
+
+// ── Harness ──────────────────────────────────────────────────────────────────
+
+void JimBench::measure(const QString &name, int iterations, qint64 bytes,
+                       const std::function<void()> &fn,
+                       const std::function<void()> &setup)
+{
+    if (!wanted(name))
+        return;
+
+    QVector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        if (setup)
+            setup();
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        samples.append(timer.nsecsElapsed() / 1e6);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    const double median = samples[samples.size() / 2];
+    QJsonObject result;
+    result["name"] = name;
+    result["iterations"] = iterations;
+    result["min_ms"] = samples.first();
+    result["median_ms"] = median;
+    result["max_ms"] = samples.last();
+    if (bytes > 0) {
+        result["bytes"] = double(bytes);
+        result["mb_per_s"] = median > 0 ? (bytes / 1048576.0) / (median / 1000.0) : 0.0;
+    }
+    m_results.append(result);
+    std::fprintf(stderr, "  %-36s %10.2f ms\n", qPrintable(name), median);
+}
+
+void JimBench::check(const QString &name, const QString &error)
+{
+    QJsonObject result;
+    result["name"] = name;
+    result["ok"] = error.isEmpty();
+    if (!error.isEmpty()) {
+        result["error"] = error;
+        m_failed = true;
+    }
+    m_results.append(result);
+    std::fprintf(stderr, "  %-36s %s\n", qPrintable(name),
+                 error.isEmpty() ? "ok" : qPrintable("FAILED: " + error));
+}
+
+QString JimBench::writeFile(const QString &name, const QByteArray &data) const
+{
+    const QString path = m_dir + "/" + name;
+    QFile file(path);
+    if (file.open(QFile::WriteOnly))
+        file.write(data);
+    return path;
+}
+
+void JimBench::closeEditorTabs(TextEditor &editor)
+{
+    for (int i = editor.tabWidget->count() - 1; i >= 0; --i) {
+        QWidget *w = editor.tabWidget->widget(i);
+        if (w == editor.welcomeWidget)
+            continue;
+        editor.tabWidget->removeTab(i);
+        if (CodeEditor *ed = qobject_cast<CodeEditor *>(w)) {
+            editor.unwatchFile(ed->getFileName());
+            editor.highlighters.remove(ed);
+        }
+        delete w;
+    }
+}
+
+void JimBench::run()
+{
+    benchTextEditor();
+    benchHighlighter();
+    benchMarkdown();
+    benchBinaryInspector();
+    benchHexPaint();
+    benchSymbolIndex();
+    checkLspTransport();
+}
+
+void JimBench::benchTextEditor()
+{
+    TextEditor editor;
+
+    const QByteArray source = repeatTo(sampleFor(Language::CPP), 10 * 1024 * 1024);
+    const QString sourcePath = writeFile("bench_10mb.cpp", source);
+    measure("loadFile/10MB-cpp", 3, source.size(),
+            [&] { editor.loadFile(sourcePath); },
+            [&] { closeEditorTabs(editor); });
+
+    QByteArray minified = repeatTo("{\"id\":@N,\"v\":[1,2,3],\"s\":\"x@N\"},",
+                                   10 * 1024 * 1024);
+    minified.prepend('[').append("{}]");
+    const QString minifiedPath = writeFile("bench_10mb_min.json", minified);
+    measure("loadFile/10MB-minified-json", 3, minified.size(),
+            [&] { editor.loadFile(minifiedPath); },
+            [&] { closeEditorTabs(editor); });
+
+    // Search and save run against the 10 MB C++ tab
+    closeEditorTabs(editor);
+    editor.loadFile(sourcePath);
+    measure("onFindTextChanged/10MB-many-hits", 3, source.size(),
+            [&] { editor.onFindTextChanged("total"); },
+            [&] { editor.onFindTextChanged(QString()); });
+    measure("onFindTextChanged/10MB-no-hits", 3, source.size(),
+            [&] { editor.onFindTextChanged("zz_not_present_zz"); },
+            [&] { editor.onFindTextChanged(QString()); });
+    editor.onFindTextChanged(QString());
+
+    const QString savePath = m_dir + "/bench_save.cpp";
+    measure("saveFileToPath/10MB", 3, source.size(),
+            [&] { editor.saveFileToPath(savePath); });
+    closeEditorTabs(editor);
+}
+
+void JimBench::benchHighlighter()
+{
+    static const char *names[] = {"PlainText", "CPP",  "Python", "JavaScript",
+                                  "HTML",      "CSS",  "Rust",   "Go",
+                                  "JSON",      "YAML", "Markdown"};
+    for (int i = 0; i <= int(Language::Markdown); ++i) {
+        const Language lang = Language(i);
+        const QByteArray text = repeatTo(sampleFor(lang), 1024 * 1024);
+        QTextDocument doc;
+        doc.setPlainText(QString::fromUtf8(text));
+        SyntaxHighlighter *highlighter = new SyntaxHighlighter(&doc);
+        // setLanguage() re-runs highlightBlock over the whole document
+        measure(QString("rehighlight/1MB-%1").arg(names[i]), 3, text.size(),
+                [&] { highlighter->setLanguage(lang); });
+    }
+}
+
+void JimBench::benchMarkdown()
+{
+    const QString markdown =
+        QString::fromUtf8(repeatTo(sampleFor(Language::Markdown), 1024 * 1024));
+    measure("MarkdownConverter::toHtml/1MB", 5, markdown.size(),
+            [&] { MarkdownConverter::toHtml(markdown); });
+}
+
+void JimBench::benchBinaryInspector()
+{
+    BinaryInspectorWidget inspector;
+
+    // Timed through the public loadFile(); mapping the file is negligible
+    // next to analyzeFile()
+    const QString exePath = QCoreApplication::applicationFilePath();
+    const qint64 exeSize = QFileInfo(exePath).size();
+    if (exeSize > 0) {
+        measure("analyzeFile/own-executable", 3, exeSize,
+                [&] { inspector.loadFile(exePath); });
+    }
+
+    const QByteArray blob = randomBytes(8 * 1024 * 1024);
+    const QString blobPath = writeFile("bench_8mb.bin", blob);
+    measure("analyzeFile/8MB-random", 3, blob.size(),
+            [&] { inspector.loadFile(blobPath); });
+}
+
+void JimBench::benchHexPaint()
+{
+    HexEditor hex;
+    hex.setData(randomBytes(8 * 1024 * 1024));
+    hex.resize(1200, 800);
+    QImage frame(hex.size(), QImage::Format_ARGB32_Premultiplied);
+
+    // render() goes through paintEvent exactly like an on-screen repaint
+    measure("HexEditor::paintEvent/1200x800", 50, 0,
+            [&] { hex.render(&frame); });
+
+    // Scattered single-byte inserts: a treap split and merge each, no memmove
+    PieceTable table;
+    table.setData(randomBytes(64 * 1024 * 1024));
+    quint32 seed = 1;
+    measure("PieceTable::insert/64MB-x10000", 3, 0, [&] {
+        for (int i = 0; i < 10000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            table.insert(seed % table.size(), "x", 1);
+        }
+    });
+
+    // memchr-anchored scan straight over the buffer, as the search worker runs it
+    PieceTable image;
+    image.setData(randomBytes(128 * 1024 * 1024));
+    const PieceTable::Snapshot snapshot = image.snapshot();
+    const HexSearch::Pattern pattern = HexSearch::parse("DE AD ?? EF", HexSearch::HexBytes);
+    std::atomic_bool cancel{false};
+    measure("HexSearch::scan/128MB-wildcard", 3, snapshot.size(), [&] {
+        HexSearch::scan(snapshot, pattern, cancel, HexSearch::MaxHits,
+                        [](const QVector<qint64> &) {});
+    });
+
+    // Every digest at once on the pool, CRC32 split across cores
+    measure("Checksum::compute/128MB-all", 3, snapshot.size(), [&] {
+        Checksum::compute(snapshot, 0, snapshot.size(), Checksum::AllAlgorithms, cancel);
+    });
+
+    // Per-4KB histograms on the pool, as the strip beside a hex tab computes them
+    measure("EntropyMap::compute/128MB", 3, snapshot.size(), [&] {
+        std::vector<EntropyMap::Block> blocks;
+        EntropyMap::compute(snapshot, EntropyMap::blockSize(snapshot.size()), blocks, cancel);
+    });
+
+    // Two builds differing by an insertion, a deletion and a patched byte
+    QByteArray patched = image.toByteArray();
+    patched.insert(1000000, "hello");
+    patched.remove(64 * 1024 * 1024, 77);
+    patched[100 * 1024 * 1024] = char(patched[100 * 1024 * 1024] ^ 1);
+    PieceTable other;
+    other.setData(patched);
+    const PieceTable::Snapshot otherSnapshot = other.snapshot();
+    measure("HexDiff::compare/128MB-3-edits", 3, snapshot.size() + otherSnapshot.size(), [&] {
+        HexDiff::compare(snapshot, otherSnapshot, cancel, [](const QVector<HexDiff::Range> &) {});
+    });
+}
+
+void JimBench::benchSymbolIndex()
+{
+    if (!wanted("SymbolIndex"))
+        return;
+
+    // 200 files x 5000 lines: a 1M LOC tree
+    const QString root = m_dir + "/symbols";
+    QDir().mkpath(root);
+    for (int f = 0; f < 200; ++f) {
+        const QByteArray unit = sampleFor(Language::CPP).replace("@N", QByteArray::number(f) + "_@N");
+        writeFile(QString("symbols/file_%1.cpp").arg(f), repeatTo(unit, 5000 / 6 * unit.size()));
+    }
+
+    SymbolIndex index;
+    measure("SymbolIndex::build/1M-LOC", 1, 0, [&] {
+        QEventLoop loop;
+        QObject::connect(&index, &SymbolIndex::indexed, &loop, &QEventLoop::quit);
+        index.setRoot(root);
+        loop.exec();
+    });
+    measure("SymbolIndex::find/prefix", 50, 0,
+            [&] { index.find("compute_199_8"); });
+    measure("SymbolIndex::find/substring", 20, 0,
+            [&] { index.find("99_83"); });
+    measure("SymbolIndex::definitions", 50, 0,
+            [&] { index.definitions("compute_123_456"); });
+}
+
+// ── LSP transport ────────────────────────────────────────────────────────────
+
+static qint64 mockClock()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Scripted language server, run as "jim_bench --lsp-mock LOG".  Replies
+// arrive coalesced (a notification and a response in one write) or
+// dribbled a few bytes at a time, so the client has to reassemble headers
+// and bodies across reads.  shutdown is answered late, from a second
+// thread, while the main one keeps reading; LOG gets every method with
+// its arrival time, so the checker can tell whether exit waited.
+static int runLspMock(const QString &logPath)
+{
+#ifdef Q_OS_WIN
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    QFile in;
+    QFile out;
+    QFile log(logPath);
+    // Unbuffered: a buffered QFile would block reading ahead on the pipe
+    if (!in.open(stdin, QIODevice::ReadOnly | QIODevice::Unbuffered) ||
+        !out.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered) ||
+        !log.open(QIODevice::WriteOnly))
+        return 2;
+
+    std::mutex lock;
+    auto logLine = [&](const QByteArray &what) {
+        std::lock_guard<std::mutex> guard(lock);
+        log.write(what + ' ' + QByteArray::number(mockClock()) + '\n');
+        log.flush();
+    };
+    auto frame = [](const QJsonObject &message) {
+        const QByteArray body = QJsonDocument(message).toJson(QJsonDocument::Compact);
+        return "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+    };
+    auto reply = [&](const QByteArray &bytes, int slice) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int i = 0; i < bytes.size(); i += slice) {
+            out.write(bytes.mid(i, slice));
+            out.flush();
+            if (slice < bytes.size())
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    };
+
+    std::thread responder;
+    for (;;) {
+        int length = -1;
+        for (;;) {
+            const QByteArray line = in.readLine();
+            if (line.isEmpty()) {
+                if (responder.joinable())
+                    responder.join();
+                return 1;               // stdin closed without exit
+            }
+            const QByteArray header = line.trimmed();
+            if (header.isEmpty())
+                break;
+            if (header.toLower().startsWith("content-length:"))
+                length = header.mid(15).trimmed().toInt();
+        }
+        const QJsonObject message = QJsonDocument::fromJson(in.read(length)).object();
+        const QString method = message.value("method").toString();
+        const QJsonValue id = message.value("id");
+        logLine(method.toUtf8());
+
+        if (method == "initialize") {
+            const QJsonObject diagnostic{
+                {"range", QJsonObject{{"start", QJsonObject{{"line", 0}, {"character", 0}}},
+                                      {"end", QJsonObject{{"line", 0}, {"character", 1}}}}},
+                {"message", "mock"}};
+            const QJsonObject publish{
+                {"jsonrpc", "2.0"}, {"method", "textDocument/publishDiagnostics"},
+                {"params", QJsonObject{{"uri", "file:///mock"},
+                                       {"diagnostics", QJsonArray{diagnostic, diagnostic}}}}};
+            const QByteArray both = frame(publish) +
+                frame({{"jsonrpc", "2.0"}, {"id", id}, {"result", QJsonObject()}});
+            reply(both, int(both.size()));
+        } else if (method == "jim/echo") {
+            reply(frame({{"jsonrpc", "2.0"}, {"id", id},
+                         {"result", message.value("params").toObject().value("text")}}), 5);
+        } else if (method == "shutdown") {
+            responder = std::thread([&, id]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                logLine("answered");
+                reply(frame({{"jsonrpc", "2.0"}, {"id", id}, {"result", QJsonValue()}}), 5);
+            });
+        } else if (method == "exit") {
+            if (responder.joinable())
+                responder.join();
+            return 0;
+        }
+    }
+}
+
+void JimBench::checkLspTransport()
+{
+    const QString name = "LspTransport::check";
+    if (!wanted(name))
+        return;
+
+    const QString logPath = m_dir + "/lsp_mock.log";
+    const QString text = QString::fromUtf8("h\xC3\xA9llo \xE2\x9C\x93");   // multi-byte UTF-8
+    QString error;
+    bool initialized = false;
+    QString echoed;
+    int diagnostics = -1;
+    {
+        LspTransport transport(QCoreApplication::applicationFilePath(),
+                               {"--lsp-mock", logPath}, m_dir);
+        QEventLoop loop;
+        auto settled = [&]() {
+            if (initialized && !echoed.isNull() && diagnostics >= 0)
+                loop.quit();
+        };
+        QObject::connect(&transport, &LspTransport::failed, &loop, [&](const QString &e) {
+            error = e;
+            loop.quit();
+        });
+        QObject::connect(&transport, &LspTransport::responseReceived, &loop,
+                         [&](int id, const QJsonValue &result, const QString &) {
+                             if (id == 1)
+                                 initialized = true;
+                             else if (id == 2)
+                                 echoed = result.toString();
+                             settled();
+                         });
+        QObject::connect(&transport, &LspTransport::diagnosticsReady, &loop,
+                         [&](const QString &, const QVector<LspDiagnostic> &list) {
+                             diagnostics = list.size();
+                             settled();
+                         });
+        QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+
+        transport.start();
+        transport.send({{"jsonrpc", "2.0"}, {"id", 1}, {"method", "initialize"},
+                        {"params", QJsonObject()}});
+        transport.send({{"jsonrpc", "2.0"}, {"id", 2}, {"method", "jim/echo"},
+                        {"params", QJsonObject{{"text", text}}}});
+        loop.exec();
+        transport.stop();
+    }
+
+    if (error.isEmpty() && !initialized)
+        error = "no response to initialize";
+    if (error.isEmpty() && diagnostics != 2)
+        error = QString("expected 2 diagnostics, got %1").arg(diagnostics);
+    if (error.isEmpty() && echoed != text)
+        error = "dribbled response came back as '" + echoed + "'";
+
+    // exit must arrive after shutdown was answered
+    QFile log(logPath);
+    QHash<QByteArray, qint64> at;
+    QByteArrayList order;
+    if (log.open(QFile::ReadOnly)) {
+        for (const QByteArray &line : log.readAll().split('\n')) {
+            const QByteArrayList parts = line.split(' ');
+            if (parts.size() == 2) {
+                order.append(parts[0]);
+                at.insert(parts[0], parts[1].toLongLong());
+            }
+        }
+    }
+    const QByteArrayList expected{"initialize", "jim/echo", "shutdown", "answered", "exit"};
+    if (error.isEmpty() && order != expected)
+        error = "server saw " + QString::fromUtf8(order.join(", "));
+    if (error.isEmpty() && at.value("exit") < at.value("answered"))
+        error = "exit was sent before shutdown was answered";
+    check(name, error);
+}
+
+QJsonDocument JimBench::results() const
+{
+    QJsonObject root;
+    root["qt_version"] = QString::fromLatin1(qVersion());
+    root["platform"] = QGuiApplication::platformName();
+    root["results"] = m_results;
+    return QJsonDocument(root);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && std::strcmp(argv[1], "--lsp-mock") == 0)
+        return runLspMock(QString::fromLocal8Bit(argv[2]));
+
+    // Headless by default; an explicit QT_QPA_PLATFORM still wins
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    // Test mode moves the session file; settings are redirected below
+    QStandardPaths::setTestModeEnabled(true);
+
+    QApplication app(argc, argv);
+
+    QString outPath;
+    QString filter;
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--out" && i + 1 < args.size())
+            outPath = args[++i];
+        else if (args[i] == "--filter" && i + 1 < args.size())
+            filter = args[++i];
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::fprintf(stderr, "jim_bench: cannot create a temporary directory\n");
+        return 1;
+    }
+
+    // ~TextEditor writes its settings.  Native settings live in the
+    // registry on Windows, which test mode does not touch, so every
+    // QSettings goes to an INI file in the temporary directory instead
+    QCoreApplication::setOrganizationName("JimBench");
+    QCoreApplication::setApplicationName("JimBench");
+    QSettings::setDefaultFormat(QSettings::IniFormat);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, dir.filePath("settings"));
+
+    JimBench bench(dir.path(), filter);
+    bench.run();
+
+    const QByteArray json = bench.results().toJson();
+    if (outPath.isEmpty()) {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+        return bench.passed() ? 0 : 1;
+    }
+    QFile out(outPath);
+    if (!out.open(QFile::WriteOnly)) {
+        std::fprintf(stderr, "jim_bench: cannot write %s\n", qPrintable(outPath));
+        return 1;
+    }
+    out.write(json);
+    return bench.passed() ? 0 : 1;
+}
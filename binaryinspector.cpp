@@ -1,8 +1,7 @@
 #include "binaryinspector.h"
+#include "checksum.h"
 
-#include <QFile>
 #include <QFileInfo>
-#include <QCryptographicHash>
 #include <QDateTime>
 #include <QtEndian>
 #include <QTableWidgetItem>
@@ -131,55 +130,81 @@ void BinaryInspectorWidget::styleTable(QTableWidget *t)
     t->setEditTriggers(QAbstractItemView::NoEditTriggers);
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  BinaryReader
+// ─────────────────────────────────────────────────────────────────────────────
+bool BinaryReader::contains(qint64 off, qint64 length) const
+{
+    return off >= 0 && length >= 0 && off <= size() && length <= size() - off;
+}
+
+template <typename T>
+T BinaryReader::read(qint64 off) const
+{
+    T v;
+    if (!contains(off, sizeof(T)))
+        return 0;
+    m_data.read(off, reinterpret_cast<char *>(&v), sizeof(T));
+    return m_littleEndian ? qFromLittleEndian(v) : qFromBigEndian(v);
+}
+
+qint64 BinaryReader::read(qint64 off, char *dest, qint64 length) const
+{
+    return m_data.read(off, dest, length);
+}
+
+const char *BinaryReader::bytes(qint64 off, qint64 length, QByteArray &scratch) const
+{
+    return m_data.data(off, length, scratch);
+}
+
+QString BinaryReader::cString(qint64 off, qint64 maxLength) const
+{
+    if (off < 0 || off >= size() || maxLength <= 0)
+        return QString();
+    QByteArray scratch;
+    const qint64 length = qMin(maxLength, size() - off);
+    const char *p = bytes(off, length, scratch);
+    const char *end = static_cast<const char *>(memchr(p, 0, size_t(length)));
+    return QString::fromLatin1(p, end ? int(end - p) : int(length));
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Public API
 // ─────────────────────────────────────────────────────────────────────────────
 bool BinaryInspectorWidget::loadFile(const QString &filePath)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly))
+    // Mapped, not read: only the pages the parsers touch are brought in
+    PieceTable file;
+    if (!file.open(filePath, nullptr, PieceTable::ReadOnly))
         return false;
 
     m_filePath = filePath;
 
-    // Refuse files larger than 256 MB to stay responsive
-    if (file.size() > 256LL * 1024 * 1024) {
-        m_fileInfoLabel->setText(
-            QString("File too large to inspect inline (%1).")
-                .arg(formatSize(file.size())));
-        return false;
-    }
-
-    QByteArray data = file.readAll();
-    file.close();
-
     clearTables();
-    analyzeFile(data);
+    analyzeFile(file.snapshot());
     return true;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Top-level analysis
 // ─────────────────────────────────────────────────────────────────────────────
-void BinaryInspectorWidget::analyzeFile(const QByteArray &data)
+void BinaryInspectorWidget::analyzeFile(const PieceTable::Snapshot &snapshot)
 {
     QFileInfo fi(m_filePath);
-    QString md5 = computeMD5(data);
+    m_md5Row = -1;
+    const BinaryReader data(snapshot);
 
-    bool isELF = (data.size() >= 4 &&
-                  (quint8)data[0] == 0x7F &&
-                  data[1] == 'E' && data[2] == 'L' && data[3] == 'F');
+    bool isELF = (data.u8(0) == 0x7F &&
+                  data.u8(1) == 'E' && data.u8(2) == 'L' && data.u8(3) == 'F');
 
-    bool isMZ  = (data.size() >= 2 &&
-                  (quint8)data[0] == 'M' && (quint8)data[1] == 'Z');
+    bool isMZ  = (data.u8(0) == 'M' && data.u8(1) == 'Z');
     bool isPE  = false;
     if (isMZ && data.size() >= 0x40) {
-        quint32 peOff;
-        memcpy(&peOff, data.constData() + 0x3C, 4);
-        peOff = qFromLittleEndian(peOff);
-        isPE = (peOff + 4 <= (quint32)data.size() &&
-                data[peOff] == 'P' && data[peOff+1] == 'E' &&
-                data[peOff+2] == 0  && data[peOff+3] == 0);
+        quint32 peOff = data.u32(0x3C);
+        isPE = (data.contains(peOff, 4) &&
+                data.u8(peOff) == 'P' && data.u8(peOff+1) == 'E' &&
+                data.u8(peOff+2) == 0  && data.u8(peOff+3) == 0);
     }
 
     QString formatStr = "Unknown / Raw Binary";
@@ -187,66 +212,53 @@ void BinaryInspectorWidget::analyzeFile(const QByteArray &data)
     if (isPE)  formatStr = "PE (Portable Executable)";
 
     // Basic file info
-    m_fileInfoLabel->setText(
-        QString("  File: %1    Size: %2    Format: %3    MD5: %4")
-            .arg(fi.fileName())
-            .arg(formatSize(data.size()))
-            .arg(formatStr)
-            .arg(md5));
+    m_fileInfo = QString("  File: %1    Size: %2    Format: %3    MD5: ")
+                     .arg(fi.fileName())
+                     .arg(formatSize(data.size()))
+                     .arg(formatStr);
+    m_fileInfoLabel->setText(m_fileInfo + "computing...");
 
     if      (isELF) parseELF(data);
     else if (isPE)  parsePE (data);
     else {
         addHeaderRow("Format",   "Unknown",           "Not a recognised ELF or PE binary");
         addHeaderRow("Size",     formatSize(data.size()), "Total file size");
-        addHeaderRow("MD5",      md5,                 "");
+        addHeaderRow("MD5",      "computing...",      "");
+        m_md5Row = m_headerTable->rowCount() - 1;
     }
 
     extractStrings(data);
+    computeMD5(snapshot);
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  ELF Parser
 // ─────────────────────────────────────────────────────────────────────────────
-bool BinaryInspectorWidget::parseELF(const QByteArray &data)
+bool BinaryInspectorWidget::parseELF(const BinaryReader &data)
 {
     if (data.size() < 64) return false;
 
-    bool le   = ((quint8)data[5] == 1);   // EI_DATA: 1=LE, 2=BE
-    bool is64 = ((quint8)data[4] == 2);   // EI_CLASS: 1=32-bit, 2=64-bit
+    bool le   = (data.u8(5) == 1);   // EI_DATA: 1=LE, 2=BE
+    bool is64 = (data.u8(4) == 2);   // EI_CLASS: 1=32-bit, 2=64-bit
 
-    // Endian-aware readers
-    auto u16 = [&](int off) -> quint16 {
-        if (off + 2 > data.size()) return 0;
-        quint16 v; memcpy(&v, data.constData() + off, 2);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
-    auto u32 = [&](int off) -> quint32 {
-        if (off + 4 > data.size()) return 0;
-        quint32 v; memcpy(&v, data.constData() + off, 4);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
-    auto u64 = [&](int off) -> quint64 {
-        if (off + 8 > data.size()) return 0;
-        quint64 v; memcpy(&v, data.constData() + off, 8);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
+    // Endian-aware reader over the same mapping
+    const BinaryReader elf(data.snapshot(), le);
 
     // ── ELF header fields ─────────────────────────────────────────────────────
-    quint8  osabi    = (quint8)data[7];
-    quint16 e_type   = u16(16);
-    quint16 e_mach   = u16(18);
-    quint32 e_ver    = u32(20);
-    quint64 e_entry  = is64 ? u64(24) : u32(24);
-    quint64 e_phoff  = is64 ? u64(32) : u32(28);
-    quint64 e_shoff  = is64 ? u64(40) : u32(32);
-    quint32 e_flags  = is64 ? u32(48) : u32(36);
-    quint16 e_ehsize = is64 ? u16(52) : u16(40);
-    quint16 e_phesz  = is64 ? u16(54) : u16(42);
-    quint16 e_phnum  = is64 ? u16(56) : u16(44);
-    quint16 e_shesz  = is64 ? u16(58) : u16(46);
-    quint16 e_shnum  = is64 ? u16(60) : u16(48);
-    quint16 e_ssnx   = is64 ? u16(62) : u16(50);
+    quint8  osabi    = elf.u8(7);
+    quint16 e_type   = elf.u16(16);
+    quint16 e_mach   = elf.u16(18);
+    quint32 e_ver    = elf.u32(20);
+    quint64 e_entry  = is64 ? elf.u64(24) : elf.u32(24);
+    quint64 e_phoff  = is64 ? elf.u64(32) : elf.u32(28);
+    quint64 e_shoff  = is64 ? elf.u64(40) : elf.u32(32);
+    quint32 e_flags  = is64 ? elf.u32(48) : elf.u32(36);
+    quint16 e_ehsize = is64 ? elf.u16(52) : elf.u16(40);
+    quint16 e_phesz  = is64 ? elf.u16(54) : elf.u16(42);
+    quint16 e_phnum  = is64 ? elf.u16(56) : elf.u16(44);
+    quint16 e_shesz  = is64 ? elf.u16(58) : elf.u16(46);
+    quint16 e_shnum  = is64 ? elf.u16(60) : elf.u16(48);
+    quint16 e_ssnx   = is64 ? elf.u16(62) : elf.u16(50);
 
     // String mappings
     auto typeName = [](quint16 t) -> QString {
@@ -321,45 +333,38 @@ bool BinaryInspectorWidget::parseELF(const QByteArray &data)
                 .arg(typeName(e_type))));
 
     // Parse sections
-    if (e_shoff > 0 && e_shesz > 0 && e_shnum > 0)
-        parseELFSections(data, is64, le,
-                         (int)e_shoff, (int)e_shesz, (int)e_shnum, (int)e_ssnx);
+    if (e_shoff > 0 && e_shoff < (quint64)elf.size() && e_shesz > 0 && e_shnum > 0)
+        parseELFSections(elf, is64,
+                         (qint64)e_shoff, (int)e_shesz, (int)e_shnum, (int)e_ssnx);
 
     // Parse dynamic symbols for imports panel
-    parseELFDynSymbols(data, is64, le);
+    parseELFDynSymbols(elf, is64);
 
     return true;
 }
 
-void BinaryInspectorWidget::parseELFSections(const QByteArray &data,
-                                              bool is64, bool le,
-                                              int shoff, int shentsize,
+void BinaryInspectorWidget::parseELFSections(const BinaryReader &elf,
+                                              bool is64,
+                                              qint64 shoff, int shentsize,
                                               int shnum, int shstrndx)
 {
-    auto u32 = [&](int off) -> quint32 {
-        if (off + 4 > data.size()) return 0;
-        quint32 v; memcpy(&v, data.constData() + off, 4);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
-    auto u64 = [&](int off) -> quint64 {
-        if (off + 8 > data.size()) return 0;
-        quint64 v; memcpy(&v, data.constData() + off, 8);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
-
-    // Locate the section-name string table
-    QByteArray strtab;
+    // Locate the section-name string table; names are read in place
+    quint64 strOff  = 0;
+    quint64 strSize = 0;
     if (shstrndx < shnum) {
-        int sOff = shoff + shstrndx * shentsize;
-        quint64 strRawOff  = is64 ? u64(sOff + 24) : u32(sOff + 16);
-        quint64 strRawSize = is64 ? u64(sOff + 32) : u32(sOff + 20);
-        if (strRawOff > 0 && strRawOff + strRawSize <= (quint64)data.size())
-            strtab = data.mid((int)strRawOff, (int)strRawSize);
+        qint64 sOff = shoff + (qint64)shstrndx * shentsize;
+        quint64 strRawOff  = is64 ? elf.u64(sOff + 24) : elf.u32(sOff + 16);
+        quint64 strRawSize = is64 ? elf.u64(sOff + 32) : elf.u32(sOff + 20);
+        if (strRawOff > 0 && strRawOff <= (quint64)elf.size() &&
+            strRawSize <= (quint64)elf.size() - strRawOff) {
+            strOff  = strRawOff;
+            strSize = strRawSize;
+        }
     }
 
     auto getName = [&](quint32 idx) -> QString {
-        if (strtab.isEmpty() || idx >= (quint32)strtab.size()) return "";
-        return QString::fromLatin1(strtab.constData() + idx);
+        if (idx >= strSize) return "";
+        return elf.cString((qint64)(strOff + idx), (qint64)(strSize - idx));
     };
 
     auto flagStr = [](quint64 f) -> QString {
@@ -373,14 +378,14 @@ void BinaryInspectorWidget::parseELFSections(const QByteArray &data,
     };
 
     for (int i = 0; i < shnum; ++i) {
-        int sOff = shoff + i * shentsize;
-        if (sOff + shentsize > data.size()) break;
+        qint64 sOff = shoff + (qint64)i * shentsize;
+        if (!elf.contains(sOff, shentsize)) break;
 
-        quint32 sh_name    = u32(sOff);
-        quint64 sh_flags   = is64 ? u64(sOff + 8)  : u32(sOff + 8);
-        quint64 sh_addr    = is64 ? u64(sOff + 16) : u32(sOff + 12);
-        quint64 sh_offset  = is64 ? u64(sOff + 24) : u32(sOff + 16);
-        quint64 sh_size    = is64 ? u64(sOff + 32) : u32(sOff + 20);
+        quint32 sh_name    = elf.u32(sOff);
+        quint64 sh_flags   = is64 ? elf.u64(sOff + 8)  : elf.u32(sOff + 8);
+        quint64 sh_addr    = is64 ? elf.u64(sOff + 16) : elf.u32(sOff + 12);
+        quint64 sh_offset  = is64 ? elf.u64(sOff + 24) : elf.u32(sOff + 16);
+        quint64 sh_size    = is64 ? elf.u64(sOff + 32) : elf.u32(sOff + 20);
 
         QString name = getName(sh_name);
         if (name.isEmpty() && i == 0) name = "(null)";
@@ -393,78 +398,64 @@ void BinaryInspectorWidget::parseELFSections(const QByteArray &data,
     }
 }
 
-void BinaryInspectorWidget::parseELFDynSymbols(const QByteArray &data,
-                                                bool is64, bool le)
+void BinaryInspectorWidget::parseELFDynSymbols(const BinaryReader &elf,
+                                                bool is64)
 {
     // We look for a .dynstr section (type SHT_STRTAB associated with .dynsym)
     // Simplified: scan for null-separated printable strings in the .dynstr region
     // by finding the SHT_DYNSYM section and following sh_link to .dynstr.
-    auto u16 = [&](int off) -> quint16 {
-        if (off + 2 > data.size()) return 0;
-        quint16 v; memcpy(&v, data.constData() + off, 2);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
-    auto u32 = [&](int off) -> quint32 {
-        if (off + 4 > data.size()) return 0;
-        quint32 v; memcpy(&v, data.constData() + off, 4);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
-    auto u64 = [&](int off) -> quint64 {
-        if (off + 8 > data.size()) return 0;
-        quint64 v; memcpy(&v, data.constData() + off, 8);
-        return le ? qFromLittleEndian(v) : qFromBigEndian(v);
-    };
-
-    int shoff     = (int)(is64 ? u64(40) : u32(32));
-    int shentsize = (int)(is64 ? u16(58) : u16(46));
-    int shnum     = (int)(is64 ? u16(60) : u16(48));
-    if (shoff == 0 || shentsize == 0 || shnum == 0) return;
+    quint64 shoff     = is64 ? elf.u64(40) : elf.u32(32);
+    int     shentsize = is64 ? elf.u16(58) : elf.u16(46);
+    int     shnum     = is64 ? elf.u16(60) : elf.u16(48);
+    if (shoff == 0 || shoff >= (quint64)elf.size() || shentsize == 0 || shnum == 0) return;
 
     // Find SHT_DYNSYM (type == 11)
-    int dynsymOff   = -1;
-    int dynsymSize  = 0;
-    int dynsymLink  = 0;
-    int dynsymEntSz = is64 ? 24 : 16;
+    quint64 dynsymOff   = 0;
+    quint64 dynsymSize  = 0;
+    quint32 dynsymLink  = 0;
+    quint64 dynsymEntSz = is64 ? 24 : 16;
 
     for (int i = 0; i < shnum; ++i) {
-        int sOff = shoff + i * shentsize;
-        if (sOff + shentsize > data.size()) break;
-        quint32 sh_type = u32(sOff + 4);
+        qint64 sOff = (qint64)shoff + (qint64)i * shentsize;
+        if (!elf.contains(sOff, shentsize)) break;
+        quint32 sh_type = elf.u32(sOff + 4);
         if (sh_type == 11) { // SHT_DYNSYM
-            dynsymOff  = (int)(is64 ? u64(sOff + 24) : u32(sOff + 16));
-            dynsymSize = (int)(is64 ? u64(sOff + 32) : u32(sOff + 20));
-            dynsymLink = (int) u32(sOff + (is64 ? 40 : 24));
-            quint64 esz = is64 ? u64(sOff + 56) : u32(sOff + 36);
-            if (esz > 0) dynsymEntSz = (int)esz;
+            dynsymOff  = is64 ? elf.u64(sOff + 24) : elf.u32(sOff + 16);
+            dynsymSize = is64 ? elf.u64(sOff + 32) : elf.u32(sOff + 20);
+            dynsymLink = elf.u32(sOff + (is64 ? 40 : 24));
+            quint64 esz = is64 ? elf.u64(sOff + 56) : elf.u32(sOff + 36);
+            if (esz > 0) dynsymEntSz = esz;
             break;
         }
     }
-    if (dynsymOff <= 0) return;
+    if (dynsymOff == 0 || dynsymOff >= (quint64)elf.size()) return;
 
     // Find linked string table section
-    QByteArray dynstr;
-    if (dynsymLink > 0 && dynsymLink < shnum) {
-        int sOff = shoff + dynsymLink * shentsize;
-        int strOff  = (int)(is64 ? u64(sOff + 24) : u32(sOff + 16));
-        int strSize = (int)(is64 ? u64(sOff + 32) : u32(sOff + 20));
-        if (strOff > 0 && strOff + strSize <= data.size())
-            dynstr = data.mid(strOff, strSize);
+    quint64 strOff  = 0;
+    quint64 strSize = 0;
+    if (dynsymLink > 0 && dynsymLink < (quint32)shnum) {
+        qint64 sOff = (qint64)shoff + (qint64)dynsymLink * shentsize;
+        strOff  = is64 ? elf.u64(sOff + 24) : elf.u32(sOff + 16);
+        strSize = is64 ? elf.u64(sOff + 32) : elf.u32(sOff + 20);
+        if (strOff == 0 || strOff > (quint64)elf.size() ||
+            strSize > (quint64)elf.size() - strOff)
+            strSize = 0;
     }
-    if (dynstr.isEmpty()) return;
+    if (strSize == 0) return;
 
-    int numSyms = dynsymSize / dynsymEntSz;
+    quint64 numSyms = dynsymSize / dynsymEntSz;
     QString lastLib = "(ELF dynamic)";
     int added = 0;
     const int kMaxImports = 500;
 
-    for (int i = 1; i < numSyms && added < kMaxImports; ++i) {
-        int symOff = dynsymOff + i * dynsymEntSz;
-        if (symOff + dynsymEntSz > data.size()) break;
+    for (quint64 i = 1; i < numSyms && added < kMaxImports; ++i) {
+        qint64 symOff = (qint64)(dynsymOff + i * dynsymEntSz);
+        if (!elf.contains(symOff, (qint64)dynsymEntSz)) break;
 
-        quint32 st_name = u32(symOff);
-        if (st_name == 0 || st_name >= (quint32)dynstr.size()) continue;
+        quint32 st_name = elf.u32(symOff);
+        if (st_name == 0 || st_name >= strSize) continue;
 
-        QString symName = QString::fromLatin1(dynstr.constData() + st_name);
+        QString symName = elf.cString((qint64)(strOff + st_name), (qint64)(strSize - st_name));
         if (symName.isEmpty()) continue;
 
         addImportRow(lastLib, symName);
@@ -475,38 +466,21 @@ void BinaryInspectorWidget::parseELFDynSymbols(const QByteArray &data,
 // ─────────────────────────────────────────────────────────────────────────────
 //  PE Parser
 // ─────────────────────────────────────────────────────────────────────────────
-bool BinaryInspectorWidget::parsePE(const QByteArray &data)
+bool BinaryInspectorWidget::parsePE(const BinaryReader &data)
 {
     if (data.size() < 0x40) return false;
 
-    // All PE values are little-endian
-    auto u8  = [&](int off) -> quint8  { return (quint8)data[off]; };
-    auto u16 = [&](int off) -> quint16 {
-        if (off + 2 > data.size()) return 0;
-        quint16 v; memcpy(&v, data.constData() + off, 2);
-        return qFromLittleEndian(v);
-    };
-    auto u32 = [&](int off) -> quint32 {
-        if (off + 4 > data.size()) return 0;
-        quint32 v; memcpy(&v, data.constData() + off, 4);
-        return qFromLittleEndian(v);
-    };
-    auto u64 = [&](int off) -> quint64 {
-        if (off + 8 > data.size()) return 0;
-        quint64 v; memcpy(&v, data.constData() + off, 8);
-        return qFromLittleEndian(v);
-    };
-
-    quint32 peOff = u32(0x3C);
-    if (peOff + 24 > (quint32)data.size()) return false;
+    // All PE values are little-endian, the reader's default
+    quint32 peOff = data.u32(0x3C);
+    if (!data.contains(peOff, 24)) return false;
 
     // ── COFF header (immediately after PE signature) ───────────────────────
-    int coffBase = (int)peOff + 4;
-    quint16 machine      = u16(coffBase);
-    quint16 numSections  = u16(coffBase + 2);
-    quint32 timeStamp    = u32(coffBase + 4);
-    quint16 optHdrSize   = u16(coffBase + 16);
-    quint16 characts     = u16(coffBase + 18);
+    qint64 coffBase = (qint64)peOff + 4;
+    quint16 machine      = data.u16(coffBase);
+    quint16 numSections  = data.u16(coffBase + 2);
+    quint32 timeStamp    = data.u32(coffBase + 4);
+    quint16 optHdrSize   = data.u16(coffBase + 16);
+    quint16 characts     = data.u16(coffBase + 18);
 
     auto machineName = [](quint16 m) -> QString {
         switch (m) {
@@ -545,9 +519,9 @@ bool BinaryInspectorWidget::parsePE(const QByteArray &data)
     addHeaderRow("Characteristics",     buildCharsStr(characts),             "File attribute flags");
 
     // ── Optional header ────────────────────────────────────────────────────
-    int optBase = coffBase + 20;   // optional header starts here
-    if (optHdrSize >= 2 && optBase + 2 <= data.size()) {
-        quint16 magic     = u16(optBase);
+    qint64 optBase = coffBase + 20;   // optional header starts here
+    if (optHdrSize >= 2 && data.contains(optBase, 2)) {
+        quint16 magic     = data.u16(optBase);
         bool    pe32plus  = (magic == 0x020B);
 
         auto subsysName = [](quint16 s) -> QString {
@@ -567,14 +541,14 @@ bool BinaryInspectorWidget::parsePE(const QByteArray &data)
             }
         };
 
-        quint32 aoe      = u32(optBase + 16);
-        quint64 imgBase  = pe32plus ? u64(optBase + 24) : u32(optBase + 28);
-        quint32 secAlign = u32(optBase + 32);
-        quint32 filAlign = u32(optBase + 36);
-        quint16 majorOS  = u16(optBase + 40);
-        quint16 minorOS  = u16(optBase + 42);
-        quint32 sizeImg  = u32(optBase + 56);
-        quint16 subsys   = u16(optBase + 68);
+        quint32 aoe      = data.u32(optBase + 16);
+        quint64 imgBase  = pe32plus ? data.u64(optBase + 24) : data.u32(optBase + 28);
+        quint32 secAlign = data.u32(optBase + 32);
+        quint32 filAlign = data.u32(optBase + 36);
+        quint16 majorOS  = data.u16(optBase + 40);
+        quint16 minorOS  = data.u16(optBase + 42);
+        quint32 sizeImg  = data.u32(optBase + 56);
+        quint16 subsys   = data.u16(optBase + 68);
 
         addHeaderRow("Optional Magic",     pe32plus ? "PE32+ (64-bit)" : "PE32 (32-bit)", "Optional header type");
         addHeaderRow("Entry Point (RVA)",  QString("0x%1").arg(aoe, 8, 16, QChar('0')),   "Address of entry point");
@@ -598,11 +572,11 @@ bool BinaryInspectorWidget::parsePE(const QByteArray &data)
         // Offset is from beginning of Optional Header.
         // PE32  (32-bit): DataDirectory starts at offset 96
         // PE32+ (64-bit): DataDirectory starts at offset 112
-        int ddBase = optBase + (pe32plus ? 112 : 96);
-        quint32 importRVA  = (ddBase + 8 <= data.size()) ? u32(ddBase + 8)  : 0;
+        qint64 ddBase = optBase + (pe32plus ? 112 : 96);
+        quint32 importRVA  = data.u32(ddBase + 8);   // 0 past the end
 
         // ── Section headers ────────────────────────────────────────────────
-        int firstSecOff = optBase + optHdrSize;
+        qint64 firstSecOff = optBase + optHdrSize;
         parsePESections(data, firstSecOff, (int)numSections);
 
         // ── Imports ────────────────────────────────────────────────────────
@@ -613,16 +587,10 @@ bool BinaryInspectorWidget::parsePE(const QByteArray &data)
     return true;
 }
 
-void BinaryInspectorWidget::parsePESections(const QByteArray &data,
-                                             int firstSectionOff,
+void BinaryInspectorWidget::parsePESections(const BinaryReader &data,
+                                             qint64 firstSectionOff,
                                              int numSections)
 {
-    auto u32 = [&](int off) -> quint32 {
-        if (off + 4 > data.size()) return 0;
-        quint32 v; memcpy(&v, data.constData() + off, 4);
-        return qFromLittleEndian(v);
-    };
-
     auto secFlags = [](quint32 c) -> QString {
         QStringList f;
         if (c & 0x00000020) f << "CODE";
@@ -637,19 +605,19 @@ void BinaryInspectorWidget::parsePESections(const QByteArray &data,
     m_peSections.clear();
 
     for (int i = 0; i < numSections; ++i) {
-        int sOff = firstSectionOff + i * 40;
-        if (sOff + 40 > data.size()) break;
+        qint64 sOff = firstSectionOff + (qint64)i * 40;
+        if (!data.contains(sOff, 40)) break;
 
         // Name: 8 bytes, null-padded
         char nameBuf[9] = {};
-        memcpy(nameBuf, data.constData() + sOff, 8);
+        data.read(sOff, nameBuf, 8);
         QString name = QString::fromLatin1(nameBuf).trimmed();
 
-        quint32 virtualSize    = u32(sOff + 8);
-        quint32 virtualAddress = u32(sOff + 12);
-        quint32 rawSize        = u32(sOff + 16);
-        quint32 rawOffset      = u32(sOff + 20);
-        quint32 characteristics = u32(sOff + 36);
+        quint32 virtualSize    = data.u32(sOff + 8);
+        quint32 virtualAddress = data.u32(sOff + 12);
+        quint32 rawSize        = data.u32(sOff + 16);
+        quint32 rawOffset      = data.u32(sOff + 20);
+        quint32 characteristics = data.u32(sOff + 36);
 
         // Store for RVA→offset mapping
         m_peSections.append({ virtualAddress, virtualSize, rawOffset, rawSize });
@@ -662,28 +630,11 @@ void BinaryInspectorWidget::parsePESections(const QByteArray &data,
     }
 }
 
-void BinaryInspectorWidget::parsePEImports(const QByteArray &data,
+void BinaryInspectorWidget::parsePEImports(const BinaryReader &data,
                                             quint32 importRVA,
                                             bool pe32plus)
 {
-    auto u32 = [&](int off) -> quint32 {
-        if (off < 0 || off + 4 > data.size()) return 0;
-        quint32 v; memcpy(&v, data.constData() + off, 4);
-        return qFromLittleEndian(v);
-    };
-    auto u64 = [&](int off) -> quint64 {
-        if (off < 0 || off + 8 > data.size()) return 0;
-        quint64 v; memcpy(&v, data.constData() + off, 8);
-        return qFromLittleEndian(v);
-    };
-    auto readCStr = [&](int off) -> QString {
-        if (off < 0 || off >= data.size()) return QString();
-        int end = off;
-        while (end < data.size() && data[end] != 0) ++end;
-        return QString::fromLatin1(data.constData() + off, end - off);
-    };
-
-    int descOff = rvaToOffset(importRVA);
+    qint64 descOff = rvaToOffset(importRVA);
     if (descOff < 0) return;
 
     const int kMaxDlls    = 64;
@@ -691,10 +642,10 @@ void BinaryInspectorWidget::parsePEImports(const QByteArray &data,
     int dllCount = 0;
 
     // Walk IMAGE_IMPORT_DESCRIPTOR array (20 bytes each, ends with all-zero entry)
-    while (descOff + 20 <= data.size() && dllCount < kMaxDlls) {
-        quint32 oft      = u32(descOff);       // OriginalFirstThunk
-        quint32 nameRVA  = u32(descOff + 12);  // Name (RVA)
-        quint32 ft       = u32(descOff + 16);  // FirstThunk
+    while (data.contains(descOff, 20) && dllCount < kMaxDlls) {
+        quint32 oft      = data.u32(descOff);       // OriginalFirstThunk
+        quint32 nameRVA  = data.u32(descOff + 12);  // Name (RVA)
+        quint32 ft       = data.u32(descOff + 16);  // FirstThunk
 
         // Null terminator entry
         if (oft == 0 && nameRVA == 0 && ft == 0) break;
@@ -703,22 +654,22 @@ void BinaryInspectorWidget::parsePEImports(const QByteArray &data,
         ++dllCount;
 
         if (nameRVA == 0) continue;
-        int nameOff = rvaToOffset(nameRVA);
+        qint64 nameOff = rvaToOffset(nameRVA);
         if (nameOff < 0) continue;
-        QString dllName = readCStr(nameOff);
+        QString dllName = data.cString(nameOff);
         if (dllName.isEmpty()) continue;
 
         // Walk thunk array (use OFT if available, else FT)
         quint32 thunkRVA = (oft != 0) ? oft : ft;
         if (thunkRVA == 0) { addImportRow(dllName, "(no symbols)"); continue; }
 
-        int thunkOff = rvaToOffset(thunkRVA);
+        qint64 thunkOff = rvaToOffset(thunkRVA);
         if (thunkOff < 0) { addImportRow(dllName, "(unresolvable thunks)"); continue; }
 
         int entrySize = pe32plus ? 8 : 4;
         int symCount = 0;
-        while (thunkOff + entrySize <= data.size() && symCount < kMaxSymsPerDll) {
-            quint64 thunkVal = pe32plus ? u64(thunkOff) : u32(thunkOff);
+        while (data.contains(thunkOff, entrySize) && symCount < kMaxSymsPerDll) {
+            quint64 thunkVal = pe32plus ? data.u64(thunkOff) : data.u32(thunkOff);
             thunkOff += entrySize;
 
             if (thunkVal == 0) break;
@@ -731,10 +682,10 @@ void BinaryInspectorWidget::parsePEImports(const QByteArray &data,
                 addImportRow(dllName, QString("Ordinal #%1").arg(thunkVal & 0xFFFF));
             } else {
                 // Import by name: thunkVal is RVA to IMAGE_IMPORT_BY_NAME
-                int ibnOff = rvaToOffset((quint32)thunkVal);
+                qint64 ibnOff = rvaToOffset((quint32)thunkVal);
                 if (ibnOff >= 0 && ibnOff + 2 < data.size()) {
                     // Skip the 2-byte Hint field
-                    QString sym = readCStr(ibnOff + 2);
+                    QString sym = data.cString(ibnOff + 2);
                     if (!sym.isEmpty())
                         addImportRow(dllName, sym);
                 }
@@ -746,12 +697,14 @@ void BinaryInspectorWidget::parsePEImports(const QByteArray &data,
     }
 }
 
-int BinaryInspectorWidget::rvaToOffset(quint32 rva) const
+qint64 BinaryInspectorWidget::rvaToOffset(quint32 rva) const
 {
+    // In qint64: a crafted header can make the section end wrap in quint32
     for (const auto &sec : m_peSections) {
-        if (rva >= sec.virtualAddress &&
-            rva <  sec.virtualAddress + qMax(sec.virtualSize, sec.rawSize)) {
-            int off = (int)(sec.rawOffset + (rva - sec.virtualAddress));
+        const qint64 start = sec.virtualAddress;
+        const qint64 end = start + qMax(sec.virtualSize, sec.rawSize);
+        if (rva >= start && rva < end) {
+            qint64 off = (qint64)sec.rawOffset + (rva - start);
             return off;
         }
     }
@@ -761,50 +714,64 @@ int BinaryInspectorWidget::rvaToOffset(quint32 rva) const
 // ─────────────────────────────────────────────────────────────────────────────
 //  String Extractor
 // ─────────────────────────────────────────────────────────────────────────────
-void BinaryInspectorWidget::extractStrings(const QByteArray &data)
+void BinaryInspectorWidget::extractStrings(const BinaryReader &data)
 {
     const int kMinLen   = 5;
     const int kMaxStrs  = 2000;
+    const int kMaxShown = 1024;                      // longer runs are cut short
+    const qint64 kMaxScan = 256LL * 1024 * 1024;     // stay responsive on huge files
+    const qint64 kWindow  = 1024 * 1024;
     QStringList results;
 
-    int i = 0;
-    while (i < data.size() && results.size() < kMaxStrs) {
-        // Try ASCII run
-        if ((quint8)data[i] >= 0x20 && (quint8)data[i] <= 0x7E) {
-            int start = i;
-            while (i < data.size() &&
-                   (quint8)data[i] >= 0x20 && (quint8)data[i] <= 0x7E)
-                ++i;
-            int len = i - start;
-            if (len >= kMinLen) {
-                results << QString("0x%1  %2")
-                               .arg((quint32)start, 8, 16, QChar('0'))
-                               .arg(QString::fromLatin1(data.constData() + start, len));
-            }
-            continue;
+    // Walk the mapping through a sliding window rather than a whole-file copy
+    const qint64 size = qMin(data.size(), kMaxScan);
+    QByteArray scratch;
+    const char *window = nullptr;
+    qint64 winStart = 0, winEnd = 0;
+    auto at = [&](qint64 i) -> quint8 {
+        if (i < winStart || i >= winEnd) {
+            winStart = i;
+            winEnd   = qMin(i + kWindow, size);
+            window   = data.bytes(i, winEnd - i, scratch);
         }
+        return (quint8)window[i - winStart];
+    };
+    auto printable = [&](qint64 i) { quint8 c = at(i); return c >= 0x20 && c <= 0x7E; };
+
+    qint64 i = 0;
+    while (i < size && results.size() < kMaxStrs) {
+        if (!printable(i)) { ++i; continue; }
 
         // Try UTF-16LE run (letter, 0x00, letter, 0x00, …)
-        if (i + 1 < data.size() &&
-            (quint8)data[i] >= 0x20 && (quint8)data[i] <= 0x7E &&
-            data[i + 1] == 0x00) {
-            int start = i;
+        if (i + 1 < size && at(i + 1) == 0x00) {
+            qint64 start = i;
+            int len = 0;
             QString utf16;
-            while (i + 1 < data.size() &&
-                   (quint8)data[i] >= 0x20 && (quint8)data[i] <= 0x7E &&
-                   data[i + 1] == 0x00) {
-                utf16 += QChar(data[i]);
+            while (i + 1 < size && printable(i) && at(i + 1) == 0x00) {
+                if (len++ < kMaxShown)
+                    utf16 += QChar(at(i));
                 i += 2;
             }
-            if (utf16.length() >= kMinLen) {
+            if (len >= kMinLen) {
                 results << QString("0x%1  [UTF-16] %2")
-                               .arg((quint32)start, 8, 16, QChar('0'))
+                               .arg((quint64)start, 8, 16, QChar('0'))
                                .arg(utf16);
             }
             continue;
         }
 
-        ++i;
+        // ASCII run
+        qint64 start = i;
+        while (i < size && printable(i))
+            ++i;
+        qint64 len = i - start;
+        if (len >= kMinLen) {
+            QByteArray text((int)qMin<qint64>(len, kMaxShown), Qt::Uninitialized);
+            data.read(start, text.data(), text.size());
+            results << QString("0x%1  %2")
+                           .arg((quint64)start, 8, 16, QChar('0'))
+                           .arg(QString::fromLatin1(text));
+        }
     }
 
     m_stringsView->setPlainText(results.join('\n'));
@@ -914,7 +881,18 @@ QString BinaryInspectorWidget::formatSize(qint64 bytes)
     return QString("%1 GB").arg(bytes / (1024LL * 1024 * 1024));
 }
 
-QString BinaryInspectorWidget::computeMD5(const QByteArray &data)
+void BinaryInspectorWidget::computeMD5(const PieceTable::Snapshot &data)
 {
-    return QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+    if (!m_checksum) {
+        m_checksum = new Checksum(this);
+        connect(m_checksum, &Checksum::finished, this,
+                [this](const QVector<Checksum::Result> &results) {
+            const QString md5 = results.isEmpty() ? QString("-") : results.first().hex;
+            m_fileInfoLabel->setText(m_fileInfo + md5);
+            if (m_md5Row >= 0 && m_md5Row < m_headerTable->rowCount())
+                m_headerTable->item(m_md5Row, 1)->setText(md5);
+        });
+    }
+    // The snapshot keeps the mapping alive until the worker is done with it
+    m_checksum->start(data, 0, data.size(), Checksum::Md5);
 }
\ No newline at end of file
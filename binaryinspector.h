@@ -13,10 +13,51 @@
 #include <QString>
 #include <QVector>
 
+#include "piecetable.h"
+
+class Checksum;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  BinaryReader
+//  Bounds-checked random access into a PieceTable snapshot, which for a file
+//  opened from disk reads straight from its memory mapping.  Reads that run
+//  past the end yield zero or an empty string, so parsers can follow any
+//  offset a header hands them.
+// ─────────────────────────────────────────────────────────────────────────────
+class BinaryReader
+{
+public:
+    explicit BinaryReader(const PieceTable::Snapshot &data, bool littleEndian = true)
+        : m_data(data), m_littleEndian(littleEndian) {}
+
+    const PieceTable::Snapshot &snapshot() const { return m_data; }
+    qint64 size() const { return m_data.size(); }
+    bool   contains(qint64 off, qint64 length) const;
+
+    quint8  u8 (qint64 off) const { return read<quint8>(off); }
+    quint16 u16(qint64 off) const { return read<quint16>(off); }
+    quint32 u32(qint64 off) const { return read<quint32>(off); }
+    quint64 u64(qint64 off) const { return read<quint64>(off); }
+
+    qint64 read(qint64 off, char *dest, qint64 length) const;
+    // Points into the mapping when it can, otherwise copies into scratch
+    const char *bytes(qint64 off, qint64 length, QByteArray &scratch) const;
+    // NUL-terminated Latin-1 string, cut off after maxLength bytes
+    QString cString(qint64 off, qint64 maxLength = 4096) const;
+
+private:
+    template <typename T> T read(qint64 off) const;
+
+    PieceTable::Snapshot m_data;
+    bool m_littleEndian;
+};
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  BinaryInspectorWidget
 //  Parses ELF and PE binaries natively (no external tools required) and
 //  presents headers, sections, imports and extracted strings in a tabbed view.
+//  Files are mapped rather than read, and every table is parsed in place, so
+//  memory use does not grow with the size of the binary.
 // ─────────────────────────────────────────────────────────────────────────────
 class BinaryInspectorWidget : public QWidget
 {
@@ -25,13 +66,16 @@ class BinaryInspectorWidget : public QWidget
 public:
     explicit BinaryInspectorWidget(QWidget *parent = nullptr);
 
-    // Load a file from disk; returns false if the file could not be read.
+    // Load a file from disk; returns false if the file could not be opened.
     bool    loadFile(const QString &filePath);
     QString getFilePath() const { return m_filePath; }
 
 private:
     // ── state ─────────────────────────────────────────────────────────────────
     QString m_filePath;
+    QString m_fileInfo;                     // info bar text before the MD5
+    int m_md5Row = -1;                      // header row waiting for the MD5
+    Checksum *m_checksum = nullptr;
 
     // RVA → file-offset mapping (used by PE import parser)
     struct SectionMapping {
@@ -54,27 +98,27 @@ private:
     void setupUI();
 
     // ── analysis entry points ─────────────────────────────────────────────────
-    void analyzeFile(const QByteArray &data);
+    void analyzeFile(const PieceTable::Snapshot &data);
 
     // Returns true when the magic bytes indicate ELF / PE
-    bool parseELF(const QByteArray &data);
-    bool parsePE (const QByteArray &data);
+    bool parseELF(const BinaryReader &data);
+    bool parsePE (const BinaryReader &data);
 
     // Always called regardless of format
-    void extractStrings(const QByteArray &data);
+    void extractStrings(const BinaryReader &data);
 
-    // ── ELF helpers ───────────────────────────────────────────────────────────
-    void parseELFSections  (const QByteArray &data, bool is64, bool le,
-                             int shoff, int shentsize, int shnum, int shstrndx);
-    void parseELFDynSymbols(const QByteArray &data, bool is64, bool le);
+    // ── ELF helpers (elf reads in the file's byte order) ──────────────────────
+    void parseELFSections  (const BinaryReader &elf, bool is64,
+                             qint64 shoff, int shentsize, int shnum, int shstrndx);
+    void parseELFDynSymbols(const BinaryReader &elf, bool is64);
 
     // ── PE helpers ────────────────────────────────────────────────────────────
-    void parsePESections(const QByteArray &data, int firstSectionOff,
+    void parsePESections(const BinaryReader &data, qint64 firstSectionOff,
                          int numSections);
-    void parsePEImports (const QByteArray &data, quint32 importRVA,
+    void parsePEImports (const BinaryReader &data, quint32 importRVA,
                          bool pe32plus);
 
-    int  rvaToOffset(quint32 rva) const;   // uses m_peSections
+    qint64 rvaToOffset(quint32 rva) const;   // uses m_peSections
 
     // ── table helpers ─────────────────────────────────────────────────────────
     // Append one row to m_headerTable
@@ -95,7 +139,8 @@ private:
 
     // ── misc helpers ──────────────────────────────────────────────────────────
     static QString formatSize   (qint64 bytes);
-    static QString computeMD5   (const QByteArray &data);
+    // Hashes off the GUI thread and fills the MD5 in when done
+    void computeMD5(const PieceTable::Snapshot &data);
 
     // Style helpers
     void styleTable  (QTableWidget *t);
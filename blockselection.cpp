@@ -0,0 +1,125 @@
+#include "blockselection.h"
+
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <cmath>
+
+void BlockSelection::start(int line, int column)
+{
+    m_active = true;
+    m_anchorLine = m_line = line;
+    m_anchorColumn = m_column = qMax(0, column);
+}
+
+void BlockSelection::extendTo(int line, int column)
+{
+    m_line = line;
+    m_column = qMax(0, column);
+}
+
+// Column after character c that starts at column x
+static qreal advance(qreal x, QChar c, qreal tabWidth)
+{
+    if (c != QLatin1Char('\t'))
+        return x + 1;
+    return (std::floor(x / tabWidth + 1e-6) + 1) * tabWidth;
+}
+
+int BlockSelection::column(QStringView text, int position) const
+{
+    qreal x = 0;
+    const int end = qMin(position, int(text.size()));
+    for (int i = 0; i < end; ++i)
+        x = advance(x, text[i], m_tabWidth);
+    return qRound(x) + qMax(0, position - end);
+}
+
+int BlockSelection::position(QStringView text, int column, int *padding) const
+{
+    if (padding)
+        *padding = 0;
+    qreal x = 0;
+    for (int i = 0; i < text.size(); ++i) {
+        const qreal next = advance(x, text[i], m_tabWidth);
+        // A column inside a tab goes to whichever edge is closer
+        if (2 * column < x + next)
+            return i;
+        x = next;
+    }
+    if (padding)
+        *padding = qMax(0, column - qRound(x));
+    return int(text.size());
+}
+
+QString BlockSelection::text(const QTextDocument *doc) const
+{
+    QString out;
+    QTextBlock block = doc->findBlockByNumber(topLine());
+    for (int line = topLine(); line <= bottomLine() && block.isValid();
+         ++line, block = block.next()) {
+        if (line > topLine())
+            out += '\n';
+        const QString row = block.text();
+        const int from = position(row, leftColumn());
+        out += QStringView(row).mid(from, position(row, rightColumn()) - from);
+    }
+    return out;
+}
+
+void BlockSelection::replace(QTextDocument *doc, const QStringList &rows)
+{
+    apply(doc, leftColumn(), rightColumn(), rows, 0);
+}
+
+void BlockSelection::deletePrevious(QTextDocument *doc)
+{
+    apply(doc, leftColumn(), rightColumn(), {QString()}, -1);
+}
+
+void BlockSelection::deleteNext(QTextDocument *doc)
+{
+    apply(doc, leftColumn(), rightColumn(), {QString()}, 1);
+}
+
+void BlockSelection::apply(QTextDocument *doc, int from, int to,
+                           const QStringList &rows, int step)
+{
+    // Where the caret lands when its own row has nothing to edit
+    int column = from == to && step < 0 ? qMax(0, from - 1) : from;
+
+    QTextCursor cursor(doc);
+    cursor.beginEditBlock();
+    QTextBlock block = doc->findBlockByNumber(topLine());
+    for (int i = 0; i < rowCount() && block.isValid(); ++i, block = block.next()) {
+        const QString row = rows.size() == 1 ? rows.first() : rows.value(i);
+        const QString text = block.text();
+        int padding = 0;
+        int start = position(text, from, &padding);
+        int end = qMax(start, position(text, to));
+        if (from == to && padding == 0) {
+            // One character either side, which may be a whole tab
+            if (step < 0)
+                start = qMax(0, start - 1);
+            else if (step > 0)
+                end = qMin(int(text.size()), end + 1);
+        }
+        if (start == end && row.isEmpty())
+            continue;   // nothing under the selection on this row
+
+        const QString insert = QString(padding, ' ') + row;
+        // Edits stay inside the row, so the block handle remains valid
+        cursor.setPosition(block.position() + start);
+        cursor.setPosition(block.position() + end, QTextCursor::KeepAnchor);
+        if (insert.isEmpty())
+            cursor.removeSelectedText();
+        else
+            cursor.insertText(insert);
+        if (topLine() + i == m_line)
+            column = this->column(block.text(), start + int(insert.size()));
+    }
+    cursor.endEditBlock();
+
+    m_anchorColumn = m_column = column;
+}
@@ -0,0 +1,65 @@
+#ifndef BLOCKSELECTION_H
+#define BLOCKSELECTION_H
+
+#include <QStringList>
+
+class QTextDocument;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  BlockSelection
+//  Rectangular (column) selection stored as a line range × column range, so
+//  selecting 100k rows costs four integers.  Edits walk the rows with one
+//  QTextCursor inside a single edit block, which keeps the whole operation
+//  one undo step.  Columns count character cells with tabs expanded to the
+//  editor's tab stops, so the block stays rectangular on screen; rows
+//  shorter than the left column are padded with spaces when text is
+//  inserted past their end.
+// ─────────────────────────────────────────────────────────────────────────────
+class BlockSelection
+{
+public:
+    bool isActive() const { return m_active; }
+    void start(int line, int column);
+    void extendTo(int line, int column);
+    void clear() { m_active = false; }
+
+    int topLine() const { return qMin(m_anchorLine, m_line); }
+    int bottomLine() const { return qMax(m_anchorLine, m_line); }
+    int leftColumn() const { return qMin(m_anchorColumn, m_column); }
+    int rightColumn() const { return qMax(m_anchorColumn, m_column); }
+    int cursorLine() const { return m_line; }
+    int cursorColumn() const { return m_column; }
+    int rowCount() const { return bottomLine() - topLine() + 1; }
+
+    // Tab stop spacing in columns (tabStopDistance over the space advance)
+    void setTabWidth(qreal columns) { m_tabWidth = qMax<qreal>(1, columns); }
+    // Column where position starts on a row of text
+    int column(QStringView text, int position) const;
+    // Position on a row nearest to column; past the end of the row it is
+    // the row length, and padding receives the columns left over
+    int position(QStringView text, int column, int *padding = nullptr) const;
+
+    // Selected slice of every row, joined with newlines
+    QString text(const QTextDocument *doc) const;
+
+    // Replaces the selected columns on each row.  A single string goes on
+    // every row; otherwise row i receives rows[i].  The selection collapses
+    // to a zero-width column after the inserted text.
+    void replace(QTextDocument *doc, const QStringList &rows);
+    void deletePrevious(QTextDocument *doc);
+    void deleteNext(QTextDocument *doc);
+
+private:
+    // step is -1 or 1 to delete one character on each row when the block
+    // is zero columns wide, 0 otherwise
+    void apply(QTextDocument *doc, int from, int to, const QStringList &rows, int step);
+
+    bool m_active = false;
+    int m_anchorLine = 0;
+    int m_anchorColumn = 0;
+    int m_line = 0;
+    int m_column = 0;
+    qreal m_tabWidth = 8;
+};
+
+#endif // BLOCKSELECTION_H
@@ -0,0 +1,409 @@
+#include "checksum.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QCryptographicHash>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QtEndian>
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Slicing-by-8 tables for the reflected IEEE polynomial (zlib's CRC32)
+struct CrcTables {
+    quint32 t[8][256];
+    CrcTables()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[0][i] = c;
+        }
+        for (int s = 1; s < 8; ++s)
+            for (int i = 0; i < 256; ++i)
+                t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+    }
+};
+const CrcTables crcTables;
+
+// Multiplication of a bit vector by a 32x32 matrix over GF(2), for
+// crc32Combine()
+quint32 gf2Times(const quint32 *matrix, quint32 vector)
+{
+    quint32 sum = 0;
+    for (; vector; vector >>= 1, ++matrix) {
+        if (vector & 1)
+            sum ^= *matrix;
+    }
+    return sum;
+}
+
+void gf2Square(quint32 *square, const quint32 *matrix)
+{
+    for (int n = 0; n < 32; ++n)
+        square[n] = gf2Times(matrix, matrix[n]);
+}
+
+// XXH64, streaming form
+class XxHash64State
+{
+public:
+    void update(const char *data, qint64 length)
+    {
+        const uchar *p = reinterpret_cast<const uchar *>(data);
+        const uchar *end = p + length;
+        m_total += quint64(length);
+        if (m_buffered + length < 32) {
+            memcpy(m_buffer + m_buffered, p, size_t(length));
+            m_buffered += int(length);
+            return;
+        }
+        if (m_buffered) {
+            const int fill = 32 - m_buffered;
+            memcpy(m_buffer + m_buffered, p, size_t(fill));
+            consume(m_buffer);
+            p += fill;
+            m_buffered = 0;
+        }
+        for (; p + 32 <= end; p += 32)
+            consume(p);
+        m_buffered = int(end - p);
+        memcpy(m_buffer, p, size_t(m_buffered));
+    }
+
+    quint64 digest() const
+    {
+        quint64 h;
+        if (m_total >= 32) {
+            h = rotl(m_v[0], 1) + rotl(m_v[1], 7) + rotl(m_v[2], 12) + rotl(m_v[3], 18);
+            for (quint64 v : m_v)
+                h = (h ^ round(0, v)) * P1 + P4;
+        } else {
+            h = P5;
+        }
+        h += m_total;
+        const uchar *p = m_buffer;
+        const uchar *end = p + m_buffered;
+        for (; p + 8 <= end; p += 8)
+            h = rotl(h ^ round(0, qFromLittleEndian<quint64>(p)), 27) * P1 + P4;
+        if (p + 4 <= end) {
+            h = rotl(h ^ (quint64(qFromLittleEndian<quint32>(p)) * P1), 23) * P2 + P3;
+            p += 4;
+        }
+        for (; p < end; ++p)
+            h = rotl(h ^ (*p * P5), 11) * P1;
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static constexpr quint64 P1 = 0x9E3779B185EBCA87ULL;
+    static constexpr quint64 P2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr quint64 P3 = 0x165667B19E3779F9ULL;
+    static constexpr quint64 P4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr quint64 P5 = 0x27D4EB2F165667C5ULL;
+
+    static quint64 rotl(quint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+    static quint64 round(quint64 acc, quint64 input) { return rotl(acc + input * P2, 31) * P1; }
+
+    void consume(const uchar *p)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+            m_v[lane] = round(m_v[lane], qFromLittleEndian<quint64>(p + 8 * lane));
+    }
+
+    quint64 m_v[4] = {P1 + P2, P2, 0, 0 - P1};
+    quint64 m_total = 0;
+    uchar m_buffer[32];
+    int m_buffered = 0;
+};
+
+} // namespace
+
+QString Checksum::name(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Md5:      return "MD5";
+    case Sha1:     return "SHA-1";
+    case Sha256:   return "SHA-256";
+    case Crc32:    return "CRC32";
+    case XxHash64: return "XXH64";
+    default:       return QString();
+    }
+}
+
+quint32 Checksum::crc32(quint32 crc, const char *data, qint64 length)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    const auto &t = crcTables.t;
+    crc = ~crc;
+    for (; length >= 8; length -= 8, p += 8) {
+        const quint32 lo = qFromLittleEndian<quint32>(p) ^ crc;
+        const quint32 hi = qFromLittleEndian<quint32>(p + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^
+              t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+              t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    while (length-- > 0)
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+quint32 Checksum::crc32Combine(quint32 crc1, quint32 crc2, qint64 length2)
+{
+    // zlib's method: apply length2 zero bytes to crc1 through repeated
+    // squaring of the one-zero-bit operator, then fold in crc2
+    if (length2 <= 0)
+        return crc1;
+    quint32 even[32];
+    quint32 odd[32];
+    odd[0] = 0xEDB88320u;
+    quint32 row = 1;
+    for (int n = 1; n < 32; ++n, row <<= 1)
+        odd[n] = row;
+    gf2Square(even, odd);       // two zero bits
+    gf2Square(odd, even);       // four zero bits
+    do {
+        gf2Square(even, odd);
+        if (length2 & 1)
+            crc1 = gf2Times(even, crc1);
+        length2 >>= 1;
+        if (!length2)
+            break;
+        gf2Square(odd, even);
+        if (length2 & 1)
+            crc1 = gf2Times(odd, crc1);
+        length2 >>= 1;
+    } while (length2);
+    return crc1 ^ crc2;
+}
+
+QVector<Checksum::Result> Checksum::compute(const PieceTable::Snapshot &data, qint64 pos,
+                                            qint64 length, int algorithms,
+                                            const std::atomic_bool &cancel,
+                                            std::atomic<qint64> *done)
+{
+    pos = qBound(qint64(0), pos, data.size());
+    length = qBound(qint64(0), length, data.size() - pos);
+
+    static const struct { Algorithm algorithm; QCryptographicHash::Algorithm qt; } digests[] = {
+        {Md5, QCryptographicHash::Md5},
+        {Sha1, QCryptographicHash::Sha1},
+        {Sha256, QCryptographicHash::Sha256},
+    };
+    std::unique_ptr<QCryptographicHash> hashes[3];
+    quint32 crc = 0;
+    XxHash64State xxh;
+
+    // One consumer per selected algorithm, all fed the same window
+    std::vector<std::function<void(const char *, qint64)>> hashers;
+    for (int i = 0; i < 3; ++i) {
+        if (!(algorithms & digests[i].algorithm))
+            continue;
+        hashes[i] = std::make_unique<QCryptographicHash>(digests[i].qt);
+        QCryptographicHash *hash = hashes[i].get();
+        hashers.push_back([hash](const char *p, qint64 n) { hash->addData(QByteArrayView(p, n)); });
+    }
+    if (algorithms & XxHash64)
+        hashers.push_back([&xxh](const char *p, qint64 n) { xxh.update(p, n); });
+    // CRC32 splits each window into lanes hashed side by side and folded
+    // back together in order with crc32Combine()
+    const int crcLanes = (algorithms & Crc32)
+                             ? qBound(1, QThread::idealThreadCount() - int(hashers.size()), 8)
+                             : 0;
+    std::vector<quint32> laneCrcs(size_t(crcLanes), 0);
+    if (hashers.empty() && crcLanes == 0)
+        return {};
+
+    // Two windows alternate: one being hashed, the next being paged in.
+    // Touching a byte per page faults a mapped file in sequentially here
+    // instead of in whichever order the hashers reach it.
+    QByteArray scratch[2];
+    auto fetch = [&](qint64 off, int slot) -> const char * {
+        const qint64 n = qMin(Chunk, length - off);
+        const char *p = data.data(pos + off, n, scratch[slot]);
+        char touched = 0;
+        for (qint64 i = 0; i < n; i += 4096)
+            touched ^= p[i];
+        volatile char sink = touched;
+        Q_UNUSED(sink)
+        return p;
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(int(hashers.size()) + crcLanes + 1);
+    const char *current = length > 0 ? fetch(0, 0) : nullptr;
+    int slot = 0;
+    for (qint64 off = 0; off < length && !cancel; off += Chunk) {
+        const qint64 n = qMin(Chunk, length - off);
+        const char *next = nullptr;
+        if (off + Chunk < length)
+            pool.start([&, off]() { next = fetch(off + Chunk, slot ^ 1); });
+        const qint64 lane = crcLanes > 0 ? (n + crcLanes - 1) / crcLanes : 0;
+        for (int l = 0; l < crcLanes; ++l) {
+            pool.start([&, l]() {
+                const qint64 from = qMin(n, l * lane);
+                laneCrcs[size_t(l)] = crc32(0, current + from, qMin(lane, n - from));
+            });
+        }
+        for (size_t i = 0; i < hashers.size(); ++i)
+            pool.start([&, i]() { hashers[i](current, n); });
+        pool.waitForDone();
+        for (int l = 0; l < crcLanes; ++l) {
+            const qint64 from = qMin(n, l * lane);
+            crc = crc32Combine(crc, laneCrcs[size_t(l)], qMin(lane, n - from));
+        }
+        current = next;
+        slot ^= 1;
+        if (done)
+            *done += n;
+    }
+    if (cancel)
+        return {};
+
+    QVector<Result> results;
+    for (int i = 0; i < 3; ++i) {
+        if (hashes[i])
+            results.append({digests[i].algorithm, name(digests[i].algorithm),
+                            QString::fromLatin1(hashes[i]->result().toHex())});
+    }
+    if (algorithms & Crc32)
+        results.append({Crc32, name(Crc32), QString("%1").arg(crc, 8, 16, QChar('0'))});
+    if (algorithms & XxHash64)
+        results.append({XxHash64, name(XxHash64), QString("%1").arg(xxh.digest(), 16, 16, QChar('0'))});
+    return results;
+}
+
+Checksum::Checksum(QObject *parent)
+    : QObject(parent)
+{
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(100);
+    connect(m_progressTimer, &QTimer::timeout, this, [this]() {
+        emit progress(m_done.load(), m_total);
+    });
+}
+
+Checksum::~Checksum()
+{
+    cancel();
+}
+
+void Checksum::start(const PieceTable::Snapshot &data, qint64 pos, qint64 length,
+                     int algorithms)
+{
+    cancel();
+    m_cancel = false;
+    m_done = 0;
+    length = qBound(qint64(0), length, data.size() - qBound(qint64(0), pos, data.size()));
+    m_total = length;
+
+    const quint64 generation = m_generation;
+    m_worker = QThread::create([this, data, pos, length, algorithms, generation]() {
+        const QVector<Result> results = compute(data, pos, length, algorithms, m_cancel, &m_done);
+        QMetaObject::invokeMethod(this, [this, results, generation]() {
+            if (generation != m_generation)
+                return;
+            m_worker = nullptr;
+            m_progressTimer->stop();
+            emit progress(m_total, m_total);
+            emit finished(results);
+        }, Qt::QueuedConnection);
+    });
+    connect(m_worker, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_worker->start(QThread::LowPriority);
+    m_progressTimer->start();
+}
+
+void Checksum::cancel()
+{
+    ++m_generation;
+    m_progressTimer->stop();
+    if (m_worker) {
+        // The pass checks the flag once per chunk
+        m_cancel = true;
+        m_worker->wait();
+        m_worker = nullptr;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  ChecksumDialog
+// ─────────────────────────────────────────────────────────────────────────────
+ChecksumDialog::ChecksumDialog(const QString &title, const PieceTable::Snapshot &data,
+                               qint64 pos, qint64 length, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Checksums - " + title);
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(620, 300);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    m_status = new QLabel(QString("Hashing %1 bytes at offset 0x%2...")
+                              .arg(length).arg(pos, 0, 16), this);
+    m_progress = new QProgressBar(this);
+    m_progress->setRange(0, 1000);
+    m_table = new QTableWidget(0, 2, this);
+    m_table->setHorizontalHeaderLabels({"Algorithm", "Value"});
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->verticalHeader()->hide();
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setFont(QFont("Consolas", 9));
+    layout->addWidget(m_status);
+    layout->addWidget(m_progress);
+    layout->addWidget(m_table, 1);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *copy = buttons->addButton("Copy All", QDialogButtonBox::ActionRole);
+    copy->setEnabled(false);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(copy, &QPushButton::clicked, this, [this]() {
+        QStringList lines;
+        for (int row = 0; row < m_table->rowCount(); ++row)
+            lines << m_table->item(row, 0)->text() + "  " + m_table->item(row, 1)->text();
+        QApplication::clipboard()->setText(lines.join('\n'));
+    });
+
+    m_checksum = new Checksum(this);
+    connect(m_checksum, &Checksum::progress, this, [this](qint64 done, qint64 total) {
+        m_progress->setValue(total > 0 ? int(done * 1000 / total) : 1000);
+    });
+    connect(m_checksum, &Checksum::finished, this,
+            [this, copy, pos, length](const QVector<Checksum::Result> &results) {
+        m_status->setText(QString("%1 bytes at offset 0x%2").arg(length).arg(pos, 0, 16));
+        for (const Checksum::Result &r : results) {
+            const int row = m_table->rowCount();
+            m_table->insertRow(row);
+            m_table->setItem(row, 0, new QTableWidgetItem(r.name));
+            m_table->setItem(row, 1, new QTableWidgetItem(r.hex));
+        }
+        m_table->resizeColumnToContents(0);
+        copy->setEnabled(true);
+    });
+    m_checksum->start(data, pos, length);
+}
+
+void ChecksumDialog::done(int result)
+{
+    m_checksum->cancel();
+    QDialog::done(result);
+}
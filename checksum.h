@@ -0,0 +1,106 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QDialog>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+#include "piecetable.h"
+
+class QLabel;
+class QProgressBar;
+class QTableWidget;
+class QThread;
+class QTimer;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Checksum
+//  MD5, SHA-1, SHA-256, CRC32 and XXH64 over a range of a PieceTable
+//  snapshot — a mapped file or a hex editor buffer with unsaved edits.
+//  The range is streamed once, in order, in Chunk-sized windows straight
+//  from the mapping: pool threads feed each window to every selected
+//  algorithm side by side while another pages in the next one, so a cold
+//  file is read from disk a single time however many digests are asked
+//  for.  CRC32 also splits each window into lanes and combines them.
+// ─────────────────────────────────────────────────────────────────────────────
+class Checksum : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Algorithm {
+        Md5      = 0x01,
+        Sha1     = 0x02,
+        Sha256   = 0x04,
+        Crc32    = 0x08,
+        XxHash64 = 0x10,
+        AllAlgorithms = 0x1F
+    };
+
+    struct Result {
+        Algorithm algorithm;
+        QString name;
+        QString hex;
+    };
+
+    static constexpr qint64 Chunk = 4 * 1024 * 1024;
+
+    static QString name(Algorithm algorithm);
+    static quint32 crc32(quint32 crc, const char *data, qint64 length);
+    // CRC32 of A followed by B from crc32(A), crc32(B) and B's length
+    static quint32 crc32Combine(quint32 crc1, quint32 crc2, qint64 length2);
+
+    // Blocking; done counts bytes hashed by every algorithm (length when
+    // complete).  Returns nothing when cancelled.
+    static QVector<Result> compute(const PieceTable::Snapshot &data, qint64 pos, qint64 length,
+                                   int algorithms, const std::atomic_bool &cancel,
+                                   std::atomic<qint64> *done = nullptr);
+
+    explicit Checksum(QObject *parent = nullptr);
+    ~Checksum() override;
+
+    void start(const PieceTable::Snapshot &data, qint64 pos, qint64 length,
+               int algorithms = AllAlgorithms);
+    void cancel();
+    bool isRunning() const { return m_worker != nullptr; }
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void finished(const QVector<Checksum::Result> &results);
+
+private:
+    QThread *m_worker = nullptr;
+    QTimer *m_progressTimer;
+    std::atomic_bool m_cancel{false};
+    std::atomic<qint64> m_done{0};
+    qint64 m_total = 0;
+    quint64 m_generation = 0;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  ChecksumDialog
+//  Non-modal results panel: progress while hashing, then one row per
+//  algorithm.  Closing it cancels the run.
+// ─────────────────────────────────────────────────────────────────────────────
+class ChecksumDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ChecksumDialog(const QString &title, const PieceTable::Snapshot &data,
+                   qint64 pos, qint64 length, QWidget *parent = nullptr);
+
+protected:
+    void done(int result) override;
+
+private:
+    Checksum *m_checksum;
+    QLabel *m_status;
+    QProgressBar *m_progress;
+    QTableWidget *m_table;
+};
+
+#endif // CHECKSUM_H
@@ -0,0 +1,49 @@
+#include "decorationlayer.h"
+
+#include <algorithm>
+
+int DecorationLayer::firstFrom(int pos) const
+{
+    // Non-overlapping and sorted by start, so ends are sorted too
+    auto it = std::partition_point(m_ranges.cbegin(), m_ranges.cend(),
+                                   [pos](const Decoration &d) { return d.end() < pos; });
+    return int(it - m_ranges.cbegin());
+}
+
+int DecorationLayer::indexOf(int start, int length) const
+{
+    auto it = std::lower_bound(m_ranges.cbegin(), m_ranges.cend(), start,
+                               [](const Decoration &d, int s) { return d.start < s; });
+    if (it != m_ranges.cend() && it->start == start && it->length == length)
+        return int(it - m_ranges.cbegin());
+    return -1;
+}
+
+void DecorationLayer::shift(int pos, int removed, int added)
+{
+    const int delta = added - removed;
+    const int editEnd = pos + removed;
+
+    // Text inserted at either edge of a range stays outside it; carets at
+    // pos move past the insertion like a QTextCursor would.
+    auto mapStart = [&](int p) {
+        return p < pos ? p : p >= editEnd ? p + delta : pos + added;
+    };
+    auto mapEnd = [&](int p) {
+        return p <= pos ? p : p >= editEnd ? p + delta : pos;
+    };
+
+    const int first = firstFrom(pos);
+    int out = first;
+    for (int i = first; i < m_ranges.size(); ++i) {
+        Decoration d = m_ranges[i];
+        const int s = mapStart(d.start);
+        const int e = qMax(s, mapEnd(d.end()));
+        if (d.length > 0 && e == s)
+            continue;
+        d.start = s;
+        d.length = e - s;
+        m_ranges[out++] = d;
+    }
+    m_ranges.resize(out);
+}
@@ -0,0 +1,62 @@
+#ifndef DECORATIONLAYER_H
+#define DECORATIONLAYER_H
+
+#include <QVector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  DecorationLayer
+//  Flat, position-sorted ranges painted straight onto the editor viewport in
+//  place of QTextEdit::ExtraSelection.  A range is three integers, so a
+//  layer with thousands of search hits or carets costs a few kilobytes and
+//  replacing it only repaints the rows it touched.  Layers keep their
+//  offsets valid across edits through shift().
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum DecorationStyle : quint8 {
+    DecoCurrentLine,        // full-width row behind the main cursor
+    DecoSearchHit,
+    DecoCurrentSearchHit,
+    DecoBracketMatch,
+    DecoExtraCaret,         // zero-length; drawn as a caret bar
+    DecoSelection,          // extra-cursor and block selections
+    DecoDiagnosticError,    // language server diagnostics, drawn underlined
+    DecoDiagnosticWarning,
+    DecoDiagnosticInfo,
+    DecoStyleCount
+};
+
+struct Decoration {
+    int start;
+    int length;
+    DecorationStyle style;
+
+    int end() const { return start + length; }
+};
+
+class DecorationLayer
+{
+public:
+    const QVector<Decoration> &ranges() const { return m_ranges; }
+    bool isEmpty() const { return m_ranges.isEmpty(); }
+
+    // Ranges must be sorted by start and must not overlap
+    void set(QVector<Decoration> ranges) { m_ranges = std::move(ranges); }
+    void clear() { m_ranges.clear(); }
+    void restyle(int index, DecorationStyle style) { m_ranges[index].style = style; }
+
+    // Index of the first range ending at or after pos
+    int firstFrom(int pos) const;
+
+    // Index of the range exactly covering [start, start + length), or -1
+    int indexOf(int start, int length) const;
+
+    // Follows QTextDocument::contentsChange.  Ranges after the edit move by
+    // the size difference, ranges overlapping it are trimmed, and non-empty
+    // ranges that lose all their text are dropped.
+    void shift(int pos, int removed, int added);
+
+private:
+    QVector<Decoration> m_ranges;
+};
+
+#endif // DECORATIONLAYER_H
@@ -0,0 +1,624 @@
+#include "hexdiff.h"
+#include "hexeditor.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QThread>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr quint64 Prime = 0x100000001b3ULL;
+constexpr quint64 Mix   = 0x9E3779B97F4A7C15ULL;
+
+quint64 hashBlock(const uchar *p, int length)
+{
+    quint64 h = 0;
+    for (int i = 0; i < length; ++i)
+        h = h * Prime + p[i];
+    return h;
+}
+
+// Forward window over a snapshot, refetched only when a request leaves it.
+// Pointers stay valid until the next call.
+class Reader
+{
+public:
+    Reader(const PieceTable::Snapshot &data, qint64 window)
+        : m_data(data), m_window(window) {}
+
+    const uchar *at(qint64 pos, qint64 length)
+    {
+        if (pos < m_base || pos + length > m_base + m_length) {
+            m_base = pos;
+            m_length = qMin(qMax(m_window, length), m_data.size() - pos);
+            m_bytes = reinterpret_cast<const uchar *>(m_data.data(m_base, m_length, m_scratch));
+        }
+        return m_bytes + (pos - m_base);
+    }
+
+private:
+    const PieceTable::Snapshot &m_data;
+    const qint64 m_window;
+    QByteArray m_scratch;
+    const uchar *m_bytes = nullptr;
+    qint64 m_base = 0;
+    qint64 m_length = 0;
+};
+
+// Rabin-Karp hash of the block-sized window at pos, moved one byte at a time
+class Roller
+{
+public:
+    Roller(const PieceTable::Snapshot &data, int block)
+        : m_reader(data, HexDiff::Window), m_size(data.size()), m_block(block)
+    {
+        for (int i = 1; i < block; ++i)
+            m_power *= Prime;
+    }
+
+    bool start(qint64 pos)
+    {
+        m_pos = pos;
+        if (pos + m_block > m_size)
+            return false;
+        refill();
+        m_hash = hashBlock(m_cur, m_block);
+        return true;
+    }
+
+    bool advance()
+    {
+        if (m_pos + m_block >= m_size)
+            return false;
+        if (m_cur + m_block >= m_end)
+            refill();
+        m_hash = (m_hash - m_cur[0] * m_power) * Prime + m_cur[m_block];
+        ++m_cur;
+        ++m_pos;
+        return true;
+    }
+
+    qint64 pos() const { return m_pos; }
+    quint64 hash() const { return m_hash; }
+
+private:
+    void refill()
+    {
+        const qint64 length = qMin(HexDiff::Window, m_size - m_pos);
+        m_cur = m_reader.at(m_pos, length);
+        m_end = m_cur + length;
+    }
+
+    Reader m_reader;
+    const qint64 m_size;
+    const int m_block;
+    quint64 m_power = 1;                // Prime^(block - 1)
+    qint64 m_pos = 0;
+    quint64 m_hash = 0;
+    const uchar *m_cur = nullptr;       // window start inside the reader
+    const uchar *m_end = nullptr;
+};
+
+// Content-defined anchors: windows whose mixed hash has its top bits clear.
+// A run shared by both files holds the same anchors in each, wherever it
+// has moved to.
+bool isAnchor(quint64 hash, int bits)
+{
+    return (hash * Mix) >> (64 - bits) == 0;
+}
+
+// The anchor windows of one side, grouped into buckets by the low bits of
+// the mixed hash and sorted by (hash, offset) inside each
+class AnchorIndex
+{
+public:
+    struct Entry {
+        quint64 hash;
+        qint64 offset;
+        bool operator<(const Entry &other) const
+        {
+            return hash < other.hash || (hash == other.hash && offset < other.offset);
+        }
+    };
+
+    void build(const PieceTable::Snapshot &data, int block, int anchorBits,
+               const std::atomic_bool &cancel, std::atomic<qint64> *done)
+    {
+        // Anchors closer than a block are dropped so runs of one repeated
+        // byte index like aligned blocks instead of at every offset
+        Roller roller(data, block);
+        qint64 last = -block;
+        qint64 reported = 0;
+        for (bool more = roller.start(0); more && !cancel; more = roller.advance()) {
+            const qint64 pos = roller.pos();
+            if (pos >= last + block && isAnchor(roller.hash(), anchorBits)) {
+                m_entries.push_back({roller.hash(), pos});
+                last = pos;
+            }
+            if (done && pos - reported >= HexDiff::Window) {
+                *done += pos - reported;
+                reported = pos;
+            }
+        }
+        if (done && !cancel)
+            *done += data.size() - reported;
+
+        m_bits = 10;
+        while ((qint64(1) << m_bits) < qint64(m_entries.size()) * 2)
+            ++m_bits;
+        std::sort(m_entries.begin(), m_entries.end(), [this](const Entry &x, const Entry &y) {
+            const quint64 bx = bucket(x.hash);
+            const quint64 by = bucket(y.hash);
+            return bx < by || (bx == by && x < y);
+        });
+        m_starts.assign((size_t(1) << m_bits) + 1, 0);
+        for (const Entry &e : m_entries)
+            ++m_starts[bucket(e.hash) + 1];
+        for (size_t i = 1; i < m_starts.size(); ++i)
+            m_starts[i] += m_starts[i - 1];
+    }
+
+    // Of the anchors with this hash at or past from, tries the ones either
+    // side of target (the diagonal) so repeated blocks pick the nearest
+    template <typename Verify>
+    qint64 find(quint64 hash, qint64 from, qint64 target, const Verify &verify) const
+    {
+        const quint64 b = bucket(hash);
+        const auto begin = m_entries.cbegin() + m_starts[b];
+        const auto end = m_entries.cbegin() + m_starts[b + 1];
+        const auto first = std::lower_bound(begin, end, Entry{hash, from});
+        if (first == end || first->hash != hash)
+            return -1;
+        auto after = std::lower_bound(first, end, Entry{hash, target});
+        auto before = after;
+        for (int tries = 0; tries < 8; ++tries) {
+            const bool hasAfter = after != end && after->hash == hash;
+            const bool hasBefore = before != first;
+            if (!hasAfter && !hasBefore)
+                break;
+            const bool takeAfter = hasAfter && (!hasBefore ||
+                                   after->offset - target <= target - (before - 1)->offset);
+            const qint64 offset = takeAfter ? (after++)->offset : (--before)->offset;
+            if (verify(offset))
+                return offset;
+        }
+        return -1;
+    }
+
+private:
+    // The anchor test used the top bits; the low ones are still uniform
+    quint64 bucket(quint64 hash) const { return (hash * Mix) & ((quint64(1) << m_bits) - 1); }
+
+    std::vector<Entry> m_entries;
+    std::vector<quint32> m_starts;      // first entry of each bucket
+    int m_bits = 10;
+};
+
+qint64 commonPrefix(const uchar *a, const uchar *b, qint64 length)
+{
+    qint64 k = 0;
+    while (k + 4096 <= length && memcmp(a + k, b + k, 4096) == 0)
+        k += 4096;
+    while (k < length && a[k] == b[k])
+        ++k;
+    return k;
+}
+
+} // namespace
+
+int HexDiff::blockSize(qint64 size)
+{
+    int block = MinBlock;
+    while (size / block > MaxBlocks)
+        block *= 2;
+    return block;
+}
+
+void HexDiff::compare(const PieceTable::Snapshot &a, const PieceTable::Snapshot &b,
+                      const std::atomic_bool &cancel,
+                      const std::function<void(const QVector<Range> &)> &found,
+                      std::atomic<qint64> *done)
+{
+    const qint64 na = a.size();
+    const qint64 nb = b.size();
+    const int block = blockSize(qMax(na, nb));
+    int anchorBits = 1;                         // one window in 2 × block
+    while ((1 << anchorBits) < 2 * block)
+        ++anchorBits;
+
+    // Windows rolled over A are looked up among B's anchors and vice
+    // versa; the two indexes build side by side
+    AnchorIndex indexA;
+    AnchorIndex indexB;
+    QThread *other = QThread::create([&]() { indexB.build(b, block, anchorBits, cancel, done); });
+    other->start();
+    indexA.build(a, block, anchorBits, cancel, done);
+    other->wait();
+    delete other;
+
+    Reader walkA(a, Window);
+    Reader walkB(b, Window);
+    Reader verifyA(a, 64 * 1024);
+    Reader verifyB(b, 64 * 1024);
+    Roller rollA(a, block);
+    Roller rollB(b, block);
+    auto same = [&](qint64 pa, qint64 pb) {
+        return memcmp(verifyA.at(pa, block), verifyB.at(pb, block), size_t(block)) == 0;
+    };
+
+    QVector<Range> batch;
+    qint64 sinceFlush = 0;
+    qint64 i = 0;
+    qint64 j = 0;
+    while (!cancel) {
+        // Skip the equal run
+        while (i < na && j < nb) {
+            const qint64 n = qMin(Window, qMin(na - i, nb - j));
+            const qint64 run = commonPrefix(walkA.at(i, n), walkB.at(j, n), n);
+            i += run;
+            j += run;
+            sinceFlush += run;
+            if (done)
+                *done += 2 * run;
+            if (run < n)
+                break;
+        }
+        if (i >= na || j >= nb)
+            break;
+
+        // Roll both sides from the mismatch.  Equal windows at the same
+        // distance mean the bytes were overwritten; an anchor found on the
+        // other side at or past its cursor means bytes were inserted or
+        // removed.
+        qint64 ma = na;
+        qint64 mb = nb;
+        bool canRollA = rollA.start(i);
+        bool canRollB = rollB.start(j);
+        for (qint64 k = 0; canRollA || canRollB; ++k) {
+            if ((k & 0xFFFF) == 0 && cancel)
+                return;
+            if (canRollA && canRollB && rollA.hash() == rollB.hash() && same(rollA.pos(), rollB.pos())) {
+                ma = rollA.pos();
+                mb = rollB.pos();
+                break;
+            }
+            if (canRollA && isAnchor(rollA.hash(), anchorBits)) {
+                const qint64 at = indexB.find(rollA.hash(), j, j + k, [&](qint64 offset) {
+                    return same(rollA.pos(), offset);
+                });
+                if (at >= 0) {
+                    ma = rollA.pos();
+                    mb = at;
+                    break;
+                }
+            }
+            if (canRollB && isAnchor(rollB.hash(), anchorBits)) {
+                const qint64 at = indexA.find(rollB.hash(), i, i + k, [&](qint64 offset) {
+                    return same(offset, rollB.pos());
+                });
+                if (at >= 0) {
+                    ma = at;
+                    mb = rollB.pos();
+                    break;
+                }
+            }
+            if (canRollA)
+                canRollA = rollA.advance();
+            if (canRollB)
+                canRollB = rollB.advance();
+        }
+
+        // The hit can start anywhere inside the equal run; walk back to
+        // where it really begins
+        while (ma > i && mb > j) {
+            const qint64 n = qMin(qint64(4096), qMin(ma - i, mb - j));
+            const uchar *pa = verifyA.at(ma - n, n);
+            const uchar *pb = verifyB.at(mb - n, n);
+            qint64 k = n;
+            while (k > 0 && pa[k - 1] == pb[k - 1])
+                --k;
+            ma -= n - k;
+            mb -= n - k;
+            if (k > 0)
+                break;
+        }
+
+        batch.append({i, ma - i, j, mb - j});
+        if (done)
+            *done += (ma - i) + (mb - j);
+        sinceFlush += qMax(ma - i, mb - j);
+        i = ma;
+        j = mb;
+        if (batch.size() >= 256 || sinceFlush >= Window) {
+            found(batch);
+            batch.clear();
+            sinceFlush = 0;
+        }
+    }
+    if (cancel)
+        return;
+    if (i < na || j < nb) {
+        batch.append({i, na - i, j, nb - j});
+        if (done)
+            *done += (na - i) + (nb - j);
+    }
+    if (!batch.isEmpty())
+        found(batch);
+}
+
+HexDiff::HexDiff(QObject *parent)
+    : QObject(parent)
+{
+    // Ranges arrive in batches; progress is polled so long equal runs
+    // still move the bar
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(100);
+    connect(m_progressTimer, &QTimer::timeout, this, [this]() {
+        emit progress(m_done.load(), m_total);
+    });
+}
+
+HexDiff::~HexDiff()
+{
+    cancel();
+}
+
+void HexDiff::start(const PieceTable::Snapshot &a, const PieceTable::Snapshot &b)
+{
+    cancel();
+    m_ranges.clear();
+    m_cancel = false;
+    m_done = 0;
+    m_total = 2 * (a.size() + b.size());
+
+    const quint64 generation = m_generation;
+    m_worker = QThread::create([this, a, b, generation]() {
+        QVector<Range> pending;
+        QElapsedTimer sinceFlush;
+        sinceFlush.start();
+        auto flush = [&]() {
+            QMetaObject::invokeMethod(this, [this, generation, ranges = pending]() {
+                if (generation != m_generation)
+                    return;
+                m_ranges += ranges;
+                emit rangesAdded(m_ranges.size());
+            }, Qt::QueuedConnection);
+            pending.clear();
+            sinceFlush.restart();
+        };
+        compare(a, b, m_cancel, [&](const QVector<Range> &ranges) {
+            pending += ranges;
+            if (sinceFlush.elapsed() >= 100)
+                flush();
+        }, &m_done);
+        if (!pending.isEmpty())
+            flush();
+        QMetaObject::invokeMethod(this, [this, generation]() {
+            if (generation != m_generation)
+                return;
+            m_worker = nullptr;
+            m_progressTimer->stop();
+            emit progress(m_total, m_total);
+            emit finished(m_ranges.size());
+        }, Qt::QueuedConnection);
+    });
+    connect(m_worker, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_worker->start(QThread::LowPriority);
+    m_progressTimer->start();
+}
+
+void HexDiff::cancel()
+{
+    ++m_generation;
+    m_progressTimer->stop();
+    if (m_worker) {
+        // The walk checks the flag once per window or rolled byte
+        m_cancel = true;
+        m_worker->wait();
+        m_worker = nullptr;
+    }
+}
+
+int HexDiff::next(qint64 pos) const
+{
+    if (m_ranges.isEmpty())
+        return -1;
+    const auto it = std::upper_bound(m_ranges.cbegin(), m_ranges.cend(), pos,
+                                     [](qint64 p, const Range &r) { return p < r.aPos; });
+    return it == m_ranges.cend() ? 0 : int(it - m_ranges.cbegin());
+}
+
+int HexDiff::previous(qint64 pos) const
+{
+    if (m_ranges.isEmpty())
+        return -1;
+    const auto it = std::lower_bound(m_ranges.cbegin(), m_ranges.cend(), pos,
+                                     [](const Range &r, qint64 p) { return r.aPos < p; });
+    return it == m_ranges.cbegin() ? m_ranges.size() - 1 : int(it - m_ranges.cbegin()) - 1;
+}
+
+qint64 HexDiff::mapOffset(qint64 pos, Side from) const
+{
+    // Last range starting at or before pos; equal runs keep a fixed shift,
+    // positions inside a change clamp to the other side's part of it
+    const auto start = [from](const Range &r) { return from == A ? r.aPos : r.bPos; };
+    const auto it = std::upper_bound(m_ranges.cbegin(), m_ranges.cend(), pos,
+                                     [&](qint64 p, const Range &r) { return p < start(r); });
+    if (it == m_ranges.cbegin())
+        return pos;
+    const Range &r = *(it - 1);
+    const qint64 fromPos = from == A ? r.aPos : r.bPos;
+    const qint64 fromLength = from == A ? r.aLength : r.bLength;
+    const qint64 toPos = from == A ? r.bPos : r.aPos;
+    const qint64 toLength = from == A ? r.bLength : r.aLength;
+    if (pos < fromPos + fromLength)
+        return toPos + qMin(pos - fromPos, toLength);
+    return toPos + toLength + (pos - fromPos - fromLength);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexDiffView
+// ─────────────────────────────────────────────────────────────────────────────
+HexDiffView::HexDiffView(QWidget *parent)
+    : QWidget(parent)
+{
+    setStyleSheet("background-color: #1e1e1e; color: #d4d4d4;");
+
+    auto *root = new QVBoxLayout(this);
+    root->setContentsMargins(0, 0, 0, 0);
+    root->setSpacing(0);
+
+    auto *bar = new QWidget;
+    bar->setStyleSheet("background-color: #252526; border-bottom: 1px solid #3c3c3c;");
+    auto *barLayout = new QHBoxLayout(bar);
+    barLayout->setContentsMargins(12, 4, 12, 4);
+    m_status = new QLabel("No files");
+    m_status->setStyleSheet("background: transparent;");
+    const QString buttonStyle =
+        "QPushButton { background: #3c3c3c; color: #d4d4d4; border: none; padding: 3px 10px; }"
+        "QPushButton:hover { background: #505050; }"
+        "QPushButton:disabled { color: #6a6a6a; }";
+    m_prevButton = new QPushButton(QString::fromUtf8("\xE2\x96\xB2 Previous"));
+    m_prevButton->setToolTip("Previous difference (Shift+F8)");
+    m_prevButton->setShortcut(QKeySequence(Qt::SHIFT | Qt::Key_F8));
+    m_prevButton->setStyleSheet(buttonStyle);
+    m_nextButton = new QPushButton(QString::fromUtf8("\xE2\x96\xBC Next"));
+    m_nextButton->setToolTip("Next difference (F8)");
+    m_nextButton->setShortcut(QKeySequence(Qt::Key_F8));
+    m_nextButton->setStyleSheet(buttonStyle);
+    connect(m_prevButton, &QPushButton::clicked, this, &HexDiffView::previousDifference);
+    connect(m_nextButton, &QPushButton::clicked, this, &HexDiffView::nextDifference);
+    barLayout->addWidget(m_status, 1);
+    barLayout->addWidget(m_prevButton);
+    barLayout->addWidget(m_nextButton);
+    root->addWidget(bar);
+
+    auto *panes = new QHBoxLayout;
+    panes->setSpacing(1);
+    auto addPane = [&](QLabel *&title, HexEditor *&editor) {
+        auto *column = new QVBoxLayout;
+        column->setSpacing(0);
+        title = new QLabel;
+        title->setStyleSheet("background: #252526; color: #858585; padding: 3px 8px;");
+        editor = new HexEditor;
+        editor->setReadOnly(true);
+        column->addWidget(title);
+        column->addWidget(editor, 1);
+        panes->addLayout(column, 1);
+    };
+    addPane(m_leftTitle, m_left);
+    addPane(m_rightTitle, m_right);
+    root->addLayout(panes, 1);
+
+    m_diff = new HexDiff(this);
+    connect(m_diff, &HexDiff::rangesAdded, this, &HexDiffView::onRangesAdded);
+    connect(m_diff, &HexDiff::progress, this, [this](qint64 done, qint64 total) {
+        m_percent = total > 0 ? int(done * 100 / total) : 100;
+        updateStatus();
+    });
+    connect(m_diff, &HexDiff::finished, this, [this]() { updateStatus(); });
+    connect(m_left, &HexEditor::scrolled, this, [this](qint64 top) { syncScroll(m_left, top); });
+    connect(m_right, &HexEditor::scrolled, this, [this](qint64 top) { syncScroll(m_right, top); });
+    updateStatus();
+}
+
+bool HexDiffView::loadFiles(const QString &fileA, const QString &fileB)
+{
+    // Both sides stay mapped; the compare reads snapshots of the mappings
+    if (!m_left->loadFile(fileA) || !m_right->loadFile(fileB))
+        return false;
+    m_fileA = fileA;
+    m_fileB = fileB;
+    m_leftTitle->setText(QFileInfo(fileA).fileName());
+    m_rightTitle->setText(QFileInfo(fileB).fileName());
+    m_left->clearMarks();
+    m_right->clearMarks();
+    m_current = -1;
+    m_percent = 0;
+    m_diff->start(m_left->snapshot(), m_right->snapshot());
+    updateStatus();
+    return true;
+}
+
+void HexDiffView::onRangesAdded(int total)
+{
+    // Ranges only ever append, so only the new tail is handed to the panes
+    const int known = m_left->markCount();
+    QVector<HexEditor::Mark> left;
+    QVector<HexEditor::Mark> right;
+    left.reserve(total - known);
+    right.reserve(total - known);
+    for (int i = known; i < total; ++i) {
+        const HexDiff::Range &r = m_diff->ranges().at(i);
+        left.append({r.aPos, r.aLength});
+        right.append({r.bPos, r.bLength});
+    }
+    m_left->addMarks(left);
+    m_right->addMarks(right);
+    updateStatus();
+}
+
+void HexDiffView::syncScroll(HexEditor *from, qint64 top)
+{
+    if (m_syncing)
+        return;
+    m_syncing = true;
+    HexEditor *to = from == m_left ? m_right : m_left;
+    to->scrollToOffset(m_diff->mapOffset(top, from == m_left ? HexDiff::A : HexDiff::B));
+    m_syncing = false;
+}
+
+void HexDiffView::nextDifference()
+{
+    showDifference(m_diff->next(m_left->cursorPosition()));
+}
+
+void HexDiffView::previousDifference()
+{
+    showDifference(m_diff->previous(m_left->cursorPosition()));
+}
+
+void HexDiffView::showDifference(int index)
+{
+    if (index < 0)
+        return;
+    const HexDiff::Range &r = m_diff->ranges().at(index);
+    m_current = index;
+    m_syncing = true;
+    m_left->select(r.aPos, r.aLength);
+    m_right->select(r.bPos, r.bLength);
+    m_syncing = false;
+    updateStatus();
+}
+
+void HexDiffView::updateStatus()
+{
+    const int total = m_diff->ranges().size();
+    QString text;
+    if (m_fileA.isEmpty()) {
+        text = "No files";
+    } else if (m_diff->isRunning()) {
+        text = QString::fromUtf8("Comparing\xE2\x80\xA6 %1%  \xE2\x80\x94  %2 difference%3 so far")
+                   .arg(m_percent).arg(total).arg(total == 1 ? "" : "s");
+    } else if (total == 0) {
+        text = "Files are identical";
+    } else if (m_current >= 0) {
+        const HexDiff::Range &r = m_diff->ranges().at(m_current);
+        text = QString::fromUtf8("Difference %1 of %2  \xE2\x80\x94  %3 byte(s) left, %4 byte(s) right")
+                   .arg(m_current + 1).arg(total).arg(r.aLength).arg(r.bLength);
+    } else {
+        text = QString("%1 difference%2").arg(total).arg(total == 1 ? "" : "s");
+    }
+    m_status->setText(text);
+    m_prevButton->setEnabled(total > 0);
+    m_nextButton->setEnabled(total > 0);
+}
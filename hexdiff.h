@@ -0,0 +1,133 @@
+#ifndef HEXDIFF_H
+#define HEXDIFF_H
+
+#include <QObject>
+#include <QVector>
+#include <QWidget>
+
+#include <atomic>
+#include <functional>
+
+#include "piecetable.h"
+
+class HexEditor;
+class QLabel;
+class QPushButton;
+class QThread;
+class QTimer;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexDiff
+//  Binary compare of two PieceTable snapshots that survives insertions and
+//  deletions.  Equal runs are skipped with memcmp; at a mismatch a
+//  block-sized window is rolled (Rabin-Karp) over both sides in lockstep.
+//  Equal hashes at the same distance resync an overwrite; for shifted
+//  data each side is indexed by content-defined anchors (windows whose
+//  hash has its top bits clear), so only about one rolled window in
+//  2 × block needs a lookup in the other side's index.  A verified hit is
+//  extended backwards byte by byte so ranges are exact.  Blocks grow with
+//  the file size to keep each index near a million entries, and both
+//  files are read window by window from their mappings, so multi-GB
+//  images compare in bounded memory.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexDiff : public QObject
+{
+    Q_OBJECT
+
+public:
+    // A differing region; one length is zero for a pure insertion
+    struct Range {
+        qint64 aPos;
+        qint64 aLength;
+        qint64 bPos;
+        qint64 bLength;
+    };
+
+    enum Side { A, B };
+
+    static constexpr int    MinBlock  = 16;
+    static constexpr qint64 MaxBlocks = 1 << 20;
+    static constexpr qint64 Window    = 4 * 1024 * 1024;
+
+    static int blockSize(qint64 size);
+
+    // Calls found for every batch of ascending ranges; done counts bytes
+    // indexed plus bytes walked on both sides (2 × (a + b) when complete)
+    static void compare(const PieceTable::Snapshot &a, const PieceTable::Snapshot &b,
+                        const std::atomic_bool &cancel,
+                        const std::function<void(const QVector<Range> &)> &found,
+                        std::atomic<qint64> *done = nullptr);
+
+    explicit HexDiff(QObject *parent = nullptr);
+    ~HexDiff() override;
+
+    void start(const PieceTable::Snapshot &a, const PieceTable::Snapshot &b);
+    void cancel();
+    bool isRunning() const { return m_worker != nullptr; }
+
+    const QVector<Range> &ranges() const { return m_ranges; }
+
+    // Index of the first range past / before pos on side A, wrapping; -1 if none
+    int next(qint64 pos) const;
+    int previous(qint64 pos) const;
+    // Position on the other side that lines up with pos on side `from`
+    qint64 mapOffset(qint64 pos, Side from) const;
+
+signals:
+    void rangesAdded(int total);
+    void progress(qint64 done, qint64 total);
+    void finished(int total);
+
+private:
+    QThread *m_worker = nullptr;
+    QTimer *m_progressTimer;
+    std::atomic_bool m_cancel{false};
+    std::atomic<qint64> m_done{0};
+    qint64 m_total = 0;
+    quint64 m_generation = 0;
+    QVector<Range> m_ranges;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexDiffView
+//  Two read-only hex panes side by side.  Differences are marked in both,
+//  scrolling one pane scrolls the other to the matching offset, and
+//  F8 / Shift+F8 step through the differences.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexDiffView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HexDiffView(QWidget *parent = nullptr);
+
+    bool loadFiles(const QString &fileA, const QString &fileB);
+    QString fileA() const { return m_fileA; }
+    QString fileB() const { return m_fileB; }
+
+public slots:
+    void nextDifference();
+    void previousDifference();
+
+private:
+    void onRangesAdded(int total);
+    void syncScroll(HexEditor *from, qint64 top);
+    void showDifference(int index);
+    void updateStatus();
+
+    HexDiff *m_diff;
+    HexEditor *m_left;
+    HexEditor *m_right;
+    QLabel *m_leftTitle;
+    QLabel *m_rightTitle;
+    QLabel *m_status;
+    QPushButton *m_prevButton;
+    QPushButton *m_nextButton;
+    QString m_fileA;
+    QString m_fileB;
+    int m_current = -1;
+    int m_percent = 0;
+    bool m_syncing = false;
+};
+
+#endif // HEXDIFF_H
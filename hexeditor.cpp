@@ -1,22 +1,39 @@
 #include "hexeditor.h"
+#include "hexentropy.h"
+#include "perfmonitor.h"
 #include <QPainter>
 #include <QScrollBar>
+#include <QSignalBlocker>
 #include <QKeyEvent>
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QFile>
+#include <QSaveFile>
 #include <QFontMetrics>
 #include <QApplication>
+#include <QClipboard>
+#include <QMimeData>
+#include <QRegularExpression>
+#include <QHelpEvent>
+#include <QToolTip>
+
+#include <algorithm>
+#include <limits>
 
 HexEditor::HexEditor(QWidget *parent)
     : QWidget(parent)
+    , m_searchOrigin(0)
+    , m_searchIndex(-1)
     , m_cursorPosition(0)
     , m_selectionStart(-1)
     , m_selectionEnd(-1)
     , m_bytesPerLine(16)
+    , m_groupSize(1)
     , m_addressWidth(8)
+    , m_autoFit(true)
     , m_readOnly(false)
     , m_modified(false)
+    , m_insertMode(false)
     , m_cursorInHexArea(true)
     , m_nibblePosition(false)
 {
@@ -28,13 +45,41 @@ HexEditor::HexEditor(QWidget *parent)
     m_charHeight = fm.height();
     
     m_scrollBar = new QScrollBar(Qt::Vertical, this);
-    connect(m_scrollBar, &QScrollBar::valueChanged, this, [this]() { update(); });
+    connect(m_scrollBar, &QScrollBar::valueChanged, this, [this](int value) {
+        // Values set from m_topLine keep it; a dragged bar lands on a step
+        if (value != m_topLine / m_lineScale) {
+            m_topLine = qMin(qint64(value) * m_lineScale, maxTopLine());
+        }
+        update();
+        emit scrolled(topOffset());
+    });
     
-    updateScrollBar();
+    m_search = new HexSearch(this);
+    connect(m_search, &HexSearch::hitsAdded, this, [this](int total) {
+        // Jump once the first hit past the cursor arrives; earlier ones wait
+        // for the scan to finish so the search can wrap around
+        if (m_searchIndex < 0 && m_search->hits().last() >= m_searchOrigin) {
+            showHit(m_search->next(m_searchOrigin - 1));
+        } else {
+            emit searchUpdated(m_searchIndex + 1, total, false);
+            update();
+        }
+    });
+    connect(m_search, &HexSearch::finished, this, [this](int total) {
+        if (m_searchIndex < 0 && total > 0) {
+            showHit(0);
+        } else {
+            emit searchUpdated(m_searchIndex + 1, total, true);
+        }
+    });
+    
+    updateLayout();
 }
 
 void HexEditor::setData(const QByteArray &data) {
-    m_data = data;
+    m_data.setData(data);
+    m_fileName.clear();
+    m_history.clear();
     m_cursorPosition = 0;
     m_selectionStart = -1;
     m_selectionEnd = -1;
@@ -46,6 +91,8 @@ void HexEditor::setData(const QByteArray &data) {
 
 void HexEditor::clear() {
     m_data.clear();
+    m_fileName.clear();
+    m_history.clear();
     m_cursorPosition = 0;
     m_selectionStart = -1;
     m_selectionEnd = -1;
@@ -55,26 +102,48 @@ void HexEditor::clear() {
 }
 
 bool HexEditor::loadFile(const QString &fileName) {
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) {
+    // Mapped, not read: the piece table edits on top of the file itself.
+    // Read-only views never save over it, so they are mapped everywhere.
+    if (!m_data.open(fileName, nullptr,
+                     m_readOnly ? PieceTable::ReadOnly : PieceTable::Editable)) {
         return false;
     }
+    m_fileName = fileName;
     
-    setData(file.readAll());
+    m_history.clear();
+    m_cursorPosition = 0;
+    m_selectionStart = -1;
+    m_selectionEnd = -1;
+    setModified(false);
+    updateScrollBar();
+    update();
+    emit dataChanged();
     return true;
 }
 
 bool HexEditor::saveFile(const QString &fileName) {
-    QFile file(fileName);
+    QSaveFile file(fileName);
     if (!file.open(QIODevice::WriteOnly)) {
         return false;
     }
     
-    file.write(m_data);
-    setModified(false);
+    if (!m_data.write(&file) || !file.commit()) {
+        return false;
+    }
+    fileSaved(fileName);
     return true;
 }
 
+void HexEditor::fileSaved(const QString &fileName) {
+    // Re-base the pieces on the saved file so the add buffer is released
+    m_data.open(fileName);
+    m_fileName = fileName;
+    m_cursorPosition = qMin(m_cursorPosition, lastCursorPosition());
+    m_history.setClean();
+    setModified(false);
+    update();
+}
+
 void HexEditor::setModified(bool modified) {
     if (m_modified != modified) {
         m_modified = modified;
@@ -83,58 +152,110 @@ void HexEditor::setModified(bool modified) {
 }
 
 void HexEditor::paintEvent(QPaintEvent *event) {
+    PerfMonitor::Scope perf(PerfMonitor::HexPaint);
     QPainter painter(this);
     painter.fillRect(rect(), QColor(30, 30, 30));
     
-    if (m_data.isEmpty()) {
+    if (m_data.isEmpty() && !m_insertMode) {
         painter.setPen(Qt::gray);
         painter.drawText(rect(), Qt::AlignCenter, "No data");
         return;
     }
     
-    int firstLine = m_scrollBar->value();
-    int lastLine = firstLine + visibleLines();
+    const qint64 firstLine = m_topLine;
+    const qint64 lastLine = firstLine + visibleLines();
     
     int y = 5;
-    qint64 offset = firstLine * m_bytesPerLine;
+    qint64 offset = qint64(firstLine) * m_bytesPerLine;
+    
+    // One read for the viewport instead of a piece lookup per byte
+    const qint64 first = offset;
+    const QByteArray visible = m_data.read(first, qint64(lastLine - firstLine + 1) * m_bytesPerLine);
+    const qint64 end = first + visible.size();
+    // In insert mode the cursor may sit one past the last byte
+    const qint64 drawEnd = (m_insertMode && end == m_data.size() && m_cursorPosition == end) ? end + 1 : end;
+    
+    const QVector<qint64> &hits = m_search->hits();
+    const qint64 hitSize = qMax(1, m_search->patternSize());
+    auto hit = std::lower_bound(hits.cbegin(), hits.cend(), first - hitSize + 1);
+    auto mark = std::lower_bound(m_marks.cbegin(), m_marks.cend(), first,
+                                 [](const Mark &m, qint64 pos) { return m.pos + qMax(qint64(1), m.length) <= pos; });
+    auto field = std::lower_bound(m_overlay.cbegin(), m_overlay.cend(), first,
+                                  [](const Overlay &o, qint64 pos) { return o.pos + o.length <= pos; });
     
-    for (int line = firstLine; line <= lastLine && offset < m_data.size(); ++line) {
+    for (qint64 line = firstLine; line <= lastLine && offset < drawEnd; ++line) {
         // Draw address
         painter.setPen(QColor(100, 149, 237));
         QString address = QString("%1").arg(offset, m_addressWidth, 16, QChar('0')).toUpper();
         painter.drawText(5, y + m_charHeight, address);
         
-        int hexX = 5 + (m_addressWidth + 2) * m_charWidth;
-        int asciiX = hexX + (m_bytesPerLine * 3 + 2) * m_charWidth;
-        
         // Draw hex and ASCII
-        for (int i = 0; i < m_bytesPerLine && offset + i < m_data.size(); ++i) {
-            unsigned char byte = static_cast<unsigned char>(m_data[offset + i]);
+        for (int i = 0; i < m_bytesPerLine && offset + i < drawEnd; ++i) {
             qint64 pos = offset + i;
+            const int hexByteX = m_layout.hexByteX[i];
+            const int cellWidth = m_layout.hexByteX[i + 1] - hexByteX;
+            const int asciiByteX = m_layout.asciiX + i * m_charWidth;
+            
+            // Tint template fields, alternating so neighbours stay apart
+            while (field != m_overlay.cend() && field->pos + field->length <= pos) {
+                ++field;
+            }
+            if (field != m_overlay.cend() && field->pos <= pos && pos < end) {
+                const QColor tint = (field - m_overlay.cbegin()) % 2 ? QColor(80, 120, 200, 60) : QColor(80, 160, 120, 60);
+                painter.fillRect(hexByteX, y, cellWidth, m_charHeight, tint);
+                painter.fillRect(asciiByteX, y, m_charWidth, m_charHeight, tint);
+            }
             
-            // Highlight selection
+            // Highlight search hits, then the selection
+            while (hit != hits.cend() && *hit + hitSize <= pos) {
+                ++hit;
+            }
+            if (hit != hits.cend() && *hit <= pos && pos < end) {
+                painter.fillRect(hexByteX, y, m_charWidth * 2, m_charHeight, QColor(230, 160, 40, 90));
+                painter.fillRect(asciiByteX, y, m_charWidth, m_charHeight, QColor(230, 160, 40, 90));
+            }
+            while (mark != m_marks.cend() && mark->pos + qMax(qint64(1), mark->length) <= pos) {
+                ++mark;
+            }
+            if (mark != m_marks.cend() && mark->pos <= pos && pos < end) {
+                if (mark->length > 0) {
+                    painter.fillRect(hexByteX, y, cellWidth, m_charHeight, QColor(220, 60, 60, 90));
+                    painter.fillRect(asciiByteX, y, m_charWidth, m_charHeight, QColor(220, 60, 60, 90));
+                } else {
+                    painter.fillRect(hexByteX - 2, y, 2, m_charHeight, QColor(220, 60, 60));
+                }
+            }
             bool isSelected = (m_selectionStart >= 0 && pos >= m_selectionStart && pos <= m_selectionEnd);
             bool isCursor = (pos == m_cursorPosition);
             
             // Draw hex byte
-            int hexByteX = hexX + i * 3 * m_charWidth;
             if (isSelected) {
                 painter.fillRect(hexByteX, y, m_charWidth * 2, m_charHeight, QColor(0, 120, 215, 100));
             }
             if (isCursor && m_cursorInHexArea) {
-                painter.fillRect(hexByteX, y, m_charWidth * 2, m_charHeight, QColor(255, 255, 255, 50));
+                if (m_insertMode)
+                    painter.fillRect(hexByteX - 1, y, 2, m_charHeight, QColor(255, 255, 255, 200));
+                else
+                    painter.fillRect(hexByteX, y, m_charWidth * 2, m_charHeight, QColor(255, 255, 255, 50));
+            }
+            
+            if (isCursor && !m_cursorInHexArea && m_insertMode) {
+                painter.fillRect(asciiByteX - 1, y, 2, m_charHeight, QColor(255, 255, 255, 200));
+            }
+            if (pos >= end) {
+                continue;
             }
+            unsigned char byte = static_cast<unsigned char>(visible[int(pos - first)]);
             
             painter.setPen(Qt::white);
             QString hexByte = QString("%1").arg(byte, 2, 16, QChar('0')).toUpper();
             painter.drawText(hexByteX, y + m_charHeight, hexByte);
             
             // Draw ASCII character
-            int asciiByteX = asciiX + i * m_charWidth;
             if (isSelected) {
                 painter.fillRect(asciiByteX, y, m_charWidth, m_charHeight, QColor(0, 120, 215, 100));
             }
-            if (isCursor && !m_cursorInHexArea) {
+            if (isCursor && !m_cursorInHexArea && !m_insertMode) {
                 painter.fillRect(asciiByteX, y, m_charWidth, m_charHeight, QColor(255, 255, 255, 50));
             }
             
@@ -151,7 +272,10 @@ void HexEditor::paintEvent(QPaintEvent *event) {
 void HexEditor::resizeEvent(QResizeEvent *event) {
     QWidget::resizeEvent(event);
     m_scrollBar->setGeometry(width() - 20, 0, 20, height());
-    updateScrollBar();
+    if (m_entropyStrip) {
+        m_entropyStrip->setGeometry(width() - 20 - EntropyStrip::StripWidth, 0, EntropyStrip::StripWidth, height());
+    }
+    updateLayout();
 }
 
 void HexEditor::keyPressEvent(QKeyEvent *event) {
@@ -161,6 +285,22 @@ void HexEditor::keyPressEvent(QKeyEvent *event) {
         return;
     }
     
+    // Moving the cursor ends the current typing run; a bare modifier does not
+    switch (event->key()) {
+        case Qt::Key_Delete:
+        case Qt::Key_Backspace:
+        case Qt::Key_Shift:
+        case Qt::Key_Control:
+        case Qt::Key_Alt:
+        case Qt::Key_Meta:
+            break;
+        default:
+            if (event->text().isEmpty()) {
+                m_history.breakMerge();
+            }
+            break;
+    }
+    
     switch (event->key()) {
         case Qt::Key_Left:
             if (m_cursorPosition > 0) {
@@ -171,7 +311,7 @@ void HexEditor::keyPressEvent(QKeyEvent *event) {
             break;
             
         case Qt::Key_Right:
-            if (m_cursorPosition < m_data.size() - 1) {
+            if (m_cursorPosition < lastCursorPosition()) {
                 m_cursorPosition++;
                 ensureCursorVisible();
                 update();
@@ -187,7 +327,7 @@ void HexEditor::keyPressEvent(QKeyEvent *event) {
             break;
             
         case Qt::Key_Down:
-            if (m_cursorPosition + m_bytesPerLine < m_data.size()) {
+            if (m_cursorPosition + m_bytesPerLine <= lastCursorPosition()) {
                 m_cursorPosition += m_bytesPerLine;
                 ensureCursorVisible();
                 update();
@@ -201,7 +341,7 @@ void HexEditor::keyPressEvent(QKeyEvent *event) {
             break;
             
         case Qt::Key_PageDown:
-            m_cursorPosition = qMin((qint64)m_data.size() - 1, m_cursorPosition + m_bytesPerLine * visibleLines());
+            m_cursorPosition = qMin(lastCursorPosition(), m_cursorPosition + m_bytesPerLine * visibleLines());
             ensureCursorVisible();
             update();
             break;
@@ -213,7 +353,7 @@ void HexEditor::keyPressEvent(QKeyEvent *event) {
             break;
             
         case Qt::Key_End:
-            m_cursorPosition = m_data.size() - 1;
+            m_cursorPosition = lastCursorPosition();
             ensureCursorVisible();
             update();
             break;
@@ -223,58 +363,34 @@ void HexEditor::keyPressEvent(QKeyEvent *event) {
             update();
             break;
             
+        case Qt::Key_Insert:
+            m_insertMode = !m_insertMode;
+            m_nibblePosition = false;
+            m_cursorPosition = qMin(m_cursorPosition, lastCursorPosition());
+            updateScrollBar();
+            update();
+            break;
+            
+        case Qt::Key_Delete:
+            removeBytes(false);
+            break;
+            
+        case Qt::Key_Backspace:
+            removeBytes(true);
+            break;
+            
         default:
             if (!m_readOnly && m_cursorInHexArea) {
                 QString text = event->text().toUpper();
                 if (text.length() == 1 && text[0].isDigit()) {
-                    int value = text[0].digitValue();
-                    unsigned char byte = static_cast<unsigned char>(m_data[m_cursorPosition]);
-                    
-                    if (!m_nibblePosition) {
-                        byte = (byte & 0x0F) | (value << 4);
-                        m_nibblePosition = true;
-                    } else {
-                        byte = (byte & 0xF0) | value;
-                        m_nibblePosition = false;
-                        if (m_cursorPosition < m_data.size() - 1) {
-                            m_cursorPosition++;
-                        }
-                    }
-                    
-                    m_data[m_cursorPosition] = byte;
-                    setModified(true);
-                    emit dataChanged();
-                    update();
+                    typeNibble(text[0].digitValue());
                 } else if (text.length() == 1 && text[0] >= 'A' && text[0] <= 'F') {
-                    int value = text[0].toLatin1() - 'A' + 10;
-                    unsigned char byte = static_cast<unsigned char>(m_data[m_cursorPosition]);
-                    
-                    if (!m_nibblePosition) {
-                        byte = (byte & 0x0F) | (value << 4);
-                        m_nibblePosition = true;
-                    } else {
-                        byte = (byte & 0xF0) | value;
-                        m_nibblePosition = false;
-                        if (m_cursorPosition < m_data.size() - 1) {
-                            m_cursorPosition++;
-                        }
-                    }
-                    
-                    m_data[m_cursorPosition] = byte;
-                    setModified(true);
-                    emit dataChanged();
-                    update();
+                    typeNibble(text[0].toLatin1() - 'A' + 10);
                 }
             } else if (!m_readOnly && !m_cursorInHexArea) {
                 QString text = event->text();
                 if (text.length() == 1 && text[0].isPrint()) {
-                    m_data[m_cursorPosition] = text[0].toLatin1();
-                    if (m_cursorPosition < m_data.size() - 1) {
-                        m_cursorPosition++;
-                    }
-                    setModified(true);
-                    emit dataChanged();
-                    update();
+                    typeByte(text[0].toLatin1());
                 }
             }
             break;
@@ -287,10 +403,11 @@ void HexEditor::mousePressEvent(QMouseEvent *event) {
     bool inHexArea;
     qint64 pos = positionFromPoint(event->pos(), inHexArea);
     
-    if (pos >= 0 && pos < m_data.size()) {
+    if (pos >= 0 && pos <= lastCursorPosition()) {
         m_cursorPosition = pos;
         m_cursorInHexArea = inHexArea;
         m_nibblePosition = false;
+        m_history.breakMerge();
         
         if (event->modifiers() & Qt::ShiftModifier) {
             if (m_selectionStart < 0) {
@@ -311,66 +428,465 @@ void HexEditor::wheelEvent(QWheelEvent *event) {
     int numDegrees = event->angleDelta().y() / 8;
     int numSteps = numDegrees / 15;
     
-    int newValue = m_scrollBar->value() - numSteps;
-    m_scrollBar->setValue(newValue);
+    setTopLine(m_topLine - numSteps);
     
     event->accept();
 }
 
+bool HexEditor::replaceBytes(qint64 pos, qint64 removed, const QByteArray &bytes, bool typing) {
+    // The undo step keeps a copy of the removed bytes
+    if (removed > PieceTable::MaxReadLength) {
+        return false;
+    }
+    const qint64 before = m_data.size();
+    HexHistory::Delta delta;
+    delta.pos = pos;
+    delta.removed = m_data.read(pos, removed);
+    delta.removedPieces = m_data.pieces(pos, removed);
+    delta.inserted = bytes;
+    delta.cursorBefore = m_cursorPosition;
+    m_history.record(delta, typing);
+    
+    if (removed > 0) {
+        m_data.remove(pos, removed);
+    }
+    if (!bytes.isEmpty()) {
+        m_data.insert(pos, bytes);
+    }
+    if (m_data.size() != before) {
+        updateScrollBar();
+    }
+    clearSearch();
+    setModified(true);
+    emit dataChanged();
+    update();
+    return true;
+}
+
+void HexEditor::typeNibble(int value) {
+    if (!m_nibblePosition) {
+        // High nibble: insert mode starts a new byte, overwrite mode edits one
+        if (m_insertMode) {
+            replaceBytes(m_cursorPosition, 0, QByteArray(1, char(value << 4)), true);
+        } else if (m_cursorPosition < m_data.size()) {
+            unsigned char byte = static_cast<unsigned char>(m_data.at(m_cursorPosition));
+            replaceBytes(m_cursorPosition, 1, QByteArray(1, char((byte & 0x0F) | (value << 4))), true);
+        } else {
+            return;
+        }
+        m_nibblePosition = true;
+    } else {
+        unsigned char byte = static_cast<unsigned char>(m_data.at(m_cursorPosition));
+        replaceBytes(m_cursorPosition, 1, QByteArray(1, char((byte & 0xF0) | value)), true);
+        m_nibblePosition = false;
+        if (m_cursorPosition < lastCursorPosition()) {
+            m_cursorPosition++;
+        }
+    }
+    ensureCursorVisible();
+}
+
+void HexEditor::typeByte(char byte) {
+    if (m_insertMode) {
+        replaceBytes(m_cursorPosition, 0, QByteArray(1, byte), true);
+    } else if (m_cursorPosition < m_data.size()) {
+        replaceBytes(m_cursorPosition, 1, QByteArray(1, byte), true);
+    } else {
+        return;
+    }
+    if (m_cursorPosition < lastCursorPosition()) {
+        m_cursorPosition++;
+    }
+    m_nibblePosition = false;
+    ensureCursorVisible();
+}
+
+void HexEditor::removeBytes(bool backward) {
+    // Overwrite mode never changes the file size
+    if (m_readOnly || !m_insertMode) {
+        return;
+    }
+    
+    qint64 pos;
+    qint64 count = 1;
+    const bool selection = m_selectionStart >= 0;
+    if (selection) {
+        pos = qMin(m_selectionStart, m_selectionEnd);
+        count = qAbs(m_selectionEnd - m_selectionStart) + 1;
+    } else if (backward) {
+        if (m_cursorPosition == 0) {
+            return;
+        }
+        pos = m_cursorPosition - 1;
+    } else {
+        if (m_cursorPosition >= m_data.size()) {
+            return;
+        }
+        pos = m_cursorPosition;
+    }
+    
+    if (!replaceBytes(pos, count, QByteArray(), !selection)) {
+        return;
+    }
+    m_selectionStart = -1;
+    m_selectionEnd = -1;
+    m_cursorPosition = pos;
+    m_nibblePosition = false;
+    ensureCursorVisible();
+}
+
+void HexEditor::undo() {
+    if (m_history.canUndo()) {
+        HexHistory::Delta &delta = m_history.undo();
+        // Typing merges into the record, so its pieces are taken only now
+        delta.insertedPieces = m_data.pieces(delta.pos, delta.inserted.size());
+        applyDelta(delta, false);
+    }
+}
+
+void HexEditor::redo() {
+    if (m_history.canRedo()) {
+        applyDelta(m_history.redo(), true);
+    }
+}
+
+void HexEditor::applyDelta(HexHistory::Delta &delta, bool forward) {
+    const QByteArray &gone = forward ? delta.removed : delta.inserted;
+    const QByteArray &back = forward ? delta.inserted : delta.removed;
+    PieceTable::Pieces &pieces = forward ? delta.insertedPieces : delta.removedPieces;
+    m_data.remove(delta.pos, gone.size());
+    if (!m_data.insert(delta.pos, pieces)) {
+        // Saving re-based the table; append the bytes once and keep their
+        // new pieces for the next round
+        m_data.insert(delta.pos, back);
+        pieces = m_data.pieces(delta.pos, back.size());
+    }
+    clearSearch();
+    
+    m_cursorPosition = qMin(forward ? delta.pos + delta.inserted.size() : delta.cursorBefore,
+                            lastCursorPosition());
+    m_selectionStart = -1;
+    m_selectionEnd = -1;
+    m_nibblePosition = false;
+    updateScrollBar();
+    ensureCursorVisible();
+    setModified(!m_history.isClean());
+    emit dataChanged();
+    update();
+    emit currentAddressChanged(m_cursorPosition);
+}
+
+void HexEditor::pasteClipboard() {
+    if (m_readOnly) {
+        return;
+    }
+    const QMimeData *mime = QApplication::clipboard()->mimeData();
+    QByteArray bytes;
+    if (mime && mime->hasFormat("application/octet-stream")) {
+        bytes = mime->data("application/octet-stream");
+    } else {
+        const QString text = QApplication::clipboard()->text();
+        static const QRegularExpression hexText("^[0-9A-Fa-f\\s]+$");
+        QString digits = text;
+        digits.remove(QRegularExpression("\\s"));
+        if (hexText.match(text).hasMatch() && digits.size() % 2 == 0) {
+            bytes = QByteArray::fromHex(digits.toLatin1());
+        } else {
+            bytes = text.toUtf8();
+        }
+    }
+    if (bytes.isEmpty()) {
+        return;
+    }
+    
+    qint64 pos = m_cursorPosition;
+    qint64 removed = 0;
+    if (m_insertMode && m_selectionStart >= 0) {
+        pos = qMin(m_selectionStart, m_selectionEnd);
+        removed = qAbs(m_selectionEnd - m_selectionStart) + 1;
+    } else if (!m_insertMode) {
+        // Overwrite mode keeps the size: clip to the end of the data
+        bytes.truncate(int(qMin(qint64(bytes.size()), m_data.size() - pos)));
+        removed = bytes.size();
+        if (bytes.isEmpty()) {
+            return;
+        }
+    }
+    
+    m_history.breakMerge();
+    if (!replaceBytes(pos, removed, bytes, false)) {
+        return;
+    }
+    m_cursorPosition = qMin(pos + bytes.size(), lastCursorPosition());
+    m_selectionStart = -1;
+    m_selectionEnd = -1;
+    m_nibblePosition = false;
+    ensureCursorVisible();
+    emit currentAddressChanged(m_cursorPosition);
+}
+
+void HexEditor::addMarks(const QVector<Mark> &marks) {
+    m_marks += marks;
+    update();
+}
+
+void HexEditor::clearMarks() {
+    m_marks.clear();
+    update();
+}
+
+bool HexEditor::writeBytes(qint64 pos, qint64 removed, const QByteArray &bytes) {
+    if (m_readOnly || pos < 0 || removed < 0 || pos + removed > m_data.size()) {
+        return false;
+    }
+    if (!replaceBytes(pos, removed, bytes, false)) {
+        return false;
+    }
+    m_cursorPosition = qMin(m_cursorPosition, lastCursorPosition());
+    m_nibblePosition = false;
+    return true;
+}
+
+void HexEditor::setEntropyMapVisible(bool visible) {
+    if (!m_entropyStrip) {
+        if (!visible) {
+            return;
+        }
+        m_entropyStrip = new EntropyStrip(this);
+        m_entropyStrip->setGeometry(width() - 20 - EntropyStrip::StripWidth, 0, EntropyStrip::StripWidth, height());
+    }
+    m_entropyStrip->setVisible(visible);
+    updateLayout();
+}
+
+bool HexEditor::isEntropyMapVisible() const {
+    return m_entropyStrip && !m_entropyStrip->isHidden();
+}
+
+void HexEditor::setAutoFit(bool autoFit) {
+    m_autoFit = autoFit;
+    updateLayout();
+}
+
+void HexEditor::setBytesPerLine(int bytes) {
+    m_autoFit = false;
+    m_bytesPerLine = qMax(m_groupSize, bytes - bytes % m_groupSize);
+    updateLayout();
+}
+
+void HexEditor::setGroupSize(int bytes) {
+    m_groupSize = (bytes == 2 || bytes == 4 || bytes == 8) ? bytes : 1;
+    if (!m_autoFit) {
+        m_bytesPerLine = qMax(m_groupSize, m_bytesPerLine - m_bytesPerLine % m_groupSize);
+    }
+    updateLayout();
+}
+
+void HexEditor::setAddressWidth(int digits) {
+    m_addressWidth = qBound(4, digits, 16);
+    updateLayout();
+}
+
+void HexEditor::setOverlay(const QVector<Overlay> &overlay) {
+    m_overlay = overlay;
+    update();
+}
+
+bool HexEditor::event(QEvent *event) {
+    if (event->type() == QEvent::ToolTip) {
+        auto *help = static_cast<QHelpEvent *>(event);
+        bool inHexArea = false;
+        const qint64 pos = positionFromPoint(help->pos(), inHexArea);
+        auto field = std::upper_bound(m_overlay.cbegin(), m_overlay.cend(), pos,
+                                      [](qint64 pos, const Overlay &o) { return pos < o.pos; });
+        if (pos >= 0 && field != m_overlay.cbegin() && pos < (field - 1)->pos + (field - 1)->length) {
+            QToolTip::showText(help->globalPos(), (field - 1)->label, this);
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void HexEditor::select(qint64 pos, qint64 length) {
+    m_cursorPosition = qBound(qint64(0), pos, lastCursorPosition());
+    m_selectionStart = length > 0 ? m_cursorPosition : -1;
+    m_selectionEnd = length > 0 ? qMin(pos + length, m_data.size()) - 1 : -1;
+    m_nibblePosition = false;
+    m_history.breakMerge();
+    ensureCursorVisible();
+    update();
+    emit currentAddressChanged(m_cursorPosition);
+}
+
+void HexEditor::scrollToOffset(qint64 offset) {
+    setTopLine(offset / m_bytesPerLine);
+}
+
+void HexEditor::find(const HexSearch::Pattern &pattern) {
+    m_searchOrigin = m_cursorPosition;
+    m_searchIndex = -1;
+    m_search->start(m_data.snapshot(), pattern);
+    emit searchUpdated(0, 0, !pattern.isValid());
+    update();
+}
+
+void HexEditor::clearSearch() {
+    if (m_search->isRunning() || !m_search->hits().isEmpty()) {
+        m_search->clear();
+        m_searchIndex = -1;
+        emit searchUpdated(0, 0, true);
+    }
+}
+
+void HexEditor::findNext() {
+    showHit(m_search->next(m_cursorPosition));
+}
+
+void HexEditor::findPrevious() {
+    showHit(m_search->previous(m_cursorPosition));
+}
+
+void HexEditor::showHit(int index) {
+    if (index < 0) {
+        return;
+    }
+    const qint64 pos = m_search->hits().at(index);
+    m_searchIndex = index;
+    m_cursorPosition = pos;
+    m_selectionStart = pos;
+    m_selectionEnd = pos + qMax(1, m_search->patternSize()) - 1;
+    m_nibblePosition = false;
+    m_history.breakMerge();
+    ensureCursorVisible();
+    update();
+    emit currentAddressChanged(m_cursorPosition);
+    emit searchUpdated(index + 1, m_search->hits().size(), !m_search->isRunning());
+}
+
+qint64 HexEditor::lastCursorPosition() const {
+    return m_insertMode ? m_data.size() : qMax(qint64(0), m_data.size() - 1);
+}
+
+qint64 HexEditor::maxTopLine() const {
+    const qint64 totalLines = (m_data.size() + (m_insertMode ? 1 : 0) + m_bytesPerLine - 1) / m_bytesPerLine;
+    return qMax(qint64(0), totalLines - visibleLines());
+}
+
 void HexEditor::updateScrollBar() {
-    int totalLines = (m_data.size() + m_bytesPerLine - 1) / m_bytesPerLine;
-    int visible = visibleLines();
+    const qint64 maxTop = maxTopLine();
+    const int visible = visibleLines();
+    m_lineScale = maxTop / std::numeric_limits<int>::max() + 1;
+    m_topLine = qMin(m_topLine, maxTop);
     
-    m_scrollBar->setRange(0, qMax(0, totalLines - visible));
-    m_scrollBar->setPageStep(visible);
+    // The range changes are bookkeeping; m_topLine already holds the view
+    const QSignalBlocker blocker(m_scrollBar);
+    m_scrollBar->setRange(0, int(maxTop / m_lineScale));
+    m_scrollBar->setPageStep(qMax(1, int(visible / m_lineScale)));
     m_scrollBar->setSingleStep(1);
+    m_scrollBar->setValue(int(m_topLine / m_lineScale));
+}
+
+void HexEditor::setTopLine(qint64 line) {
+    line = qBound(qint64(0), line, maxTopLine());
+    if (line == m_topLine) {
+        return;
+    }
+    m_topLine = line;
+    const int value = int(line / m_lineScale);
+    if (value != m_scrollBar->value()) {
+        m_scrollBar->setValue(value);
+    } else {
+        update();
+        emit scrolled(topOffset());
+    }
 }
 
 void HexEditor::ensureCursorVisible() {
-    int line = m_cursorPosition / m_bytesPerLine;
-    int firstVisible = m_scrollBar->value();
-    int lastVisible = firstVisible + visibleLines() - 1;
+    const qint64 line = m_cursorPosition / m_bytesPerLine;
+    const qint64 lastVisible = m_topLine + visibleLines() - 1;
     
-    if (line < firstVisible) {
-        m_scrollBar->setValue(line);
+    if (line < m_topLine) {
+        setTopLine(line);
     } else if (line > lastVisible) {
-        m_scrollBar->setValue(line - visibleLines() + 1);
+        setTopLine(line - visibleLines() + 1);
     }
 }
 
 qint64 HexEditor::positionFromPoint(const QPoint &pos, bool &inHexArea) {
-    int line = (pos.y() - 5) / (m_charHeight + 2);
-    line += m_scrollBar->value();
+    const qint64 line = m_topLine + (pos.y() - 5) / (m_charHeight + 2);
     
-    int hexX = 5 + (m_addressWidth + 2) * m_charWidth;
-    int asciiX = hexX + (m_bytesPerLine * 3 + 2) * m_charWidth;
-    
-    if (pos.x() >= hexX && pos.x() < asciiX) {
-        // In hex area
+    if (pos.x() >= m_layout.hexX && pos.x() < m_layout.asciiX) {
+        // In hex area; the gap before the ASCII column belongs to the last byte
         inHexArea = true;
-        int byteIndex = (pos.x() - hexX) / (3 * m_charWidth);
-        return line * m_bytesPerLine + byteIndex;
-    } else if (pos.x() >= asciiX) {
+        int column = qMin((pos.x() - m_layout.hexX) / m_charWidth, int(m_layout.byteAtHexChar.size()) - 1);
+        return qint64(line) * m_bytesPerLine + m_layout.byteAtHexChar[column];
+    } else if (pos.x() >= m_layout.asciiX) {
         // In ASCII area
         inHexArea = false;
-        int byteIndex = (pos.x() - asciiX) / m_charWidth;
-        return line * m_bytesPerLine + byteIndex;
+        int byteIndex = qMin((pos.x() - m_layout.asciiX) / m_charWidth, m_bytesPerLine - 1);
+        return qint64(line) * m_bytesPerLine + byteIndex;
     }
     
     return -1;
 }
 
 QRect HexEditor::hexAreaRect() const {
-    int hexX = 5 + (m_addressWidth + 2) * m_charWidth;
-    int width = m_bytesPerLine * 3 * m_charWidth;
-    return QRect(hexX, 0, width, height());
+    return QRect(m_layout.hexX, 0, m_layout.hexWidth, height());
 }
 
 QRect HexEditor::asciiAreaRect() const {
-    int hexX = 5 + (m_addressWidth + 2) * m_charWidth;
-    int asciiX = hexX + (m_bytesPerLine * 3 + 2) * m_charWidth;
-    int width = m_bytesPerLine * m_charWidth;
-    return QRect(asciiX, 0, width, height());
+    return QRect(m_layout.asciiX, 0, m_bytesPerLine * m_charWidth, height());
+}
+
+int HexEditor::fitBytesPerLine() const {
+    // Characters left for the hex and ASCII columns; each group takes two
+    // digits and one ASCII cell per byte plus a gap
+    int right = width() - 20 - 5;
+    if (isEntropyMapVisible()) {
+        right -= EntropyStrip::StripWidth;
+    }
+    const int columns = (right - 5) / m_charWidth - (m_addressWidth + 2) - 2;
+    int bytes = qMax(1, columns / (3 * m_groupSize + 1)) * m_groupSize;
+    // Whole multiples of 8 keep addresses round
+    if (bytes >= 8) {
+        bytes -= bytes % 8;
+    }
+    return bytes;
+}
+
+void HexEditor::updateLayout() {
+    const qint64 top = topOffset();
+    const int previous = m_bytesPerLine;
+    if (m_autoFit) {
+        m_bytesPerLine = fitBytesPerLine();
+    }
+    
+    const int hexChars = m_bytesPerLine * 2 + m_bytesPerLine / m_groupSize;
+    m_layout.hexX = 5 + (m_addressWidth + 2) * m_charWidth;
+    m_layout.hexWidth = hexChars * m_charWidth;
+    m_layout.asciiX = m_layout.hexX + (hexChars + 2) * m_charWidth;
+    m_layout.hexByteX.resize(m_bytesPerLine + 1);
+    m_layout.byteAtHexChar.resize(hexChars);
+    for (int i = 0; i < m_bytesPerLine; ++i) {
+        const int column = i * 2 + i / m_groupSize;
+        m_layout.hexByteX[i] = m_layout.hexX + column * m_charWidth;
+        m_layout.byteAtHexChar[column] = i;
+        m_layout.byteAtHexChar[column + 1] = i;
+        if ((i + 1) % m_groupSize == 0) {
+            m_layout.byteAtHexChar[column + 2] = i;
+        }
+    }
+    m_layout.hexByteX[m_bytesPerLine] = m_layout.hexX + m_layout.hexWidth;
+    
+    updateScrollBar();
+    if (m_bytesPerLine != previous) {
+        // Keep the first visible byte on screen across a reflow
+        scrollToOffset(top);
+    }
+    update();
 }
 
 int HexEditor::visibleLines() const {
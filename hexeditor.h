@@ -6,6 +6,13 @@
 #include <QByteArray>
 #include <QFont>
 
+#include "hexhistory.h"
+#include "hexsearch.h"
+#include "piecetable.h"
+
+class EntropyStrip;
+class QIODevice;
+
 class HexEditor : public QWidget {
     Q_OBJECT
 
@@ -13,27 +20,111 @@ public:
     explicit HexEditor(QWidget *parent = nullptr);
     
     void setData(const QByteArray &data);
-    QByteArray data() const { return m_data; }
+    // Empty when the data is longer than PieceTable::MaxReadLength
+    QByteArray data() const { return m_data.toByteArray(); }
+    qint64 size() const { return m_data.size(); }
     void clear();
     
+    // Opens the file ReadOnly when setReadOnly(true) was called first
     bool loadFile(const QString &fileName);
+    // File the buffer was loaded from or last saved to
+    QString fileName() const { return m_fileName; }
     bool saveFile(const QString &fileName);
+    // Streams the pieces; call fileSaved() once the device is committed
+    bool write(QIODevice *device) const { return m_data.write(device); }
+    void fileSaved(const QString &fileName);
     
     void setReadOnly(bool readOnly) { m_readOnly = readOnly; }
     bool isReadOnly() const { return m_readOnly; }
 
+    // Insert mode types new bytes and lets Delete/Backspace remove them;
+    // overwrite mode keeps the file size fixed
+    void setInsertMode(bool insert) { m_insertMode = insert; updateScrollBar(); update(); }
+    bool isInsertMode() const { return m_insertMode; }
+
+    bool canUndo() const { return m_history.canUndo(); }
+    bool canRedo() const { return m_history.canRedo(); }
+
+    // Marked byte ranges (diff hunks), kept sorted and non-overlapping; a
+    // zero-length mark draws a bar where bytes exist only on the other side
+    struct Mark {
+        qint64 pos;
+        qint64 length;
+    };
+    void addMarks(const QVector<Mark> &marks);
+    void clearMarks();
+    int markCount() const { return m_marks.size(); }
+
+    // Tinted field ranges from a structure template, sorted and disjoint;
+    // hovering one shows its label
+    struct Overlay {
+        qint64 pos;
+        qint64 length;
+        QString label;
+    };
+    void setOverlay(const QVector<Overlay> &overlay);
+
+    qint64 cursorPosition() const { return m_cursorPosition; }
+    // Moves the cursor to pos and selects length bytes (none when 0)
+    void select(qint64 pos, qint64 length);
+    qint64 topOffset() const { return m_topLine * m_bytesPerLine; }
+    qint64 visibleBytes() const { return qint64(visibleLines()) * m_bytesPerLine; }
+    void scrollToOffset(qint64 offset);
+
+    // Scans a snapshot in the background; hits stream in and the first one
+    // at or after the cursor is selected.  Edits discard the results.
+    void find(const HexSearch::Pattern &pattern);
+    void clearSearch();
+
+public slots:
+    void undo();
+    void redo();
+    // Hex text ("DE AD BE EF") is pasted as bytes, anything else verbatim
+    void pasteClipboard();
+    void findNext();
+    void findPrevious();
+
+public:
+
+    // Straight from the buffer, for small reads on the GUI thread
+    qint64 read(qint64 pos, char *dest, qint64 length) const { return m_data.read(pos, dest, length); }
+    // Replaces removed bytes at pos with bytes as one undo step and leaves
+    // the cursor where it is; false when read-only or past the end
+    bool writeBytes(qint64 pos, qint64 removed, const QByteArray &bytes);
+
+    // Frozen copy of the buffer for worker threads (search, checksums)
+    PieceTable::Snapshot snapshot() const { return m_data.snapshot(); }
+    bool hasSelection() const { return m_selectionStart >= 0; }
+    qint64 selectionStart() const { return qMin(m_selectionStart, m_selectionEnd); }
+    qint64 selectionLength() const { return hasSelection() ? qAbs(m_selectionEnd - m_selectionStart) + 1 : 0; }
+
     bool isModified() const { return m_modified; }
     void setModified(bool modified);
     
-    void setAddressWidth(int width) { m_addressWidth = width; update(); }
-    void setBytesPerLine(int bytes) { m_bytesPerLine = bytes; updateScrollBar(); update(); }
+    // Layout: bytes per line follow the widget width in whole groups unless
+    // a fixed count is set; groups are 1, 2, 4 or 8 bytes between spaces
+    void setAutoFit(bool autoFit);
+    bool autoFit() const { return m_autoFit; }
+    void setBytesPerLine(int bytes);
+    int bytesPerLine() const { return m_bytesPerLine; }
+    void setGroupSize(int bytes);
+    int groupSize() const { return m_groupSize; }
+    void setAddressWidth(int digits);
+    int addressWidth() const { return m_addressWidth; }
+
+    // Entropy and byte-mix overview beside the scroll bar
+    void setEntropyMapVisible(bool visible);
+    bool isEntropyMapVisible() const;
 
 signals:
     void dataChanged();
     void modificationChanged(bool modified);
     void currentAddressChanged(qint64 address);
+    void searchUpdated(int current, int total, bool finished);
+    void scrolled(qint64 topOffset);
 
 protected:
+    bool event(QEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
@@ -41,24 +132,63 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
 
 private:
-    QByteArray m_data;
+    PieceTable m_data;
+    HexHistory m_history;
+    HexSearch *m_search;
+    qint64 m_searchOrigin;
+    int m_searchIndex;
+    QVector<Mark> m_marks;
+    QVector<Overlay> m_overlay;
     QScrollBar *m_scrollBar;
+    // Lines are counted in qint64; the int scroll bar moves m_lineScale
+    // lines per step once a file has more lines than it can hold
+    qint64 m_topLine = 0;
+    qint64 m_lineScale = 1;
+    EntropyStrip *m_entropyStrip = nullptr;
+    QString m_fileName;
     
     qint64 m_cursorPosition;
     qint64 m_selectionStart;
     qint64 m_selectionEnd;
     
     int m_bytesPerLine;
+    int m_groupSize;
     int m_addressWidth;
     int m_charWidth;
     int m_charHeight;
+    bool m_autoFit;
+
+    // Geometry of one line, rebuilt by updateLayout() when the width,
+    // grouping or address width changes; painting and hit-testing index it
+    // instead of recomputing positions per byte
+    struct Layout {
+        int hexX = 0;
+        int asciiX = 0;
+        int hexWidth = 0;               // digits and group gaps
+        QVector<int> hexByteX;          // left of byte i's digits; [bytesPerLine] ends the area
+        QVector<int> byteAtHexChar;     // byte under each character cell of the hex area
+    };
+    Layout m_layout;
     
     bool m_readOnly;
     bool m_modified;
+    bool m_insertMode;
     bool m_cursorInHexArea;
     bool m_nibblePosition; // false = high nibble, true = low nibble
     
+    // False, changing nothing, when the removed bytes are too many to undo
+    bool replaceBytes(qint64 pos, qint64 removed, const QByteArray &bytes, bool typing);
+    void applyDelta(HexHistory::Delta &delta, bool forward);
+    void showHit(int index);
+    void typeNibble(int value);
+    void typeByte(char byte);
+    void removeBytes(bool backward);
+    qint64 lastCursorPosition() const;
     void updateScrollBar();
+    qint64 maxTopLine() const;
+    void setTopLine(qint64 line);
+    void updateLayout();
+    int fitBytesPerLine() const;
     void ensureCursorVisible();
     qint64 positionFromPoint(const QPoint &pos, bool &inHexArea);
     QRect hexAreaRect() const;
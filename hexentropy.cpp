@@ -0,0 +1,394 @@
+#include "hexentropy.h"
+#include "hexeditor.h"
+
+#include <QCache>
+#include <QDateTime>
+#include <QEvent>
+#include <QFileInfo>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QToolTip>
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Maps of unmodified files, costed in KB; only touched on the GUI thread
+struct CachedMap {
+    QDateTime modified;
+    qint64 size;
+    std::shared_ptr<const std::vector<EntropyMap::Block>> blocks;
+};
+
+QCache<QString, CachedMap> &mapCache()
+{
+    static QCache<QString, CachedMap> cache(64 * 1024);
+    return cache;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  EntropyMap
+// ─────────────────────────────────────────────────────────────────────────────
+qint64 EntropyMap::blockSize(qint64 size)
+{
+    qint64 block = MinBlock;
+    while (size / block > MaxBlocks)
+        block *= 2;
+    return block;
+}
+
+EntropyMap::Block EntropyMap::analyze(const uchar *data, qint64 length, const float *cLog2c)
+{
+    // Four tables so neighbouring bytes never wait on the same counter
+    quint32 counts[4][256] = {};
+    qint64 i = 0;
+    for (; i + 8 <= length; i += 8) {
+        quint64 w;
+        memcpy(&w, data + i, 8);
+        ++counts[0][w & 0xFF];
+        ++counts[1][(w >> 8) & 0xFF];
+        ++counts[2][(w >> 16) & 0xFF];
+        ++counts[3][(w >> 24) & 0xFF];
+        ++counts[0][(w >> 32) & 0xFF];
+        ++counts[1][(w >> 40) & 0xFF];
+        ++counts[2][(w >> 48) & 0xFF];
+        ++counts[3][w >> 56];
+    }
+    for (; i < length; ++i)
+        ++counts[0][data[i]];
+
+    // H = log2(n) - sum(c log2 c) / n
+    float sum = 0;
+    quint32 text = 0;
+    quint32 high = 0;
+    for (int v = 0; v < 256; ++v) {
+        const quint32 c = counts[0][v] + counts[1][v] + counts[2][v] + counts[3][v];
+        sum += cLog2c[c];
+        if ((v >= 0x20 && v < 0x7F) || v == '\t' || v == '\n' || v == '\r')
+            text += c;
+        else if (v >= 0x80)
+            high += c;
+        counts[0][v] = c;
+    }
+    Block block = {};
+    if (length > 0) {
+        const float n = float(length);
+        const float entropy = std::log2(n) - sum / n;
+        block.entropy = quint8(qBound(0.0f, entropy / 8.0f, 1.0f) * 255.0f + 0.5f);
+        block.zeros = quint8(counts[0][0] * 255.0f / n + 0.5f);
+        block.text = quint8(text * 255.0f / n + 0.5f);
+        block.high = quint8(high * 255.0f / n + 0.5f);
+    }
+    return block;
+}
+
+void EntropyMap::compute(const PieceTable::Snapshot &data, qint64 blockSize,
+                         std::vector<Block> &out, const std::atomic_bool &cancel,
+                         std::atomic<qint64> *done)
+{
+    const qint64 size = data.size();
+    const qint64 count = (size + blockSize - 1) / blockSize;
+    out.assign(size_t(count), Block{});
+
+    std::vector<float> cLog2c(size_t(blockSize) + 1, 0.0f);
+    for (qint64 c = 1; c <= blockSize; ++c)
+        cLog2c[size_t(c)] = float(c * std::log2(double(c)));
+
+    // Threads claim runs of blocks until none are left
+    const qint64 perChunk = qMax(qint64(1), Chunk / blockSize);
+    std::atomic<qint64> next{0};
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for (int t = 0; t < pool.maxThreadCount(); ++t) {
+        pool.start([&]() {
+            QByteArray scratch;
+            for (qint64 first; !cancel && (first = next.fetch_add(perChunk)) < count;) {
+                const qint64 pos = first * blockSize;
+                const qint64 n = qMin(perChunk * blockSize, size - pos);
+                const uchar *p = reinterpret_cast<const uchar *>(data.data(pos, n, scratch));
+                for (qint64 off = 0, b = first; off < n; off += blockSize, ++b)
+                    out[size_t(b)] = analyze(p + off, qMin(blockSize, n - off), cLog2c.data());
+                if (done)
+                    *done += n;
+            }
+        });
+    }
+    pool.waitForDone();
+}
+
+EntropyMap::EntropyMap(QObject *parent)
+    : QObject(parent)
+    , m_blocks(std::make_shared<std::vector<Block>>())
+{
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(100);
+    connect(m_progressTimer, &QTimer::timeout, this, [this]() {
+        emit progress(m_done.load(), m_size);
+    });
+}
+
+EntropyMap::~EntropyMap()
+{
+    cancel();
+}
+
+void EntropyMap::start(const PieceTable::Snapshot &data, const QString &fileName)
+{
+    cancel();
+    m_cancel = false;
+    m_done = 0;
+    m_size = data.size();
+    m_blockSize = blockSize(m_size);
+
+    const quint64 generation = m_generation;
+    const QDateTime modified = fileName.isEmpty() ? QDateTime() : QFileInfo(fileName).lastModified();
+    const CachedMap *cached = fileName.isEmpty() ? nullptr : mapCache().object(fileName);
+    if (cached && cached->size == m_size && cached->modified == modified) {
+        m_blocks = cached->blocks;
+        QMetaObject::invokeMethod(this, [this, generation]() {
+            if (generation == m_generation)
+                emit finished();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    const qint64 size = m_size;
+    const qint64 block = m_blockSize;
+    m_worker = QThread::create([this, data, fileName, modified, size, block, generation]() {
+        auto blocks = std::make_shared<std::vector<Block>>();
+        compute(data, block, *blocks, m_cancel, &m_done);
+        QMetaObject::invokeMethod(this, [this, blocks, fileName, modified, size, generation]() {
+            if (generation != m_generation)
+                return;
+            m_worker = nullptr;
+            m_progressTimer->stop();
+            m_blocks = blocks;
+            if (!fileName.isEmpty())
+                mapCache().insert(fileName, new CachedMap{modified, size, blocks},
+                                  int(blocks->size() * sizeof(Block) / 1024 + 1));
+            emit progress(m_size, m_size);
+            emit finished();
+        }, Qt::QueuedConnection);
+    });
+    connect(m_worker, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_worker->start(QThread::LowPriority);
+    m_progressTimer->start();
+}
+
+void EntropyMap::cancel()
+{
+    ++m_generation;
+    m_progressTimer->stop();
+    if (m_worker) {
+        // Workers check the flag once per chunk
+        m_cancel = true;
+        m_worker->wait();
+        m_worker = nullptr;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  EntropyStrip
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+const QColor kPanel(37, 37, 38);
+const QColor kBorder(60, 60, 60);
+const QColor kFg(212, 212, 212);
+
+// Dim blue for uniform padding through green to red for random-looking data
+QRgb entropyColor(float e)
+{
+    return QColor::fromHsvF((1.0f - e) * 0.66f, 0.85f, 0.30f + 0.70f * e).rgb();
+}
+
+} // namespace
+
+EntropyStrip::EntropyStrip(HexEditor *editor)
+    : QWidget(editor)
+    , m_editor(editor)
+{
+    setCursor(Qt::PointingHandCursor);
+
+    m_map = new EntropyMap(this);
+    connect(m_map, &EntropyMap::progress, this, [this](qint64 done, qint64 total) {
+        m_percent = total > 0 ? int(done * 100 / total) : 100;
+        update();
+    });
+    connect(m_map, &EntropyMap::finished, this, [this]() {
+        buildImage();
+        update();
+    });
+
+    // Edits recompute once they pause; hidden strips wait until shown
+    m_refresh = new QTimer(this);
+    m_refresh->setSingleShot(true);
+    m_refresh->setInterval(500);
+    connect(m_refresh, &QTimer::timeout, this, [this]() {
+        if (isVisible())
+            refresh();
+    });
+    connect(m_editor, &HexEditor::dataChanged, this, [this]() {
+        m_stale = true;
+        m_refresh->start();
+    });
+    connect(m_editor, &HexEditor::scrolled, this, qOverload<>(&QWidget::update));
+}
+
+void EntropyStrip::refresh()
+{
+    m_refresh->stop();
+    m_stale = false;
+    m_percent = 0;
+    m_map->start(m_editor->snapshot(), m_editor->isModified() ? QString() : m_editor->fileName());
+    update();
+}
+
+void EntropyStrip::buildImage()
+{
+    const std::vector<EntropyMap::Block> &blocks = m_map->blocks();
+    const int h = height();
+    if (blocks.empty() || h <= 0) {
+        m_image = QImage();
+        return;
+    }
+
+    // One row per pixel, averaging the blocks it covers
+    m_image = QImage(StripWidth, h, QImage::Format_RGB32);
+    m_image.fill(kPanel);
+    const int split = StripWidth * 3 / 5;
+    const qint64 n = qint64(blocks.size());
+    for (int y = 0; y < h; ++y) {
+        const qint64 first = y * n / h;
+        const qint64 last = qMax(first + 1, (y + 1) * n / h);
+        quint64 entropy = 0, zeros = 0, text = 0, high = 0;
+        for (qint64 b = first; b < last; ++b) {
+            const EntropyMap::Block &block = blocks[size_t(b)];
+            entropy += block.entropy;
+            zeros += block.zeros;
+            text += block.text;
+            high += block.high;
+        }
+        const qint64 count = last - first;
+        QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(y));
+        const QRgb e = entropyColor(float(entropy) / (255.0f * count));
+        for (int x = 0; x < split - 1; ++x)
+            line[x] = e;
+
+        // Zero, text, other and high bytes side by side by share
+        const int width = StripWidth - split;
+        const int zeroEnd = split + int(zeros * width / (255 * count));
+        const int textEnd = zeroEnd + int(text * width / (255 * count));
+        const int highStart = StripWidth - int(high * width / (255 * count));
+        for (int x = split; x < StripWidth; ++x) {
+            if (x < zeroEnd)
+                line[x] = qRgb(90, 90, 90);
+            else if (x < textEnd)
+                line[x] = qRgb(106, 153, 85);
+            else if (x >= highStart)
+                line[x] = qRgb(206, 145, 120);
+            else
+                line[x] = qRgb(86, 156, 214);
+        }
+    }
+}
+
+qint64 EntropyStrip::offsetAt(int y) const
+{
+    const qint64 size = m_map->size();
+    if (size <= 0 || height() <= 0)
+        return 0;
+    const qint64 offset = qBound(0, y, height() - 1) * size / height();
+    return offset - offset % m_map->blockSize();
+}
+
+void EntropyStrip::jumpTo(int y)
+{
+    const qint64 offset = offsetAt(y);
+    m_editor->scrollToOffset(offset);
+    m_editor->select(offset, 0);
+}
+
+bool EntropyStrip::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        auto *help = static_cast<QHelpEvent *>(event);
+        const std::vector<EntropyMap::Block> &blocks = m_map->blocks();
+        const qint64 offset = offsetAt(help->pos().y());
+        const qint64 index = offset / m_map->blockSize();
+        if (index < qint64(blocks.size())) {
+            const EntropyMap::Block &b = blocks[size_t(index)];
+            QToolTip::showText(help->globalPos(),
+                QString("0x%1 – 0x%2\nEntropy %3 bits/byte\nZero %4%  Text %5%  High %6%")
+                    .arg(QString::number(offset, 16).toUpper())
+                    .arg(QString::number(qMin(offset + m_map->blockSize(), m_map->size()) - 1, 16).toUpper())
+                    .arg(b.entropy * 8.0 / 255.0, 0, 'f', 2)
+                    .arg(b.zeros * 100 / 255).arg(b.text * 100 / 255).arg(b.high * 100 / 255),
+                this);
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void EntropyStrip::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), kPanel);
+    if (!m_image.isNull())
+        painter.drawImage(0, 0, m_image);
+    painter.setPen(kBorder);
+    painter.drawLine(0, 0, 0, height());
+
+    // Outline the bytes on screen
+    const qint64 size = m_map->size();
+    if (size > 0) {
+        const int top = int(m_editor->topOffset() * height() / size);
+        const int bottom = int(qMin(size, m_editor->topOffset() + m_editor->visibleBytes()) * height() / size);
+        painter.setPen(QColor(255, 255, 255, 200));
+        painter.setBrush(QColor(255, 255, 255, 40));
+        painter.drawRect(0, top, width() - 1, qMax(2, bottom - top));
+    }
+
+    if (m_map->isRunning()) {
+        painter.setPen(kFg);
+        painter.setFont(QFont("Consolas", 7));
+        painter.drawText(rect().adjusted(0, 4, 0, 0), Qt::AlignHCenter | Qt::AlignTop,
+                         QString("%1%").arg(m_percent));
+    }
+}
+
+void EntropyStrip::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+        jumpTo(event->position().toPoint().y());
+}
+
+void EntropyStrip::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton)
+        jumpTo(event->position().toPoint().y());
+}
+
+void EntropyStrip::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    buildImage();
+}
+
+void EntropyStrip::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (m_stale)
+        refresh();
+}
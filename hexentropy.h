@@ -0,0 +1,123 @@
+#ifndef HEXENTROPY_H
+#define HEXENTROPY_H
+
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QWidget>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "piecetable.h"
+
+class HexEditor;
+class QThread;
+class QTimer;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  EntropyMap
+//  Shannon entropy and a coarse value distribution (zero, text, high and
+//  other bytes) per block of a PieceTable snapshot.  Blocks start at 4 KB
+//  and grow with the file so a map never exceeds MaxBlocks entries.  Pool
+//  threads claim Chunk-sized runs of blocks and count bytes into four
+//  interleaved histograms, which keeps successive increments of the same
+//  value from stalling on each other; entropy then comes from a c·log2(c)
+//  table instead of a log per value.  Maps of unmodified files are cached
+//  by path, size and modification time.
+// ─────────────────────────────────────────────────────────────────────────────
+class EntropyMap : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Each field scaled to 0..255: entropy of 8 bits, fractions of the block
+    struct Block {
+        quint8 entropy;
+        quint8 zeros;
+        quint8 text;
+        quint8 high;
+    };
+
+    static constexpr qint64 MinBlock  = 4096;
+    static constexpr qint64 MaxBlocks = 1 << 20;
+    static constexpr qint64 Chunk     = 4 * 1024 * 1024;
+
+    static qint64 blockSize(qint64 size);
+    static Block analyze(const uchar *data, qint64 length, const float *cLog2c);
+
+    // Blocking; fills out with one entry per block, done counts bytes
+    static void compute(const PieceTable::Snapshot &data, qint64 blockSize,
+                        std::vector<Block> &out, const std::atomic_bool &cancel,
+                        std::atomic<qint64> *done = nullptr);
+
+    explicit EntropyMap(QObject *parent = nullptr);
+    ~EntropyMap() override;
+
+    // fileName names the data on disk when it has no unsaved edits; such
+    // maps are cached and reused
+    void start(const PieceTable::Snapshot &data, const QString &fileName = QString());
+    void cancel();
+    bool isRunning() const { return m_worker != nullptr; }
+
+    qint64 size() const { return m_size; }
+    qint64 blockSize() const { return m_blockSize; }
+    const std::vector<Block> &blocks() const { return *m_blocks; }
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void finished();
+
+private:
+    QThread *m_worker = nullptr;
+    QTimer *m_progressTimer;
+    std::atomic_bool m_cancel{false};
+    std::atomic<qint64> m_done{0};
+    qint64 m_size = 0;
+    qint64 m_blockSize = MinBlock;
+    quint64 m_generation = 0;
+    std::shared_ptr<const std::vector<Block>> m_blocks;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  EntropyStrip
+//  Narrow overview beside a HexEditor's scroll bar.  The left column is
+//  entropy (dim blue for padding through red for compressed or encrypted
+//  data), the right one the byte mix of each row.  The visible range is
+//  outlined; clicking or dragging jumps there.  Recomputed shortly after
+//  edits.
+// ─────────────────────────────────────────────────────────────────────────────
+class EntropyStrip : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int StripWidth = 36;
+
+    explicit EntropyStrip(HexEditor *editor);
+
+    void refresh();
+
+protected:
+    bool event(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void buildImage();
+    qint64 offsetAt(int y) const;
+    void jumpTo(int y);
+
+    HexEditor *m_editor;
+    EntropyMap *m_map;
+    QTimer *m_refresh;
+    QImage m_image;
+    int m_percent = 0;
+    bool m_stale = true;
+};
+
+#endif // HEXENTROPY_H
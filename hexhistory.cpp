@@ -0,0 +1,93 @@
+#include "hexhistory.h"
+
+void HexHistory::record(const Delta &delta, bool typing)
+{
+    // A new edit forks the history; if the saved state was on the redo side
+    // it can no longer be reached
+    for (const Delta &undone : m_redo)
+        m_bytes -= cost(undone);
+    m_redo.clear();
+    if (m_clean > qint64(m_undo.size()))
+        m_clean = -1;
+
+    if (!(typing && m_mergeable && !m_undo.empty() && !isClean() && merge(delta))) {
+        m_undo.push_back(delta);
+        m_bytes += cost(delta);
+    }
+    m_mergeable = typing;
+    trim();
+}
+
+void HexHistory::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+    m_bytes = 0;
+    m_clean = 0;
+    m_mergeable = false;
+}
+
+HexHistory::Delta &HexHistory::undo()
+{
+    m_redo.push_back(std::move(m_undo.back()));
+    m_undo.pop_back();
+    m_mergeable = false;
+    return m_redo.back();
+}
+
+HexHistory::Delta &HexHistory::redo()
+{
+    m_undo.push_back(std::move(m_redo.back()));
+    m_redo.pop_back();
+    m_mergeable = false;
+    return m_undo.back();
+}
+
+void HexHistory::setClean()
+{
+    m_clean = qint64(m_undo.size());
+    m_mergeable = false;
+}
+
+bool HexHistory::merge(const Delta &delta)
+{
+    Delta &top = m_undo.back();
+    const qint64 topEnd = top.pos + top.inserted.size();
+    const qint64 before = cost(top);
+
+    if (delta.pos >= top.pos && delta.pos + delta.removed.size() <= topEnd) {
+        // Rewrites bytes this record inserted: second nibble, backspace
+        top.inserted.replace(int(delta.pos - top.pos), delta.removed.size(), delta.inserted);
+    } else if (delta.pos == topEnd) {
+        // Continues right after it: the next typed byte, repeated Delete
+        top.removed += delta.removed;
+        top.inserted += delta.inserted;
+        top.removedPieces.list.insert(top.removedPieces.list.end(),
+                                      delta.removedPieces.list.begin(),
+                                      delta.removedPieces.list.end());
+    } else if (delta.inserted.isEmpty() && delta.pos + delta.removed.size() == top.pos) {
+        // Backspace past the start of the record
+        top.removed.prepend(delta.removed);
+        top.removedPieces.list.insert(top.removedPieces.list.begin(),
+                                      delta.removedPieces.list.begin(),
+                                      delta.removedPieces.list.end());
+        top.pos = delta.pos;
+    } else {
+        return false;
+    }
+    m_bytes += cost(top) - before;
+    return true;
+}
+
+void HexHistory::trim()
+{
+    // The newest record always stays, however large, so the last edit can
+    // be undone
+    while (m_undo.size() > 1 &&
+           (m_bytes > MaxBytes || m_undo.size() > size_t(MaxRecords))) {
+        m_bytes -= cost(m_undo.front());
+        m_undo.pop_front();
+        if (m_clean >= 0)
+            m_clean = m_clean == 0 ? -1 : m_clean - 1;
+    }
+}
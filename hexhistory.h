@@ -0,0 +1,65 @@
+#ifndef HEXHISTORY_H
+#define HEXHISTORY_H
+
+#include <QByteArray>
+
+#include "piecetable.h"
+
+#include <deque>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexHistory
+//  Undo/redo stack for the hex editor.  Each record is one byte-range
+//  delta — the bytes an edit removed and the bytes it inserted at a
+//  position — so undoing or redoing costs the size of the edit, never the
+//  size of the file.  Records also hold the pieces those bytes occupy in
+//  the PieceTable, so undo and redo link them back in rather than append
+//  the bytes to the add buffer once more.  Consecutive typing merges into the record on top
+//  (overwriting a nibble, extending a run, backspacing into it), and the
+//  oldest records are dropped once the stack exceeds MaxBytes or
+//  MaxRecords, keeping memory bounded over long sessions.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexHistory
+{
+public:
+    struct Delta {
+        qint64 pos = 0;
+        QByteArray removed;
+        QByteArray inserted;
+        qint64 cursorBefore = 0;    // restored by undo; redo lands after inserted
+        PieceTable::Pieces removedPieces;   // taken by the edit
+        PieceTable::Pieces insertedPieces;  // taken by undo, for redo
+    };
+
+    static constexpr qint64 MaxBytes   = 64 * 1024 * 1024;
+    static constexpr int    MaxRecords = 100000;
+
+    void record(const Delta &delta, bool typing);
+    void breakMerge() { m_mergeable = false; }
+    void clear();
+
+    bool canUndo() const { return !m_undo.empty(); }
+    bool canRedo() const { return !m_redo.empty(); }
+
+    // Move the delta across stacks and hand it back to reverse or reapply;
+    // the reference is good until the history changes
+    Delta &undo();
+    Delta &redo();
+
+    void setClean();
+    bool isClean() const { return m_clean == qint64(m_undo.size()); }
+
+private:
+    bool merge(const Delta &delta);
+    void trim();
+    static qint64 cost(const Delta &delta) { return delta.removed.size() + delta.inserted.size(); }
+
+    std::deque<Delta> m_undo;
+    std::vector<Delta> m_redo;
+    qint64 m_bytes = 0;         // payload held by both stacks
+    qint64 m_clean = 0;         // undo depth matching the file on disk, -1 if lost
+    bool m_mergeable = false;
+};
+
+#endif // HEXHISTORY_H
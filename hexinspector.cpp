@@ -0,0 +1,413 @@
+#include "hexinspector.h"
+#include "hexeditor.h"
+
+#include <QComboBox>
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QRegularExpression>
+#include <QTableWidget>
+#include <QUuid>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const char *kRowNames[HexInspector::RowCount] = {
+    "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64",
+    "float", "double", "ULEB128", "time_t (32-bit)", "time_t (64-bit)", "GUID", "UTF-8"
+};
+
+// Fixed widths; 0 for the variable-length encodings
+const int kRowWidths[HexInspector::RowCount] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8, 0, 4, 8, 16, 0};
+
+quint64 load(const uchar *p, int width, bool bigEndian)
+{
+    quint64 v = 0;
+    for (int i = 0; i < width; ++i)
+        v |= quint64(p[bigEndian ? width - 1 - i : i]) << (8 * i);
+    return v;
+}
+
+QByteArray store(quint64 v, int width, bool bigEndian)
+{
+    QByteArray bytes(width, Qt::Uninitialized);
+    for (int i = 0; i < width; ++i)
+        bytes[bigEndian ? width - 1 - i : i] = char(v >> (8 * i));
+    return bytes;
+}
+
+// Encoded length, or 0 when there is no terminated value of at most 10 bytes
+int decodeUleb(const uchar *p, int available, quint64 &value)
+{
+    value = 0;
+    for (int i = 0; i < qMin(available, 10); ++i) {
+        value |= quint64(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80))
+            return i + 1;
+    }
+    return 0;
+}
+
+// Sequence length, or 0 for an invalid, overlong or truncated sequence
+int decodeUtf8(const uchar *p, int available, char32_t &codePoint)
+{
+    if (available < 1)
+        return 0;
+    const uchar lead = p[0];
+    int length;
+    char32_t min;
+    if (lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2, min = 0x80, codePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3, min = 0x800, codePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4, min = 0x10000, codePoint = lead & 0x07;
+    } else {
+        return 0;
+    }
+    if (available < length)
+        return 0;
+    for (int i = 1; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80)
+            return 0;
+        codePoint = (codePoint << 6) | (p[i] & 0x3F);
+    }
+    if (codePoint < min || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+        return 0;
+    return length;
+}
+
+// GUIDs keep Data1..Data3 in the chosen byte order and Data4 as bytes
+void swapGuid(uchar *p)
+{
+    std::reverse(p, p + 4);
+    std::reverse(p + 4, p + 6);
+    std::reverse(p + 6, p + 8);
+}
+
+QString timeText(qint64 seconds)
+{
+    const QDateTime time = QDateTime::fromSecsSinceEpoch(seconds, Qt::UTC);
+    return time.isValid() ? time.toString("yyyy-MM-dd HH:mm:ss") + " UTC" : QString();
+}
+
+// Decimal, or hex with a 0x prefix; a leading zero is not octal here
+bool parseInteger(const QString &text, qint64 *s, quint64 *u)
+{
+    QString t = text.trimmed();
+    const bool negative = t.startsWith('-');
+    if (negative)
+        t.remove(0, 1);
+    int base = 10;
+    if (t.startsWith("0x", Qt::CaseInsensitive)) {
+        t.remove(0, 2);
+        base = 16;
+    }
+    bool ok = false;
+    const quint64 magnitude = t.toULongLong(&ok, base);
+    if (!ok)
+        return false;
+    if (u) {
+        *u = magnitude;
+        return !negative;
+    }
+    if (negative ? magnitude > quint64(1) << 63 : magnitude > quint64(INT64_MAX))
+        return false;
+    *s = negative ? qint64(0 - magnitude) : qint64(magnitude);
+    return true;
+}
+
+} // namespace
+
+HexInspector::HexInspector(QWidget *parent)
+    : QWidget(parent)
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    auto *row = new QHBoxLayout;
+    m_offset = new QLabel;
+    m_byteOrder = new QComboBox;
+    m_byteOrder->addItems({"Little endian", "Big endian"});
+    row->addWidget(m_offset, 1);
+    row->addWidget(m_byteOrder);
+    layout->addLayout(row);
+
+    m_table = new QTableWidget(RowCount, 2);
+    m_table->setHorizontalHeaderLabels({"Type", "Value"});
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->setFont(QFont("Consolas", 9));
+    for (int r = 0; r < RowCount; ++r) {
+        auto *name = new QTableWidgetItem(kRowNames[r]);
+        name->setFlags(Qt::ItemIsEnabled);
+        m_table->setItem(r, 0, name);
+        m_table->setItem(r, 1, new QTableWidgetItem);
+    }
+    m_table->resizeRowsToContents();
+    layout->addWidget(m_table, 1);
+
+    m_status = new QLabel;
+    m_status->setWordWrap(true);
+    layout->addWidget(m_status);
+
+    connect(m_byteOrder, &QComboBox::currentIndexChanged, this, [this](int index) {
+        m_bigEndian = index == 1;
+        refresh(true);
+    });
+    connect(m_table, &QTableWidget::itemChanged, this, &HexInspector::commit);
+}
+
+void HexInspector::setEditor(HexEditor *editor)
+{
+    if (m_editor == editor)
+        return;
+    if (m_editor)
+        disconnect(m_editor, nullptr, this, nullptr);
+    m_editor = editor;
+    if (m_editor) {
+        connect(m_editor, &HexEditor::currentAddressChanged, this, [this]() { refresh(); });
+        connect(m_editor, &HexEditor::dataChanged, this, [this]() { refresh(true); });
+        connect(m_editor, &QObject::destroyed, this, [this]() {
+            m_editor = nullptr;
+            refresh(true);
+        });
+    }
+    m_status->clear();
+    refresh(true);
+}
+
+void HexInspector::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (m_stale)
+        refresh(true);
+}
+
+void HexInspector::setRow(int row, const QString &text)
+{
+    QTableWidgetItem *item = m_table->item(row, 1);
+    if (item->text() != text)
+        item->setText(text);
+}
+
+void HexInspector::refresh(bool force)
+{
+    if (!isVisible()) {
+        m_stale = true;
+        return;
+    }
+    m_stale = false;
+
+    uchar bytes[Window];
+    const qint64 pos = m_editor ? m_editor->cursorPosition() : -1;
+    const int available = m_editor ? int(m_editor->read(pos, reinterpret_cast<char *>(bytes), Window)) : 0;
+    if (!force && pos == m_pos && available == m_available && memcmp(bytes, m_bytes, size_t(available)) == 0)
+        return;
+    m_pos = pos;
+    m_available = available;
+    memcpy(m_bytes, bytes, size_t(available));
+
+    m_updating = true;
+    m_offset->setText(m_editor ? QString("Offset 0x%1 (%2)").arg(QString::number(pos, 16).toUpper()).arg(pos)
+                               : QString("No hex editor"));
+    const bool big = m_bigEndian;
+    auto has = [&](int width) { return available >= width; };
+    const uchar *p = m_bytes;
+
+    setRow(Int8,   has(1) ? QString::number(qint8(p[0])) : QString());
+    setRow(UInt8,  has(1) ? QString::number(p[0]) : QString());
+    setRow(Int16,  has(2) ? QString::number(qint16(load(p, 2, big))) : QString());
+    setRow(UInt16, has(2) ? QString::number(quint16(load(p, 2, big))) : QString());
+    setRow(Int32,  has(4) ? QString::number(qint32(load(p, 4, big))) : QString());
+    setRow(UInt32, has(4) ? QString::number(quint32(load(p, 4, big))) : QString());
+    setRow(Int64,  has(8) ? QString::number(qint64(load(p, 8, big))) : QString());
+    setRow(UInt64, has(8) ? QString::number(load(p, 8, big)) : QString());
+
+    if (has(4)) {
+        const quint32 bits = quint32(load(p, 4, big));
+        float f;
+        memcpy(&f, &bits, 4);
+        setRow(Float, QString::number(f, 'g', 9));
+    } else {
+        setRow(Float, QString());
+    }
+    if (has(8)) {
+        const quint64 bits = load(p, 8, big);
+        double d;
+        memcpy(&d, &bits, 8);
+        setRow(Double, QString::number(d, 'g', 17));
+    } else {
+        setRow(Double, QString());
+    }
+
+    quint64 leb = 0;
+    m_ulebLength = decodeUleb(p, available, leb);
+    setRow(Uleb128, m_ulebLength ? QString::number(leb) : QString());
+    m_table->item(Uleb128, 1)->setToolTip(m_ulebLength ? QString("%1 byte(s)").arg(m_ulebLength) : QString());
+
+    setRow(Time32, has(4) ? timeText(qint32(load(p, 4, big))) : QString());
+    setRow(Time64, has(8) ? timeText(qint64(load(p, 8, big))) : QString());
+
+    if (has(16)) {
+        uchar guid[16];
+        memcpy(guid, p, 16);
+        if (!big)
+            swapGuid(guid);
+        setRow(Guid, QUuid::fromRfc4122(QByteArrayView(guid, 16)).toString(QUuid::WithBraces).toUpper());
+    } else {
+        setRow(Guid, QString());
+    }
+
+    char32_t codePoint = 0;
+    m_utf8Length = decodeUtf8(p, available, codePoint);
+    setRow(Utf8, m_utf8Length ? (codePoint >= 0x20 && codePoint != 0x7F ? QString::fromUcs4(&codePoint, 1) : QString("\\x%1").arg(uint(codePoint), 2, 16, QChar('0')))
+                              : QString());
+    m_table->item(Utf8, 1)->setToolTip(
+        m_utf8Length ? QString("U+%1, %2 byte(s)")
+                           .arg(QString::number(uint(codePoint), 16).toUpper().rightJustified(4, '0'))
+                           .arg(m_utf8Length)
+                     : QString());
+    m_updating = false;
+}
+
+QByteArray HexInspector::encode(int row, const QString &text, QString *error) const
+{
+    const QString t = text.trimmed();
+    const int width = kRowWidths[row];
+    qint64 s = 0;
+    quint64 u = 0;
+    bool ok = false;
+
+    switch (row) {
+    case Int8: case Int16: case Int32: case Int64: {
+        const qint64 limit = width == 8 ? INT64_MAX : (qint64(1) << (8 * width - 1)) - 1;
+        if (parseInteger(t, &s, nullptr) && s <= limit && s >= -limit - 1)
+            return store(quint64(s), width, m_bigEndian);
+        break;
+    }
+    case UInt8: case UInt16: case UInt32: case UInt64: {
+        const quint64 limit = width == 8 ? ~quint64(0) : (quint64(1) << (8 * width)) - 1;
+        if (parseInteger(t, nullptr, &u) && u <= limit)
+            return store(u, width, m_bigEndian);
+        break;
+    }
+    case Float: {
+        const float f = t.toFloat(&ok);
+        quint32 bits;
+        memcpy(&bits, &f, 4);
+        if (ok)
+            return store(bits, 4, m_bigEndian);
+        break;
+    }
+    case Double: {
+        const double d = t.toDouble(&ok);
+        quint64 bits;
+        memcpy(&bits, &d, 8);
+        if (ok)
+            return store(bits, 8, m_bigEndian);
+        break;
+    }
+    case Uleb128: {
+        if (!parseInteger(t, nullptr, &u))
+            break;
+        QByteArray bytes;
+        do {
+            bytes.append(char((u & 0x7F) | (u > 0x7F ? 0x80 : 0)));
+            u >>= 7;
+        } while (u);
+        // Padded with continuation bytes to keep the old length, and what follows
+        if (bytes.size() < m_ulebLength) {
+            bytes.back() = char(bytes.back() | 0x80);
+            while (bytes.size() < m_ulebLength - 1)
+                bytes.append(char(0x80));
+            bytes.append('\0');
+        }
+        return bytes;
+    }
+    case Time32: case Time64: {
+        if (!parseInteger(t, &s, nullptr)) {
+            QString date = t;
+            if (date.endsWith("UTC", Qt::CaseInsensitive))
+                date.chop(3);
+            QDateTime time = QDateTime::fromString(date.trimmed(), Qt::ISODate);
+            if (!time.isValid())
+                break;
+            time.setTimeSpec(Qt::UTC);
+            s = time.toSecsSinceEpoch();
+        }
+        if (row == Time32 && (s < INT32_MIN || s > INT32_MAX)) {
+            if (error)
+                *error = "Out of range for a 32-bit time_t";
+            return QByteArray();
+        }
+        return store(quint64(s), width, m_bigEndian);
+    }
+    case Guid: {
+        const QUuid uuid(t);
+        // QUuid parses garbage as the nil GUID; accept that only if it was typed
+        if (uuid.isNull() && (t.contains(QRegularExpression("[1-9A-Fa-f]")) || !t.contains('0')))
+            break;
+        QByteArray bytes = uuid.toRfc4122();
+        if (!m_bigEndian)
+            swapGuid(reinterpret_cast<uchar *>(bytes.data()));
+        return bytes;
+    }
+    case Utf8: {
+        // One character as typed, or \xNN for the control codes shown that way
+        char32_t c;
+        if (text.startsWith("\\x") && parseInteger("0x" + text.mid(2), nullptr, &u) && u <= 0x10FFFF) {
+            c = char32_t(u);
+        } else {
+            const QList<uint> codePoints = text.toUcs4();
+            if (codePoints.size() != 1)
+                break;
+            c = codePoints.first();
+        }
+        return QString::fromUcs4(&c, 1).toUtf8();
+    }
+    }
+    if (error)
+        *error = QString("'%1' is not a valid %2").arg(t, kRowNames[row]);
+    return QByteArray();
+}
+
+void HexInspector::commit(QTableWidgetItem *item)
+{
+    if (m_updating || item->column() != 1 || !m_editor)
+        return;
+    const int row = item->row();
+    QString error;
+    const QByteArray bytes = encode(row, item->text(), &error);
+
+    // Insert mode swaps a variable-length value for its new encoding;
+    // otherwise the new bytes overwrite as many as they need
+    qint64 removed = bytes.size();
+    if (m_editor->isInsertMode() && row == Uleb128)
+        removed = m_ulebLength;
+    else if (m_editor->isInsertMode() && row == Utf8)
+        removed = m_utf8Length;
+
+    if (error.isEmpty() && m_editor->isReadOnly())
+        error = "The buffer is read-only";
+    if (error.isEmpty() && m_pos + removed > m_editor->size())
+        error = QString("Needs %1 byte(s) after the cursor").arg(removed);
+    if (error.isEmpty() && !m_editor->writeBytes(m_pos, removed, bytes))
+        error = "Write failed";
+    m_status->setText(error.isEmpty() ? QString("Wrote %1 byte(s) at 0x%2")
+                                            .arg(bytes.size()).arg(QString::number(m_pos, 16).toUpper())
+                                      : error);
+    // Restores the decoded text when nothing was written
+    refresh(true);
+}
@@ -0,0 +1,67 @@
+#ifndef HEXINSPECTOR_H
+#define HEXINSPECTOR_H
+
+#include <QByteArray>
+#include <QWidget>
+
+class HexEditor;
+class QComboBox;
+class QLabel;
+class QTableWidget;
+class QTableWidgetItem;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexInspector
+//  Data inspector for the bound HexEditor: the bytes at the cursor decoded
+//  as every integer width, float, double, ULEB128, time_t, GUID and a
+//  UTF-8 code point, in the chosen byte order.  Cursor moves read 16 bytes
+//  into a fixed buffer and decode from the stack; nothing is redrawn when
+//  those bytes did not change, and only rows whose text differs are
+//  touched.  Editing a value encodes it and writes it back through the
+//  editor, as one undo step.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexInspector : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum Row {
+        Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64,
+        Float, Double, Uleb128, Time32, Time64, Guid, Utf8,
+        RowCount
+    };
+
+    static constexpr int Window = 16;
+
+    explicit HexInspector(QWidget *parent = nullptr);
+
+    void setEditor(HexEditor *editor);
+    HexEditor *editor() const { return m_editor; }
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void refresh(bool force = false);
+    void setRow(int row, const QString &text);
+    void commit(QTableWidgetItem *item);
+    // Bytes for text typed into row; sets error and returns nothing on failure
+    QByteArray encode(int row, const QString &text, QString *error) const;
+
+    HexEditor *m_editor = nullptr;
+    QComboBox *m_byteOrder;
+    QTableWidget *m_table;
+    QLabel *m_offset;
+    QLabel *m_status;
+
+    qint64 m_pos = -1;
+    uchar m_bytes[Window] = {};
+    int m_available = -1;
+    int m_ulebLength = 0;               // encoded lengths at the cursor, 0 if invalid
+    int m_utf8Length = 0;
+    bool m_bigEndian = false;
+    bool m_updating = false;
+    bool m_stale = true;
+};
+
+#endif // HEXINSPECTOR_H
@@ -0,0 +1,277 @@
+#include "hexsearch.h"
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+
+QStringList HexSearch::modeNames()
+{
+    return {"Hex bytes", "Text (UTF-8)", "UTF-16 LE", "UTF-16 BE", "Int8",
+            "Int16 LE", "Int16 BE", "Int32 LE", "Int32 BE", "Int64 LE", "Int64 BE"};
+}
+
+HexSearch::Pattern HexSearch::parse(const QString &text, Mode mode, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error)
+            *error = message;
+        return Pattern();
+    };
+    if (text.isEmpty())
+        return fail(QString());
+
+    QByteArray bytes;
+    switch (mode) {
+    case HexBytes: {
+        // "DE AD ?? EF", "deadbeef", "4? 5A": two digits per byte, ? per nibble
+        QString digits = text;
+        digits.remove(QRegularExpression("[\\s,]|0x"));
+        if (digits.size() % 2)
+            return fail("Odd number of hex digits");
+        QByteArray mask;
+        for (int i = 0; i < digits.size(); i += 2) {
+            int value = 0;
+            int bits = 0;
+            for (int n = 0; n < 2; ++n) {
+                const QChar c = digits[i + n];
+                const int shift = n == 0 ? 4 : 0;
+                if (c == '?')
+                    continue;
+                const int digit = QStringLiteral("0123456789abcdef").indexOf(c.toLower());
+                if (digit < 0)
+                    return fail(QString("'%1' is not a hex digit").arg(c));
+                value |= digit << shift;
+                bits |= 0xF << shift;
+            }
+            bytes.append(char(value));
+            mask.append(char(bits));
+        }
+        if (mask.count(char(0)) == mask.size())
+            return fail("Every digit is a wildcard");
+        return fromBytes(bytes, mask);
+    }
+    case Text:
+        bytes = text.toUtf8();
+        break;
+    case Utf16LE:
+    case Utf16BE:
+        for (const QChar c : text) {
+            const ushort u = c.unicode();
+            const char lo = char(u & 0xFF);
+            const char hi = char(u >> 8);
+            bytes.append(mode == Utf16LE ? lo : hi);
+            bytes.append(mode == Utf16LE ? hi : lo);
+        }
+        break;
+    default: {
+        static const int widths[] = {1, 2, 2, 4, 4, 8, 8};
+        const int width = widths[mode - Int8];
+        const bool bigEndian = mode == Int16BE || mode == Int32BE || mode == Int64BE;
+        bool ok = false;
+        quint64 value = quint64(text.trimmed().toLongLong(&ok, 0));
+        const bool negative = ok && qint64(value) < 0;
+        if (!ok)
+            value = text.trimmed().toULongLong(&ok, 0);
+        if (!ok)
+            return fail("Not an integer");
+        if (width < 8) {
+            const qint64 bits = 8 * width;
+            const bool fits = negative ? qint64(value) >= -(qint64(1) << (bits - 1))
+                                       : value < (quint64(1) << bits);
+            if (!fits)
+                return fail(QString("Does not fit in %1 bytes").arg(width));
+        }
+        for (int i = 0; i < width; ++i)
+            bytes.append(char(value >> (8 * (bigEndian ? width - 1 - i : i))));
+        break;
+    }
+    }
+    return fromBytes(bytes, QByteArray(bytes.size(), char(0xFF)));
+}
+
+// Rough rank of how often a byte value turns up in executables, documents
+// and text; higher is more common.  Only the order matters.
+static int byteFrequency(uchar b)
+{
+    if (b == 0x00)
+        return 9;
+    if (b == 0xFF)
+        return 8;
+    if (b == ' ' || std::strchr("etaoinsr", b))
+        return 7;
+    if (b >= 'a' && b <= 'z')
+        return 6;
+    if ((b >= '0' && b <= '9') || b == '\n' || b == '\r' || b == '\t')
+        return 5;
+    if (b < 0x10 || b == 0x48 || b == 0x89 || b == 0x8B || b == 0xE8)
+        return 4;       // small counts and lengths, common x86-64 opcodes
+    if (b >= 'A' && b <= 'Z')
+        return 3;
+    if (b < 0x80)
+        return 2;       // punctuation and the rest of the low half
+    return 1;
+}
+
+HexSearch::Pattern HexSearch::fromBytes(const QByteArray &bytes, const QByteArray &mask)
+{
+    Pattern pattern;
+    pattern.bytes = bytes;
+    pattern.mask = mask;
+    // The rarest fixed byte makes the best memchr anchor: fewer false hits
+    // to verify.  Ties go to the earliest.
+    int best = 0;
+    for (int i = 0; i < bytes.size(); ++i) {
+        if (uchar(mask[i]) != 0xFF)
+            continue;
+        const int frequency = byteFrequency(uchar(bytes[i]));
+        if (pattern.anchor < 0 || frequency < best) {
+            pattern.anchor = i;
+            best = frequency;
+        }
+    }
+    return pattern;
+}
+
+void HexSearch::scan(const PieceTable::Snapshot &data, const Pattern &pattern,
+                     const std::atomic_bool &cancel, int maxHits,
+                     const std::function<void(const QVector<qint64> &)> &found)
+{
+    const qint64 length = pattern.size();
+    if (!pattern.isValid() || data.size() < length)
+        return;
+    // With only nibbles fixed there is nothing for memchr to look for, and
+    // every offset is tested against the mask instead
+    const bool linear = pattern.anchor < 0;
+    const int anchor = qMax(0, pattern.anchor);
+    const char key = pattern.bytes[anchor];
+    const char *bytes = pattern.bytes.constData();
+    const uchar *mask = reinterpret_cast<const uchar *>(pattern.mask.constData());
+    const bool exact = std::all_of(mask, mask + length, [](uchar m) { return m == 0xFF; });
+
+    QByteArray scratch;
+    QVector<qint64> batch;
+    int total = 0;
+    for (qint64 base = 0; base + length <= data.size() && !cancel; base += Window) {
+        // Windows overlap by length - 1 so matches across the seam are seen
+        const qint64 span = qMin(Window + length - 1, data.size() - base);
+        const char *window = data.data(base, span, scratch);
+        const char *p = window + anchor;
+        const char *end = window + qMin(Window, span - length + 1) + anchor;
+        while (p < end) {
+            if (!linear) {
+                p = static_cast<const char *>(memchr(p, key, size_t(end - p)));
+                if (!p)
+                    break;
+            }
+            const char *start = p - anchor;
+            bool match = true;
+            if (exact) {
+                match = memcmp(start, bytes, size_t(length)) == 0;
+            } else {
+                for (qint64 i = 0; i < length && match; ++i)
+                    match = (uchar(start[i]) & mask[i]) == uchar(bytes[i]);
+            }
+            if (match) {
+                batch.append(base + (start - window));
+                if (++total >= maxHits) {
+                    found(batch);
+                    return;
+                }
+            }
+            ++p;
+        }
+        if (!batch.isEmpty()) {
+            found(batch);
+            batch.clear();
+        }
+    }
+}
+
+HexSearch::HexSearch(QObject *parent)
+    : QObject(parent)
+{
+}
+
+HexSearch::~HexSearch()
+{
+    cancel();
+}
+
+void HexSearch::start(const PieceTable::Snapshot &data, const Pattern &pattern)
+{
+    cancel();
+    m_hits.clear();
+    m_patternSize = pattern.size();
+    if (!pattern.isValid())
+        return;
+
+    m_cancel = false;
+    const quint64 generation = ++m_generation;
+    m_worker = QThread::create([this, data, pattern, generation]() {
+        QVector<qint64> pending;
+        QElapsedTimer sinceFlush;
+        sinceFlush.start();
+        auto flush = [&]() {
+            QMetaObject::invokeMethod(this, [this, generation, hits = pending]() {
+                if (generation != m_generation)
+                    return;
+                m_hits += hits;
+                emit hitsAdded(m_hits.size());
+            }, Qt::QueuedConnection);
+            pending.clear();
+            sinceFlush.restart();
+        };
+        scan(data, pattern, m_cancel, MaxHits, [&](const QVector<qint64> &hits) {
+            pending += hits;
+            if (sinceFlush.elapsed() >= 100)
+                flush();
+        });
+        if (!pending.isEmpty())
+            flush();
+        QMetaObject::invokeMethod(this, [this, generation]() {
+            if (generation != m_generation)
+                return;
+            m_worker = nullptr;
+            emit finished(m_hits.size(), m_hits.size() >= MaxHits);
+        }, Qt::QueuedConnection);
+    });
+    connect(m_worker, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_worker->start(QThread::LowPriority);
+}
+
+void HexSearch::cancel()
+{
+    ++m_generation;
+    if (m_worker) {
+        // The scan checks the flag once per window, so this returns quickly
+        m_cancel = true;
+        m_worker->wait();
+        m_worker = nullptr;
+    }
+}
+
+void HexSearch::clear()
+{
+    cancel();
+    m_hits.clear();
+    m_patternSize = 0;
+}
+
+int HexSearch::next(qint64 pos) const
+{
+    if (m_hits.isEmpty())
+        return -1;
+    const auto it = std::upper_bound(m_hits.cbegin(), m_hits.cend(), pos);
+    return it == m_hits.cend() ? 0 : int(it - m_hits.cbegin());
+}
+
+int HexSearch::previous(qint64 pos) const
+{
+    if (m_hits.isEmpty())
+        return -1;
+    const auto it = std::lower_bound(m_hits.cbegin(), m_hits.cend(), pos);
+    return it == m_hits.cbegin() ? m_hits.size() - 1 : int(it - m_hits.cbegin()) - 1;
+}
@@ -0,0 +1,86 @@
+#ifndef HEXSEARCH_H
+#define HEXSEARCH_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+#include "piecetable.h"
+
+class QThread;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexSearch
+//  Byte-pattern search for the hex editor.  Patterns are bytes plus a mask
+//  (hex with ?? or nibble wildcards, UTF-8 or UTF-16 text, integers of
+//  either endianness).  A worker thread scans a PieceTable snapshot window
+//  by window, straight from the mapping where a window lies in one piece:
+//  memchr finds the rarest fixed byte of the pattern, which libc does with
+//  vector instructions, and only those candidates are verified.  Hits
+//  stream back to the GUI thread in batches while the scan runs.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        HexBytes, Text, Utf16LE, Utf16BE,
+        Int8, Int16LE, Int16BE, Int32LE, Int32BE, Int64LE, Int64BE
+    };
+
+    struct Pattern {
+        QByteArray bytes;   // already masked
+        QByteArray mask;    // 0xFF fixed, 0x00 wildcard, 0xF0/0x0F nibbles
+        int anchor = -1;    // fixed byte handed to memchr; -1 when only nibbles are
+
+        bool isValid() const { return !bytes.isEmpty(); }
+        int size() const { return bytes.size(); }
+    };
+
+    static constexpr int    MaxHits = 1000000;
+    static constexpr qint64 Window  = 4 * 1024 * 1024;
+
+    static QStringList modeNames();
+    static Pattern parse(const QString &text, Mode mode, QString *error = nullptr);
+
+    // Calls found for every batch of ascending hit offsets; stops early
+    // when cancel is set or maxHits is reached
+    static void scan(const PieceTable::Snapshot &data, const Pattern &pattern,
+                     const std::atomic_bool &cancel, int maxHits,
+                     const std::function<void(const QVector<qint64> &)> &found);
+
+    explicit HexSearch(QObject *parent = nullptr);
+    ~HexSearch() override;
+
+    void start(const PieceTable::Snapshot &data, const Pattern &pattern);
+    void cancel();
+    void clear();
+    bool isRunning() const { return m_worker != nullptr; }
+
+    const QVector<qint64> &hits() const { return m_hits; }
+    int patternSize() const { return m_patternSize; }
+
+    // Index of the first hit after / before pos, wrapping around; -1 if none
+    int next(qint64 pos) const;
+    int previous(qint64 pos) const;
+
+signals:
+    void hitsAdded(int total);
+    void finished(int total, bool truncated);
+
+private:
+    static Pattern fromBytes(const QByteArray &bytes, const QByteArray &mask);
+
+    QThread *m_worker = nullptr;
+    std::atomic_bool m_cancel{false};
+    quint64 m_generation = 0;
+    QVector<qint64> m_hits;
+    int m_patternSize = 0;
+};
+
+#endif // HEXSEARCH_H
@@ -0,0 +1,1318 @@
+#include "hextemplate.h"
+#include "hexeditor.h"
+
+#include <QColor>
+#include <QComboBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeView>
+#include <QVBoxLayout>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Built-in templates — the layouts BinaryInspectorWidget decodes by hand
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+const char *kElfEnums = R"(
+enum ElfClass { 1 = "ELF32"  2 = "ELF64" }
+enum ElfData { 1 = "Little endian"  2 = "Big endian" }
+enum OsAbi {
+    0 = "System V / None"  1 = "HP-UX"  2 = "NetBSD"  3 = "Linux"  6 = "Solaris"
+    7 = "AIX"  8 = "IRIX"  9 = "FreeBSD"  12 = "OpenBSD"  64 = "ARM EABI"  97 = "ARM"
+    255 = "Standalone"
+}
+enum ElfType {
+    0 = "ET_NONE (None)"  1 = "ET_REL (Relocatable)"  2 = "ET_EXEC (Executable)"
+    3 = "ET_DYN (Shared object)"  4 = "ET_CORE (Core)"
+}
+enum Machine {
+    0x00 = "None"  0x02 = "SPARC"  0x03 = "x86"  0x08 = "MIPS"  0x14 = "PowerPC"
+    0x16 = "PowerPC 64"  0x28 = "ARM (32-bit)"  0x2A = "SuperH"  0x32 = "IA-64"
+    0x3E = "x86-64 (AMD64)"  0xB7 = "AArch64 (ARM64)"  0xF3 = "RISC-V"  0xF7 = "BPF"
+}
+enum SegmentType {
+    0 = "PT_NULL"  1 = "PT_LOAD"  2 = "PT_DYNAMIC"  3 = "PT_INTERP"  4 = "PT_NOTE"
+    5 = "PT_SHLIB"  6 = "PT_PHDR"  7 = "PT_TLS"  0x6474e550 = "PT_GNU_EH_FRAME"
+    0x6474e551 = "PT_GNU_STACK"  0x6474e552 = "PT_GNU_RELRO"
+}
+enum SectionType {
+    0 = "SHT_NULL"  1 = "SHT_PROGBITS"  2 = "SHT_SYMTAB"  3 = "SHT_STRTAB"  4 = "SHT_RELA"
+    5 = "SHT_HASH"  6 = "SHT_DYNAMIC"  7 = "SHT_NOTE"  8 = "SHT_NOBITS"  9 = "SHT_REL"
+    11 = "SHT_DYNSYM"  14 = "SHT_INIT_ARRAY"  15 = "SHT_FINI_ARRAY"
+    0x6ffffff6 = "SHT_GNU_HASH"  0x6ffffffe = "SHT_GNU_verneed"  0x6fffffff = "SHT_GNU_versym"
+}
+struct Ident {
+    char[4]  magic
+    u8       class : ElfClass
+    u8       data : ElfData
+    u8       version
+    u8       osabi : OsAbi
+    u8       abiversion
+    u8[7]    pad
+}
+)";
+
+const char *kElf64 = R"(
+struct Elf64_Phdr {
+    u32 p_type : SegmentType
+    u32 p_flags
+    u64 p_offset
+    u64 p_vaddr
+    u64 p_paddr
+    u64 p_filesz
+    u64 p_memsz
+    u64 p_align
+}
+struct Elf64_Shdr {
+    u32 sh_name
+    u32 sh_type : SectionType
+    u64 sh_flags
+    u64 sh_addr
+    u64 sh_offset
+    u64 sh_size
+    u32 sh_link
+    u32 sh_info
+    u64 sh_addralign
+    u64 sh_entsize
+}
+struct Elf64_Ehdr {
+    Ident    e_ident
+    u16      e_type : ElfType
+    u16      e_machine : Machine
+    u32      e_version
+    u64      e_entry
+    u64      e_phoff
+    u64      e_shoff
+    u32      e_flags
+    u16      e_ehsize
+    u16      e_phentsize
+    u16      e_phnum
+    u16      e_shentsize
+    u16      e_shnum
+    u16      e_shstrndx
+    Elf64_Phdr[e_phnum] program_headers @ e_phoff
+    Elf64_Shdr[e_shnum] section_headers @ e_shoff
+}
+root Elf64_Ehdr
+)";
+
+const char *kElf32 = R"(
+struct Elf32_Phdr {
+    u32 p_type : SegmentType
+    u32 p_offset
+    u32 p_vaddr
+    u32 p_paddr
+    u32 p_filesz
+    u32 p_memsz
+    u32 p_flags
+    u32 p_align
+}
+struct Elf32_Shdr {
+    u32 sh_name
+    u32 sh_type : SectionType
+    u32 sh_flags
+    u32 sh_addr
+    u32 sh_offset
+    u32 sh_size
+    u32 sh_link
+    u32 sh_info
+    u32 sh_addralign
+    u32 sh_entsize
+}
+struct Elf32_Ehdr {
+    Ident    e_ident
+    u16      e_type : ElfType
+    u16      e_machine : Machine
+    u32      e_version
+    u32      e_entry
+    u32      e_phoff
+    u32      e_shoff
+    u32      e_flags
+    u16      e_ehsize
+    u16      e_phentsize
+    u16      e_phnum
+    u16      e_shentsize
+    u16      e_shnum
+    u16      e_shstrndx
+    Elf32_Phdr[e_phnum] program_headers @ e_phoff
+    Elf32_Shdr[e_shnum] section_headers @ e_shoff
+}
+root Elf32_Ehdr
+)";
+
+// %1 is the width-dependent part of the optional header
+const char *kPe = R"(
+endian little
+enum PeMachine {
+    0x0000 = "Any"  0x014C = "x86 (i386)"  0x0200 = "IA-64 (Itanium)"
+    0x8664 = "x86-64 (AMD64)"  0x01C0 = "ARM (little endian)"  0x01C4 = "ARM Thumb-2"
+    0xAA64 = "ARM64 (AArch64)"  0x5032 = "RISC-V 32-bit"  0x5064 = "RISC-V 64-bit"
+}
+enum PeMagic { 0x10B = "PE32 (32-bit)"  0x20B = "PE32+ (64-bit)" }
+enum Subsystem {
+    1 = "Native"  2 = "Windows GUI"  3 = "Windows CUI (console)"  5 = "OS/2 CUI"
+    7 = "POSIX CUI"  9 = "Windows CE GUI"  10 = "EFI Application"
+    11 = "EFI Boot Service Driver"  12 = "EFI Runtime Driver"  14 = "Xbox"
+    16 = "Windows Boot Application"
+}
+struct FileHeader {
+    u16 Machine : PeMachine
+    u16 NumberOfSections
+    u32 TimeDateStamp
+    u32 PointerToSymbolTable
+    u32 NumberOfSymbols
+    u16 SizeOfOptionalHeader
+    u16 Characteristics
+}
+struct DataDirectory {
+    u32 VirtualAddress
+    u32 Size
+}
+struct OptionalHeader {
+    u16 Magic : PeMagic
+    u8  MajorLinkerVersion
+    u8  MinorLinkerVersion
+    u32 SizeOfCode
+    u32 SizeOfInitializedData
+    u32 SizeOfUninitializedData
+    u32 AddressOfEntryPoint
+    u32 BaseOfCode
+    %1
+    u32 SectionAlignment
+    u32 FileAlignment
+    u16 MajorOperatingSystemVersion
+    u16 MinorOperatingSystemVersion
+    u16 MajorImageVersion
+    u16 MinorImageVersion
+    u16 MajorSubsystemVersion
+    u16 MinorSubsystemVersion
+    u32 Win32VersionValue
+    u32 SizeOfImage
+    u32 SizeOfHeaders
+    u32 CheckSum
+    u16 Subsystem : Subsystem
+    u16 DllCharacteristics
+    %2 SizeOfStackReserve
+    %2 SizeOfStackCommit
+    %2 SizeOfHeapReserve
+    %2 SizeOfHeapCommit
+    u32 LoaderFlags
+    u32 NumberOfRvaAndSizes
+    DataDirectory[NumberOfRvaAndSizes] DataDirectories
+}
+struct SectionHeader {
+    char[8] Name
+    u32 VirtualSize
+    u32 VirtualAddress
+    u32 SizeOfRawData
+    u32 PointerToRawData
+    u32 PointerToRelocations
+    u32 PointerToLinenumbers
+    u16 NumberOfRelocations
+    u16 NumberOfLinenumbers
+    u32 Characteristics
+}
+struct NtHeaders {
+    char[4]        Signature
+    FileHeader     FileHeader
+    OptionalHeader OptionalHeader
+    SectionHeader[FileHeader.NumberOfSections] Sections @ e_lfanew + 24 + FileHeader.SizeOfOptionalHeader
+}
+struct DosHeader {
+    char[2]  e_magic
+    u16      e_cblp
+    u16      e_cp
+    u16      e_crlc
+    u16      e_cparhdr
+    u16      e_minalloc
+    u16      e_maxalloc
+    u16      e_ss
+    u16      e_sp
+    u16      e_csum
+    u16      e_ip
+    u16      e_cs
+    u16      e_lfarlc
+    u16      e_ovno
+    u16[4]   e_res
+    u16      e_oemid
+    u16      e_oeminfo
+    u16[10]  e_res2
+    u32      e_lfanew
+    NtHeaders nt @ e_lfanew
+}
+root DosHeader
+)";
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Tokenizer and parser
+// ─────────────────────────────────────────────────────────────────────────────
+struct Token {
+    enum Type { End, Ident, Number, String, Punct };
+    Type type = End;
+    QString text;
+    qint64 number = 0;
+    int line = 0;
+};
+
+bool tokenize(const QString &source, QVector<Token> &tokens, QString *error)
+{
+    int line = 1;
+    for (int i = 0; i < source.size();) {
+        const QChar c = source[i];
+        if (c == '\n') {
+            ++line;
+            ++i;
+        } else if (c.isSpace() || c == ',') {
+            ++i;
+        } else if (c == '#' || (c == '/' && i + 1 < source.size() && source[i + 1] == '/')) {
+            while (i < source.size() && source[i] != '\n')
+                ++i;
+        } else if (c.isLetter() || c == '_') {
+            const int start = i;
+            while (i < source.size() && (source[i].isLetterOrNumber() || source[i] == '_'))
+                ++i;
+            tokens.append({Token::Ident, source.mid(start, i - start), 0, line});
+        } else if (c.isDigit()) {
+            const int start = i;
+            while (i < source.size() && source[i].isLetterOrNumber())
+                ++i;
+            bool ok = false;
+            const QString text = source.mid(start, i - start);
+            const qint64 value = text.toLongLong(&ok, 0);
+            if (!ok) {
+                if (error)
+                    *error = QString("line %1: bad number '%2'").arg(line).arg(text);
+                return false;
+            }
+            tokens.append({Token::Number, text, value, line});
+        } else if (c == '"') {
+            const int start = ++i;
+            while (i < source.size() && source[i] != '"' && source[i] != '\n')
+                ++i;
+            tokens.append({Token::String, source.mid(start, i - start), 0, line});
+            ++i;
+        } else if (QStringLiteral("{}[]@:=+-*;.").contains(c)) {
+            tokens.append({Token::Punct, QString(c), 0, line});
+            ++i;
+        } else {
+            if (error)
+                *error = QString("line %1: unexpected '%2'").arg(line).arg(c);
+            return false;
+        }
+    }
+    tokens.append({Token::End, QString(), 0, line});
+    return true;
+}
+
+class Parser
+{
+public:
+    explicit Parser(const QVector<Token> &tokens) : m_tokens(tokens) {}
+
+    const Token &peek() const { return m_tokens[m_pos]; }
+    const Token &take() { return m_tokens[m_pos < m_tokens.size() - 1 ? m_pos++ : m_pos]; }
+    bool at(const QString &text) const { return peek().type != Token::String && peek().text == text; }
+    bool accept(const QString &text)
+    {
+        if (!at(text))
+            return false;
+        take();
+        return true;
+    }
+
+    bool fail(const QString &message)
+    {
+        if (m_error.isEmpty())
+            m_error = QString("line %1: %2").arg(peek().line).arg(message);
+        return false;
+    }
+    bool expect(const QString &text)
+    {
+        return accept(text) || fail(QString("expected '%1'").arg(text));
+    }
+    bool identifier(QString &out)
+    {
+        if (peek().type != Token::Ident)
+            return fail("expected a name");
+        out = take().text;
+        return true;
+    }
+
+    bool factor(HexTemplate::Expr::Factor &out)
+    {
+        if (peek().type == Token::Number) {
+            out.value = take().number;
+            return true;
+        }
+        QString name;
+        if (!identifier(name))
+            return false;
+        out.path << name;
+        while (accept(".")) {
+            if (!identifier(name))
+                return false;
+            out.path << name;
+        }
+        return true;
+    }
+
+    bool expression(HexTemplate::Expr &out)
+    {
+        bool negative = accept("-");
+        for (;;) {
+            HexTemplate::Expr::Term term;
+            term.negative = negative;
+            do {
+                HexTemplate::Expr::Factor f;
+                if (!factor(f))
+                    return false;
+                term.factors.append(f);
+            } while (accept("*"));
+            out.terms.append(term);
+            if (at("+") || at("-"))
+                negative = take().text == "-";
+            else
+                return true;
+        }
+    }
+
+    QString error() const { return m_error; }
+
+private:
+    const QVector<Token> &m_tokens;
+    int m_pos = 0;
+    QString m_error;
+};
+
+bool primitive(QString name, HexTemplate::Kind &kind, int &endian)
+{
+    static const QHash<QString, HexTemplate::Kind> kinds = {
+        {"u8", HexTemplate::U8},   {"u16", HexTemplate::U16}, {"u32", HexTemplate::U32},
+        {"u64", HexTemplate::U64}, {"i8", HexTemplate::I8},   {"i16", HexTemplate::I16},
+        {"i32", HexTemplate::I32}, {"i64", HexTemplate::I64}, {"f32", HexTemplate::F32},
+        {"f64", HexTemplate::F64}, {"char", HexTemplate::Char}};
+    endian = -1;
+    if (name.size() > 3 && (name.endsWith("be") || name.endsWith("le"))) {
+        endian = name.endsWith("be") ? 1 : 0;
+        name.chop(2);
+    }
+    const auto it = kinds.find(name);
+    if (it == kinds.end())
+        return false;
+    kind = *it;
+    return true;
+}
+
+bool isConstant(const HexTemplate::Expr &expr, qint64 &value)
+{
+    value = 0;
+    for (const auto &term : expr.terms) {
+        qint64 product = 1;
+        for (const auto &factor : term.factors) {
+            if (!factor.path.isEmpty())
+                return false;
+            product *= factor.value;
+        }
+        value += term.negative ? -product : product;
+    }
+    return true;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexTemplate
+// ─────────────────────────────────────────────────────────────────────────────
+QStringList HexTemplate::builtinNames()
+{
+    return {"ELF64 (little-endian)", "ELF64 (big-endian)", "ELF32 (little-endian)",
+            "ELF32 (big-endian)", "PE32+ (64-bit)", "PE32 (32-bit)"};
+}
+
+QString HexTemplate::builtinSource(const QString &name)
+{
+    if (name.startsWith("ELF")) {
+        const QString endian = name.contains("big") ? "endian big\n" : "endian little\n";
+        return endian + kElfEnums + (name.startsWith("ELF64") ? kElf64 : kElf32);
+    }
+    if (name == "PE32+ (64-bit)")
+        return QString(kPe).arg("u64 ImageBase", "u64");
+    if (name == "PE32 (32-bit)")
+        return QString(kPe).arg("u32 BaseOfData\n    u32 ImageBase", "u32");
+    return QString();
+}
+
+QString HexTemplate::detect(const PieceTable::Snapshot &data)
+{
+    char head[64] = {};
+    const qint64 n = data.read(0, head, sizeof(head));
+    if (n >= 6 && memcmp(head, "\x7f" "ELF", 4) == 0) {
+        const QString width = head[4] == 2 ? "ELF64" : "ELF32";
+        return width + (head[5] == 2 ? " (big-endian)" : " (little-endian)");
+    }
+    if (n >= 0x40 && head[0] == 'M' && head[1] == 'Z') {
+        const qint64 lfanew = qFromLittleEndian<quint32>(head + 0x3C);
+        char nt[26] = {};
+        if (data.read(lfanew, nt, sizeof(nt)) == sizeof(nt) && memcmp(nt, "PE\0\0", 4) == 0)
+            return qFromLittleEndian<quint16>(nt + 24) == 0x20B ? "PE32+ (64-bit)" : "PE32 (32-bit)";
+    }
+    return QString();
+}
+
+HexTemplate HexTemplate::parse(const QString &source, QString *error)
+{
+    HexTemplate result;
+    QVector<Token> tokens;
+    if (!tokenize(source, tokens, error))
+        return result;
+
+    Parser p(tokens);
+    bool bigEndian = false;
+    QString rootName;
+    Expr rootOffset;
+    QHash<QString, int> structIndex;
+    auto failed = [&]() {
+        if (error)
+            *error = p.error();
+        return HexTemplate();
+    };
+
+    while (p.peek().type != Token::End) {
+        if (p.accept("endian")) {
+            if (p.at("little") || p.at("big"))
+                bigEndian = p.take().text == "big";
+            else
+                return p.fail("expected 'little' or 'big'"), failed();
+        } else if (p.accept("enum")) {
+            QString name;
+            if (!p.identifier(name) || !p.expect("{"))
+                return failed();
+            QHash<qint64, QString> &labels = result.m_enums[name];
+            while (!p.accept("}")) {
+                const bool negative = p.accept("-");
+                if (p.peek().type != Token::Number)
+                    return p.fail("expected a value"), failed();
+                const qint64 value = p.take().number;
+                if (!p.expect("="))
+                    return failed();
+                if (p.peek().type != Token::String)
+                    return p.fail("expected a quoted label"), failed();
+                labels.insert(negative ? -value : value, p.take().text);
+            }
+        } else if (p.accept("struct")) {
+            StructDef def;
+            bool structBig = bigEndian;
+            if (!p.identifier(def.name))
+                return failed();
+            if (p.at("little") || p.at("big"))
+                structBig = p.take().text == "big";
+            if (structIndex.contains(def.name))
+                return p.fail(QString("struct '%1' defined twice").arg(def.name)), failed();
+            if (!p.expect("{"))
+                return failed();
+            while (!p.accept("}")) {
+                Field field;
+                field.line = p.peek().line;
+                QString type;
+                if (!p.identifier(type))
+                    return failed();
+                int endian = -1;
+                if (primitive(type, field.kind, endian)) {
+                    field.bigEndian = endian < 0 ? structBig : endian == 1;
+                } else {
+                    field.kind = Struct;
+                    field.typeName = type;
+                }
+                if (p.accept("[")) {
+                    field.isArray = true;
+                    if (!p.expression(field.count) || !p.expect("]"))
+                        return failed();
+                }
+                if (!p.identifier(field.name))
+                    return failed();
+                if (p.accept("@") && !p.expression(field.offset))
+                    return failed();
+                if (p.accept(":") && !p.identifier(field.enumName))
+                    return failed();
+                p.accept(";");
+                def.fields.append(field);
+            }
+            p.accept(";");
+            structIndex.insert(def.name, result.m_structs.size());
+            result.m_structs.append(def);
+        } else if (p.accept("root")) {
+            if (!p.identifier(rootName))
+                return failed();
+            if (p.accept("@") && !p.expression(rootOffset))
+                return failed();
+        } else {
+            return p.fail(QString("unexpected '%1'").arg(p.peek().text)), failed();
+        }
+    }
+
+    // Struct types may be used before they are defined
+    for (StructDef &def : result.m_structs) {
+        for (Field &field : def.fields) {
+            if (field.kind != Struct)
+                continue;
+            field.structIndex = structIndex.value(field.typeName, -1);
+            if (field.structIndex < 0) {
+                if (error)
+                    *error = QString("line %1: unknown type '%2'").arg(field.line).arg(field.typeName);
+                return HexTemplate();
+            }
+            if (!field.enumName.isEmpty()) {
+                if (error)
+                    *error = QString("line %1: enum on a struct field").arg(field.line);
+                return HexTemplate();
+            }
+        }
+    }
+    if (result.m_structs.isEmpty()) {
+        if (error)
+            *error = "no struct defined";
+        return HexTemplate();
+    }
+    result.m_root = rootName.isEmpty() ? result.m_structs.size() - 1 : structIndex.value(rootName, -1);
+    if (result.m_root < 0) {
+        if (error)
+            *error = QString("unknown root struct '%1'").arg(rootName);
+        return HexTemplate();
+    }
+    result.m_rootOffset = rootOffset;
+    result.computeSizes();
+    return result;
+}
+
+void HexTemplate::computeSizes()
+{
+    // 0 unvisited, 1 in progress (a recursive layout is never fixed), 2 done
+    QVector<int> state(m_structs.size(), 0);
+    std::function<qint64(int)> size = [&](int s) -> qint64 {
+        if (state[s] == 1)
+            return -1;
+        if (state[s] == 2)
+            return m_structs[s].fixedSize;
+        state[s] = 1;
+        qint64 total = 0;
+        for (const Field &field : m_structs[s].fields) {
+            if (field.offset.isSet())
+                continue;
+            const qint64 element = field.kind == Struct ? size(field.structIndex) : kindSize(field.kind);
+            qint64 count = 1;
+            if (element < 0 || (field.isArray && !isConstant(field.count, count))) {
+                total = -1;
+                break;
+            }
+            total += element * qMax(qint64(0), count);
+        }
+        state[s] = 2;
+        m_structs[s].fixedSize = total;
+        return total;
+    };
+    for (int s = 0; s < m_structs.size(); ++s)
+        size(s);
+}
+
+int HexTemplate::kindSize(Kind kind)
+{
+    switch (kind) {
+    case U8: case I8: case Char: return 1;
+    case U16: case I16: return 2;
+    case U32: case I32: case F32: return 4;
+    case U64: case I64: case F64: return 8;
+    case Struct: break;
+    }
+    return 0;
+}
+
+QString HexTemplate::kindName(Kind kind)
+{
+    static const char *names[] = {"u8", "u16", "u32", "u64", "i8", "i16", "i32", "i64",
+                                  "f32", "f64", "char", "struct"};
+    return names[kind];
+}
+
+QString HexTemplate::enumLabel(const QString &enumName, qint64 value) const
+{
+    const auto it = m_enums.find(enumName);
+    return it == m_enums.end() ? QString() : it->value(value);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexTemplateModel
+// ─────────────────────────────────────────────────────────────────────────────
+struct HexTemplateModel::Node {
+    Node *parent = nullptr;
+    int row = 0;
+    const HexTemplate::Field *field = nullptr;  // null for the root instance
+    HexTemplate::Kind kind = HexTemplate::Struct;
+    int structIndex = -1;
+    qint64 offset = 0;
+    qint64 size = 0;
+    qint64 count = -1;                  // array length; -1 for single values
+    qint64 fetched = 0;                 // array rows exposed so far
+    bool element = false;
+    bool shared = false;                // stands in for every row of a value array
+    bool populated = false;
+    bool variable = false;              // array elements differ in size
+    bool sized = true;                  // false while size is only a lower bound
+    Node *tail = nullptr;               // unsized last field of an unsized struct
+    QString error;
+    std::vector<std::unique_ptr<Node>> children;        // struct fields
+    QHash<int, Node *> elements;                        // struct array rows created so far
+    std::unique_ptr<Node> value;                        // the shared row of a value array
+    std::vector<qint64> elementOffsets;                 // variable-size elements
+
+    bool isArray() const { return count >= 0; }
+    bool isString() const { return isArray() && kind == HexTemplate::Char; }
+    ~Node() { qDeleteAll(elements); }
+};
+
+HexTemplateModel::HexTemplateModel(const HexTemplate &tmpl, const PieceTable::Snapshot &data,
+                                   QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_template(tmpl)
+    , m_data(data)
+    , m_root(new Node)
+{
+    // The invisible root holds one row: the root struct instance
+    m_root->populated = true;
+    qint64 offset = 0;
+    QString error;
+    if (m_template.rootOffset().isSet())
+        evaluate(m_template.rootOffset(), m_root.get(), offset, &error);
+    Node *top = makeNode(m_root.get(), 0, nullptr, HexTemplate::Struct, m_template.rootStruct(),
+                         offset, false);
+    top->error = error;
+    m_root->children.emplace_back(top);
+}
+
+HexTemplateModel::~HexTemplateModel() = default;
+
+HexTemplateModel::Node *HexTemplateModel::nodeAt(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return m_root.get();
+    Node *node = static_cast<Node *>(index.internalPointer());
+    if (node->shared) {
+        // Value array rows share one node, placed from the row on each use
+        node->row = index.row();
+        node->offset = node->parent->offset + index.row() * node->size;
+    }
+    return node;
+}
+
+HexTemplateModel::Node *HexTemplateModel::makeNode(Node *parent, int row, const HexTemplate::Field *field,
+                                                   HexTemplate::Kind kind, int structIndex,
+                                                   qint64 offset, bool element) const
+{
+    Node *node = new Node;
+    node->parent = parent;
+    node->row = row;
+    node->field = field;
+    node->kind = kind;
+    node->structIndex = structIndex;
+    node->offset = offset;
+    node->element = element;
+    if (kind == HexTemplate::Struct)
+        node->size = structSize(structIndex, offset, node);
+    else
+        node->size = HexTemplate::kindSize(kind);
+    return node;
+}
+
+qint64 HexTemplateModel::structSize(int structIndex, qint64 offset, Node *scope) const
+{
+    const qint64 fixed = m_template.structs()[structIndex].fixedSize;
+    if (fixed >= 0)
+        return fixed;
+    // Variable layouts are sized by laying them out, which decodes the
+    // fields their counts depend on
+    scope->offset = offset;
+    populate(scope);
+    return scope->size;
+}
+
+void HexTemplateModel::populate(Node *node) const
+{
+    if (node->populated || node->kind != HexTemplate::Struct || node->isArray())
+        return;
+    node->populated = true;
+
+    int depth = 0;
+    for (Node *p = node->parent; p; p = p->parent)
+        ++depth;
+    if (depth > 64) {
+        node->error = "nested too deeply";
+        return;
+    }
+
+    const HexTemplate::StructDef &def = m_template.structs()[node->structIndex];
+    qint64 cursor = node->offset;
+    // An unsized field the cursor has yet to pass; it is only laid out in
+    // full when a later field is placed after it
+    Node *pending = nullptr;
+    for (int i = 0; i < def.fields.size(); ++i) {
+        const HexTemplate::Field &field = def.fields[i];
+        QString error;
+        qint64 at = cursor;
+        if (!field.offset.isSet() || !evaluate(field.offset, node, at, &error)) {
+            if (pending) {
+                cursor = pending->offset + sizeOf(pending);
+                pending = nullptr;
+            }
+            at = cursor;
+        }
+        qint64 count = -1;
+        if (field.isArray && !evaluate(field.count, node, count, &error))
+            count = 0;
+
+        Node *child;
+        if (field.isArray) {
+            // Arrays are sized from the element layout without creating rows
+            child = new Node;
+            child->parent = node;
+            child->row = i;
+            child->field = &field;
+            child->kind = field.kind;
+            child->structIndex = field.structIndex;
+            child->offset = at;
+            const qint64 fixed = field.kind == HexTemplate::Struct
+                                     ? m_template.structs()[field.structIndex].fixedSize
+                                     : HexTemplate::kindSize(field.kind);
+            const qint64 room = qMax(qint64(0), m_data.size() - at);
+            qint64 limit = fixed > 0 ? room / fixed : qMin(room, qint64(1000000));
+            limit = qMin(limit, qint64(INT_MAX));
+            if (count < 0 || count > limit) {
+                if (error.isEmpty())
+                    error = QString("count %1 clamped to %2").arg(count).arg(limit);
+                count = qBound(qint64(0), count, limit);
+            }
+            child->count = count;
+            // Rows are exposed a batch at a time however the elements are sized
+            child->fetched = qMin(count, qint64(FetchBatch));
+            if (fixed >= 0) {
+                child->size = count * fixed;
+            } else {
+                // Elements are laid out as rows are fetched
+                child->variable = true;
+                child->sized = count == 0;
+            }
+        } else {
+            child = makeNode(node, i, &field, field.kind, field.structIndex, at, false);
+        }
+        if (child->error.isEmpty())
+            child->error = error;
+        node->children.emplace_back(child);
+        if (!field.offset.isSet()) {
+            cursor += child->size;
+            if (!child->sized)
+                pending = child;
+        }
+    }
+    node->size = cursor - node->offset;
+    if (pending) {
+        node->sized = false;
+        node->tail = pending;
+    }
+}
+
+qint64 HexTemplateModel::sizeOf(Node *node) const
+{
+    // Lays out whatever is still unsized; only needed when something's
+    // position depends on where this node ends
+    if (!node->sized) {
+        node->sized = true;
+        if (node->isArray())
+            node->size = elementSize(node, node->count);
+        else
+            node->size = node->tail->offset + sizeOf(node->tail) - node->offset;
+    }
+    return node->size;
+}
+
+qint64 HexTemplateModel::elementSize(Node *array, qint64 index) const
+{
+    // Offset of element `index` from the array start, laying out
+    // variable-size elements in order and remembering where each began
+    std::vector<qint64> &offsets = array->elementOffsets;
+    if (offsets.empty())
+        offsets.push_back(array->offset);
+    while (qint64(offsets.size()) <= index) {
+        const qint64 at = offsets.back();
+        Node *element = child(array, int(offsets.size() - 1));
+        offsets.push_back(at + qMax(qint64(1), element ? sizeOf(element) : 1));
+    }
+    // What is laid out so far is a lower bound until the array is sized
+    if (!array->sized)
+        array->size = qMax(array->size, offsets.back() - array->offset);
+    return offsets[size_t(index)] - array->offset;
+}
+
+HexTemplateModel::Node *HexTemplateModel::child(Node *node, int row) const
+{
+    if (node->isArray()) {
+        if (row < 0 || row >= node->count)
+            return nullptr;
+        if (node->kind != HexTemplate::Struct) {
+            // Plain values have no children to hang off a row of their own
+            if (!node->value) {
+                node->value.reset(makeNode(node, row, node->field, node->kind, node->structIndex,
+                                           node->offset, true));
+                node->value->shared = true;
+            }
+            Node *value = node->value.get();
+            value->row = row;
+            value->offset = node->offset + row * value->size;
+            return value;
+        }
+        if (Node *existing = node->elements.value(row))
+            return existing;
+        const qint64 fixed = node->kind == HexTemplate::Struct
+                                 ? m_template.structs()[node->structIndex].fixedSize
+                                 : HexTemplate::kindSize(node->kind);
+        qint64 offset;
+        if (fixed >= 0) {
+            offset = node->offset + row * fixed;
+        } else {
+            if (qint64(node->elementOffsets.size()) <= row)
+                elementSize(node, row);
+            offset = node->elementOffsets[size_t(row)];
+        }
+        Node *element = makeNode(node, row, node->field, node->kind, node->structIndex, offset, true);
+        node->elements.insert(row, element);
+        return element;
+    }
+    populate(node);
+    return row >= 0 && row < int(node->children.size()) ? node->children[size_t(row)].get() : nullptr;
+}
+
+HexTemplateModel::Node *HexTemplateModel::resolve(const QStringList &path, Node *scope) const
+{
+    // The first name is looked up among decoded siblings, then outwards
+    for (Node *s = scope; s; s = s->parent) {
+        if (s->isArray() || s->kind != HexTemplate::Struct)
+            continue;
+        for (const auto &c : s->children) {
+            if (!c->field || c->field->name != path.first())
+                continue;
+            Node *n = c.get();
+            for (int i = 1; n && i < path.size(); ++i) {
+                populate(n);
+                Node *next = nullptr;
+                for (const auto &grandchild : n->children) {
+                    if (grandchild->field && grandchild->field->name == path[i])
+                        next = grandchild.get();
+                }
+                n = next;
+            }
+            return n;
+        }
+    }
+    return nullptr;
+}
+
+bool HexTemplateModel::evaluate(const HexTemplate::Expr &expr, Node *scope, qint64 &result,
+                                QString *error) const
+{
+    result = 0;
+    for (const auto &term : expr.terms) {
+        qint64 product = 1;
+        for (const auto &factor : term.factors) {
+            if (factor.path.isEmpty()) {
+                product *= factor.value;
+                continue;
+            }
+            const Node *n = resolve(factor.path, scope);
+            if (!n || n->kind == HexTemplate::Struct || n->isArray()) {
+                if (error)
+                    *error = QString("'%1' is not a decoded number").arg(factor.path.join('.'));
+                return false;
+            }
+            product *= integer(n);
+        }
+        result += term.negative ? -product : product;
+    }
+    return true;
+}
+
+qint64 HexTemplateModel::integer(const Node *node) const
+{
+    const int width = HexTemplate::kindSize(node->kind);
+    uchar bytes[8] = {};
+    if (width == 0 || m_data.read(node->offset, reinterpret_cast<char *>(bytes), width) != width)
+        return 0;
+    const bool big = node->field && node->field->bigEndian;
+    quint64 v = 0;
+    for (int i = 0; i < width; ++i)
+        v |= quint64(bytes[big ? width - 1 - i : i]) << (8 * i);
+    switch (node->kind) {
+    case HexTemplate::I8:  return qint8(v);
+    case HexTemplate::I16: return qint16(v);
+    case HexTemplate::I32: return qint32(v);
+    case HexTemplate::F32: { quint32 b = quint32(v); float f; memcpy(&f, &b, 4); return qint64(f); }
+    case HexTemplate::F64: { double d; memcpy(&d, &v, 8); return qint64(d); }
+    default:               return qint64(v);
+    }
+}
+
+QString HexTemplateModel::valueText(const Node *node) const
+{
+    if (node->offset < 0 || node->offset + node->size > m_data.size())
+        return "<past end of data>";
+    if (node->isString()) {
+        QByteArray text(int(qMin(node->count, qint64(64))), Qt::Uninitialized);
+        m_data.read(node->offset, text.data(), text.size());
+        const int nul = text.indexOf('\0');
+        if (nul >= 0)
+            text.truncate(nul);
+        QString shown;
+        for (const char c : text)
+            shown += (uchar(c) >= 32 && uchar(c) < 127) ? QLatin1Char(c) : QLatin1Char('.');
+        return QString("\"%1%2\"").arg(shown, node->count > 64 && nul < 0 ? "…" : "");
+    }
+    if (node->isArray()) {
+        if (node->kind == HexTemplate::U8 && node->count <= 16) {
+            QByteArray bytes(int(node->count), Qt::Uninitialized);
+            m_data.read(node->offset, bytes.data(), bytes.size());
+            return QString::fromLatin1(bytes.toHex(' ')).toUpper();
+        }
+        return QString("[%1]").arg(node->count);
+    }
+    if (node->kind == HexTemplate::Struct)
+        return QString();
+
+    if (node->kind == HexTemplate::F32 || node->kind == HexTemplate::F64) {
+        uchar bytes[8] = {};
+        const int width = HexTemplate::kindSize(node->kind);
+        m_data.read(node->offset, reinterpret_cast<char *>(bytes), width);
+        if (node->field && node->field->bigEndian)
+            std::reverse(bytes, bytes + width);
+        if (width == 4) {
+            float f;
+            memcpy(&f, bytes, 4);
+            return QString::number(f, 'g', 9);
+        }
+        double d;
+        memcpy(&d, bytes, 8);
+        return QString::number(d, 'g', 17);
+    }
+
+    const qint64 v = integer(node);
+    if (node->kind == HexTemplate::Char)
+        return (v >= 32 && v < 127) ? QString("'%1'").arg(QLatin1Char(char(v))) : QString::number(v);
+    const int width = HexTemplate::kindSize(node->kind);
+    const quint64 mask = width == 8 ? ~quint64(0) : (quint64(1) << (8 * width)) - 1;
+    QString text = QString("0x%1").arg(quint64(v) & mask, 0, 16);
+    if (node->kind >= HexTemplate::I8 && node->kind <= HexTemplate::I64)
+        text = QString("%1 (%2)").arg(v).arg(text);
+    else if (v > 9)
+        text += QString(" (%1)").arg(quint64(v) & mask);
+    if (node->field && !node->field->enumName.isEmpty()) {
+        const QString label = m_template.enumLabel(node->field->enumName, v);
+        if (!label.isEmpty())
+            text += "  " + label;
+    }
+    return text;
+}
+
+QModelIndex HexTemplateModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column < 0 || column >= ColumnCount)
+        return QModelIndex();
+    Node *c = child(nodeAt(parent), row);
+    return c ? createIndex(row, column, c) : QModelIndex();
+}
+
+QModelIndex HexTemplateModel::parent(const QModelIndex &child) const
+{
+    Node *node = nodeAt(child);
+    if (!child.isValid() || !node->parent || node->parent == m_root.get())
+        return QModelIndex();
+    return createIndex(node->parent->row, 0, node->parent);
+}
+
+int HexTemplateModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+    Node *node = nodeAt(parent);
+    if (node->isString())
+        return 0;
+    if (node->isArray())
+        return int(node->fetched);
+    if (node->kind != HexTemplate::Struct)
+        return 0;
+    populate(node);
+    return int(node->children.size());
+}
+
+bool HexTemplateModel::canFetchMore(const QModelIndex &parent) const
+{
+    const Node *node = nodeAt(parent);
+    return node->isArray() && !node->isString() && node->fetched < node->count;
+}
+
+void HexTemplateModel::fetchMore(const QModelIndex &parent)
+{
+    Node *node = nodeAt(parent);
+    if (!node->isArray() || node->isString() || node->fetched >= node->count)
+        return;
+    const qint64 rows = qMin(node->count - node->fetched, qint64(FetchBatch));
+    beginInsertRows(parent, int(node->fetched), int(node->fetched + rows - 1));
+    node->fetched += rows;
+    endInsertRows();
+}
+
+int HexTemplateModel::columnCount(const QModelIndex &) const
+{
+    return ColumnCount;
+}
+
+bool HexTemplateModel::hasChildren(const QModelIndex &parent) const
+{
+    // Answered from the declaration so expansion arrows cost no decoding
+    Node *node = nodeAt(parent);
+    if (node == m_root.get())
+        return true;
+    if (node->isArray())
+        return !node->isString() && node->count > 0;
+    return node->kind == HexTemplate::Struct && !m_template.structs()[node->structIndex].fields.isEmpty();
+}
+
+QVariant HexTemplateModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+    const Node *node = nodeAt(index);
+    if (role == Qt::ToolTipRole)
+        return node->error.isEmpty() ? QVariant() : QVariant(node->error);
+    if (role == Qt::ForegroundRole && !node->error.isEmpty())
+        return QColor(244, 135, 113);
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (index.column()) {
+    case NameColumn:
+        if (node->element)
+            return QString("[%1]").arg(node->row);
+        return node->field ? node->field->name : m_template.structs()[node->structIndex].name;
+    case ValueColumn:
+        return valueText(node);
+    case OffsetColumn:
+        return "0x" + QString::number(node->offset, 16).toUpper();
+    case TypeColumn: {
+        QString type = node->kind == HexTemplate::Struct ? m_template.structs()[node->structIndex].name
+                                                         : HexTemplate::kindName(node->kind);
+        if (node->isArray())
+            type += QString("[%1]").arg(node->count);
+        return type;
+    }
+    }
+    return QVariant();
+}
+
+QVariant HexTemplateModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+    static const char *titles[] = {"Field", "Value", "Offset", "Type"};
+    return QString(titles[section]);
+}
+
+qint64 HexTemplateModel::offset(const QModelIndex &index) const
+{
+    return nodeAt(index)->offset;
+}
+
+qint64 HexTemplateModel::size(const QModelIndex &index) const
+{
+    return nodeAt(index)->size;
+}
+
+QString HexTemplateModel::path(const QModelIndex &index) const
+{
+    QStringList parts;
+    for (QModelIndex i = index; i.isValid(); i = i.parent())
+        parts.prepend(data(i.sibling(i.row(), NameColumn)).toString());
+    return parts.join('.').replace(".[", "[");
+}
+
+bool HexTemplateModel::isLeaf(const QModelIndex &index) const
+{
+    return !hasChildren(index);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexTemplateView
+// ─────────────────────────────────────────────────────────────────────────────
+HexTemplateView::HexTemplateView(QWidget *parent)
+    : QWidget(parent)
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    auto *row = new QHBoxLayout;
+    m_templates = new QComboBox;
+    m_templates->addItem("Auto-detect");
+    m_templates->addItems(HexTemplate::builtinNames());
+    auto *load = new QPushButton("Load...");
+    load->setToolTip("Load a template file");
+    row->addWidget(m_templates, 1);
+    row->addWidget(load);
+    layout->addLayout(row);
+
+    m_tree = new QTreeView;
+    m_tree->setUniformRowHeights(true);
+    m_tree->setAlternatingRowColors(true);
+    m_tree->setFont(QFont("Consolas", 9));
+    layout->addWidget(m_tree, 1);
+
+    m_status = new QLabel;
+    m_status->setWordWrap(true);
+    layout->addWidget(m_status);
+
+    // Edits re-decode once typing pauses
+    m_refresh = new QTimer(this);
+    m_refresh->setSingleShot(true);
+    m_refresh->setInterval(300);
+    connect(m_refresh, &QTimer::timeout, this, &HexTemplateView::apply);
+
+    connect(m_templates, &QComboBox::currentIndexChanged, this, &HexTemplateView::apply);
+    connect(load, &QPushButton::clicked, this, &HexTemplateView::loadTemplateFile);
+    connect(m_tree, &QTreeView::expanded, this, &HexTemplateView::updateOverlay);
+    connect(m_tree, &QTreeView::collapsed, this, &HexTemplateView::updateOverlay);
+    connect(m_tree, &QTreeView::clicked, this, [this](const QModelIndex &index) {
+        if (m_editor && m_model)
+            m_editor->select(m_model->offset(index), m_model->size(index));
+    });
+}
+
+void HexTemplateView::setEditor(HexEditor *editor)
+{
+    if (m_editor == editor)
+        return;
+    if (m_editor) {
+        m_editor->setOverlay({});
+        disconnect(m_editor, nullptr, this, nullptr);
+    }
+    m_editor = editor;
+    if (m_editor) {
+        connect(m_editor, &HexEditor::dataChanged, this, [this]() { m_refresh->start(); });
+        connect(m_editor, &QObject::destroyed, this, [this]() { m_editor = nullptr; apply(); });
+    }
+    apply();
+}
+
+void HexTemplateView::apply()
+{
+    m_refresh->stop();
+    HexTemplateModel *old = m_model;
+    m_model = nullptr;
+    m_tree->setModel(nullptr);
+    delete old;
+
+    if (!m_editor) {
+        m_status->setText("Open a file in the hex editor to apply a template.");
+        return;
+    }
+    const PieceTable::Snapshot data = m_editor->snapshot();
+    QString name = m_templates->currentText();
+    if (m_templates->currentIndex() == 0) {
+        name = HexTemplate::detect(data);
+        if (name.isEmpty()) {
+            m_editor->setOverlay({});
+            m_status->setText("No built-in template matches this data; pick one or load a file.");
+            return;
+        }
+    }
+    const QString source = m_loaded.contains(name) ? m_loaded.value(name) : HexTemplate::builtinSource(name);
+    QString error;
+    const HexTemplate tmpl = HexTemplate::parse(source, &error);
+    if (!tmpl.isValid()) {
+        m_editor->setOverlay({});
+        m_status->setText(QString("%1: %2").arg(name, error));
+        return;
+    }
+
+    m_model = new HexTemplateModel(tmpl, data, this);
+    m_tree->setModel(m_model);
+    m_tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_tree->expand(m_model->index(0, 0));
+    m_status->setText(name);
+    updateOverlay();
+}
+
+void HexTemplateView::loadTemplateFile()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "Load Structure Template", QString(),
+                                                      "Templates (*.jt *.txt);;All Files (*)");
+    if (path.isEmpty())
+        return;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_status->setText(QString("Cannot read %1: %2").arg(path, file.errorString()));
+        return;
+    }
+    const QString name = QFileInfo(path).fileName();
+    const bool known = m_loaded.contains(name);
+    m_loaded.insert(name, QString::fromUtf8(file.readAll()));
+    if (!known)
+        m_templates->addItem(name);
+    if (m_templates->currentText() == name)
+        apply();
+    else
+        m_templates->setCurrentText(name);
+}
+
+void HexTemplateView::updateOverlay()
+{
+    if (!m_editor || !m_model)
+        return;
+    // Tint the fields the tree shows: collapsed nodes as one block, open
+    // ones by their children, up to a fixed budget of rows
+    QVector<HexEditor::Overlay> overlay;
+    int budget = 4096;
+    std::function<void(const QModelIndex &)> collect = [&](const QModelIndex &parent) {
+        const int rows = m_model->rowCount(parent);
+        for (int r = 0; r < rows && budget > 0; ++r, --budget) {
+            const QModelIndex index = m_model->index(r, 0, parent);
+            if (m_tree->isExpanded(index) && m_model->hasChildren(index)) {
+                collect(index);
+                continue;
+            }
+            const qint64 size = m_model->size(index);
+            if (size <= 0)
+                continue;
+            const QString value = m_model->data(index.sibling(r, HexTemplateModel::ValueColumn)).toString();
+            overlay.append({m_model->offset(index), size,
+                            value.isEmpty() ? m_model->path(index) : m_model->path(index) + " = " + value});
+        }
+    };
+    collect(m_model->index(0, 0));
+
+    // @-placed tables can overlap their parents; keep the first of each
+    std::stable_sort(overlay.begin(), overlay.end(),
+                     [](const HexEditor::Overlay &a, const HexEditor::Overlay &b) { return a.pos < b.pos; });
+    QVector<HexEditor::Overlay> disjoint;
+    qint64 end = 0;
+    for (const HexEditor::Overlay &o : overlay) {
+        if (o.pos >= end) {
+            disjoint.append(o);
+            end = o.pos + o.length;
+        }
+    }
+    m_editor->setOverlay(disjoint);
+}
@@ -0,0 +1,200 @@
+#ifndef HEXTEMPLATE_H
+#define HEXTEMPLATE_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+#include <memory>
+#include <vector>
+
+#include "piecetable.h"
+
+class HexEditor;
+class QComboBox;
+class QLabel;
+class QTimer;
+class QTreeView;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexTemplate
+//  Declarative struct layouts for the hex editor, in a small text format:
+//
+//      endian little                   # default for what follows
+//      enum Machine { 0x3E = "x86-64"  0xB7 = "AArch64" }
+//      struct Header {
+//          char[4]  magic
+//          u16      machine : Machine
+//          u32be    length              # per-field byte order
+//          u64      tableOffset
+//          u16      count
+//          Entry[count] entries @ tableOffset
+//      }
+//      root Header @ 0
+//
+//  Types are u8..u64, i8..i64, f32, f64, char and other structs.  Array
+//  counts and `@` offsets are expressions (+ - * over numbers and fields
+//  decoded earlier, dotted for nested ones); `@` places a field at an
+//  absolute file offset without advancing the layout.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexTemplate
+{
+public:
+    enum Kind { U8, U16, U32, U64, I8, I16, I32, I64, F32, F64, Char, Struct };
+
+    // Sum of products: terms[i] is multiplied out and added with its sign
+    struct Expr {
+        struct Factor {
+            qint64 value = 0;
+            QStringList path;           // field reference when not empty
+        };
+        struct Term {
+            bool negative = false;
+            QVector<Factor> factors;
+        };
+        QVector<Term> terms;
+        bool isSet() const { return !terms.isEmpty(); }
+    };
+
+    struct Field {
+        QString name;
+        Kind kind = U8;
+        int structIndex = -1;           // for Kind::Struct
+        QString typeName;               // struct name as written
+        bool bigEndian = false;
+        bool isArray = false;
+        Expr count;
+        Expr offset;                    // absolute when set
+        QString enumName;
+        int line = 0;
+    };
+
+    struct StructDef {
+        QString name;
+        QVector<Field> fields;
+        qint64 fixedSize = -1;          // -1 when the size depends on the data
+    };
+
+    static QStringList builtinNames();
+    static QString builtinSource(const QString &name);
+    // Built-in template matching the data's magic, or an empty string
+    static QString detect(const PieceTable::Snapshot &data);
+
+    static HexTemplate parse(const QString &source, QString *error = nullptr);
+
+    static int kindSize(Kind kind);
+    static QString kindName(Kind kind);
+
+    bool isValid() const { return m_root >= 0; }
+    const QVector<StructDef> &structs() const { return m_structs; }
+    int rootStruct() const { return m_root; }
+    const Expr &rootOffset() const { return m_rootOffset; }
+    QString enumLabel(const QString &enumName, qint64 value) const;
+
+private:
+    void computeSizes();
+
+    QVector<StructDef> m_structs;
+    QHash<QString, QHash<qint64, QString>> m_enums;
+    int m_root = -1;
+    Expr m_rootOffset;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexTemplateModel
+//  Tree of a template laid over a snapshot.  Nodes are created when a view
+//  first asks for them: a struct's fields are laid out on expansion and
+//  arrays expose FetchBatch rows at a time through fetchMore(), so a
+//  template over a million-entry table costs only the rows fetched.  Rows
+//  of plain-value arrays share one node placed arithmetically from the row
+//  number.  Arrays of variable-size elements can only be walked in order,
+//  and their full size is worked out only when a later field's position
+//  depends on it.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexTemplateModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn, ValueColumn, OffsetColumn, TypeColumn, ColumnCount };
+
+    static constexpr int FetchBatch = 256;
+
+    HexTemplateModel(const HexTemplate &tmpl, const PieceTable::Snapshot &data,
+                     QObject *parent = nullptr);
+    ~HexTemplateModel() override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    // Byte range of the node at index; a variable-size array not fetched to
+    // its end reports the part laid out so far
+    qint64 offset(const QModelIndex &index) const;
+    qint64 size(const QModelIndex &index) const;
+    QString path(const QModelIndex &index) const;
+    bool isLeaf(const QModelIndex &index) const;
+
+private:
+    struct Node;
+
+    Node *nodeAt(const QModelIndex &index) const;
+    void populate(Node *node) const;
+    Node *child(Node *node, int row) const;
+    Node *makeNode(Node *parent, int row, const HexTemplate::Field *field, HexTemplate::Kind kind,
+                   int structIndex, qint64 offset, bool element) const;
+    qint64 elementSize(Node *array, qint64 index) const;
+    qint64 sizeOf(Node *node) const;
+    qint64 structSize(int structIndex, qint64 offset, Node *scope) const;
+    bool evaluate(const HexTemplate::Expr &expr, Node *scope, qint64 &result, QString *error) const;
+    Node *resolve(const QStringList &path, Node *scope) const;
+    qint64 integer(const Node *node) const;
+    QString valueText(const Node *node) const;
+
+    HexTemplate m_template;
+    PieceTable::Snapshot m_data;
+    std::unique_ptr<Node> m_root;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  HexTemplateView
+//  Side panel: picks a template (built-in or loaded from a file), shows
+//  the field tree for the bound hex editor, selects a field's bytes when
+//  it is clicked and tints the fields of expanded nodes in the hex view.
+// ─────────────────────────────────────────────────────────────────────────────
+class HexTemplateView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HexTemplateView(QWidget *parent = nullptr);
+
+    void setEditor(HexEditor *editor);
+    HexEditor *editor() const { return m_editor; }
+
+public slots:
+    void apply();
+    void loadTemplateFile();
+
+private:
+    void updateOverlay();
+
+    HexEditor *m_editor = nullptr;
+    QComboBox *m_templates;
+    QTreeView *m_tree;
+    QLabel *m_status;
+    QTimer *m_refresh;
+    HexTemplateModel *m_model = nullptr;
+    QHash<QString, QString> m_loaded;       // file templates by display name
+};
+
+#endif // HEXTEMPLATE_H
@@ -0,0 +1,30 @@
+# Editor sources shared by the application (jim.pro) and the benchmark
+# harness (bench/jim_bench.pro). main.cpp stays with the application.
+
+INCLUDEPATH += $$PWD
+
+win32 {
+    LIBS += -lole32 -luuid
+}
+
+SOURCES += $$PWD/texteditor.cpp $$PWD/linenumberarea.cpp $$PWD/hexeditor.cpp \
+           $$PWD/aiautocomplete.cpp $$PWD/aisettingsdialog.cpp \
+           $$PWD/disassembler.cpp $$PWD/binaryinspector.cpp \
+           $$PWD/markdownviewer.cpp $$PWD/audiomonitor.cpp \
+           $$PWD/linediff.cpp $$PWD/largefilepolicy.cpp $$PWD/startupprofiler.cpp \
+           $$PWD/perfmonitor.cpp $$PWD/uiupdatescheduler.cpp \
+           $$PWD/decorationlayer.cpp $$PWD/multicursor.cpp \
+           $$PWD/blockselection.cpp $$PWD/syntaxtree.cpp $$PWD/symbolindex.cpp \
+           $$PWD/lspclient.cpp $$PWD/piecetable.cpp $$PWD/hexhistory.cpp \
+           $$PWD/hexsearch.cpp $$PWD/checksum.cpp $$PWD/hexdiff.cpp \
+           $$PWD/hextemplate.cpp $$PWD/hexentropy.cpp $$PWD/hexinspector.cpp
+HEADERS += $$PWD/texteditor.h $$PWD/linenumberarea.h $$PWD/hexeditor.h \
+           $$PWD/aiautocomplete.h $$PWD/aisettingsdialog.h \
+           $$PWD/disassembler.h $$PWD/binaryinspector.h \
+           $$PWD/markdownviewer.h $$PWD/audiomonitor.h \
+           $$PWD/linediff.h $$PWD/largefilepolicy.h $$PWD/startupprofiler.h \
+           $$PWD/perfmonitor.h $$PWD/uiupdatescheduler.h $$PWD/decorationlayer.h \
+           $$PWD/multicursor.h $$PWD/blockselection.h $$PWD/syntaxtree.h \
+           $$PWD/symbolindex.h $$PWD/lspclient.h $$PWD/piecetable.h \
+           $$PWD/hexhistory.h $$PWD/hexsearch.h $$PWD/checksum.h $$PWD/hexdiff.h \
+           $$PWD/hextemplate.h $$PWD/hexentropy.h $$PWD/hexinspector.h
@@ -16,16 +16,5 @@ unix {
     }
 }
 
-win32 {
-    LIBS += -lole32 -luuid
-}
-
-SOURCES += texteditor.cpp linenumberarea.cpp hexeditor.cpp main.cpp \
-           aiautocomplete.cpp aisettingsdialog.cpp \
-           disassembler.cpp binaryinspector.cpp \
-           markdownviewer.cpp audiomonitor.cpp
-HEADERS += texteditor.h linenumberarea.h hexeditor.h \
-           aiautocomplete.h aisettingsdialog.h \
-           disassembler.h binaryinspector.h \
-           markdownviewer.h audiomonitor.h
-
+include(jim.pri)
+SOURCES += main.cpp
@@ -0,0 +1,91 @@
+#include "largefilepolicy.h"
+
+#include <climits>
+#include <cstring>
+
+int LargeFilePolicy::featuresFor(const QByteArray &data)
+{
+    const bool huge = data.size() > LeanFileSize;
+    const bool minified = longestLine(data) > LeanLineLength;
+    if (!huge && !minified)
+        return AllEditorFeatures;
+
+    // Everything that walks block text goes; long lines stay whole unless
+    // they are the reason we are here, in which case they get chunked.
+    return minified ? 0 : FeatureLongLines;
+}
+
+int LargeFilePolicy::longestLine(const QByteArray &data)
+{
+    // memchr keeps this at memory speed even for 100 MB inputs
+    const char *p   = data.constData();
+    const char *end = p + data.size();
+    qint64 longest = 0;
+    while (p < end) {
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        const char *lineEnd = nl ? nl : end;
+        longest = qMax<qint64>(longest, lineEnd - p);
+        if (longest > LeanLineLength)
+            return int(qMin<qint64>(longest, INT_MAX));
+        p = lineEnd + 1;
+    }
+    return int(longest);
+}
+
+QString LargeFilePolicy::chunkLongLines(const QString &text,
+                                        QVector<int> *continuations)
+{
+    QString out;
+    out.reserve(text.size() + text.size() / ChunkLength + 1);
+
+    int outLine = 0;
+    qsizetype start = 0;
+    while (start <= text.size()) {
+        qsizetype nl = text.indexOf('\n', start);
+        if (nl < 0)
+            nl = text.size();
+
+        qsizetype pos = start;
+        while (nl - pos > ChunkLength) {
+            // Break after punctuation near the limit so tokens stay whole
+            qsizetype cut = pos + ChunkLength;
+            for (qsizetype i = cut; i > cut - ChunkSearch; --i) {
+                const QChar c = text[i - 1];
+                if (c == ',' || c == ';' || c == ' ' || c == '}' ||
+                    c == ']' || c == '>') {
+                    cut = i;
+                    break;
+                }
+            }
+            if (text[cut - 1].isHighSurrogate())
+                --cut;
+
+            out += QStringView(text).mid(pos, cut - pos);
+            out += '\n';
+            ++outLine;
+            continuations->append(outLine);
+            pos = cut;
+        }
+
+        out += QStringView(text).mid(pos, nl - pos);
+        if (nl < text.size()) {
+            out += '\n';
+            ++outLine;
+        }
+        start = nl + 1;
+    }
+    return out;
+}
+
+QString LargeFilePolicy::featureName(EditorFeature feature)
+{
+    switch (feature) {
+    case FeatureHighlighting:  return "Syntax Highlighting";
+    case FeatureColorSwatches: return "Color Swatches";
+    case FeatureBreadcrumbs:   return "Breadcrumbs";
+    case FeatureFolding:       return "Code Folding";
+    case FeatureMiniMap:       return "Mini Map";
+    case FeatureLongLines:     return "Unsplit Long Lines";
+    default:                   return QString();
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef LARGEFILEPOLICY_H
+#define LARGEFILEPOLICY_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  LargeFilePolicy
+//  Decides which editor features a file can afford.  Huge or minified files
+//  start in lean mode with the per-block features switched off; the status
+//  bar badge lets the user opt back into each one individually.
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum EditorFeature {
+    FeatureHighlighting  = 0x01,
+    FeatureColorSwatches = 0x02,
+    FeatureBreadcrumbs   = 0x04,
+    FeatureFolding       = 0x08,
+    FeatureMiniMap       = 0x10,
+    FeatureLongLines     = 0x20,   // overlong lines kept as one block
+    AllEditorFeatures    = 0x3f
+};
+
+class LargeFilePolicy
+{
+public:
+    static constexpr qint64 LeanFileSize   = 16 * 1024 * 1024;
+    static constexpr int    LeanLineLength = 20000;
+    static constexpr int    ChunkLength    = 4096;
+    static constexpr int    ChunkSearch    = 256;   // look-back for a break
+
+    // Feature mask to open a file with these contents
+    static int featuresFor(const QByteArray &data);
+    static bool isLean(int features) { return features != AllEditorFeatures; }
+
+    static int longestLine(const QByteArray &data);
+
+    // Splits lines longer than ChunkLength into display chunks, preferring
+    // to break after a delimiter.  *continuations receives the output line
+    // numbers that continue the line before them.
+    static QString chunkLongLines(const QString &text, QVector<int> *continuations);
+
+    static QString featureName(EditorFeature feature);
+};
+
+#endif // LARGEFILEPOLICY_H
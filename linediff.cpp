@@ -0,0 +1,127 @@
+#include "linediff.h"
+
+#include <QHash>
+
+QVector<LineDiff::Hunk> LineDiff::compute(const QStringList &oldLines,
+                                          const QStringList &newLines,
+                                          int maxCost)
+{
+    QVector<Hunk> hunks;
+    const int n = oldLines.size();
+    const int m = newLines.size();
+
+    // External changes are usually local (appends, regenerated sections), so
+    // strip the common prefix and suffix before running the O(ND) search.
+    int prefix = 0;
+    while (prefix < n && prefix < m && oldLines[prefix] == newLines[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix &&
+           oldLines[n - 1 - suffix] == newLines[m - 1 - suffix])
+        ++suffix;
+
+    const int oldLen = n - prefix - suffix;
+    const int newLen = m - prefix - suffix;
+    if (oldLen == 0 && newLen == 0)
+        return hunks;
+    if (oldLen == 0 || newLen == 0) {
+        hunks.append({prefix, oldLen, prefix, newLen});
+        return hunks;
+    }
+
+    // Hash every line once so the inner loop mostly compares integers
+    QVector<size_t> oldHash(oldLen), newHash(newLen);
+    for (int i = 0; i < oldLen; ++i)
+        oldHash[i] = qHash(oldLines[prefix + i]);
+    for (int i = 0; i < newLen; ++i)
+        newHash[i] = qHash(newLines[prefix + i]);
+    auto equal = [&](int x, int y) {
+        return oldHash[x] == newHash[y] &&
+               oldLines[prefix + x] == newLines[prefix + y];
+    };
+
+    // ── Myers forward pass ────────────────────────────────────────────────────
+    // v[k + vOff] is the furthest x reached on diagonal k.  Before each step
+    // d we keep the slice k ∈ [-d, d] so the path can be recovered.
+    const int limit = qMin(oldLen + newLen, maxCost);
+    const int vOff  = limit + 1;
+    QVector<int> v(2 * limit + 3, 0);
+    QVector<QVector<int>> trace;
+    int finalD = -1;
+
+    for (int d = 0; d <= limit && finalD < 0; ++d) {
+        trace.append(v.mid(vOff - d, 2 * d + 1));
+        for (int k = -d; k <= d; k += 2) {
+            int x;
+            if (k == -d || (k != d && v[vOff + k - 1] < v[vOff + k + 1]))
+                x = v[vOff + k + 1];          // step down: insert a new line
+            else
+                x = v[vOff + k - 1] + 1;      // step right: delete an old line
+            int y = x - k;
+            while (x < oldLen && y < newLen && equal(x, y)) {
+                ++x;
+                ++y;
+            }
+            v[vOff + k] = x;
+            if (x >= oldLen && y >= newLen) {
+                finalD = d;
+                break;
+            }
+        }
+    }
+
+    if (finalD < 0) {
+        // Too different to be worth a minimal script – replace the middle
+        hunks.append({prefix, oldLen, prefix, newLen});
+        return hunks;
+    }
+
+    // ── Backtrack, marking which lines on each side changed ───────────────────
+    QVector<bool> oldChanged(oldLen, false), newChanged(newLen, false);
+    int x = oldLen;
+    int y = newLen;
+    for (int d = finalD; d > 0; --d) {
+        const QVector<int> &vs = trace[d];   // indexed by k + d
+        const int k = x - y;
+        int prevK;
+        if (k == -d || (k != d && vs[k - 1 + d] < vs[k + 1 + d]))
+            prevK = k + 1;
+        else
+            prevK = k - 1;
+        const int prevX = vs[prevK + d];
+        const int prevY = prevX - prevK;
+
+        while (x > prevX && y > prevY) {     // matching lines of the snake
+            --x;
+            --y;
+        }
+        if (x == prevX)
+            newChanged[prevY] = true;        // came down: inserted line
+        else
+            oldChanged[prevX] = true;        // came right: deleted line
+        x = prevX;
+        y = prevY;
+    }
+
+    // ── Group consecutive changes into hunks ──────────────────────────────────
+    int i = 0;
+    int j = 0;
+    while (i < oldLen || j < newLen) {
+        if (i < oldLen && j < newLen && !oldChanged[i] && !newChanged[j]) {
+            ++i;
+            ++j;
+            continue;
+        }
+        Hunk h;
+        h.oldStart = prefix + i;
+        h.newStart = prefix + j;
+        while (i < oldLen && oldChanged[i])
+            ++i;
+        while (j < newLen && newChanged[j])
+            ++j;
+        h.oldCount = prefix + i - h.oldStart;
+        h.newCount = prefix + j - h.newStart;
+        hunks.append(h);
+    }
+    return hunks;
+}
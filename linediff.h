@@ -0,0 +1,31 @@
+#ifndef LINEDIFF_H
+#define LINEDIFF_H
+
+#include <QStringList>
+#include <QVector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  LineDiff
+//  Line-level Myers diff.  Produces the list of hunks that turns one list of
+//  lines into another, so an open document can follow its file on disk with
+//  a handful of small edits instead of a full setPlainText().
+// ─────────────────────────────────────────────────────────────────────────────
+class LineDiff
+{
+public:
+    struct Hunk {
+        int oldStart;   // first old line replaced by this hunk
+        int oldCount;   // number of old lines removed
+        int newStart;   // first new line inserted in its place
+        int newCount;   // number of new lines inserted
+    };
+
+    // Hunks are returned in ascending order.  If the edit distance exceeds
+    // maxCost the differing middle section is reported as one hunk, which
+    // bounds both time and the memory used by the backtracking trace.
+    static QVector<Hunk> compute(const QStringList &oldLines,
+                                 const QStringList &newLines,
+                                 int maxCost = 2000);
+};
+
+#endif // LINEDIFF_H
@@ -0,0 +1,447 @@
+#include "lspclient.h"
+
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+
+#include <algorithm>
+
+// ── LspTransport ─────────────────────────────────────────────────────────────
+
+LspTransport::LspTransport(const QString &program, const QStringList &arguments,
+                           const QString &workingDirectory)
+    : m_program(program), m_arguments(arguments), m_workingDirectory(workingDirectory)
+{
+}
+
+void LspTransport::start()
+{
+    // Created here so the process and timer belong to the worker thread
+    m_process = new QProcess(this);
+    m_process->setWorkingDirectory(m_workingDirectory);
+    m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    connect(m_process, &QProcess::readyReadStandardOutput, this,
+            &LspTransport::readAvailable);
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError) {
+        emit failed(m_process->errorString());
+    });
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int code, QProcess::ExitStatus) {
+                emit failed(QString("Language server exited with code %1").arg(code));
+            });
+
+    m_diagnosticsTimer = new QTimer(this);
+    m_diagnosticsTimer->setSingleShot(true);
+    m_diagnosticsTimer->setInterval(DiagnosticsMs);
+    connect(m_diagnosticsTimer, &QTimer::timeout, this, &LspTransport::flushDiagnostics);
+
+    m_process->start(m_program, m_arguments);
+    emit started();
+}
+
+void LspTransport::send(const QJsonObject &message)
+{
+    if (!m_process || m_process->state() == QProcess::NotRunning)
+        return;
+    const QByteArray body = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    m_process->write("Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n");
+    m_process->write(body);
+}
+
+void LspTransport::stop()
+{
+    if (!m_process)
+        return;
+    m_process->disconnect(this);
+    if (m_process->state() != QProcess::NotRunning) {
+        // exit must wait for the answer to shutdown (id 0, which requests
+        // never use).  This runs blocking on the worker, so the answer is
+        // read here rather than through readyRead.
+        m_stopping = true;
+        send({{"jsonrpc", "2.0"}, {"id", 0}, {"method", "shutdown"}});
+        QDeadlineTimer deadline(ShutdownMs);
+        while (!m_shutDown && m_process->state() != QProcess::NotRunning &&
+               m_process->waitForReadyRead(int(deadline.remainingTime())))
+            readAvailable();
+        if (m_shutDown) {
+            send({{"jsonrpc", "2.0"}, {"method", "exit"}});
+            m_process->closeWriteChannel();
+        }
+        if (!m_shutDown || !m_process->waitForFinished(ShutdownMs))
+            m_process->kill();
+    }
+}
+
+void LspTransport::readAvailable()
+{
+    m_buffer += m_process->readAllStandardOutput();
+    for (;;) {
+        if (m_bodyLength < 0) {
+            const int headerEnd = m_buffer.indexOf("\r\n\r\n", m_consumed);
+            if (headerEnd < 0)
+                break;
+            const QList<QByteArray> headers =
+                m_buffer.mid(m_consumed, headerEnd - m_consumed).split('\n');
+            for (const QByteArray &header : headers) {
+                const int colon = header.indexOf(':');
+                if (colon > 0 && header.left(colon).trimmed().toLower() == "content-length")
+                    m_bodyLength = header.mid(colon + 1).trimmed().toInt();
+            }
+            m_consumed = headerEnd + 4;
+            if (m_bodyLength < 0) {
+                emit failed("Language server sent a message without Content-Length");
+                m_process->kill();
+                return;
+            }
+        }
+        if (m_buffer.size() - m_consumed < m_bodyLength)
+            break;
+
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(
+            QByteArray::fromRawData(m_buffer.constData() + m_consumed, m_bodyLength), &error);
+        m_consumed += m_bodyLength;
+        m_bodyLength = -1;
+        if (error.error == QJsonParseError::NoError && doc.isObject())
+            dispatch(doc.object());
+    }
+    // Drop what has been dispatched; a partial message stays
+    m_buffer.remove(0, m_consumed);
+    m_consumed = 0;
+}
+
+void LspTransport::dispatch(const QJsonObject &message)
+{
+    const QString method = message.value("method").toString();
+    if (method.isEmpty() && m_stopping) {
+        if (message.value("id").toInt(-1) == 0)
+            m_shutDown = true;
+        return;
+    }
+    if (method.isEmpty()) {
+        const QJsonObject error = message.value("error").toObject();
+        emit responseReceived(message.value("id").toInt(), message.value("result"),
+                              error.isEmpty() ? QString() : error.value("message").toString());
+        return;
+    }
+
+    if (method == QLatin1String("textDocument/publishDiagnostics")) {
+        const QJsonObject params = message.value("params").toObject();
+        const QJsonArray list = params.value("diagnostics").toArray();
+        QVector<LspDiagnostic> diagnostics;
+        diagnostics.reserve(qMin(int(list.size()), MaxDiagnostics));
+        for (const QJsonValue &value : list) {
+            if (diagnostics.size() == MaxDiagnostics)
+                break;
+            const QJsonObject d = value.toObject();
+            const QJsonObject range = d.value("range").toObject();
+            const QJsonObject start = range.value("start").toObject();
+            const QJsonObject end = range.value("end").toObject();
+            LspDiagnostic diagnostic;
+            diagnostic.startLine = start.value("line").toInt();
+            diagnostic.startCharacter = start.value("character").toInt();
+            diagnostic.endLine = end.value("line").toInt();
+            diagnostic.endCharacter = end.value("character").toInt();
+            diagnostic.severity = d.value("severity").toInt(1);
+            diagnostic.message = d.value("message").toString();
+            diagnostics.append(diagnostic);
+        }
+        m_diagnostics.insert(params.value("uri").toString(), diagnostics);
+        if (!m_diagnosticsTimer->isActive())
+            m_diagnosticsTimer->start();
+        return;
+    }
+
+    // Server-to-client requests (configuration, progress tokens) get an
+    // empty answer; servers block on some of them otherwise
+    if (message.contains("id"))
+        send({{"jsonrpc", "2.0"}, {"id", message.value("id")}, {"result", QJsonValue()}});
+}
+
+void LspTransport::flushDiagnostics()
+{
+    for (auto it = m_diagnostics.cbegin(); it != m_diagnostics.cend(); ++it)
+        emit diagnosticsReady(it.key(), it.value());
+    m_diagnostics.clear();
+}
+
+// ── LspClient ────────────────────────────────────────────────────────────────
+
+LspClient::LspClient(QObject *parent)
+    : QObject(parent)
+{
+    // Edits made in one event loop turn (multi-caret typing, replace all)
+    // leave as one didChange
+    m_changeTimer = new QTimer(this);
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(0);
+    connect(m_changeTimer, &QTimer::timeout, this, &LspClient::flushChanges);
+}
+
+LspClient::~LspClient()
+{
+    stop();
+}
+
+void LspClient::start(const QString &program, const QStringList &arguments,
+                      const QString &rootPath)
+{
+    stop();
+
+    m_thread = new QThread(this);
+    m_transport = new LspTransport(program, arguments, rootPath);
+    m_transport->moveToThread(m_thread);
+    connect(m_thread, &QThread::started, m_transport, &LspTransport::start);
+    connect(m_thread, &QThread::finished, m_transport, &QObject::deleteLater);
+    connect(this, &LspClient::outgoing, m_transport, &LspTransport::send);
+    connect(m_transport, &LspTransport::responseReceived, this, &LspClient::onResponse);
+    connect(m_transport, &LspTransport::diagnosticsReady, this, &LspClient::onDiagnostics);
+    connect(m_transport, &LspTransport::failed, this, &LspClient::serverFailed);
+    m_thread->start();
+
+    m_initialized = false;
+    m_initializeId = m_nextId++;
+    QJsonObject capabilities{
+        {"textDocument", QJsonObject{
+            {"synchronization", QJsonObject{{"dynamicRegistration", false}}},
+            {"publishDiagnostics", QJsonObject{{"relatedInformation", false}}},
+            {"definition", QJsonObject{{"linkSupport", true}}}}},
+        {"general", QJsonObject{{"positionEncodings", QJsonArray{"utf-16"}}}}};
+    emit outgoing({{"jsonrpc", "2.0"},
+                   {"id", m_initializeId},
+                   {"method", "initialize"},
+                   {"params", QJsonObject{
+                        {"processId", int(QCoreApplication::applicationPid())},
+                        {"rootUri", QUrl::fromLocalFile(rootPath).toString()},
+                        {"capabilities", capabilities}}}});
+}
+
+void LspClient::stop()
+{
+    if (!m_thread)
+        return;
+    for (auto it = m_documents.cbegin(); it != m_documents.cend(); ++it)
+        QObject::disconnect(it.key(), nullptr, this, nullptr);
+    m_documents.clear();
+    m_byPath.clear();
+    m_pending.clear();
+    m_queued.clear();
+    m_changeTimer->stop();
+
+    QMetaObject::invokeMethod(m_transport, &LspTransport::stop, Qt::BlockingQueuedConnection);
+    m_transport->disconnect(this);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_transport = nullptr;
+}
+
+QJsonObject LspClient::position(int line, int character)
+{
+    return {{"line", line}, {"character", character}};
+}
+
+QJsonObject LspClient::documentIdentifier(const QString &path)
+{
+    return {{"uri", QUrl::fromLocalFile(path).toString()}};
+}
+
+void LspClient::send(const QJsonObject &message)
+{
+    if (m_initialized)
+        emit outgoing(message);
+    else
+        m_queued.append(message);
+}
+
+void LspClient::notify(const QString &method, const QJsonObject &params)
+{
+    send({{"jsonrpc", "2.0"}, {"method", method}, {"params", params}});
+}
+
+QVector<int> LspClient::lineLengths(const QTextDocument *doc, int first, int last)
+{
+    QVector<int> lengths;
+    lengths.reserve(last - first + 1);
+    QTextBlock b = doc->findBlockByNumber(first);
+    for (int i = first; i <= last && b.isValid(); ++i, b = b.next())
+        lengths.append(b.length());
+    return lengths;
+}
+
+void LspClient::openDocument(QTextDocument *doc, const QString &path,
+                             const QString &languageId)
+{
+    if (!m_thread || m_documents.contains(doc) || path.isEmpty())
+        return;
+
+    Document d;
+    d.path = path;
+    d.uri = QUrl::fromLocalFile(path).toString();
+    d.revision = doc->revision();
+    d.lineLengths = lineLengths(doc, 0, doc->blockCount() - 1);
+    m_documents.insert(doc, d);
+    m_byPath.insert(QUrl::fromLocalFile(path).toLocalFile(), doc);
+
+    connect(doc, &QTextDocument::contentsChange, this,
+            [this, doc](int pos, int removed, int added) {
+                contentsChange(doc, pos, removed, added);
+            });
+    connect(doc, &QObject::destroyed, this, [this, doc]() { closeDocument(doc); });
+
+    notify("textDocument/didOpen",
+           {{"textDocument", QJsonObject{{"uri", d.uri},
+                                         {"languageId", languageId},
+                                         {"version", d.version},
+                                         {"text", doc->toPlainText()}}}});
+}
+
+void LspClient::closeDocument(QTextDocument *doc)
+{
+    auto it = m_documents.find(doc);
+    if (it == m_documents.end())
+        return;
+    QObject::disconnect(doc, nullptr, this, nullptr);
+    notify("textDocument/didClose", {{"textDocument", QJsonObject{{"uri", it->uri}}}});
+    m_byPath.remove(QUrl::fromLocalFile(it->path).toLocalFile());
+    m_documents.erase(it);
+    for (auto p = m_pending.begin(); p != m_pending.end();) {
+        if (p->doc == doc)
+            p = m_pending.erase(p);
+        else
+            ++p;
+    }
+}
+
+void LspClient::contentsChange(QTextDocument *doc, int pos, int removed, int added)
+{
+    Document &d = m_documents[doc];
+
+    // Rehighlighting marks blocks dirty with contentsChange(pos, n, n) and
+    // no edit; forwarding it would only cancel the pending requests
+    if (removed == added && doc->revision() == d.revision)
+        return;
+    d.revision = doc->revision();
+
+    // Text before pos is unchanged, so its line and column are the same in
+    // the old and new document; the end of the removed span is found by
+    // walking the old line lengths.
+    const QTextBlock startBlock = doc->findBlock(pos);
+    const int line = startBlock.blockNumber();
+    const int character = pos - startBlock.position();
+    int endLine = qMin(line, int(d.lineLengths.size()) - 1);
+    int endCharacter = character + removed;
+    while (endLine + 1 < d.lineLengths.size() && endCharacter >= d.lineLengths[endLine]) {
+        endCharacter -= d.lineLengths[endLine];
+        ++endLine;
+    }
+    endCharacter = qMin(endCharacter, qMax(0, d.lineLengths.value(endLine) - 1));
+
+    const int docEnd = doc->characterCount() - 1;
+    const int addedEnd = qMin(pos + added, docEnd);
+    const int lastLine = doc->findBlock(addedEnd).blockNumber();
+    const QVector<int> fresh = lineLengths(doc, line, lastLine);
+    // Resize the replaced run in one move, then overwrite it
+    const int oldLines = qMax(0, endLine - line + 1);
+    if (fresh.size() < oldLines)
+        d.lineLengths.remove(line, oldLines - fresh.size());
+    else if (fresh.size() > oldLines)
+        d.lineLengths.insert(line, fresh.size() - oldLines, 0);
+    std::copy(fresh.cbegin(), fresh.cend(), d.lineLengths.begin() + line);
+
+    QTextCursor cursor(doc);
+    cursor.setPosition(qMin(pos, docEnd));
+    cursor.setPosition(addedEnd, QTextCursor::KeepAnchor);
+    const QString text = cursor.selectedText().replace(QChar::ParagraphSeparator, '\n');
+    d.changes.append(QJsonObject{
+        {"range", QJsonObject{{"start", position(line, character)},
+                              {"end", position(endLine, endCharacter)}}},
+        {"text", text}});
+    m_changeTimer->start();
+
+    // Answers computed for the old text are worthless now
+    for (auto p = m_pending.begin(); p != m_pending.end();) {
+        if (p->doc == doc) {
+            notify("$/cancelRequest", {{"id", p.key()}});
+            p = m_pending.erase(p);
+        } else {
+            ++p;
+        }
+    }
+}
+
+void LspClient::flushChanges()
+{
+    for (auto it = m_documents.begin(); it != m_documents.end(); ++it) {
+        Document &d = it.value();
+        if (d.changes.isEmpty())
+            continue;
+        ++d.version;
+        const QJsonArray changes =
+            m_fullSync ? QJsonArray{QJsonObject{{"text", it.key()->toPlainText()}}}
+                       : d.changes;
+        d.changes = QJsonArray();
+        notify("textDocument/didChange",
+               {{"textDocument", QJsonObject{{"uri", d.uri}, {"version", d.version}}},
+                {"contentChanges", changes}});
+    }
+}
+
+int LspClient::request(QTextDocument *doc, const QString &method, const QJsonObject &params,
+                       Callback callback)
+{
+    if (!m_thread)
+        return 0;
+    flushChanges();
+    const int id = m_nextId++;
+    m_pending.insert(id, {doc, std::move(callback)});
+    send({{"jsonrpc", "2.0"}, {"id", id}, {"method", method}, {"params", params}});
+    return id;
+}
+
+void LspClient::cancel(int id)
+{
+    if (m_pending.remove(id))
+        notify("$/cancelRequest", {{"id", id}});
+}
+
+void LspClient::onResponse(int id, const QJsonValue &result, const QString &error)
+{
+    if (id == m_initializeId && !m_initialized) {
+        if (!error.isEmpty()) {
+            emit serverFailed(error);
+            return;
+        }
+        // textDocumentSync is either a kind or an options object
+        const QJsonValue sync = result.toObject().value("capabilities").toObject()
+                                    .value("textDocumentSync");
+        const int kind = sync.isObject() ? sync.toObject().value("change").toInt(2)
+                                         : sync.toInt(2);
+        m_fullSync = kind == 1;
+        m_initialized = true;
+        emit outgoing({{"jsonrpc", "2.0"}, {"method", "initialized"}, {"params", QJsonObject()}});
+        for (const QJsonObject &message : std::as_const(m_queued))
+            emit outgoing(message);
+        m_queued.clear();
+        return;
+    }
+
+    const Pending pending = m_pending.take(id);
+    if (pending.callback && error.isEmpty())
+        pending.callback(result);
+}
+
+void LspClient::onDiagnostics(const QString &uri, const QVector<LspDiagnostic> &diagnostics)
+{
+    QTextDocument *doc = m_byPath.value(QUrl(uri).toLocalFile());
+    if (doc)
+        emit diagnosticsChanged(doc, diagnostics);
+}
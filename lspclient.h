@@ -0,0 +1,153 @@
+#ifndef LSPCLIENT_H
+#define LSPCLIENT_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+#include <functional>
+
+class QProcess;
+class QTextDocument;
+class QThread;
+class QTimer;
+
+struct LspDiagnostic {
+    int startLine = 0;
+    int startCharacter = 0;
+    int endLine = 0;
+    int endCharacter = 0;
+    int severity = 1;       // 1 error, 2 warning, 3 information, 4 hint
+    QString message;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  LspTransport
+//  Worker-thread half of the client.  Owns the server QProcess, frames and
+//  parses JSON-RPC messages, answers server-to-client requests and turns
+//  publishDiagnostics into plain structs.  Diagnostics are held back and
+//  flushed once per DiagnosticsMs, newest per document, so a server that
+//  republishes on every keystroke costs the GUI one update per interval.
+//  stop() sends exit only once shutdown is answered, and kills a server
+//  that takes longer than ShutdownMs.
+// ─────────────────────────────────────────────────────────────────────────────
+class LspTransport : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DiagnosticsMs  = 150;
+    static constexpr int MaxDiagnostics = 5000;    // per document
+    static constexpr int ShutdownMs     = 1000;
+
+    LspTransport(const QString &program, const QStringList &arguments,
+                 const QString &workingDirectory);
+
+public slots:
+    void start();
+    void send(const QJsonObject &message);
+    void stop();
+
+signals:
+    void started();
+    void failed(const QString &error);
+    void responseReceived(int id, const QJsonValue &result, const QString &error);
+    void diagnosticsReady(const QString &uri, const QVector<LspDiagnostic> &diagnostics);
+
+private:
+    void readAvailable();
+    void dispatch(const QJsonObject &message);
+    void flushDiagnostics();
+
+    QString m_program;
+    QStringList m_arguments;
+    QString m_workingDirectory;
+    QProcess *m_process = nullptr;
+    QTimer *m_diagnosticsTimer = nullptr;
+    QByteArray m_buffer;
+    int m_consumed = 0;             // bytes of m_buffer already dispatched
+    int m_bodyLength = -1;          // Content-Length of the message being read
+    bool m_stopping = false;        // shutdown sent; responses are dropped
+    bool m_shutDown = false;        // shutdown answered
+    QHash<QString, QVector<LspDiagnostic>> m_diagnostics;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  LspClient
+//  GUI-thread half: one language server per client.  Open documents are
+//  synced incrementally; every contentsChange becomes a range edit computed
+//  from a shadow table of line lengths, and the edits of one event loop
+//  turn go out as a single didChange.  Requests tied to a document are
+//  cancelled ($/cancelRequest) as soon as that document is edited again,
+//  so stale completions or lookups never reach their callbacks.
+// ─────────────────────────────────────────────────────────────────────────────
+class LspClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(const QJsonValue &result)>;
+
+    explicit LspClient(QObject *parent = nullptr);
+    ~LspClient() override;
+
+    void start(const QString &program, const QStringList &arguments,
+               const QString &rootPath);
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    void openDocument(QTextDocument *doc, const QString &path, const QString &languageId);
+    void closeDocument(QTextDocument *doc);
+    bool hasDocument(QTextDocument *doc) const { return m_documents.contains(doc); }
+
+    // Sends pending edits first, so the server answers for the current text
+    int request(QTextDocument *doc, const QString &method, const QJsonObject &params,
+                Callback callback);
+    void cancel(int id);
+
+    static QJsonObject position(int line, int character);
+    static QJsonObject documentIdentifier(const QString &path);
+
+signals:
+    void outgoing(const QJsonObject &message);
+    void diagnosticsChanged(QTextDocument *doc, const QVector<LspDiagnostic> &diagnostics);
+    void serverFailed(const QString &error);
+
+private:
+    struct Document {
+        QString path;
+        QString uri;
+        int version = 0;
+        int revision = -1;          // doc->revision() last sent
+        QVector<int> lineLengths;   // block lengths including the separator
+        QJsonArray changes;         // not yet sent
+    };
+    struct Pending {
+        QTextDocument *doc;
+        Callback callback;
+    };
+
+    void send(const QJsonObject &message);
+    void notify(const QString &method, const QJsonObject &params);
+    void contentsChange(QTextDocument *doc, int pos, int removed, int added);
+    void flushChanges();
+    void onResponse(int id, const QJsonValue &result, const QString &error);
+    void onDiagnostics(const QString &uri, const QVector<LspDiagnostic> &diagnostics);
+    static QVector<int> lineLengths(const QTextDocument *doc, int first, int last);
+
+    QThread *m_thread = nullptr;
+    LspTransport *m_transport = nullptr;
+    QTimer *m_changeTimer;
+    int m_nextId = 1;
+    int m_initializeId = 0;
+    bool m_initialized = false;
+    bool m_fullSync = false;            // server only takes whole documents
+    QVector<QJsonObject> m_queued;      // held until initialize returns
+    QHash<QTextDocument *, Document> m_documents;
+    QHash<QString, QTextDocument *> m_byPath;
+    QHash<int, Pending> m_pending;
+};
+
+#endif // LSPCLIENT_H
@@ -1,20 +1,38 @@
 #include <QApplication>
 #include <QDir>
 #include <QFileInfo>
+#include <QTimer>
 #include "texteditor.h"
+#include "startupprofiler.h"
 
 int main(int argc, char *argv[]) {
+    // First use starts the clock, so do it before anything else
+    StartupProfiler &profiler = StartupProfiler::instance();
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--trace-startup") == 0)
+            profiler.setEnabled(true);
+    }
+
     // Suppress Qt font warnings
     qputenv("QT_LOGGING_RULES", "qt.text.font.db=false");
     
     QApplication app(argc, argv);
+    profiler.mark("QApplication");
+
+    QStringList args = app.arguments();
+    args.removeAll("--trace-startup");
     
     TextEditor editor;
+    profiler.mark("TextEditor");
+    // Shown first: restored tabs are read in the background afterwards
     editor.show();
+    profiler.mark("show");
+    editor.restoreSession();
+    profiler.mark("restoreSession");
     
     // Handle command line arguments
-    if (argc > 1) {
-        QString arg = argv[1];
+    if (args.size() > 1) {
+        QString arg = args.at(1);
         QFileInfo fileInfo(arg);
         
         if (fileInfo.isDir()) {
@@ -27,7 +45,14 @@ int main(int argc, char *argv[]) {
             // Open current directory
             editor.openFolderPath(QDir::currentPath());
         }
+        profiler.mark("command line");
     }
+
+    // The first event-loop turn is when the window can take input
+    QTimer::singleShot(0, &app, [&profiler]() {
+        profiler.mark("first event loop turn");
+        profiler.finish();
+    });
     
     return app.exec();
 }
@@ -0,0 +1,166 @@
+#include "multicursor.h"
+
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <algorithm>
+
+void MultiCursor::add(int anchor, int position)
+{
+    m_carets.append({anchor, position});
+    normalize(m_carets);
+}
+
+void MultiCursor::set(QVector<Caret> carets)
+{
+    m_carets = std::move(carets);
+    normalize(m_carets);
+}
+
+int MultiCursor::lastEnd() const
+{
+    int last = -1;
+    for (const Caret &c : m_carets)
+        last = qMax(last, c.end());
+    return last;
+}
+
+void MultiCursor::normalize(QVector<Caret> &carets)
+{
+    std::sort(carets.begin(), carets.end(), [](const Caret &a, const Caret &b) {
+        return a.start() != b.start() ? a.start() < b.start() : a.end() < b.end();
+    });
+
+    // Carets on the same spot or with overlapping selections become one
+    int out = 0;
+    for (int i = 0; i < carets.size(); ++i) {
+        const Caret &c = carets[i];
+        if (out > 0) {
+            Caret &prev = carets[out - 1];
+            if (c.start() == prev.start() || c.start() < prev.end()) {
+                const int s = prev.start();
+                const int e = qMax(prev.end(), c.end());
+                const bool backward = prev.position < prev.anchor;
+                prev.anchor = backward ? e : s;
+                prev.position = backward ? s : e;
+                prev.primary = prev.primary || c.primary;
+                continue;
+            }
+        }
+        carets[out++] = c;
+    }
+    carets.resize(out);
+}
+
+void MultiCursor::edit(QTextDocument *doc, Caret &primary, EditKind kind,
+                       const QString &text)
+{
+    QVector<Caret> all = m_carets;
+    Caret main = primary;
+    main.primary = true;
+    all.append(main);
+    normalize(all);
+
+    struct Edit {
+        int start;
+        int length;
+        int inserted;
+    };
+    QVector<Edit> edits;
+    edits.reserve(all.size());
+    const int docEnd = doc->characterCount() - 1;
+    for (const Caret &c : all) {
+        int s = c.start();
+        int e = c.end();
+        if (!c.hasSelection()) {
+            if (kind == DeletePrevious && s > 0) {
+                --s;
+                if (s > 0 && doc->characterAt(s).isLowSurrogate())
+                    --s;
+            } else if (kind == DeleteNext && e < docEnd) {
+                ++e;
+                if (e < docEnd && doc->characterAt(e - 1).isHighSurrogate())
+                    ++e;
+            }
+        }
+        // Side-by-side carets can widen into each other's character
+        if (!edits.isEmpty())
+            s = qMax(s, edits.last().start + edits.last().length);
+        e = qMax(s, e);
+        edits.append({s, e - s, kind == InsertText ? int(text.size()) : 0});
+    }
+
+    // Back to front, so every offset still refers to the original text.
+    // One edit block would reach contentsChange listeners as a single change
+    // spanning all carets, wiping the decorations between them; instead
+    // each edit is its own block, joined onto the first for undo.
+    m_editing = true;
+    QTextCursor cursor(doc);
+    bool joined = false;
+    for (int i = edits.size() - 1; i >= 0; --i) {
+        const Edit &ed = edits[i];
+        if (ed.length == 0 && ed.inserted == 0)
+            continue;
+        if (joined)
+            cursor.joinPreviousEditBlock();
+        else
+            cursor.beginEditBlock();
+        joined = true;
+        cursor.setPosition(ed.start);
+        cursor.setPosition(ed.start + ed.length, QTextCursor::KeepAnchor);
+        if (kind == InsertText)
+            cursor.insertText(text);
+        else
+            cursor.removeSelectedText();
+        cursor.endEditBlock();
+    }
+    m_editing = false;
+
+    // Front to back, each caret lands after its own edit
+    int delta = 0;
+    for (int i = 0; i < all.size(); ++i) {
+        const int p = edits[i].start + delta + edits[i].inserted;
+        all[i].anchor = all[i].position = p;
+        delta += edits[i].inserted - edits[i].length;
+    }
+    normalize(all);
+
+    m_carets.clear();
+    for (const Caret &c : std::as_const(all)) {
+        if (c.primary)
+            primary = c;
+        else
+            m_carets.append(c);
+    }
+}
+
+void MultiCursor::follow(int pos, int removed, int added)
+{
+    if (m_editing || m_carets.isEmpty())
+        return;
+    const int editEnd = pos + removed;
+    auto map = [&](int p) {
+        return p < pos ? p : p >= editEnd ? p + added - removed : pos + added;
+    };
+    for (Caret &c : m_carets) {
+        c.anchor = map(c.anchor);
+        c.position = map(c.position);
+    }
+    normalize(m_carets);
+}
+
+QVector<Decoration> MultiCursor::decorations() const
+{
+    QVector<Decoration> marks;
+    marks.reserve(m_carets.size() * 2);
+    for (const Caret &c : m_carets) {
+        if (c.hasSelection())
+            marks.append({c.start(), c.end() - c.start(), DecoSelection});
+        marks.append({c.position, 0, DecoExtraCaret});
+    }
+    // A caret at the start of its own selection sorts before it
+    std::sort(marks.begin(), marks.end(), [](const Decoration &a, const Decoration &b) {
+        return a.start != b.start ? a.start < b.start : a.length < b.length;
+    });
+    return marks;
+}
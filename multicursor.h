@@ -0,0 +1,64 @@
+#ifndef MULTICURSOR_H
+#define MULTICURSOR_H
+
+#include <QString>
+#include <QVector>
+
+#include "decorationlayer.h"
+
+class QTextDocument;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  MultiCursor
+//  Extra carets as plain (anchor, position) offsets kept sorted by position.
+//  A keystroke becomes one edit per caret, applied back to front as a single
+//  undo step that still reports each edit as its own contentsChange, and the
+//  new caret offsets are recomputed front to back with a running delta.  No QTextCursor is kept per caret, so the document
+//  never has to adjust thousands of registered cursors on every insert.
+// ─────────────────────────────────────────────────────────────────────────────
+class MultiCursor
+{
+public:
+    struct Caret {
+        int anchor;
+        int position;
+        bool primary = false;   // stands in for the editor's own cursor
+
+        int start() const { return qMin(anchor, position); }
+        int end() const { return qMax(anchor, position); }
+        bool hasSelection() const { return anchor != position; }
+    };
+
+    enum EditKind { InsertText, DeletePrevious, DeleteNext };
+
+    bool isEmpty() const { return m_carets.isEmpty(); }
+    int size() const { return m_carets.size(); }
+    const QVector<Caret> &carets() const { return m_carets; }
+
+    void add(int anchor, int position);
+    void set(QVector<Caret> carets);
+    void clear() { m_carets.clear(); }
+
+    // Furthest selection end, where "select next" continues from
+    int lastEnd() const;
+
+    // Applies one edit to every extra caret and to primary as a single undo
+    // step.  primary is updated to its caret's new place; carets that meet
+    // are merged.
+    void edit(QTextDocument *doc, Caret &primary, EditKind kind,
+              const QString &text = QString());
+
+    // Follows QTextDocument::contentsChange for edits made elsewhere
+    void follow(int pos, int removed, int added);
+
+    // Carets and selections for the editor's decoration layer
+    QVector<Decoration> decorations() const;
+
+private:
+    static void normalize(QVector<Caret> &carets);
+
+    QVector<Caret> m_carets;
+    bool m_editing = false;
+};
+
+#endif // MULTICURSOR_H
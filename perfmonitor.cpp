@@ -0,0 +1,219 @@
+#include "perfmonitor.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLabel>
+#include <QTimer>
+#include <QVBoxLayout>
+
+bool PerfMonitor::s_enabled = false;
+
+PerfMonitor::PerfMonitor()
+{
+    m_clock.start();
+    m_ring.resize(Capacity);
+}
+
+PerfMonitor &PerfMonitor::instance()
+{
+    static PerfMonitor monitor;
+    return monitor;
+}
+
+void PerfMonitor::setEnabled(bool enabled)
+{
+    s_enabled = enabled;
+    m_pendingKey = -1;
+    m_keyEdited = false;
+    if (enabled) {
+        if (!m_heartbeat) {
+            // The singleton outlives QApplication; a timer it owned would be
+            // destroyed after the event loop it belongs to
+            m_heartbeat = new QTimer(QCoreApplication::instance());
+            m_heartbeat->setInterval(HeartbeatMs);
+            connect(m_heartbeat, &QTimer::timeout, this, &PerfMonitor::heartbeat);
+        }
+        m_lastBeat = now();
+        m_heartbeat->start();
+    } else if (m_heartbeat) {
+        m_heartbeat->stop();
+    }
+}
+
+void PerfMonitor::record(Kind kind, qint64 startNs, qint64 durationNs)
+{
+    m_ring[m_next] = {kind, startNs, durationNs};
+    m_next = (m_next + 1) % Capacity;
+    m_size = qMin(m_size + 1, Capacity);
+}
+
+void PerfMonitor::editorPainted()
+{
+    if (!s_enabled || m_pendingKey < 0)
+        return;
+    // A key that changed nothing must not be closed by an unrelated paint
+    // such as the caret blink
+    if (m_keyEdited)
+        record(KeyToPaint, m_pendingKey, now() - m_pendingKey);
+    m_pendingKey = -1;
+    m_keyEdited = false;
+}
+
+void PerfMonitor::heartbeat()
+{
+    // A late tick means the event loop was busy for the difference
+    const qint64 t = now();
+    const double lateMs = (t - m_lastBeat) / 1e6 - HeartbeatMs;
+    if (lateMs > StallThresholdMs)
+        record(Stall, m_lastBeat + qint64(HeartbeatMs) * 1000000,
+               qint64(lateMs * 1e6));
+    m_lastBeat = t;
+}
+
+PerfMonitor::Stats PerfMonitor::stats(Kind kind) const
+{
+    Stats s;
+    double total = 0;
+    bool haveLast = false;
+    // Walk newest to oldest so the first hit is the latest sample
+    for (int i = 0; i < m_size; ++i) {
+        const Event &e = m_ring[(m_next - 1 - i + Capacity) % Capacity];
+        if (e.kind != kind)
+            continue;
+        const double ms = e.durationNs / 1e6;
+        if (!haveLast) {
+            s.lastMs = ms;
+            haveLast = true;
+        }
+        s.maxMs = qMax(s.maxMs, ms);
+        total += ms;
+        ++s.count;
+    }
+    if (s.count > 0)
+        s.avgMs = total / s.count;
+    return s;
+}
+
+const char *PerfMonitor::kindName(Kind kind)
+{
+    switch (kind) {
+    case KeyToPaint:   return "Key to paint";
+    case EditorPaint:  return "Editor paint";
+    case GutterPaint:  return "Gutter paint";
+    case FoldingPaint: return "Folding paint";
+    case MiniMapPaint: return "MiniMap paint";
+    case HexPaint:     return "Hex paint";
+    case Stall:        return "Event loop stall";
+    default:           return "?";
+    }
+}
+
+bool PerfMonitor::exportChromeTrace(const QString &path) const
+{
+    // Complete ("X") events on one thread per subsystem so chrome://tracing
+    // shows input latency, paints and stalls as separate tracks.
+    QJsonArray events;
+    for (int i = 0; i < m_size; ++i) {
+        const Event &e = m_ring[(m_next - m_size + i + Capacity) % Capacity];
+        QJsonObject ev;
+        ev["name"] = kindName(e.kind);
+        ev["cat"] = e.kind == KeyToPaint ? "input"
+                    : e.kind == Stall    ? "eventloop"
+                                         : "paint";
+        ev["ph"] = "X";
+        ev["ts"] = e.startNs / 1000.0;
+        ev["dur"] = e.durationNs / 1000.0;
+        ev["pid"] = 1;
+        ev["tid"] = int(e.kind) + 1;
+        events.append(ev);
+    }
+    for (int k = 0; k < KindCount; ++k) {
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = 1;
+        meta["tid"] = k + 1;
+        meta["args"] = QJsonObject{{"name", kindName(Kind(k))}};
+        events.append(meta);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(path);
+    if (!file.open(QFile::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  PerfOverlay
+// ─────────────────────────────────────────────────────────────────────────────
+
+PerfOverlay::PerfOverlay(QWidget *parent)
+    : QWidget(parent)
+{
+    // Opaque on purpose: a translucent panel would repaint the editor under
+    // it on every refresh and show up in its own measurements.
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAutoFillBackground(true);
+    QPalette pal = palette();
+    pal.setColor(QPalette::Window, QColor(20, 20, 20));
+    setPalette(pal);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(10, 8, 10, 8);
+    m_label = new QLabel(this);
+    m_label->setStyleSheet("color: #d7ffaf; font-family: Consolas, monospace;"
+                           "font-size: 11px;");
+    layout->addWidget(m_label);
+
+    m_refresh = new QTimer(this);
+    m_refresh->setInterval(250);
+    connect(m_refresh, &QTimer::timeout, this, &PerfOverlay::refresh);
+    hide();
+}
+
+void PerfOverlay::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    m_refresh->start();
+}
+
+void PerfOverlay::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_refresh->stop();
+}
+
+void PerfOverlay::refresh()
+{
+    const PerfMonitor &monitor = PerfMonitor::instance();
+    QString text = QString("%1 %2 %3 %4\n")
+                       .arg("", -18).arg("last", 7).arg("avg", 7).arg("max", 7);
+    for (int k = 0; k < PerfMonitor::KindCount; ++k) {
+        const auto kind = PerfMonitor::Kind(k);
+        const PerfMonitor::Stats s = monitor.stats(kind);
+        text += QString("%1 %2 %3 %4")
+                    .arg(PerfMonitor::kindName(kind), -18)
+                    .arg(s.lastMs, 7, 'f', 2)
+                    .arg(s.avgMs, 7, 'f', 2)
+                    .arg(s.maxMs, 7, 'f', 2);
+        if (kind == PerfMonitor::Stall)
+            text += QString("  (%1)").arg(s.count);
+        text += '\n';
+    }
+    text += "all times in ms";
+    m_label->setText(text);
+
+    adjustSize();
+    if (parentWidget())
+        move(parentWidget()->width() - width() - 16, 48);
+    raise();
+}
@@ -0,0 +1,129 @@
+#ifndef PERFMONITOR_H
+#define PERFMONITOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+
+class QLabel;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  PerfMonitor
+//  In-process frame and latency instrumentation.  Paint handlers open a
+//  PerfMonitor::Scope, editing key presses are stamped so the next editor
+//  paint after the document changes can report keypress-to-paint latency,
+//  and a heartbeat timer reports event loop stalls.  Events live in a fixed ring buffer and can be exported in
+//  Chrome trace format (chrome://tracing, Perfetto).  Disabled by default;
+//  every hook is a single branch until enabled.
+// ─────────────────────────────────────────────────────────────────────────────
+class PerfMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Event names; kept as an enum so recording never allocates
+    enum Kind {
+        KeyToPaint,
+        EditorPaint,
+        GutterPaint,
+        FoldingPaint,
+        MiniMapPaint,
+        HexPaint,
+        Stall,
+        KindCount
+    };
+
+    struct Event {
+        Kind   kind;
+        qint64 startNs;
+        qint64 durationNs;
+    };
+
+    struct Stats {
+        int    count = 0;
+        double lastMs = 0;
+        double avgMs = 0;
+        double maxMs = 0;
+    };
+
+    // RAII timer for one paint handler
+    class Scope
+    {
+    public:
+        explicit Scope(Kind kind)
+            : m_kind(kind), m_start(s_enabled ? instance().now() : -1) {}
+        ~Scope()
+        {
+            if (m_start >= 0)
+                instance().record(m_kind, m_start, instance().now() - m_start);
+        }
+
+    private:
+        Kind   m_kind;
+        qint64 m_start;
+    };
+
+    static PerfMonitor &instance();
+    static bool isEnabled() { return s_enabled; }
+    void setEnabled(bool enabled);
+
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+    void record(Kind kind, qint64 startNs, qint64 durationNs);
+
+    // Keypress-to-paint: stamp on a key that may edit, keep the stamp only
+    // if the document then changes, close it on the next editor paint
+    void keyPressed()      { if (s_enabled && m_pendingKey < 0) m_pendingKey = now(); }
+    void documentChanged() { if (m_pendingKey >= 0) m_keyEdited = true; }
+    void editorPainted();
+
+    Stats stats(Kind kind) const;
+    static const char *kindName(Kind kind);
+
+    bool exportChromeTrace(const QString &path) const;
+
+    static constexpr int    Capacity        = 16384;
+    static constexpr int    HeartbeatMs     = 16;
+    static constexpr double StallThresholdMs = 50.0;
+
+private:
+    PerfMonitor();
+    void heartbeat();
+
+    static bool s_enabled;
+
+    QElapsedTimer  m_clock;
+    QVector<Event> m_ring;       // fixed size, m_next wraps
+    int            m_next = 0;
+    int            m_size = 0;
+    qint64         m_pendingKey = -1;
+    bool           m_keyEdited = false;
+    QPointer<QTimer> m_heartbeat;   // owned by the application, not the singleton
+    qint64         m_lastBeat = 0;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  PerfOverlay
+//  Small opaque panel pinned to the top-right of its parent showing
+//  last / average / max per instrumented path, refreshed four times a second.
+// ─────────────────────────────────────────────────────────────────────────────
+class PerfOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerfOverlay(QWidget *parent);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    QLabel *m_label;
+    QTimer *m_refresh;
+    void refresh();
+};
+
+#endif // PERFMONITOR_H
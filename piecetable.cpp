@@ -0,0 +1,418 @@
+#include "piecetable.h"
+
+#include <QFile>
+#include <QIODevice>
+
+#include <algorithm>
+#include <cstring>
+
+// The file stays open while mapped; closing it would unmap the view.  The
+// last owner, table or snapshot, unmaps it on destruction.
+struct PieceTable::Mapping {
+    QFile file;
+    const uchar *data = nullptr;
+};
+
+PieceTable::PieceTable() = default;
+
+PieceTable::~PieceTable()
+{
+    clear();
+}
+
+bool PieceTable::open(const QString &fileName, QString *error, OpenMode mode)
+{
+    // Keep the current contents if the file cannot be read at all
+    QFile probe(fileName);
+    if (!probe.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = probe.errorString();
+        return false;
+    }
+    probe.close();
+
+    clear();
+    auto mapping = std::make_shared<Mapping>();
+    QFile &file = mapping->file;
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    const qint64 length = file.size();
+    if (length == 0)
+        return true;
+    // Windows refuses to replace a mapped file, so saving over it would fail
+#ifdef Q_OS_WIN
+    const bool map = mode == ReadOnly;
+#else
+    const bool map = true;
+    Q_UNUSED(mode)
+#endif
+    if (map)
+        mapping->data = file.map(0, length);
+    if (mapping->data) {
+        m_mapping = std::move(mapping);
+    } else {
+        m_original = file.readAll();
+        if (m_original.size() != length) {
+            if (error)
+                *error = file.errorString();
+            m_original.clear();
+            return false;
+        }
+    }
+    m_root = newNode(Original, 0, length);
+    return true;
+}
+
+void PieceTable::setData(const QByteArray &data)
+{
+    clear();
+    m_original = data;
+    if (!data.isEmpty())
+        m_root = newNode(Original, 0, data.size());
+}
+
+void PieceTable::clear()
+{
+    m_mapping.reset();
+    m_original.clear();
+    m_added.clear();
+    m_nodes.clear();
+    m_free.clear();
+    m_root = -1;
+    ++m_generation;
+}
+
+qint64 PieceTable::size() const
+{
+    return total(m_root);
+}
+
+char PieceTable::at(qint64 pos) const
+{
+    int node = m_root;
+    while (node >= 0) {
+        const Node &n = m_nodes[node];
+        const qint64 left = total(n.left);
+        if (pos < left) {
+            node = n.left;
+        } else if (pos < left + n.length) {
+            return buffer(n.source)[n.start + pos - left];
+        } else {
+            pos -= left + n.length;
+            node = n.right;
+        }
+    }
+    return 0;
+}
+
+qint64 PieceTable::read(qint64 pos, char *dest, qint64 length) const
+{
+    if (pos < 0 || pos >= size() || length <= 0)
+        return 0;
+    return collect(m_root, pos, dest, qMin(length, size() - pos));
+}
+
+QByteArray PieceTable::read(qint64 pos, qint64 length) const
+{
+    if (pos < 0 || pos >= size() || length <= 0)
+        return QByteArray();
+    length = qMin(length, size() - pos);
+    if (length > MaxReadLength)
+        return QByteArray();
+    QByteArray bytes(int(length), Qt::Uninitialized);
+    read(pos, bytes.data(), length);
+    return bytes;
+}
+
+void PieceTable::insert(qint64 pos, const char *data, qint64 length)
+{
+    if (length <= 0)
+        return;
+    pos = qBound(qint64(0), pos, size());
+
+    int left, right;
+    split(m_root, pos, left, right);
+
+    // Consecutive typing lands right after the newest added bytes: grow that
+    // piece in place rather than adding one per keystroke
+    int last = left;
+    while (last >= 0 && m_nodes[last].right >= 0)
+        last = m_nodes[last].right;
+    const qint64 addedEnd = m_added.size();
+    m_added.append(data, length);
+    if (last >= 0 && m_nodes[last].source == Added &&
+        m_nodes[last].start + m_nodes[last].length == addedEnd) {
+        m_nodes[last].length += length;
+        for (int node = left; node >= 0; node = m_nodes[node].right)
+            m_nodes[node].total += length;
+    } else {
+        left = merge(left, newNode(Added, addedEnd, length));
+    }
+    m_root = merge(left, right);
+}
+
+bool PieceTable::insert(qint64 pos, const Pieces &pieces)
+{
+    if (pieces.generation != m_generation)
+        return false;
+    pos = qBound(qint64(0), pos, size());
+    int left, right;
+    split(m_root, pos, left, right);
+    for (const Piece &piece : pieces.list)
+        left = merge(left, newNode(piece.source, piece.start, piece.length));
+    m_root = merge(left, right);
+    return true;
+}
+
+void PieceTable::remove(qint64 pos, qint64 length)
+{
+    if (pos < 0 || pos >= size() || length <= 0)
+        return;
+    int left, middle, right;
+    split(m_root, pos, left, middle);
+    split(middle, length, middle, right);
+    freeTree(middle);
+    m_root = merge(left, right);
+}
+
+void PieceTable::replace(qint64 pos, const QByteArray &bytes)
+{
+    remove(pos, qMin(qint64(bytes.size()), size() - pos));
+    insert(pos, bytes);
+}
+
+bool PieceTable::write(QIODevice *device) const
+{
+    return writeTree(m_root, device);
+}
+
+const char *PieceTable::buffer(Source source) const
+{
+    if (source == Added)
+        return m_added.constData();
+    return m_mapping ? reinterpret_cast<const char *>(m_mapping->data) : m_original.constData();
+}
+
+int PieceTable::newNode(Source source, qint64 start, qint64 length)
+{
+    // xorshift32; balance only needs the priorities to be well spread
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    const Node n{start, length, length, m_seed, -1, -1, source};
+    if (!m_free.empty()) {
+        const int index = m_free.back();
+        m_free.pop_back();
+        m_nodes[index] = n;
+        return index;
+    }
+    m_nodes.push_back(n);
+    return int(m_nodes.size()) - 1;
+}
+
+void PieceTable::freeTree(int node)
+{
+    std::vector<int> stack;
+    if (node >= 0)
+        stack.push_back(node);
+    while (!stack.empty()) {
+        const int n = stack.back();
+        stack.pop_back();
+        if (m_nodes[n].left >= 0)
+            stack.push_back(m_nodes[n].left);
+        if (m_nodes[n].right >= 0)
+            stack.push_back(m_nodes[n].right);
+        m_free.push_back(n);
+    }
+}
+
+void PieceTable::refresh(int node)
+{
+    Node &n = m_nodes[node];
+    n.total = n.length + total(n.left) + total(n.right);
+}
+
+void PieceTable::split(int node, qint64 pos, int &left, int &right)
+{
+    if (node < 0) {
+        left = right = -1;
+        return;
+    }
+    const qint64 before = total(m_nodes[node].left);
+    const qint64 length = m_nodes[node].length;
+    int a, b;
+    if (pos <= before) {
+        split(m_nodes[node].left, pos, a, b);
+        m_nodes[node].left = b;
+        refresh(node);
+        left = a;
+        right = node;
+    } else if (pos >= before + length) {
+        split(m_nodes[node].right, pos - before - length, a, b);
+        m_nodes[node].right = a;
+        refresh(node);
+        left = node;
+        right = b;
+    } else {
+        // The cut falls inside this piece: its tail becomes a new piece that
+        // leads the right half
+        const qint64 cut = pos - before;
+        const int tail = newNode(m_nodes[node].source, m_nodes[node].start + cut, length - cut);
+        const int rest = m_nodes[node].right;
+        m_nodes[node].length = cut;
+        m_nodes[node].right = -1;
+        refresh(node);
+        left = node;
+        right = merge(tail, rest);
+    }
+}
+
+int PieceTable::merge(int left, int right)
+{
+    if (left < 0)
+        return right;
+    if (right < 0)
+        return left;
+    if (m_nodes[left].priority > m_nodes[right].priority) {
+        const int merged = merge(m_nodes[left].right, right);
+        m_nodes[left].right = merged;
+        refresh(left);
+        return left;
+    }
+    const int merged = merge(left, m_nodes[right].left);
+    m_nodes[right].left = merged;
+    refresh(right);
+    return right;
+}
+
+qint64 PieceTable::collect(int node, qint64 pos, char *dest, qint64 length) const
+{
+    if (node < 0 || length <= 0)
+        return 0;
+    const Node &n = m_nodes[node];
+    const qint64 before = total(n.left);
+    qint64 copied = 0;
+    if (pos < before)
+        copied = collect(n.left, pos, dest, length);
+    if (copied < length && pos < before + n.length) {
+        const qint64 offset = qMax(qint64(0), pos - before);
+        const qint64 count = qMin(n.length - offset, length - copied);
+        memcpy(dest + copied, buffer(n.source) + n.start + offset, size_t(count));
+        copied += count;
+    }
+    if (copied < length)
+        copied += collect(n.right, qMax(qint64(0), pos - before - n.length),
+                          dest + copied, length - copied);
+    return copied;
+}
+
+bool PieceTable::writeTree(int node, QIODevice *device) const
+{
+    if (node < 0)
+        return true;
+    const Node &n = m_nodes[node];
+    if (!writeTree(n.left, device))
+        return false;
+    // Slices keep each write call bounded on multi-GB pieces
+    constexpr qint64 Slice = 4 * 1024 * 1024;
+    const char *data = buffer(n.source) + n.start;
+    for (qint64 done = 0; done < n.length; done += Slice) {
+        const qint64 count = qMin(Slice, n.length - done);
+        if (device->write(data + done, count) != count)
+            return false;
+    }
+    return writeTree(n.right, device);
+}
+
+PieceTable::Pieces PieceTable::pieces(qint64 pos, qint64 length) const
+{
+    Pieces pieces;
+    pieces.generation = m_generation;
+    collectPieces(m_root, 0, pos, pos + length, pieces);
+    return pieces;
+}
+
+// offset is the document position of the subtree's first byte; subtrees
+// outside [pos, end) are skipped
+void PieceTable::collectPieces(int node, qint64 offset, qint64 pos, qint64 end,
+                               Pieces &pieces) const
+{
+    if (node < 0 || offset >= end || offset + total(node) <= pos)
+        return;
+    const Node &n = m_nodes[node];
+    collectPieces(n.left, offset, pos, end, pieces);
+    const qint64 start = offset + total(n.left);
+    const qint64 from = qMax(pos, start);
+    const qint64 to = qMin(end, start + n.length);
+    if (from < to)
+        pieces.list.push_back({n.source, n.start + from - start, to - from});
+    collectPieces(n.right, start + n.length, pos, end, pieces);
+}
+
+PieceTable::Snapshot PieceTable::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.m_mapping = m_mapping;
+    snapshot.m_original = m_original;   // implicitly shared; a later append
+    snapshot.m_added = m_added;         // on the GUI side detaches, not this
+    snapshot.m_size = size();
+    snapshot.m_spans.reserve(size_t(pieceCount()));
+    collectSpans(m_root, snapshot);
+    return snapshot;
+}
+
+void PieceTable::collectSpans(int node, Snapshot &snapshot) const
+{
+    if (node < 0)
+        return;
+    const Node &n = m_nodes[node];
+    collectSpans(n.left, snapshot);
+    const char *base = n.source == Added ? snapshot.m_added.constData()
+                       : m_mapping       ? reinterpret_cast<const char *>(m_mapping->data)
+                                         : snapshot.m_original.constData();
+    const qint64 offset = snapshot.m_spans.empty()
+                              ? 0
+                              : snapshot.m_spans.back().offset + snapshot.m_spans.back().length;
+    snapshot.m_spans.push_back({offset, n.length, base + n.start});
+    collectSpans(n.right, snapshot);
+}
+
+int PieceTable::Snapshot::spanAt(qint64 pos) const
+{
+    auto it = std::upper_bound(m_spans.begin(), m_spans.end(), pos,
+                               [](qint64 p, const Span &span) { return p < span.offset; });
+    return int(it - m_spans.begin()) - 1;
+}
+
+qint64 PieceTable::Snapshot::read(qint64 pos, char *dest, qint64 length) const
+{
+    if (pos < 0 || pos >= m_size || length <= 0)
+        return 0;
+    length = qMin(length, m_size - pos);
+    qint64 copied = 0;
+    for (int i = spanAt(pos); copied < length; ++i) {
+        const Span &span = m_spans[size_t(i)];
+        const qint64 offset = pos + copied - span.offset;
+        const qint64 count = qMin(span.length - offset, length - copied);
+        memcpy(dest + copied, span.data + offset, size_t(count));
+        copied += count;
+    }
+    return copied;
+}
+
+const char *PieceTable::Snapshot::data(qint64 pos, qint64 length, QByteArray &scratch) const
+{
+    if (pos < 0 || pos >= m_size || length <= 0)
+        return nullptr;
+    length = qMin(length, m_size - pos);
+    const Span &span = m_spans[size_t(spanAt(pos))];
+    if (pos + length <= span.offset + span.length)
+        return span.data + (pos - span.offset);
+    scratch.resize(int(length));
+    read(pos, scratch.data(), length);
+    return scratch.constData();
+}
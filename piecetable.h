@@ -0,0 +1,147 @@
+#ifndef PIECETABLE_H
+#define PIECETABLE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+class QIODevice;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  PieceTable
+//  Byte-level piece table for the hex editor.  The original file is
+//  memory-mapped (or held in a QByteArray when it cannot be), typed bytes
+//  go to an append-only add buffer, and the document is the in-order walk
+//  of pieces referencing either one.  Pieces live in a treap keyed by
+//  position with subtree byte counts, so locating, inserting and removing
+//  are O(log pieces) no matter how large the file is.  Typing at the end of
+//  the last added piece extends it instead of creating a new one.
+//
+//  snapshot() freezes the current document for a worker thread: a flat
+//  span list sharing the mapping and the buffers, which later edits on
+//  the GUI thread never touch.
+//
+//  pieces() records where a range's bytes live; inserting that list puts
+//  them back by reference, so undo and redo never grow the add buffer.
+// ─────────────────────────────────────────────────────────────────────────────
+class PieceTable
+{
+    struct Mapping;
+
+public:
+    enum Source : quint8 { Original, Added };
+
+    struct Piece {
+        Source source;
+        qint64 start;
+        qint64 length;
+    };
+    // Valid until the table is cleared or reopened, which bumps generation
+    struct Pieces {
+        quint64 generation = 0;
+        std::vector<Piece> list;
+    };
+
+    class Snapshot
+    {
+    public:
+        qint64 size() const { return m_size; }
+        qint64 read(qint64 pos, char *dest, qint64 length) const;
+        // Points straight into the source when the range lies in one piece,
+        // otherwise copies it into scratch
+        const char *data(qint64 pos, qint64 length, QByteArray &scratch) const;
+
+    private:
+        friend class PieceTable;
+        struct Span {
+            qint64 offset;      // document position
+            qint64 length;
+            const char *data;
+        };
+        int spanAt(qint64 pos) const;
+
+        std::vector<Span> m_spans;
+        std::shared_ptr<const Mapping> m_mapping;
+        QByteArray m_original;
+        QByteArray m_added;
+        qint64 m_size = 0;
+    };
+
+    PieceTable();
+    ~PieceTable();
+
+    PieceTable(const PieceTable &) = delete;
+    PieceTable &operator=(const PieceTable &) = delete;
+
+    // ReadOnly tables are never saved over their file, so they are mapped
+    // on Windows as well
+    enum OpenMode { Editable, ReadOnly };
+
+    bool open(const QString &fileName, QString *error = nullptr, OpenMode mode = Editable);
+    void setData(const QByteArray &data);
+    void clear();
+
+    qint64 size() const;
+    bool isEmpty() const { return size() == 0; }
+    int pieceCount() const { return int(m_nodes.size() - m_free.size()); }
+
+    // The QByteArray overloads refuse ranges longer than this and return
+    // nothing rather than building an array that large
+    static constexpr qint64 MaxReadLength = std::numeric_limits<int>::max();
+
+    char at(qint64 pos) const;
+    qint64 read(qint64 pos, char *dest, qint64 length) const;
+    QByteArray read(qint64 pos, qint64 length) const;
+    QByteArray toByteArray() const { return read(0, size()); }
+
+    void insert(qint64 pos, const char *data, qint64 length);
+    void insert(qint64 pos, const QByteArray &bytes) { insert(pos, bytes.constData(), bytes.size()); }
+    // False, inserting nothing, when the pieces outlived their buffers
+    bool insert(qint64 pos, const Pieces &pieces);
+    void remove(qint64 pos, qint64 length);
+    void replace(qint64 pos, const QByteArray &bytes);
+
+    // Streams the pieces in order; nothing is concatenated in memory
+    bool write(QIODevice *device) const;
+
+    Pieces pieces(qint64 pos, qint64 length) const;
+
+    Snapshot snapshot() const;
+
+private:
+    struct Node {
+        qint64 start;       // offset into the source buffer
+        qint64 length;
+        qint64 total;       // bytes in this subtree
+        quint32 priority;
+        int left;
+        int right;
+        Source source;
+    };
+
+    const char *buffer(Source source) const;
+    int newNode(Source source, qint64 start, qint64 length);
+    void freeTree(int node);
+    void refresh(int node);
+    qint64 total(int node) const { return node < 0 ? 0 : m_nodes[node].total; }
+    void split(int node, qint64 pos, int &left, int &right);
+    int merge(int left, int right);
+    qint64 collect(int node, qint64 pos, char *dest, qint64 length) const;
+    bool writeTree(int node, QIODevice *device) const;
+    void collectSpans(int node, Snapshot &snapshot) const;
+    void collectPieces(int node, qint64 offset, qint64 pos, qint64 end, Pieces &pieces) const;
+
+    std::shared_ptr<Mapping> m_mapping;     // shared with snapshots
+    QByteArray m_original;          // used when the file cannot be mapped
+    QByteArray m_added;
+    std::vector<Node> m_nodes;
+    std::vector<int> m_free;
+    int m_root = -1;
+    quint64 m_generation = 0;
+    quint32 m_seed = 0x9e3779b9u;
+};
+
+#endif // PIECETABLE_H
@@ -0,0 +1,38 @@
+#include "startupprofiler.h"
+
+#include <cstdio>
+
+StartupProfiler::StartupProfiler()
+{
+    // Started at first use, which main() makes the first thing it does
+    m_timer.start();
+    m_enabled = qEnvironmentVariableIsSet("JIM_STARTUP_TRACE");
+}
+
+StartupProfiler &StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+void StartupProfiler::mark(const char *phase)
+{
+    if (!m_enabled || m_finished)
+        return;
+    const qint64 now = m_timer.nsecsElapsed();
+    m_phases.append({QByteArray(phase), now - m_last});
+    m_last = now;
+}
+
+void StartupProfiler::finish()
+{
+    if (!m_enabled || m_finished)
+        return;
+    m_finished = true;
+
+    std::fprintf(stderr, "Jim startup trace\n");
+    for (const Phase &p : m_phases)
+        std::fprintf(stderr, "  %-28s %8.2f ms\n", p.name.constData(),
+                     p.nsecs / 1e6);
+    std::fprintf(stderr, "  %-28s %8.2f ms\n", "total", m_last / 1e6);
+}
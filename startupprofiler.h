@@ -0,0 +1,43 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QVector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  StartupProfiler
+//  Named-phase timings for cold start.  Enabled by the JIM_STARTUP_TRACE
+//  environment variable or the --trace-startup flag; when disabled every
+//  call is a cheap early return.
+// ─────────────────────────────────────────────────────────────────────────────
+class StartupProfiler
+{
+public:
+    static StartupProfiler &instance();
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+
+    // Records the time spent since the previous mark under this name
+    void mark(const char *phase);
+
+    // Prints the phase table to stderr; later calls are ignored
+    void finish();
+
+private:
+    StartupProfiler();
+
+    struct Phase {
+        QByteArray name;
+        qint64 nsecs;
+    };
+
+    QElapsedTimer  m_timer;
+    qint64         m_last = 0;
+    QVector<Phase> m_phases;
+    bool           m_enabled = false;
+    bool           m_finished = false;
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,676 @@
+#include "symbolindex.h"
+#include "texteditor.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// On-disk layout: header, file records, symbol records, string pool.  The
+// file is a private cache, so native byte order is fine.
+const quint32 TableMagic = 0x4D59534A;  // "JSYM"
+const quint32 TableVersion = 1;
+
+struct TableHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 fileCount;
+    quint32 symbolCount;
+    quint32 poolSize;
+    quint32 reserved;
+};
+
+struct FileRecord {
+    qint64 mtime;
+    qint64 size;
+    quint32 path;           // pool offset, UTF-8
+    quint32 pathLength;
+};
+
+struct SymbolRecord {
+    quint32 text;           // pool offset of scope followed by name
+    quint16 scopeLength;
+    quint16 nameLength;
+    quint32 file;
+    quint32 line;
+    quint8 kind;
+    quint8 reserved[3];
+};
+
+struct TableView {
+    const TableHeader *header = nullptr;
+    const FileRecord *files = nullptr;
+    const SymbolRecord *symbols = nullptr;
+    const char *pool = nullptr;
+
+    bool isValid() const { return header != nullptr; }
+    int fileCount() const { return header ? int(header->fileCount) : 0; }
+    int symbolCount() const { return header ? int(header->symbolCount) : 0; }
+
+    // Checks every offset once, so lookups can trust the mapping
+    static TableView of(const uchar *map, qint64 size)
+    {
+        TableView t;
+        if (!map || size < qint64(sizeof(TableHeader)))
+            return t;
+        const TableHeader *h = reinterpret_cast<const TableHeader *>(map);
+        if (h->magic != TableMagic || h->version != TableVersion)
+            return t;
+        const qint64 filesAt = sizeof(TableHeader);
+        const qint64 symbolsAt = filesAt + qint64(h->fileCount) * sizeof(FileRecord);
+        const qint64 poolAt = symbolsAt + qint64(h->symbolCount) * sizeof(SymbolRecord);
+        if (poolAt + h->poolSize > size)
+            return t;
+        const FileRecord *files = reinterpret_cast<const FileRecord *>(map + filesAt);
+        const SymbolRecord *symbols = reinterpret_cast<const SymbolRecord *>(map + symbolsAt);
+        for (quint32 i = 0; i < h->fileCount; ++i) {
+            if (qint64(files[i].path) + files[i].pathLength > h->poolSize)
+                return t;
+        }
+        for (quint32 i = 0; i < h->symbolCount; ++i) {
+            const SymbolRecord &s = symbols[i];
+            if (s.file >= h->fileCount ||
+                qint64(s.text) + s.scopeLength + s.nameLength > h->poolSize)
+                return t;
+        }
+        t.header = h;
+        t.files = files;
+        t.symbols = symbols;
+        t.pool = reinterpret_cast<const char *>(map + poolAt);
+        return t;
+    }
+
+    // A mapping that of() accepted earlier
+    static TableView trusted(const uchar *map)
+    {
+        TableView t;
+        if (!map)
+            return t;
+        t.header = reinterpret_cast<const TableHeader *>(map);
+        t.files = reinterpret_cast<const FileRecord *>(map + sizeof(TableHeader));
+        t.symbols = reinterpret_cast<const SymbolRecord *>(t.files + t.header->fileCount);
+        t.pool = reinterpret_cast<const char *>(t.symbols + t.header->symbolCount);
+        return t;
+    }
+
+    QString path(quint32 file) const
+    {
+        return QString::fromUtf8(pool + files[file].path, files[file].pathLength);
+    }
+    const char *name(const SymbolRecord &s) const { return pool + s.text + s.scopeLength; }
+
+    SymbolIndex::Entry entry(const SymbolRecord &s) const
+    {
+        SymbolIndex::Entry e;
+        e.scope = QString::fromUtf8(pool + s.text, s.scopeLength);
+        e.name = QString::fromUtf8(name(s), s.nameLength);
+        e.file = path(s.file);
+        e.line = int(s.line);
+        e.kind = SyntaxTree::SymbolKind(s.kind);
+        return e;
+    }
+};
+
+// Identifiers are ASCII in practice; folding bytes keeps the table order,
+// the binary search and the substring scan consistent with each other.
+inline uchar fold(uchar c)
+{
+    return c >= 'A' && c <= 'Z' ? uchar(c + ('a' - 'A')) : c;
+}
+
+QByteArray folded(const QByteArray &bytes)
+{
+    QByteArray out = bytes;
+    for (char &c : out)
+        c = char(fold(uchar(c)));
+    return out;
+}
+
+// Compares a name against a folded key; with prefix set, a name that
+// starts with the key compares equal
+int foldedCompare(const char *s, int n, const QByteArray &key, bool prefix)
+{
+    const int k = int(key.size());
+    const int common = qMin(n, k);
+    for (int i = 0; i < common; ++i) {
+        const int d = int(fold(uchar(s[i]))) - int(uchar(key[i]));
+        if (d)
+            return d;
+    }
+    if (prefix && n >= k)
+        return 0;
+    return n - k;
+}
+
+int foldedIndexOf(const char *s, int n, const QByteArray &key)
+{
+    const int k = int(key.size());
+    const uchar first = uchar(key[0]);
+    for (int i = 0; i + k <= n; ++i) {
+        if (fold(uchar(s[i])) != first)
+            continue;
+        int j = 1;
+        while (j < k && fold(uchar(s[i + j])) == uchar(key[j]))
+            ++j;
+        if (j == k)
+            return i;
+    }
+    return -1;
+}
+
+// Range of records whose folded name equals (or starts with) the key
+std::pair<int, int> equalRange(const TableView &t, const QByteArray &key, bool prefix)
+{
+    const SymbolRecord *begin = t.symbols;
+    const SymbolRecord *end = t.symbols + t.symbolCount();
+    const SymbolRecord *lo = std::lower_bound(begin, end, key,
+        [&t](const SymbolRecord &s, const QByteArray &k) {
+            return foldedCompare(t.name(s), s.nameLength, k, prefix) < 0;
+        });
+    const SymbolRecord *hi = std::upper_bound(lo, end, key,
+        [&t](const QByteArray &k, const SymbolRecord &s) {
+            return foldedCompare(t.name(s), s.nameLength, k, prefix) > 0;
+        });
+    return {int(lo - begin), int(hi - begin)};
+}
+
+bool isSkippedDir(const QString &name)
+{
+    // Hidden directories (.git, .cache) are already filtered by QDir
+    return name == QLatin1String("node_modules") || name == QLatin1String("__pycache__") ||
+           name == QLatin1String("target") || name == QLatin1String("build") ||
+           name == QLatin1String("dist") || name.startsWith(QLatin1String("build-")) ||
+           name.startsWith(QLatin1String("cmake-build-"));
+}
+
+} // namespace
+
+QString SymbolIndex::Entry::display() const
+{
+    return kind == SyntaxTree::FunctionSymbol ? scope + name + "()" : name;
+}
+
+SymbolIndex::SymbolIndex(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+SymbolIndex::~SymbolIndex()
+{
+    m_cancel = true;
+    if (m_worker)
+        m_worker->wait();
+    m_pool.waitForDone();
+    unmapTable();
+}
+
+bool SymbolIndex::isIndexable(const QString &path)
+{
+    switch (TextEditor::detectLanguage(path)) {
+    case Language::CPP:
+    case Language::Python:
+    case Language::JavaScript:
+    case Language::Rust:
+    case Language::Go:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QVector<SymbolIndex::Entry> SymbolIndex::extract(const QString &path, const QByteArray &data)
+{
+    SyntaxTree tree;
+    tree.setLanguage(TextEditor::detectLanguage(path));
+
+    QVector<Entry> out;
+    for (const SyntaxTree::Symbol &symbol : tree.declarations(QString::fromUtf8(data))) {
+        // SyntaxTree names read "Scope::name()" / "name()" / "Type"
+        QString name = symbol.name;
+        if (name.endsWith(QLatin1String("()")))
+            name.chop(2);
+        if (name.isEmpty())
+            continue;
+        Entry e;
+        const int split = name.lastIndexOf(QLatin1String("::"));
+        if (split >= 0) {
+            e.scope = name.left(split + 2).remove(' ');
+            name = name.mid(split + 2);
+        }
+        e.name = name;
+        e.file = path;
+        e.line = symbol.line;
+        e.kind = symbol.kind;
+        out.append(e);
+    }
+    return out;
+}
+
+QString SymbolIndex::tablePath(const QString &root)
+{
+    const QByteArray key =
+        QCryptographicHash::hash(QDir::cleanPath(root).toUtf8(), QCryptographicHash::Md5);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/symbols/" +
+           QString::fromLatin1(key.toHex()) + ".idx";
+}
+
+bool SymbolIndex::writeTable(const QString &root, const QString &path,
+                             const std::atomic_bool &cancel, QStringList *dirs,
+                             int *files, int *symbols)
+{
+    // Records of files unchanged since the previous table are copied over
+    // instead of being read and lexed again
+    QFile oldFile(path);
+    const uchar *oldMap = nullptr;
+    if (oldFile.open(QFile::ReadOnly))
+        oldMap = oldFile.map(0, oldFile.size());
+    const TableView old = TableView::of(oldMap, oldMap ? oldFile.size() : 0);
+    QHash<QString, int> oldFiles;
+    QVector<QVector<int>> oldSymbols(old.fileCount());
+    for (int f = 0; f < old.fileCount(); ++f)
+        oldFiles.insert(old.path(f), f);
+    for (int s = 0; s < old.symbolCount(); ++s)
+        oldSymbols[old.symbols[s].file].append(s);
+
+    struct Row {
+        QByteArray key;     // folded name
+        QByteArray scope;
+        QByteArray name;
+        quint32 file;
+        quint32 line;
+        quint8 kind;
+    };
+    QVector<Row> rows;
+    QVector<FileRecord> fileRecords;
+    QByteArray pool;
+
+    QStringList pending{QDir::cleanPath(root)};
+    while (!pending.isEmpty()) {
+        if (cancel)
+            return false;
+        const QString dir = pending.takeLast();
+        if (dirs->size() < MaxWatchDirs)
+            dirs->append(dir);
+        const QFileInfoList entries = QDir(dir).entryInfoList(
+            QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        for (const QFileInfo &info : entries) {
+            if (info.isDir()) {
+                if (!isSkippedDir(info.fileName()))
+                    pending.append(info.filePath());
+                continue;
+            }
+            const QString file = info.filePath();
+            if (info.size() > MaxFileSize || !isIndexable(file))
+                continue;
+
+            const quint32 id = quint32(fileRecords.size());
+            const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+            const QByteArray utf8 = file.toUtf8();
+            fileRecords.append({mtime, info.size(), quint32(pool.size()), quint32(utf8.size())});
+            pool += utf8;
+
+            const int previous = oldFiles.value(file, -1);
+            if (previous >= 0 && old.files[previous].mtime == mtime &&
+                old.files[previous].size == info.size()) {
+                for (int s : std::as_const(oldSymbols[previous])) {
+                    const SymbolRecord &r = old.symbols[s];
+                    const QByteArray name(old.name(r), r.nameLength);
+                    rows.append({folded(name), QByteArray(old.pool + r.text, r.scopeLength),
+                                 name, id, r.line, r.kind});
+                }
+                continue;
+            }
+
+            QFile source(file);
+            if (!source.open(QFile::ReadOnly))
+                continue;
+            for (const Entry &e : extract(file, source.readAll())) {
+                const QByteArray name = e.name.toUtf8();
+                const QByteArray scope = e.scope.toUtf8();
+                if (name.size() > 0xffff || scope.size() > 0xffff)
+                    continue;
+                rows.append({folded(name), scope, name, id, quint32(e.line), quint8(e.kind)});
+            }
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+        if (a.key != b.key)
+            return a.key < b.key;
+        if (a.name != b.name)
+            return a.name < b.name;
+        return a.file != b.file ? a.file < b.file : a.line < b.line;
+    });
+
+    QVector<SymbolRecord> symbolRecords;
+    symbolRecords.reserve(rows.size());
+    for (const Row &row : std::as_const(rows)) {
+        SymbolRecord r{};
+        r.text = quint32(pool.size());
+        r.scopeLength = quint16(row.scope.size());
+        r.nameLength = quint16(row.name.size());
+        r.file = row.file;
+        r.line = row.line;
+        r.kind = row.kind;
+        symbolRecords.append(r);
+        pool += row.scope;
+        pool += row.name;
+    }
+    if (pool.size() > 0xffffffffLL || cancel)
+        return false;
+
+    // Written next to the live table; the GUI thread swaps it in once the
+    // old mapping is released (a mapped file cannot be replaced on Windows)
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile out(path + ".new");
+    if (!out.open(QFile::WriteOnly))
+        return false;
+    const TableHeader header{TableMagic, TableVersion, quint32(fileRecords.size()),
+                             quint32(symbolRecords.size()), quint32(pool.size()), 0};
+    out.write(reinterpret_cast<const char *>(&header), sizeof header);
+    out.write(reinterpret_cast<const char *>(fileRecords.constData()),
+              fileRecords.size() * qint64(sizeof(FileRecord)));
+    out.write(reinterpret_cast<const char *>(symbolRecords.constData()),
+              symbolRecords.size() * qint64(sizeof(SymbolRecord)));
+    out.write(pool);
+    if (!out.commit())
+        return false;
+
+    *files = int(fileRecords.size());
+    *symbols = int(symbolRecords.size());
+    return true;
+}
+
+void SymbolIndex::setRoot(const QString &folder)
+{
+    const QString root = QDir::cleanPath(folder);
+    if (root == m_root)
+        return;
+
+    ++m_generation;
+    if (m_worker) {
+        m_cancel = true;
+        m_worker->wait();
+        m_worker = nullptr;
+    }
+    m_rebuildQueued = false;
+    unmapTable();
+    m_overlay.clear();
+    delete m_watcher;
+    m_watcher = nullptr;
+
+    m_root = root;
+    if (m_root.isEmpty())
+        return;
+    // A table from an earlier session answers lookups while the refresh runs
+    mapTable();
+    startBuild();
+}
+
+void SymbolIndex::startBuild()
+{
+    if (m_worker) {
+        m_rebuildQueued = true;
+        return;
+    }
+    m_cancel = false;
+    const QString root = m_root;
+    const QString path = tablePath(root);
+    const quint64 generation = m_generation;
+    m_worker = QThread::create([this, root, path, generation]() {
+        QStringList dirs;
+        int files = 0;
+        int symbols = 0;
+        const bool ok = writeTable(root, path, m_cancel, &dirs, &files, &symbols);
+        QMetaObject::invokeMethod(this, [=]() {
+            buildFinished(generation, ok, dirs, files, symbols);
+        }, Qt::QueuedConnection);
+    });
+    connect(m_worker, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_worker->start(QThread::LowPriority);
+    emit indexingStarted();
+}
+
+void SymbolIndex::buildFinished(quint64 generation, bool ok, const QStringList &dirs,
+                                int files, int symbols)
+{
+    if (generation != m_generation)
+        return;
+    m_worker = nullptr;
+
+    if (ok) {
+        const QString path = tablePath(m_root);
+        unmapTable();
+        QFile::remove(path);
+        QFile::rename(path + ".new", path);
+        mapTable();
+
+        // Overlay entries the new table already reflects are dropped
+        const TableView t = TableView::trusted(m_map);
+        for (auto it = m_overlay.begin(); it != m_overlay.end();) {
+            const quint32 id = m_fileIds.value(it.key(), quint32(-1));
+            const bool current = id != quint32(-1) ? t.files[id].mtime == it->mtime &&
+                                                         t.files[id].size == it->size
+                                                   : it->mtime == 0;
+            if (current) {
+                m_shadowed.remove(id);
+                it = m_overlay.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        delete m_watcher;
+        m_watcher = new QFileSystemWatcher(this);
+        m_watcher->addPaths(dirs);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this,
+                &SymbolIndex::directoryChanged);
+        emit indexed(files, symbols);
+    }
+
+    if (m_rebuildQueued) {
+        m_rebuildQueued = false;
+        startBuild();
+    }
+}
+
+void SymbolIndex::mapTable()
+{
+    unmapTable();
+    m_table.setFileName(tablePath(m_root));
+    if (!m_table.open(QFile::ReadOnly))
+        return;
+    m_mapSize = m_table.size();
+    m_map = m_table.map(0, m_mapSize);
+    const TableView t = TableView::of(m_map, m_mapSize);
+    if (!t.isValid()) {
+        unmapTable();
+        return;
+    }
+    m_fileIds.reserve(t.fileCount());
+    for (int f = 0; f < t.fileCount(); ++f)
+        m_fileIds.insert(t.path(f), quint32(f));
+    for (auto it = m_overlay.cbegin(); it != m_overlay.cend(); ++it) {
+        if (m_fileIds.contains(it.key()))
+            m_shadowed.insert(m_fileIds.value(it.key()));
+    }
+}
+
+void SymbolIndex::unmapTable()
+{
+    if (m_map)
+        m_table.unmap(const_cast<uchar *>(m_map));
+    m_table.close();
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_fileIds.clear();
+    m_shadowed.clear();
+}
+
+int SymbolIndex::symbolCount() const
+{
+    int count = TableView::trusted(m_map).symbolCount();
+    for (const Overlay &o : m_overlay)
+        count += o.symbols.size();
+    return count;
+}
+
+QVector<SymbolIndex::Entry> SymbolIndex::find(const QString &query, int limit) const
+{
+    QVector<Entry> out;
+    const QByteArray key = folded(query.trimmed().toUtf8());
+    if (key.isEmpty())
+        return out;
+
+    const TableView t = TableView::trusted(m_map);
+
+    // Prefix matches: one contiguous run of the sorted table
+    const std::pair<int, int> range = equalRange(t, key, true);
+    for (int i = range.first; i < range.second && out.size() < limit; ++i) {
+        if (!m_shadowed.contains(t.symbols[i].file))
+            out.append(t.entry(t.symbols[i]));
+    }
+    for (const Overlay &o : m_overlay) {
+        for (const Entry &e : o.symbols) {
+            const QByteArray name = e.name.toUtf8();
+            if (out.size() < limit && foldedCompare(name.constData(), name.size(), key, true) == 0)
+                out.append(e);
+        }
+    }
+
+    // Then names containing the query elsewhere
+    for (int i = 0; i < t.symbolCount() && out.size() < limit; ++i) {
+        const SymbolRecord &s = t.symbols[i];
+        if (foldedIndexOf(t.name(s), s.nameLength, key) > 0 && !m_shadowed.contains(s.file))
+            out.append(t.entry(s));
+    }
+    for (const Overlay &o : m_overlay) {
+        for (const Entry &e : o.symbols) {
+            const QByteArray name = e.name.toUtf8();
+            if (out.size() < limit && foldedIndexOf(name.constData(), name.size(), key) > 0)
+                out.append(e);
+        }
+    }
+    return out;
+}
+
+QVector<SymbolIndex::Entry> SymbolIndex::definitions(const QString &name) const
+{
+    QVector<Entry> out;
+    const QByteArray exact = name.toUtf8();
+    if (exact.isEmpty())
+        return out;
+
+    const TableView t = TableView::trusted(m_map);
+    const std::pair<int, int> range = equalRange(t, folded(exact), false);
+    for (int i = range.first; i < range.second; ++i) {
+        const SymbolRecord &s = t.symbols[i];
+        if (s.nameLength == exact.size() && !m_shadowed.contains(s.file) &&
+            memcmp(t.name(s), exact.constData(), s.nameLength) == 0)
+            out.append(t.entry(s));
+    }
+    for (const Overlay &o : m_overlay) {
+        for (const Entry &e : o.symbols) {
+            if (e.name == name)
+                out.append(e);
+        }
+    }
+    // Types first: "Widget" should land on the class, not a constructor
+    std::stable_sort(out.begin(), out.end(), [](const Entry &a, const Entry &b) {
+        return a.kind == SyntaxTree::TypeSymbol && b.kind != SyntaxTree::TypeSymbol;
+    });
+    return out;
+}
+
+void SymbolIndex::fileChanged(const QString &path)
+{
+    const QString file = QDir::cleanPath(path);
+    if (m_root.isEmpty() || !file.startsWith(m_root + '/') || !isIndexable(file))
+        return;
+
+    const quint64 generation = m_generation;
+    m_pool.start([this, file, generation]() {
+        Overlay overlay;   // a missing file leaves an empty overlay: removed
+        const QFileInfo info(file);
+        QFile source(file);
+        if (info.exists() && info.size() <= MaxFileSize && source.open(QFile::ReadOnly)) {
+            overlay.mtime = info.lastModified().toMSecsSinceEpoch();
+            overlay.size = info.size();
+            overlay.symbols = extract(file, source.readAll());
+        }
+        QMetaObject::invokeMethod(this, [=]() {
+            applyFile(generation, file, overlay);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SymbolIndex::applyFile(quint64 generation, const QString &path, const Overlay &overlay)
+{
+    if (generation != m_generation)
+        return;
+    m_overlay.insert(path, overlay);
+    if (m_fileIds.contains(path))
+        m_shadowed.insert(m_fileIds.value(path));
+    emit updated();
+    if (m_overlay.size() > MaxOverlay)
+        startBuild();
+}
+
+void SymbolIndex::directoryChanged(const QString &dir)
+{
+    // The watcher only says something in dir changed; compare what is on
+    // disk with what the index knows to find out which files
+    const TableView t = TableView::trusted(m_map);
+    const QString prefix = dir + '/';
+    const QFileInfoList entries = QDir(dir).entryInfoList(
+        QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    for (const QFileInfo &info : entries) {
+        const QString file = info.filePath();
+        if (info.isDir()) {
+            if (!isSkippedDir(info.fileName()) && m_watcher &&
+                m_watcher->directories().size() < MaxWatchDirs &&
+                m_watcher->addPath(file))
+                directoryChanged(file);   // new directory: index what it holds
+            continue;
+        }
+        if (info.size() > MaxFileSize || !isIndexable(file))
+            continue;
+        qint64 mtime = -1;
+        qint64 size = -1;
+        if (m_overlay.contains(file)) {
+            mtime = m_overlay[file].mtime;
+            size = m_overlay[file].size;
+        } else if (m_fileIds.contains(file)) {
+            const FileRecord &r = t.files[m_fileIds.value(file)];
+            mtime = r.mtime;
+            size = r.size;
+        }
+        if (mtime != info.lastModified().toMSecsSinceEpoch() || size != info.size())
+            fileChanged(file);
+    }
+
+    // Deleted files
+    QStringList known;
+    for (auto it = m_fileIds.cbegin(); it != m_fileIds.cend(); ++it) {
+        if (it.key().startsWith(prefix) && !m_overlay.contains(it.key()))
+            known.append(it.key());
+    }
+    for (auto it = m_overlay.cbegin(); it != m_overlay.cend(); ++it) {
+        if (it.key().startsWith(prefix) && it->mtime != 0)
+            known.append(it.key());
+    }
+    for (const QString &file : std::as_const(known)) {
+        if (file.indexOf('/', prefix.size()) < 0 && !QFileInfo::exists(file))
+            fileChanged(file);
+    }
+}
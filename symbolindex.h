@@ -0,0 +1,115 @@
+#ifndef SYMBOLINDEX_H
+#define SYMBOLINDEX_H
+
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+
+#include "syntaxtree.h"
+
+class QFileSystemWatcher;
+class QThread;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  SymbolIndex
+//  Workspace-wide table of functions, classes and structs for C++, Python,
+//  JavaScript, Rust and Go.  A worker thread walks the folder, extracts
+//  declarations with SyntaxTree and writes a flat table (file records,
+//  symbol records sorted by case-folded name, one UTF-8 string pool) to the
+//  cache directory; the GUI thread memory-maps it, so name and prefix
+//  lookups are binary searches over the mapping and reopening a folder is
+//  instant.  Rebuilds
+//  reuse the records of files whose size and mtime are unchanged.
+//
+//  Saved files and directory changes reported by the file watcher are
+//  re-extracted individually into a small overlay that shadows their rows
+//  in the table; once the overlay grows, the table is rewritten.
+// ─────────────────────────────────────────────────────────────────────────────
+class SymbolIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QString name;       // bare identifier: "compute"
+        QString scope;      // "Widget::" for out-of-line C++ members
+        QString file;       // absolute path
+        int line = 0;       // block number
+        SyntaxTree::SymbolKind kind = SyntaxTree::NoSymbol;
+
+        QString display() const;
+    };
+
+    static constexpr qint64 MaxFileSize  = 4 * 1024 * 1024;
+    static constexpr int    MaxWatchDirs = 4096;   // inotify budget
+    static constexpr int    MaxOverlay   = 256;    // files before a rewrite
+
+    explicit SymbolIndex(QObject *parent = nullptr);
+    ~SymbolIndex() override;
+
+    void setRoot(const QString &folder);
+    QString root() const { return m_root; }
+    bool isIndexing() const { return m_worker != nullptr; }
+    int symbolCount() const;
+
+    // Go to symbol: prefix matches on the case-folded name, then substring
+    // matches, up to limit entries.  The substring pass scans every symbol.
+    QVector<Entry> find(const QString &query, int limit = 200) const;
+
+    // Go to definition: exact, case-sensitive name
+    QVector<Entry> definitions(const QString &name) const;
+
+    // Re-extracts one file (saved, created or removed) off the GUI thread
+    void fileChanged(const QString &path);
+
+signals:
+    void indexingStarted();
+    void indexed(int files, int symbols);
+    void updated();
+
+private:
+    struct Overlay {
+        qint64 mtime = 0;
+        qint64 size = 0;
+        QVector<Entry> symbols;
+    };
+
+    static bool isIndexable(const QString &path);
+    static QVector<Entry> extract(const QString &path, const QByteArray &data);
+    static QString tablePath(const QString &root);
+    static bool writeTable(const QString &root, const QString &path,
+                           const std::atomic_bool &cancel, QStringList *dirs,
+                           int *files, int *symbols);
+
+    void startBuild();
+    void buildFinished(quint64 generation, bool ok, const QStringList &dirs,
+                       int files, int symbols);
+    void mapTable();
+    void unmapTable();
+    void directoryChanged(const QString &dir);
+    void applyFile(quint64 generation, const QString &path, const Overlay &overlay);
+
+    QString m_root;
+    quint64 m_generation = 0;               // bumped per root; stale results are dropped
+    QThread *m_worker = nullptr;            // full build
+    QThreadPool m_pool;                     // single-file updates, in order
+    std::atomic_bool m_cancel{false};
+    bool m_rebuildQueued = false;
+
+    QFile m_table;
+    const uchar *m_map = nullptr;
+    qint64 m_mapSize = 0;
+    QHash<QString, quint32> m_fileIds;      // path → table file record
+    QSet<quint32> m_shadowed;               // table files replaced by m_overlay
+    QHash<QString, Overlay> m_overlay;
+
+    QFileSystemWatcher *m_watcher = nullptr;
+};
+
+#endif // SYMBOLINDEX_H
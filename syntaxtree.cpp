@@ -0,0 +1,645 @@
+#include "syntaxtree.h"
+#include "texteditor.h"
+
+#include <QRegularExpression>
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include <climits>
+
+// Lines inside multi-line strings or comments do not shape scopes
+bool SyntaxTree::isCode(const Line &l)
+{
+    return l.stateIn == Normal && !(l.flags & (Blank | Commented));
+}
+
+void SyntaxTree::Chunk::summarize()
+{
+    net = 0;
+    minPrefix = 0;
+    minIndent = 0xffff;
+    lastCode = -1;
+    symbols = 0;
+    for (int i = 0; i < lines.size(); ++i) {
+        const Line &l = lines[i];
+        minPrefix = qMin(minPrefix, net + l.minPrefix);
+        net += l.net;
+        if (isCode(l)) {
+            minIndent = qMin<int>(minIndent, l.indent);
+            lastCode = i;
+        }
+        if (l.kind != NoSymbol)
+            ++symbols;
+    }
+}
+
+void SyntaxTree::setDocument(const QTextDocument *doc)
+{
+    m_doc = doc;
+    rebuild();
+}
+
+void SyntaxTree::setLanguage(Language lang)
+{
+    m_language = lang;
+    m_structure = lang == Language::Python || lang == Language::YAML ? Indentation : Braces;
+    rebuild();
+}
+
+void SyntaxTree::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled)
+        return;
+    m_enabled = enabled;
+    if (enabled) {
+        rebuild();
+    } else {
+        m_chunks.clear();
+        m_count = 0;
+    }
+}
+
+void SyntaxTree::rebuild()
+{
+    m_chunks.clear();
+    m_count = 0;
+    if (!m_enabled || !m_doc)
+        return;
+
+    Chunk chunk;
+    quint8 state = Normal;
+    for (QTextBlock b = m_doc->begin(); b.isValid(); b = b.next()) {
+        const Line l = lex(b.text(), state);
+        state = l.stateOut;
+        chunk.lines.append(l);
+        if (chunk.lines.size() == ChunkLines) {
+            chunk.summarize();
+            m_chunks.append(std::move(chunk));
+            chunk = Chunk();
+        }
+    }
+    if (!chunk.lines.isEmpty() || m_chunks.isEmpty()) {
+        chunk.summarize();
+        m_chunks.append(std::move(chunk));
+    }
+    m_count = m_doc->blockCount();
+}
+
+void SyntaxTree::contentsChange(int pos, int removed, int added)
+{
+    Q_UNUSED(removed);
+    if (!m_enabled || !m_doc)
+        return;
+
+    // Lines [first, end] of the new text replace oldSpan lines of the old
+    const int last = m_doc->characterCount() - 1;
+    const int first = m_doc->findBlock(qMin(pos, last)).blockNumber();
+    const int end = m_doc->findBlock(qMin(pos + added, last)).blockNumber();
+    const int oldSpan = (end - first + 1) - (m_doc->blockCount() - m_count);
+    if (first < 0 || oldSpan < 0 || first + oldSpan > m_count) {
+        rebuild();
+        return;
+    }
+
+    quint8 state = first > 0 ? at(first - 1).stateOut : quint8(Normal);
+    QVector<Line> fresh;
+    fresh.reserve(end - first + 1);
+    QTextBlock b = m_doc->findBlockByNumber(first);
+    for (int i = first; i <= end; ++i, b = b.next()) {
+        fresh.append(lex(b.text(), state));
+        state = fresh.last().stateOut;
+    }
+    replaceLines(first, oldSpan, fresh);
+
+    // Only lines whose incoming lexer state changed need relexing; opening
+    // a block comment ripples, ordinary typing stops right here.  The chunk
+    // is located once and then walked alongside the blocks.
+    QVector<Line> ripple;
+    if (end + 1 < m_count) {
+        int start;
+        int c = chunkOf(end + 1, &start);
+        int i = end + 1 - start;
+        while (b.isValid() && c < m_chunks.size() && i < m_chunks[c].lines.size() &&
+               m_chunks[c].lines[i].stateIn != state) {
+            ripple.append(lex(b.text(), state));
+            state = ripple.last().stateOut;
+            b = b.next();
+            if (++i == m_chunks[c].lines.size()) {
+                ++c;
+                i = 0;
+            }
+        }
+    }
+    if (!ripple.isEmpty())
+        replaceLines(end + 1, ripple.size(), ripple);
+}
+
+int SyntaxTree::chunkOf(int line, int *first) const
+{
+    int start = 0;
+    for (int c = 0; c < m_chunks.size(); ++c) {
+        const int size = m_chunks[c].lines.size();
+        if (line < start + size) {
+            *first = start;
+            return c;
+        }
+        start += size;
+    }
+    *first = start - m_chunks.last().lines.size();
+    return m_chunks.size() - 1;
+}
+
+const SyntaxTree::Line &SyntaxTree::at(int line) const
+{
+    int first;
+    const int c = chunkOf(line, &first);
+    return m_chunks[c].lines[line - first];
+}
+
+void SyntaxTree::replaceLines(int first, int oldCount, const QVector<Line> &fresh)
+{
+    int start;
+    const int ci = chunkOf(first, &start);
+    int cj = ci;
+    int end = start + m_chunks[ci].lines.size();
+    while (first + oldCount > end && cj + 1 < m_chunks.size())
+        end += m_chunks[++cj].lines.size();
+
+    QVector<Line> merged;
+    for (int c = ci; c <= cj; ++c)
+        merged += m_chunks[c].lines;
+    const int offset = first - start;
+    merged = merged.mid(0, offset) + fresh + merged.mid(offset + oldCount);
+
+    // Absorb a neighbour rather than leave a sliver behind
+    if (merged.size() < ChunkLines / 2 && cj + 1 < m_chunks.size())
+        merged += m_chunks[++cj].lines;
+
+    QVector<Chunk> pieces;
+    const int count = qMax(1, int((merged.size() + ChunkLines - 1) / ChunkLines));
+    for (int p = 0; p < count; ++p) {
+        Chunk chunk;
+        const int from = int(merged.size()) * p / count;
+        const int to = int(merged.size()) * (p + 1) / count;
+        chunk.lines = merged.mid(from, to - from);
+        chunk.summarize();
+        pieces.append(std::move(chunk));
+    }
+    m_chunks.erase(m_chunks.begin() + ci, m_chunks.begin() + cj + 1);
+    for (int p = 0; p < pieces.size(); ++p)
+        m_chunks.insert(ci + p, std::move(pieces[p]));
+    m_count += fresh.size() - oldCount;
+}
+
+SyntaxTree::Line SyntaxTree::lex(const QString &text, quint8 stateIn) const
+{
+    Line l{0, 0, 0, stateIn, stateIn, NoSymbol, 0};
+
+    const bool cLike = m_language == Language::CPP || m_language == Language::JavaScript ||
+                       m_language == Language::Rust || m_language == Language::Go ||
+                       m_language == Language::CSS;
+    const bool hashComments = m_language == Language::Python || m_language == Language::YAML;
+    // C++, Rust and Go use single quotes for characters and lifetimes
+    const bool quoteStrings = m_language != Language::CPP && m_language != Language::Rust &&
+                              m_language != Language::Go;
+    const bool prose = m_language == Language::PlainText || m_language == Language::Markdown;
+    const QLatin1String lineComment = hashComments ? QLatin1String("#")
+                                      : cLike && m_language != Language::CSS ? QLatin1String("//")
+                                                                             : QLatin1String();
+    const QLatin1String blockOpen = cLike ? QLatin1String("/*")
+                                    : m_language == Language::HTML ? QLatin1String("<!--")
+                                                                   : QLatin1String();
+    const QLatin1String blockClose = cLike ? QLatin1String("*/") : QLatin1String("-->");
+
+    const int n = text.size();
+    int i = 0;
+    int indent = 0;
+    while (i < n && (text[i] == ' ' || text[i] == '\t')) {
+        indent += text[i] == '\t' ? 4 : 1;
+        ++i;
+    }
+    l.indent = quint16(qMin(indent, 0xfffe));
+    if (i == n)
+        l.flags |= Blank;
+    if (QStringView(text).mid(i).startsWith(commentPrefix()))
+        l.flags |= Commented;
+
+    quint8 state = stateIn;
+    int depth = 0;
+    int minDepth = 0;
+    bool firstCode = true;
+    QChar lastCode;
+    while (i < n) {
+        if (state == InBlockComment) {
+            const int close = text.indexOf(blockClose, i);
+            if (close < 0)
+                break;
+            i = close + blockClose.size();
+            state = Normal;
+            continue;
+        }
+        if (state == InTripleDouble || state == InTripleSingle) {
+            const int close = text.indexOf(state == InTripleDouble ? QLatin1String("\"\"\"")
+                                                                   : QLatin1String("'''"), i);
+            if (close < 0)
+                break;
+            i = close + 3;
+            state = Normal;
+            lastCode = '"';
+            continue;
+        }
+
+        const QChar c = text[i];
+        if (c.isSpace()) {
+            ++i;
+            continue;
+        }
+        const QStringView rest = QStringView(text).mid(i);
+        if (lineComment.size() && rest.startsWith(lineComment))
+            break;
+        if (blockOpen.size() && rest.startsWith(blockOpen)) {
+            state = InBlockComment;
+            i += blockOpen.size();
+            continue;
+        }
+        if (m_language == Language::Python &&
+            (rest.startsWith(QLatin1String("\"\"\"")) || rest.startsWith(QLatin1String("'''")))) {
+            state = c == '"' ? InTripleDouble : InTripleSingle;
+            i += 3;
+            continue;
+        }
+
+        // Prose has no strings; an apostrophe must not hide a brace
+        if (!prose && (c == '"' || (c == '\'' && quoteStrings) ||
+                       (c == '`' && m_language == Language::JavaScript))) {
+            int j = i + 1;
+            while (j < n && text[j] != c)
+                j += text[j] == '\\' ? 2 : 1;
+            i = j + 1;
+        } else if (!prose && c == '\'') {
+            // Character literal; a lone quote (Rust lifetime) is skipped
+            if (i + 2 < n && text[i + 2] == '\'')
+                i += 3;
+            else if (i + 1 < n && text[i + 1] == '\\') {
+                const int close = text.indexOf('\'', i + 2);
+                i = close < 0 ? n : close + 1;
+            } else
+                ++i;
+        } else {
+            if (c == '{') {
+                ++depth;
+                if (firstCode)
+                    l.flags |= StartsOpen;
+            } else if (c == '}') {
+                minDepth = qMin(minDepth, --depth);
+            }
+            ++i;
+        }
+        firstCode = false;
+        lastCode = c;
+    }
+
+    l.net = qint16(qBound(-32768, depth, 32767));
+    l.minPrefix = qint16(qMax(-32768, minDepth));
+    l.stateOut = state;
+    if (lastCode == ':')
+        l.flags |= EndsWithColon;
+    if (stateIn == Normal && !firstCode)
+        l.kind = classify(text);
+    return l;
+}
+
+SyntaxTree::SymbolKind SyntaxTree::classify(const QString &text) const
+{
+    // Cheap keyword checks first; the regexes only confirm candidates
+    const QString t = text.trimmed();
+    auto hasTypeKeyword = [&t]() {
+        static const char *const words[] = {"class", "struct", "enum", "interface",
+                                            "trait", "impl", "namespace"};
+        for (const char *w : words) {
+            if (t.contains(QLatin1String(w)))
+                return true;
+        }
+        return false;
+    };
+
+    switch (m_language) {
+    case Language::CPP:
+        if (t.contains('(') && !t.endsWith(';') &&
+            !symbolName(t, FunctionSymbol).isEmpty())
+            return FunctionSymbol;
+        break;
+    case Language::Python:
+        if (t.startsWith(QLatin1String("def ")) || t.startsWith(QLatin1String("async def ")))
+            return symbolName(t, FunctionSymbol).isEmpty() ? NoSymbol : FunctionSymbol;
+        if (t.startsWith(QLatin1String("class ")))
+            return symbolName(t, TypeSymbol).isEmpty() ? NoSymbol : TypeSymbol;
+        return NoSymbol;
+    default:
+        if ((t.contains(QLatin1String("fn ")) || t.contains(QLatin1String("func ")) ||
+             t.contains(QLatin1String("function"))) &&
+            !symbolName(t, FunctionSymbol).isEmpty())
+            return FunctionSymbol;
+        break;
+    }
+    if (hasTypeKeyword() && !symbolName(t, TypeSymbol).isEmpty())
+        return TypeSymbol;
+    return NoSymbol;
+}
+
+QString SyntaxTree::symbolName(const QString &text, SymbolKind kind) const
+{
+    // Handles: void Class::Func(), int* ptr(), std::vector<int> some_func(),
+    // with the brace optional for "brace on next line" styles
+    static const QRegularExpression cppFunc(
+        "(?xi)"
+        "(?: [A-Za-z_][A-Za-z0-9_<>:\\*&\\s]* \\s+ )?"  // Return type (optional)
+        " ( [A-Za-z_][A-Za-z0-9_\\s]* :: )? "            // Class/Namespace scope (optional)
+        " ( [A-Za-z_][A-Za-z0-9_]* ) "                   // Function name
+        " \\s* \\( [^\\)]* \\) "                        // Parameters
+        " \\s* (?: const )? \\s* (?: [{;]|$) ");         // End of signature
+    static const QRegularExpression pyFunc("^\\s*(?:async\\s+)?def\\s+([A-Za-z_][A-Za-z0-9_]*)\\s*\\(");
+    static const QRegularExpression pyClass("^\\s*class\\s+([A-Za-z_][A-Za-z0-9_]*)");
+    static const QRegularExpression anyFunc("(?:fn|func|def|function)\\s+([A-Za-z_][A-Za-z0-9_]*)\\s*\\(");
+    static const QRegularExpression anyType(
+        "(?:class|struct|enum|interface|trait|impl|namespace)\\s+([A-Za-z_][A-Za-z0-9_]*)");
+    static const QStringList cppKeywords = {"if", "while", "for", "switch", "catch", "else", "foreach"};
+
+    const QString t = text.trimmed();
+    if (kind == FunctionSymbol && m_language == Language::CPP) {
+        const QRegularExpressionMatch m = cppFunc.match(t);
+        if (!m.hasMatch() || cppKeywords.contains(m.captured(2)))
+            return QString();
+        return m.captured(1) + m.captured(2) + "()";
+    }
+    const bool python = m_language == Language::Python;
+    const QRegularExpression &re = kind == FunctionSymbol ? (python ? pyFunc : anyFunc)
+                                                          : (python ? pyClass : anyType);
+    const QRegularExpressionMatch m = re.match(t);
+    if (!m.hasMatch())
+        return QString();
+    return kind == FunctionSymbol ? m.captured(1) + "()" : m.captured(1);
+}
+
+SyntaxTree::Line SyntaxTree::lineInfo(int line) const
+{
+    if (m_enabled && line >= 0 && line < m_count)
+        return at(line);
+    const QTextBlock b = m_doc ? m_doc->findBlockByNumber(line) : QTextBlock();
+    return lex(b.isValid() ? b.text() : QString(), Normal);
+}
+
+int SyntaxTree::depthAt(int line) const
+{
+    int depth = 0;
+    int start = 0;
+    for (const Chunk &c : m_chunks) {
+        if (line < start + c.lines.size()) {
+            for (int k = 0; k < line - start; ++k)
+                depth += c.lines[k].net;
+            return depth;
+        }
+        depth += c.net;
+        start += c.lines.size();
+    }
+    return depth;
+}
+
+int SyntaxTree::nextCodeLine(int line) const
+{
+    if (line + 1 >= m_count)
+        return -1;
+    int start;
+    int c = chunkOf(line + 1, &start);
+    int k = line + 1 - start;
+    for (; c < m_chunks.size(); ++c, k = 0) {
+        const QVector<Line> &lines = m_chunks[c].lines;
+        for (; k < lines.size(); ++k) {
+            if (isCode(lines[k]))
+                return start + k;
+        }
+        start += lines.size();
+    }
+    return -1;
+}
+
+bool SyntaxTree::isFoldable(int line) const
+{
+    if (line < 0)
+        return false;
+    if (!m_enabled || line >= m_count) {
+        const Line l = lineInfo(line);
+        return m_structure == Braces ? l.net > 0 : bool(l.flags & EndsWithColon);
+    }
+
+    const Line &l = at(line);
+    if (m_structure == Braces) {
+        if (l.net > 0)
+            return true;
+        // "void f()" with its brace on the next line
+        return l.kind != NoSymbol && l.net == 0 && line + 1 < m_count &&
+               (at(line + 1).flags & StartsOpen) && at(line + 1).net > 0;
+    }
+    if (!isCode(l))
+        return false;
+    const int next = nextCodeLine(line);
+    return next >= 0 && at(next).indent > l.indent;
+}
+
+int SyntaxTree::scopeEnd(int line) const
+{
+    if (!m_enabled || line < 0 || line >= m_count)
+        return line;
+
+    int start;
+    int c = chunkOf(line, &start);
+    const Line &open = m_chunks[c].lines[line - start];
+
+    if (m_structure == Indentation) {
+        if (!isCode(open))
+            return line;
+        const int indent = open.indent;
+        int lastCode = line;
+        int k = line + 1 - start;
+        for (; c < m_chunks.size(); ++c, k = 0) {
+            const Chunk &chunk = m_chunks[c];
+            if (k == 0 && chunk.minIndent > indent) {
+                // Entirely inside the block
+                if (chunk.lastCode >= 0)
+                    lastCode = start + chunk.lastCode;
+            } else {
+                for (; k < chunk.lines.size(); ++k) {
+                    const Line &l = chunk.lines[k];
+                    if (!isCode(l))
+                        continue;
+                    if (l.indent <= indent)
+                        return lastCode;
+                    lastCode = start + k;
+                }
+            }
+            start += chunk.lines.size();
+        }
+        return lastCode;
+    }
+
+    if (open.net <= 0) {
+        if (isFoldable(line))
+            return scopeEnd(line + 1);
+        return line;
+    }
+
+    // The region ends on the first line whose running depth falls back to
+    // where this line started; chunks that never get that low are skipped.
+    const int target = depthAt(line);
+    int depth = target + open.net;
+    int k = line + 1 - start;
+    for (; c < m_chunks.size(); ++c, k = 0) {
+        const Chunk &chunk = m_chunks[c];
+        if (k == 0 && depth + chunk.minPrefix > target) {
+            depth += chunk.net;
+        } else {
+            for (; k < chunk.lines.size(); ++k) {
+                const Line &l = chunk.lines[k];
+                if (depth + l.minPrefix <= target)
+                    return start + k;
+                depth += l.net;
+            }
+        }
+        start += chunk.lines.size();
+    }
+    return m_count - 1;
+}
+
+SyntaxTree::Symbol SyntaxTree::enclosingSymbol(int line) const
+{
+    Symbol symbol;
+    if (!m_enabled || line < 0 || line >= m_count)
+        return symbol;
+
+    auto make = [&](int p, quint8 kind) {
+        symbol.line = p;
+        symbol.kind = SymbolKind(kind);
+        symbol.name = symbolName(m_doc->findBlockByNumber(p).text(), symbol.kind);
+        return symbol;
+    };
+
+    int start;
+    int c = chunkOf(line, &start);
+    const Line &cur = m_chunks[c].lines[line - start];
+    if (cur.kind != NoSymbol)
+        return make(line, cur.kind);
+
+    // Walk upwards keeping the lowest depth (or indent) seen between the
+    // candidate and the cursor line: a declaration encloses the cursor only
+    // if nothing in between closed its scope.
+    int k = line - start - 1;           // -1: from the end of chunk c
+    if (k < 0 && --c >= 0)
+        start -= m_chunks[c].lines.size();
+    if (m_structure == Braces) {
+        int depth = depthAt(line);      // depth at the start of line k + 1
+        int minSeen = depth;            // over lines (k, line]
+        int minAfter = depth;           // over lines (k + 1, line]
+        for (; c >= 0; --c) {
+            const Chunk &chunk = m_chunks[c];
+            if (k < 0)
+                k = chunk.lines.size() - 1;
+            if (k == chunk.lines.size() - 1 && chunk.symbols == 0) {
+                depth -= chunk.net;
+                minAfter = minSeen;
+                minSeen = qMin(minSeen, depth + chunk.minPrefix);
+            } else {
+                for (; k >= 0; --k) {
+                    const Line &l = chunk.lines[k];
+                    const int d = depth - l.net;
+                    if (l.kind != NoSymbol) {
+                        if (l.net > 0 && d < minSeen)
+                            return make(start + k, l.kind);
+                        const int next = start + k + 1;
+                        if (l.net == 0 && d < minAfter && next < m_count &&
+                            (at(next).flags & StartsOpen) && at(next).net > 0)
+                            return make(start + k, l.kind);
+                    }
+                    depth = d;
+                    minAfter = minSeen;
+                    minSeen = qMin(minSeen, d + l.minPrefix);
+                }
+            }
+            if (minSeen <= 0)
+                break;
+            k = -1;
+            if (c > 0)
+                start -= m_chunks[c - 1].lines.size();
+        }
+        return symbol;
+    }
+
+    // Indentation: a declaration encloses lines indented deeper than it
+    int minSeen = isCode(cur) ? cur.indent : INT_MAX;
+    for (; c >= 0; --c) {
+        const Chunk &chunk = m_chunks[c];
+        if (k < 0)
+            k = chunk.lines.size() - 1;
+        if (k == chunk.lines.size() - 1 && chunk.symbols == 0) {
+            minSeen = qMin(minSeen, chunk.minIndent);
+        } else {
+            for (; k >= 0; --k) {
+                const Line &l = chunk.lines[k];
+                if (!isCode(l))
+                    continue;
+                if (l.kind != NoSymbol && l.indent < minSeen)
+                    return make(start + k, l.kind);
+                minSeen = qMin<int>(minSeen, l.indent);
+            }
+        }
+        if (minSeen == 0)
+            break;
+        k = -1;
+        if (c > 0)
+            start -= m_chunks[c - 1].lines.size();
+    }
+    return symbol;
+}
+
+int SyntaxTree::indentAfter(int line) const
+{
+    const Line l = lineInfo(line);
+    const bool opens = l.net > 0 || (l.flags & EndsWithColon);
+    return l.indent + (opens ? 4 : 0);
+}
+
+bool SyntaxTree::isCommented(int line) const
+{
+    return lineInfo(line).flags & Commented;
+}
+
+QString SyntaxTree::commentPrefix() const
+{
+    switch (m_language) {
+    case Language::Python:
+    case Language::YAML:
+        return "#";
+    case Language::HTML:
+        return "<!--";
+    default:
+        return "//";
+    }
+}
+
+QVector<SyntaxTree::Symbol> SyntaxTree::declarations(const QString &text) const
+{
+    QVector<Symbol> out;
+    quint8 state = Normal;
+    int line = 0;
+    for (int from = 0; from <= text.size(); ++line) {
+        int to = text.indexOf('\n', from);
+        if (to < 0)
+            to = text.size();
+        const QString row = text.mid(from, to - from);
+        const Line l = lex(row, state);
+        state = l.stateOut;
+        if (l.kind != NoSymbol)
+            out.append({line, SymbolKind(l.kind), symbolName(row, SymbolKind(l.kind))});
+        from = to + 1;
+    }
+    return out;
+}
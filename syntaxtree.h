@@ -0,0 +1,107 @@
+#ifndef SYNTAXTREE_H
+#define SYNTAXTREE_H
+
+#include <QString>
+#include <QVector>
+
+class QTextDocument;
+enum class Language;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  SyntaxTree
+//  Incremental structure of a document for folding, breadcrumbs, auto-indent
+//  and comment toggling.  Each line is lexed once into a small summary (brace
+//  delta, lowest depth, indent, lexer state, declaration kind) and lines are
+//  grouped in chunks that carry aggregates, so scope queries skip whole
+//  chunks.  contentsChange() relexes only the edited lines plus any lines
+//  whose lexer state (block comments, triple quotes) actually changed.
+//  Block user data is left alone; long-line chunking owns it.
+// ─────────────────────────────────────────────────────────────────────────────
+class SyntaxTree
+{
+public:
+    enum SymbolKind : quint8 { NoSymbol, FunctionSymbol, TypeSymbol };
+
+    struct Symbol {
+        int line = -1;
+        SymbolKind kind = NoSymbol;
+        QString name;       // "Class::method()", "func()" or "Type"
+    };
+
+    void setDocument(const QTextDocument *doc);
+    void setLanguage(Language lang);
+
+    // Disabled trees keep no state; queries then lex the line they need
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    // Hook for QTextDocument::contentsChange
+    void contentsChange(int pos, int removed, int added);
+    void rebuild();
+
+    // Queries take block numbers
+    int lineCount() const { return m_count; }
+    int depthAt(int line) const;            // brace depth before the line
+    bool isFoldable(int line) const;
+    int scopeEnd(int line) const;           // last line of the region opened here
+    Symbol enclosingSymbol(int line) const;
+    int indentAfter(int line) const;        // indent for a new line typed after it
+    bool isCommented(int line) const;       // starts with commentPrefix()
+    QString commentPrefix() const;
+
+    // Declarations in standalone text, lexed with this tree's language but
+    // without touching its state.  Safe to call from worker threads on a
+    // tree that is not shared with the GUI.
+    QVector<Symbol> declarations(const QString &text) const;
+
+private:
+    enum Structure { Braces, Indentation };
+    enum LexState : quint8 { Normal, InBlockComment, InTripleDouble, InTripleSingle };
+    enum LineFlag : quint8 {
+        Blank         = 0x01,
+        EndsWithColon = 0x02,
+        StartsOpen    = 0x04,   // first code character is '{'
+        Commented     = 0x08,
+    };
+
+    struct Line {
+        qint16 net;         // '{' minus '}' outside strings and comments
+        qint16 minPrefix;   // lowest running depth inside the line, <= 0
+        quint16 indent;     // leading whitespace in columns, tabs as 4
+        quint8 stateIn;
+        quint8 stateOut;
+        quint8 kind;        // SymbolKind
+        quint8 flags;
+    };
+
+    struct Chunk {
+        QVector<Line> lines;
+        int net = 0;
+        int minPrefix = 0;          // lowest depth reached, relative to start
+        int minIndent = 0xffff;     // over code lines
+        int lastCode = -1;          // offset of the last code line
+        int symbols = 0;
+        void summarize();
+    };
+
+    static constexpr int ChunkLines = 256;
+
+    Line lex(const QString &text, quint8 stateIn) const;
+    SymbolKind classify(const QString &text) const;
+    QString symbolName(const QString &text, SymbolKind kind) const;
+    Line lineInfo(int line) const;
+    const Line &at(int line) const;
+    int chunkOf(int line, int *first) const;
+    void replaceLines(int first, int oldCount, const QVector<Line> &fresh);
+    int nextCodeLine(int line) const;
+    static bool isCode(const Line &l);
+
+    const QTextDocument *m_doc = nullptr;
+    Language m_language{};
+    Structure m_structure = Braces;
+    bool m_enabled = true;
+    QVector<Chunk> m_chunks;
+    int m_count = 0;
+};
+
+#endif // SYNTAXTREE_H
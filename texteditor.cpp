@@ -2,13 +2,25 @@
 #include "hexeditor.h"
 #include "disassembler.h"
 #include "binaryinspector.h"
+#include "checksum.h"
+#include "hexdiff.h"
+#include "hextemplate.h"
+#include "hexinspector.h"
 #include "markdownviewer.h"
 #include "linenumberarea.h"
 #include "aiautocomplete.h"
 #include "aisettingsdialog.h"
+#include "linediff.h"
+#include "startupprofiler.h"
+#include "perfmonitor.h"
+#include "uiupdatescheduler.h"
+#include <QActionGroup>
 #include <QApplication>
 #include <QCloseEvent>
+#include <QClipboard>
 #include <QColorDialog>
+#include <QComboBox>
+#include <QDialog>
 #include <QDir>
 #include <QDockWidget>
 #include <QFileDialog>
@@ -22,12 +34,16 @@
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QInputDialog>
+#include <QListWidget>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QMimeData>
 #include <QPainter>
 #include <QSoundEffect>
 #include "audiomonitor.h"
+#include <QJsonArray>
 #include <QPainterPath>
+#include <QPointer>
 #include <QProcessEnvironment>
 #include <QPropertyAnimation>
 #include <QPushButton>
@@ -36,21 +52,30 @@
 #include <QSaveFile>
 #include <QScrollBar>
 #include <QSettings>
+#include <QDataStream>
+#include <QStandardPaths>
 #include <QSplitter>
 #include <QStackedWidget>
 #include <QStatusBar>
+#include <QStringMatcher>
 #include <QTextBlock>
 #include <QDesktopServices>
 #include <QTextStream>
+#include <QThread>
 #include <QTimer>
 #include <QToolBar>
 #include <QVariantAnimation>
 #include <QGraphicsOpacityEffect>
 #include <QEasingCurve>
 #include <QTabBar>
+#include <QUrl>
+#include <QToolButton>
+#include <QToolTip>
 #include <QTreeView>
 #include <QVBoxLayout>
 #include <QWheelEvent>
+#include <algorithm>
+#include <memory>
 
 // ============================================================
 // Language Auto-Detection
@@ -135,9 +160,16 @@ CodeEditor::CodeEditor(QWidget *parent)
           &CodeEditor::updateLineNumberAreaWidth);
   connect(this, &CodeEditor::updateRequest, this,
           &CodeEditor::updateLineNumberArea);
+
+  // Holding an arrow key fires cursorPositionChanged per auto-repeat; the
+  // scheduler folds those into one current-line refresh per frame.
+  updates = new UiUpdateScheduler(this);
+  updates->setTask(UpdateCurrentLine, [this]() { highlightCurrentLine(); });
   connect(this, &CodeEditor::cursorPositionChanged, this,
-          &CodeEditor::highlightCurrentLine);
+          [this]() { updates->schedule(UpdateCurrentLine); });
 
+  // The minimap repaints the whole document, so it waits for scrolling and
+  // typing to pause rather than following every frame
   QTimer *minimapUpdateTimer = new QTimer(this);
   minimapUpdateTimer->setSingleShot(true);
   minimapUpdateTimer->setInterval(50);
@@ -147,13 +179,188 @@ CodeEditor::CodeEditor(QWidget *parent)
   });
   connect(this, &CodeEditor::updateRequest, this,
           [minimapUpdateTimer]() { minimapUpdateTimer->start(); });
+  connect(document(), &QTextDocument::contentsChange, this,
+          [this](int pos, int removed, int added) {
+            for (DecorationLayer &layer : decorations)
+              layer.shift(pos, removed, added);
+            multiCursor.follow(pos, removed, added);
+            syntax.contentsChange(pos, removed, added);
+            PerfMonitor::instance().documentChanged();
+            if (chunked)
+              followContinuations(pos, added);
+          });
+  syntax.setDocument(document());
 
   updateLineNumberAreaWidth(0);
   highlightCurrentLine();
   setTabStopDistance(fontMetrics().horizontalAdvance(' ') * 4);
 }
 
-void CodeEditor::setLanguage(Language lang) { currentLanguage = lang; }
+void CodeEditor::setLanguage(Language lang) {
+  currentLanguage = lang;
+  syntax.setLanguage(lang);
+  foldingArea->update();
+}
+
+namespace {
+// Marks a block that continues the logical line of the block before it
+class ChunkContinuation : public QTextBlockUserData {};
+} // namespace
+
+void CodeEditor::setChunkedText(const QString &text,
+                                const QVector<int> &continuations) {
+  chunked = false;
+  setPlainText(text);
+  chunked = !continuations.isEmpty();
+  continuationBlocks = continuations;
+  chunkBlockCount = document()->blockCount();
+
+  QTextBlock block = document()->begin();
+  int number = 0;
+  for (int c : continuations) {
+    while (block.isValid() && number < c) {
+      block = block.next();
+      ++number;
+    }
+    if (block.isValid())
+      block.setUserData(new ChunkContinuation);
+  }
+}
+
+bool CodeEditor::isContinuation(const QTextBlock &block) {
+  return dynamic_cast<ChunkContinuation *>(block.userData()) != nullptr;
+}
+
+int CodeEditor::logicalLineNumber(const QTextBlock &block) const {
+  if (!chunked)
+    return block.blockNumber();
+  // Every continuation up to this block folds one block into the line above
+  const int number = block.blockNumber();
+  return number - int(std::upper_bound(continuationBlocks.cbegin(),
+                                       continuationBlocks.cend(), number) -
+                      continuationBlocks.cbegin());
+}
+
+QTextBlock CodeEditor::blockForLogicalLine(int line) const {
+  if (!chunked)
+    return document()->findBlockByNumber(line);
+  // continuationBlocks[j] - j is one past the logical line continuation j
+  // belongs to and never decreases, so the continuations ahead of the
+  // line's first block are a prefix found by binary search
+  int lo = 0;
+  int hi = continuationBlocks.size();
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (continuationBlocks[mid] - mid <= line)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return document()->findBlockByNumber(line + lo);
+}
+
+void CodeEditor::followContinuations(int pos, int added) {
+  // Only the blocks the edit now spans are rescanned; marks before it stay
+  // put and those after it shift by the change in block count
+  const int count = document()->blockCount();
+  const int delta = count - chunkBlockCount;
+  chunkBlockCount = count;
+  const int first = document()->findBlock(pos).blockNumber();
+  QTextBlock last = document()->findBlock(pos + added);
+  const int newLast = last.isValid() ? last.blockNumber() : count - 1;
+  const int oldLast = newLast - delta;
+
+  auto from = std::lower_bound(continuationBlocks.begin(),
+                               continuationBlocks.end(), first);
+  auto to = std::upper_bound(from, continuationBlocks.end(), oldLast);
+  for (auto it = to; it != continuationBlocks.end(); ++it)
+    *it += delta;
+  int at = int(from - continuationBlocks.begin());
+  continuationBlocks.erase(from, to);
+
+  QTextBlock block = document()->findBlockByNumber(first);
+  for (int n = first; n <= newLast && block.isValid();
+       ++n, block = block.next()) {
+    if (isContinuation(block))
+      continuationBlocks.insert(at++, n);
+  }
+}
+
+int CodeEditor::logicalColumn(const QTextCursor &cursor) const {
+  QTextBlock block = cursor.block();
+  int column = cursor.positionInBlock();
+  while (chunked && isContinuation(block) && block.previous().isValid()) {
+    block = block.previous();
+    column += block.length() - 1;
+  }
+  return column;
+}
+
+int CodeEditor::documentPosition(int logical) const {
+  if (!chunked)
+    return logical;
+  // Continuation j starts j + 1 separators further into the document than
+  // into logicalText(); count the continuations starting at or before
+  int lo = 0;
+  int hi = continuationBlocks.size();
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    const int start =
+        document()->findBlockByNumber(continuationBlocks[mid]).position() -
+        (mid + 1);
+    if (start <= logical)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return logical + lo;
+}
+
+QMimeData *CodeEditor::createMimeDataFromSelection() const {
+  const QTextCursor cursor = textCursor();
+  if (!chunked || !cursor.hasSelection())
+    return QPlainTextEdit::createMimeDataFromSelection();
+  // Chunk boundaries are for display only and are not copied
+  const int start = cursor.selectionStart();
+  const int end = cursor.selectionEnd();
+  QString text;
+  for (QTextBlock b = document()->findBlock(start);
+       b.isValid() && b.position() <= end; b = b.next()) {
+    if (b.position() > start && !isContinuation(b))
+      text += '\n';
+    const int from = qMax(start, b.position()) - b.position();
+    const int to = qMin(end, b.position() + b.length() - 1) - b.position();
+    text += b.text().mid(from, to - from);
+  }
+  QMimeData *mime = new QMimeData;
+  mime->setText(text);
+  return mime;
+}
+
+QString CodeEditor::logicalText() const {
+  if (!chunked)
+    return toPlainText();
+  QString text;
+  text.reserve(document()->characterCount());
+  for (QTextBlock b = document()->begin(); b.isValid(); b = b.next()) {
+    if (b != document()->begin() && !isContinuation(b))
+      text += '\n';
+    text += b.text();
+  }
+  return text;
+}
+
+void CodeEditor::setEnabledFeatures(int f) {
+  features = f;
+  syntax.setEnabled(hasFeature(FeatureFolding) || hasFeature(FeatureBreadcrumbs));
+  if (!hasFeature(FeatureMiniMap) && miniMap->isVisible()) {
+    miniMap->hide();
+    QResizeEvent event(size(), size());
+    QApplication::sendEvent(this, &event);
+  }
+  foldingArea->update();
+  viewport()->update();
+}
 
 void CodeEditor::applyTheme(const ColorTheme &theme) {
   currentTheme = theme;
@@ -201,10 +408,396 @@ void CodeEditor::updateLineNumberArea(const QRect &rect, int dy) {
 }
 
 void CodeEditor::setSearchSelections(const QList<QTextCursor> &selections) {
-  searchSelections = selections;
+  QVector<Decoration> hits;
+  hits.reserve(selections.size());
+  for (const QTextCursor &c : selections) {
+    if (c.hasSelection())
+      hits.append({c.selectionStart(), c.selectionEnd() - c.selectionStart(),
+                   DecoSearchHit});
+  }
+  std::sort(hits.begin(), hits.end(),
+            [](const Decoration &a, const Decoration &b) { return a.start < b.start; });
+  currentSearchHit = -1;
+  setDecorations(SearchLayer, hits);
   highlightCurrentLine();
 }
 
+void CodeEditor::setDiagnostics(const QVector<LspDiagnostic> &list) {
+  diagnostics = list;
+  const int lastPos = document()->characterCount() - 1;
+  auto toPosition = [&](int line, int character) {
+    const QTextBlock b = document()->findBlockByNumber(line);
+    if (!b.isValid())
+      return lastPos;
+    return b.position() + qBound(0, character, b.length() - 1);
+  };
+
+  // Most severe first where ranges start together; overlaps are clipped so
+  // the layer stays sorted and disjoint
+  QVector<Decoration> marks;
+  marks.reserve(list.size());
+  for (const LspDiagnostic &d : list) {
+    const int start = toPosition(d.startLine, d.startCharacter);
+    // Zero-width diagnostics still get one character of underline
+    const int end = qMax(qMin(start + 1, lastPos), toPosition(d.endLine, d.endCharacter));
+    const DecorationStyle style = d.severity == 1   ? DecoDiagnosticError
+                                  : d.severity == 2 ? DecoDiagnosticWarning
+                                                    : DecoDiagnosticInfo;
+    if (end > start)
+      marks.append({start, end - start, style});
+  }
+  std::sort(marks.begin(), marks.end(), [](const Decoration &a, const Decoration &b) {
+    return a.start != b.start ? a.start < b.start : a.style < b.style;
+  });
+  int out = 0;
+  for (int i = 0; i < marks.size(); ++i) {
+    Decoration d = marks[i];
+    if (out > 0) {
+      const int prevEnd = marks[out - 1].end();
+      if (d.end() <= prevEnd)
+        continue;
+      if (d.start < prevEnd) {
+        d.length = d.end() - prevEnd;
+        d.start = prevEnd;
+      }
+    }
+    marks[out++] = d;
+  }
+  marks.resize(out);
+  setDecorations(DiagnosticLayer, marks);
+}
+
+bool CodeEditor::viewportEvent(QEvent *event) {
+  if (event->type() == QEvent::ToolTip && !diagnostics.isEmpty()) {
+    QHelpEvent *help = static_cast<QHelpEvent *>(event);
+    const QTextCursor c = cursorForPosition(help->pos());
+    const int line = c.blockNumber();
+    const int character = c.positionInBlock();
+    QStringList messages;
+    for (const LspDiagnostic &d : std::as_const(diagnostics)) {
+      const bool afterStart = line > d.startLine ||
+                              (line == d.startLine && character >= d.startCharacter);
+      const bool beforeEnd = line < d.endLine ||
+                             (line == d.endLine && character <= d.endCharacter);
+      if (afterStart && beforeEnd)
+        messages.append(d.message);
+    }
+    if (messages.isEmpty())
+      QToolTip::hideText();
+    else
+      QToolTip::showText(help->globalPos(), messages.join('\n'), viewport());
+    return true;
+  }
+  return QPlainTextEdit::viewportEvent(event);
+}
+
+void CodeEditor::setDecorations(DecorationLayerId layer,
+                                QVector<Decoration> ranges) {
+  // Repaint only the rows the old and new ranges cover
+  updateDecorationRows(decorations[layer].ranges());
+  decorations[layer].set(std::move(ranges));
+  updateDecorationRows(decorations[layer].ranges());
+}
+
+QPair<int, int> CodeEditor::visibleRange() const {
+  const QTextBlock first = firstVisibleBlock();
+  const QTextBlock last =
+      cursorForPosition(viewport()->rect().bottomRight()).block();
+  return {first.position(), last.position() + last.length()};
+}
+
+void CodeEditor::updateDecorationRows(const QVector<Decoration> &ranges) {
+  if (ranges.isEmpty())
+    return;
+  const QPair<int, int> visible = visibleRange();
+  auto it = std::partition_point(
+      ranges.cbegin(), ranges.cend(),
+      [&](const Decoration &d) { return d.end() < visible.first; });
+
+  QRegion dirty;
+  int rows = 0;
+  QTextCursor c(document());
+  for (; it != ranges.cend() && it->start <= visible.second; ++it) {
+    if (++rows > 256) {
+      viewport()->update();
+      return;
+    }
+    c.setPosition(qMin(it->start, document()->characterCount() - 1));
+    const int top = cursorRect(c).top();
+    c.setPosition(qMin(it->end(), document()->characterCount() - 1));
+    const int bottom = cursorRect(c).bottom();
+    dirty += QRect(0, top, viewport()->width(), bottom - top + 1);
+  }
+  if (!dirty.isEmpty())
+    viewport()->update(dirty);
+}
+
+QColor CodeEditor::decorationColor(DecorationStyle style) const {
+  switch (style) {
+  case DecoCurrentLine:
+    return currentTheme.currentLine.isValid() ? currentTheme.currentLine
+                                              : QColor(Qt::yellow).lighter(160);
+  case DecoSearchHit:
+    return QColor(62, 62, 66); // Subtle secondary highlight
+  case DecoCurrentSearchHit:
+    return QColor(163, 115, 20, 150); // Golden highlight for current match
+  case DecoBracketMatch:
+    return QColor(128, 128, 128, 90);
+  case DecoSelection:
+    return currentTheme.selection.isValid() ? currentTheme.selection
+                                            : palette().highlight().color();
+  case DecoDiagnosticError:
+    return QColor(244, 71, 71);
+  case DecoDiagnosticWarning:
+    return QColor(205, 173, 0);
+  case DecoDiagnosticInfo:
+    return QColor(55, 148, 255);
+  default:
+    return currentTheme.foreground.isValid() ? currentTheme.foreground
+                                             : QColor(Qt::black);
+  }
+}
+
+void CodeEditor::paintDecorations(QPainter &painter, const QRect &clip,
+                                  bool carets) {
+  const QPair<int, int> visible = visibleRange();
+  const int lastPos = document()->characterCount() - 1;
+  const int width = viewport()->width();
+  QTextCursor c(document());
+
+  for (int layer = 0; layer < LayerCount; ++layer) {
+    if (carets && layer != CaretLayer)
+      continue;
+    const QVector<Decoration> &ranges = decorations[layer].ranges();
+    for (int i = decorations[layer].firstFrom(visible.first);
+         i < ranges.size() && ranges[i].start <= visible.second; ++i) {
+      const Decoration &d = ranges[i];
+      if ((d.style == DecoExtraCaret) != carets)
+        continue;
+      c.setPosition(qMin(d.start, lastPos));
+      const QRect a = cursorRect(c);
+
+      if (d.style == DecoExtraCaret) {
+        painter.setPen(decorationColor(d.style));
+        painter.drawLine(a.topLeft(), a.bottomLeft());
+        painter.drawLine(a.topLeft() + QPoint(1, 0), a.bottomLeft() + QPoint(1, 0));
+        continue;
+      }
+      if (d.style == DecoCurrentLine) {
+        painter.fillRect(QRect(0, a.top(), width, a.height()),
+                         decorationColor(d.style));
+        continue;
+      }
+
+      c.setPosition(qMin(d.end(), lastPos));
+      const QRect b = cursorRect(c);
+      if (b.bottom() < clip.top() || a.top() > clip.bottom())
+        continue;
+      const QColor color = decorationColor(d.style);
+      if (d.style >= DecoDiagnosticError && d.style <= DecoDiagnosticInfo) {
+        // Squiggle under each row of the range
+        painter.setPen(color);
+        auto squiggle = [&painter](int x1, int x2, int y) {
+          QPolygon wave;
+          for (int x = x1, up = 0; x <= x2; x += 2, up ^= 1)
+            wave << QPoint(x, y - up * 2);
+          painter.drawPolyline(wave);
+        };
+        if (a.top() == b.top()) {
+          squiggle(a.left(), b.left(), a.bottom());
+        } else {
+          squiggle(a.left(), width, a.bottom());
+          for (int y = a.bottom() + a.height(); y < b.top(); y += a.height())
+            squiggle(0, width, y);
+          squiggle(0, b.left(), b.bottom());
+        }
+        continue;
+      }
+      if (a.top() == b.top()) {
+        painter.fillRect(QRect(a.left(), a.top(), b.left() - a.left(), a.height()),
+                         color);
+      } else {
+        // Spans rows: tail of the first, full middle rows, head of the last
+        painter.fillRect(QRect(a.left(), a.top(), width - a.left(), a.height()),
+                         color);
+        if (b.top() > a.bottom() + 1)
+          painter.fillRect(QRect(0, a.bottom() + 1, width, b.top() - a.bottom() - 1),
+                           color);
+        painter.fillRect(QRect(0, b.top(), b.left(), b.height()), color);
+      }
+      if (d.style == DecoBracketMatch) {
+        painter.setPen(decorationColor(DecoExtraCaret));
+        painter.drawRect(QRect(a.left(), a.top(), b.left() - a.left() - 1,
+                               a.height() - 1));
+      }
+    }
+  }
+  paintBlockSelection(painter, carets);
+}
+
+void CodeEditor::applyExternalText(const QString &text) {
+  QStringList oldLines;
+  oldLines.reserve(document()->blockCount());
+  for (QTextBlock b = document()->begin(); b.isValid(); b = b.next())
+    oldLines.append(b.text());
+  const QStringList newLines = text.split('\n');
+  const QVector<LineDiff::Hunk> hunks = LineDiff::compute(oldLines, newLines);
+  if (hunks.isEmpty())
+    return;
+
+  // Apply back to front so block numbers of earlier hunks stay valid. The
+  // whole reload is one undo step.
+  QTextCursor cursor(document());
+  cursor.beginEditBlock();
+  for (int h = hunks.size() - 1; h >= 0; --h) {
+    const LineDiff::Hunk &hunk = hunks[h];
+    const QString replacement =
+        newLines.mid(hunk.newStart, hunk.newCount).join('\n');
+    const int oldEnd = hunk.oldStart + hunk.oldCount;
+
+    if (hunk.oldCount == 0) {
+      if (hunk.oldStart < oldLines.size()) {
+        cursor.setPosition(
+            document()->findBlockByNumber(hunk.oldStart).position());
+        cursor.insertText(replacement + '\n');
+      } else {
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText('\n' + replacement);
+      }
+      continue;
+    }
+
+    const QTextBlock first = document()->findBlockByNumber(hunk.oldStart);
+    if (oldEnd < oldLines.size()) {
+      cursor.setPosition(first.position());
+      cursor.setPosition(document()->findBlockByNumber(oldEnd).position(),
+                         QTextCursor::KeepAnchor);
+      cursor.insertText(hunk.newCount > 0 ? replacement + '\n' : QString());
+    } else if (hunk.newCount > 0 || hunk.oldStart == 0) {
+      cursor.setPosition(first.position());
+      cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+      cursor.insertText(replacement);
+    } else {
+      // Dropping trailing lines also drops the newline in front of them
+      cursor.setPosition(first.position() - 1);
+      cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+      cursor.removeSelectedText();
+    }
+  }
+  cursor.endEditBlock();
+}
+
+bool CodeEditor::startTailFollow(int maxLines) {
+  QFile file(fileName);
+  if (fileName.isEmpty() || !file.open(QFile::ReadOnly))
+    return false;
+
+  // Only the last maxLines lines are kept, so read just enough of the end
+  // to cover them, sizing lines from the last 64 KB with room to spare; a
+  // multi-GB log is never read whole
+  const qint64 size = file.size();
+  qint64 start = 0;
+  if (maxLines > 0 && size > 0) {
+    const qint64 sample = qMin(size, qint64(64 * 1024));
+    file.seek(size - sample);
+    const qint64 lines = qMax(qint64(1), qint64(file.read(sample).count('\n')));
+    start = qMax(qint64(0), size - 2 * (sample / lines + 1) * maxLines);
+  }
+
+  // Start from a fresh copy of the file so the offset matches the document
+  if (!file.seek(start))
+    return false;
+  QByteArray bytes = file.readAll();
+  tailOffset = start + bytes.size();
+  if (start > 0) {
+    // Begin on a whole line
+    const int newline = bytes.indexOf('\n');
+    bytes = newline < 0 ? QByteArray() : bytes.mid(newline + 1);
+  }
+  tailDecoder = QStringDecoder(QStringDecoder::Utf8);
+  QString text = tailDecoder.decode(bytes);
+  text.remove('\r');
+
+  // Log lines never need undo, and the block cap turns the document into a
+  // ring that drops the oldest lines as new ones arrive.
+  document()->setUndoRedoEnabled(false);
+  document()->setMaximumBlockCount(qMax(0, maxLines));
+  setChunkedText(text, {});
+  document()->setModified(false);
+  setReadOnly(true);
+  tailFollowing = true;
+
+  if (!tailTimer) {
+    // File watcher signals arrive in bursts on busy logs; read at most once
+    // per interval and pick up everything written in between.
+    tailTimer = new QTimer(this);
+    tailTimer->setSingleShot(true);
+    tailTimer->setInterval(100);
+    connect(tailTimer, &QTimer::timeout, this, &CodeEditor::readTail);
+  }
+  verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+  return true;
+}
+
+void CodeEditor::stopTailFollow() {
+  if (!tailFollowing)
+    return;
+  tailFollowing = false;
+  tailTimer->stop();
+  document()->setMaximumBlockCount(0);
+  setReadOnly(false);
+
+  // A capped document no longer holds the whole file; reload it so editing
+  // and saving work on the real contents again, chunked like any lean load.
+  QFile file(fileName);
+  if (file.open(QFile::ReadOnly)) {
+    QString text = QString::fromUtf8(file.readAll());
+    QVector<int> continuations;
+    if (!hasFeature(FeatureLongLines))
+      text = LargeFilePolicy::chunkLongLines(text, &continuations);
+    setChunkedText(text, continuations);
+  }
+  document()->setUndoRedoEnabled(true);
+  document()->setModified(false);
+}
+
+void CodeEditor::scheduleTailRead() {
+  if (tailFollowing && !tailTimer->isActive())
+    tailTimer->start();
+}
+
+void CodeEditor::readTail() {
+  QFile file(fileName);
+  if (!file.open(QFile::ReadOnly))
+    return;
+
+  if (file.size() < tailOffset) {
+    // Truncated or rotated – follow the new file from its start
+    tailOffset = 0;
+    tailDecoder = QStringDecoder(QStringDecoder::Utf8);
+    clear();
+  }
+  if (file.size() == tailOffset || !file.seek(tailOffset))
+    return;
+
+  const QByteArray bytes = file.readAll();
+  tailOffset += bytes.size();
+  // The decoder is stateful, so a UTF-8 sequence split across reads is fine
+  QString text = tailDecoder.decode(bytes);
+  text.remove('\r');
+  if (text.isEmpty())
+    return;
+
+  QScrollBar *bar = verticalScrollBar();
+  const bool atBottom = bar->value() >= bar->maximum();
+  QTextCursor cursor(document());
+  cursor.movePosition(QTextCursor::End);
+  cursor.insertText(text);
+  document()->setModified(false);
+  if (atBottom)
+    bar->setValue(bar->maximum());
+}
+
 void CodeEditor::resizeEvent(QResizeEvent *e) {
   QPlainTextEdit::resizeEvent(e);
   QRect cr = contentsRect();
@@ -223,47 +816,59 @@ void CodeEditor::resizeEvent(QResizeEvent *e) {
 }
 
 void CodeEditor::highlightCurrentLine() {
-  QList<QTextEdit::ExtraSelection> extraSelections;
-  
-  // Search highlights
-  for (const QTextCursor &cursor : searchSelections) {
-    QTextEdit::ExtraSelection selection;
-    selection.format.setBackground(QColor(62, 62, 66)); // Subtle secondary highlight
-    selection.cursor = cursor;
-    extraSelections.append(selection);
-  }
-
-  if (!isReadOnly()) {
-    QTextEdit::ExtraSelection selection;
-    QColor lineColor = currentTheme.currentLine.isValid()
-                           ? currentTheme.currentLine
-                           : QColor(Qt::yellow).lighter(160);
-    selection.format.setBackground(lineColor);
-    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-    selection.cursor = textCursor();
-    selection.cursor.clearSelection();
-    
-    // If the current cursor is within a search match, highlight it more prominently
-    for (int i = 0; i < searchSelections.size(); ++i) {
-        if (searchSelections[i].selectionStart() == selection.cursor.selectionStart() &&
-            searchSelections[i].selectionEnd() == selection.cursor.selectionEnd()) {
-            selection.format.setBackground(QColor(163, 115, 20, 150)); // Golden highlight for current match
-            break;
-        }
+  const QTextCursor cursor = textCursor();
+
+  // The current search hit is whichever one the main cursor has selected
+  DecorationLayer &hits = decorations[SearchLayer];
+  const int hit = cursor.hasSelection()
+                      ? hits.indexOf(cursor.selectionStart(),
+                                     cursor.selectionEnd() - cursor.selectionStart())
+                      : -1;
+  if (currentSearchHit >= hits.ranges().size() ||
+      (currentSearchHit >= 0 &&
+       hits.ranges()[currentSearchHit].style != DecoCurrentSearchHit)) {
+    // An edit dropped hits before it; find where the styled one went
+    auto it = std::find_if(hits.ranges().cbegin(), hits.ranges().cend(),
+                           [](const Decoration &d) { return d.style == DecoCurrentSearchHit; });
+    currentSearchHit = it == hits.ranges().cend() ? -1 : int(it - hits.ranges().cbegin());
+  }
+  if (hit != currentSearchHit) {
+    QVector<Decoration> changed;
+    if (currentSearchHit >= 0) {
+      hits.restyle(currentSearchHit, DecoSearchHit);
+      changed.append(hits.ranges()[currentSearchHit]);
     }
-    
-    extraSelections.append(selection);
+    if (hit >= 0) {
+      hits.restyle(hit, DecoCurrentSearchHit);
+      changed.append(hits.ranges()[hit]);
+    }
+    currentSearchHit = hit;
+    std::sort(changed.begin(), changed.end(),
+              [](const Decoration &a, const Decoration &b) { return a.start < b.start; });
+    updateDecorationRows(changed);
   }
-  setExtraSelections(extraSelections);
+
+  QVector<Decoration> line;
+  if (!isReadOnly())
+    line.append({cursor.position(), 0, DecoCurrentLine});
+  setDecorations(CurrentLineLayer, line);
+  matchBrackets();
 }
 
 void CodeEditor::paintEvent(QPaintEvent *e) {
+  PerfMonitor::Scope perf(PerfMonitor::EditorPaint);
+  {
+    // Backgrounds go under the text, so they are painted first
+    QPainter under(viewport());
+    paintDecorations(under, e->rect(), false);
+  }
   QPlainTextEdit::paintEvent(e);
 
   QPainter painter(viewport());
   painter.setRenderHint(QPainter::Antialiasing);
 
-  QTextBlock block = firstVisibleBlock();
+  QTextBlock block = hasFeature(FeatureColorSwatches) ? firstVisibleBlock()
+                                                      : QTextBlock();
   QPointF offset = contentOffset();
   QRegularExpression hexRegex("#([0-9A-Fa-f]{3}|[0-9A-Fa-f]{6}|[0-9A-Fa-f]{8})\\b");
 
@@ -297,18 +902,13 @@ void CodeEditor::paintEvent(QPaintEvent *e) {
     block = block.next();
   }
 
-  if (!extraCursors.isEmpty()) {
-      QColor cColor = currentTheme.foreground.isValid() ? currentTheme.foreground : Qt::black;
-      painter.setPen(cColor);
-      for (const QTextCursor &c : extraCursors) {
-          QRect rect = cursorRect(c);
-          painter.drawLine(rect.topLeft(), rect.bottomLeft());
-          painter.drawLine(rect.topLeft() + QPoint(1,0), rect.bottomLeft() + QPoint(1,0));
-      }
-  }
+  painter.setRenderHint(QPainter::Antialiasing, false);
+  paintDecorations(painter, e->rect(), true);
+  PerfMonitor::instance().editorPainted();
 }
 
 void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event) {
+  PerfMonitor::Scope perf(PerfMonitor::GutterPaint);
   QPainter painter(lineNumberArea);
   painter.setRenderHint(QPainter::TextAntialiasing, false);
   QColor bgColor = currentTheme.lineNumberBg.isValid()
@@ -327,16 +927,20 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event) {
   int bottom = top + qRound(blockBoundingRect(block).height());
   int lineHeight = fontMetrics().height();
   int width = lineNumberArea->width() - 5;
-  int currentLine = textCursor().blockNumber();
+  int currentLine = logicalLineNumber(textCursor().block());
 
   while (block.isValid() && top <= event->rect().bottom()) {
-    if (block.isVisible() && bottom >= event->rect().top()) {
-      if (blockNumber == currentLine)
+    // Chunk continuations share their logical line's number, so leave the
+    // gutter blank for them.
+    if (block.isVisible() && bottom >= event->rect().top() &&
+        !(chunked && isContinuation(block))) {
+      int line = chunked ? logicalLineNumber(block) : blockNumber;
+      if (line == currentLine)
         painter.setPen(QColor(255, 255, 255));
       else
         painter.setPen(fgColor);
       painter.drawText(0, top, width, lineHeight, Qt::AlignRight,
-                       QString::number(blockNumber + 1));
+                       QString::number(line + 1));
     }
     block = block.next();
     top = bottom;
@@ -349,11 +953,7 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event) {
 // Code Folding
 // ============================================================
 bool CodeEditor::isFoldable(const QTextBlock &block) const {
-  QString text = block.text().trimmed();
-  return text.endsWith('{') ||
-         (text.endsWith('(') && text.contains("class ")) ||
-         text.startsWith("def ") || text.startsWith("function ") ||
-         text.startsWith("class ") || text.endsWith(":");
+  return syntax.isFoldable(block.blockNumber());
 }
 
 bool CodeEditor::isFolded(const QTextBlock &block) const {
@@ -362,36 +962,12 @@ bool CodeEditor::isFolded(const QTextBlock &block) const {
 }
 
 int CodeEditor::findMatchingBrace(const QTextBlock &block) const {
-  QString text = block.text();
-  int depth = 0;
-  for (const QChar &c : text) {
-    if (c == '{')
-      depth++;
-    if (c == '}')
-      depth--;
-  }
-  if (depth <= 0)
-    return block.blockNumber();
-
-  QTextBlock b = block.next();
-  while (b.isValid()) {
-    QString t = b.text();
-    for (const QChar &c : t) {
-      if (c == '{')
-        depth++;
-      if (c == '}')
-        depth--;
-    }
-    if (depth <= 0)
-      return b.blockNumber();
-    b = b.next();
-  }
-  return document()->blockCount() - 1;
+  return syntax.scopeEnd(block.blockNumber());
 }
 
 void CodeEditor::toggleFoldAt(int blockNumber) {
   QTextBlock block = document()->findBlockByNumber(blockNumber);
-  if (!block.isValid() || !isFoldable(block))
+  if (!hasFeature(FeatureFolding) || !block.isValid() || !isFoldable(block))
     return;
 
   bool fold = !isFolded(block);
@@ -409,6 +985,7 @@ void CodeEditor::toggleFoldAt(int blockNumber) {
 }
 
 void CodeEditor::foldingAreaPaintEvent(QPaintEvent *event) {
+  PerfMonitor::Scope perf(PerfMonitor::FoldingPaint);
   QPainter painter(foldingArea);
   QColor bgColor = currentTheme.lineNumberBg.isValid()
                        ? currentTheme.lineNumberBg
@@ -421,8 +998,8 @@ void CodeEditor::foldingAreaPaintEvent(QPaintEvent *event) {
   int bottom = top + qRound(blockBoundingRect(block).height());
 
   while (block.isValid() && top <= event->rect().bottom()) {
-    if (block.isVisible() && bottom >= event->rect().top() &&
-        isFoldable(block)) {
+    if (hasFeature(FeatureFolding) && block.isVisible() &&
+        bottom >= event->rect().top() && isFoldable(block)) {
       int yCenter = top + (bottom - top) / 2;
       int xCenter = foldingAreaWidth() / 2;
 
@@ -452,13 +1029,29 @@ void CodeEditor::foldingAreaPaintEvent(QPaintEvent *event) {
 }
 
 void CodeEditor::addExtraCursor(const QTextCursor &c) {
-    extraCursors.append(c);
-    viewport()->update();
+    multiCursor.add(c.anchor(), c.position());
+    refreshCaretDecorations();
 }
 
 void CodeEditor::clearExtraCursors() {
-    extraCursors.clear();
-    viewport()->update();
+    multiCursor.clear();
+    refreshCaretDecorations();
+}
+
+void CodeEditor::refreshCaretDecorations() {
+    setDecorations(CaretLayer, multiCursor.decorations());
+}
+
+void CodeEditor::editAllCarets(MultiCursor::EditKind kind, const QString &text) {
+    const QTextCursor c = textCursor();
+    MultiCursor::Caret primary{c.anchor(), c.position()};
+    multiCursor.edit(document(), primary, kind, text);
+
+    QTextCursor moved(document());
+    moved.setPosition(primary.anchor);
+    moved.setPosition(primary.position, QTextCursor::KeepAnchor);
+    setTextCursor(moved);
+    refreshCaretDecorations();
 }
 
 void CodeEditor::selectNextOccurrence() {
@@ -469,29 +1062,333 @@ void CodeEditor::selectNextOccurrence() {
         return;
     }
     QString text = mainC.selectedText();
-    QTextCursor searchStart = extraCursors.isEmpty() ? mainC : extraCursors.last();
-    QTextCursor nextC = document()->find(text, searchStart);
+    const int from = qMax(mainC.selectionEnd(), multiCursor.lastEnd());
+    QTextCursor nextC = document()->find(text, from);
     if (!nextC.isNull()) {
         addExtraCursor(nextC);
     }
 }
 
+void CodeEditor::selectAllOccurrences() {
+    QTextCursor mainC = textCursor();
+    if (!mainC.hasSelection())
+        mainC.select(QTextCursor::WordUnderCursor);
+    QString needle = mainC.selectedText();
+    if (needle.isEmpty())
+        return;
+    needle.replace(QChar::ParagraphSeparator, '\n');
+
+    // One pass over the plain text; positions map 1:1 onto the document
+    const QString all = document()->toPlainText();
+    const QStringMatcher matcher(needle, Qt::CaseSensitive);
+    QVector<MultiCursor::Caret> carets;
+    int primary = 0;
+    for (qsizetype at = matcher.indexIn(all, 0); at >= 0;
+         at = matcher.indexIn(all, at + needle.size())) {
+        if (at == mainC.selectionStart())
+            primary = carets.size();
+        carets.append({int(at), int(at + needle.size())});
+    }
+    selectRanges(std::move(carets), primary);
+}
+
+void CodeEditor::selectRanges(QVector<MultiCursor::Caret> ranges, int primary) {
+    if (ranges.isEmpty())
+        return;
+    primary = qBound(0, primary, int(ranges.size()) - 1);
+    const MultiCursor::Caret main = ranges.takeAt(primary);
+    QTextCursor c(document());
+    c.setPosition(main.anchor);
+    c.setPosition(main.position, QTextCursor::KeepAnchor);
+    setTextCursor(c);
+    multiCursor.set(std::move(ranges));
+    refreshCaretDecorations();
+}
+
 void CodeEditor::mousePressEvent(QMouseEvent *event) {
-    if (event->modifiers() & Qt::AltModifier) {
-        QTextCursor c = cursorForPosition(event->pos());
-        addExtraCursor(c);
+    if ((event->modifiers() & Qt::AltModifier) && event->button() == Qt::LeftButton) {
+        // Release without moving adds a caret; dragging selects a block
+        if (blockSelection.isActive()) {
+            blockSelection.clear();
+            viewport()->update();
+        }
+        altPressed = true;
+        altPressPos = event->pos();
         return;
     }
     clearExtraCursors();
+    if (blockSelection.isActive()) {
+        blockSelection.clear();
+        viewport()->update();
+    }
     QPlainTextEdit::mousePressEvent(event);
 }
 
+void CodeEditor::mouseMoveEvent(QMouseEvent *event) {
+    if (altPressed && (event->buttons() & Qt::LeftButton)) {
+        if (!blockSelection.isActive()) {
+            if ((event->pos() - altPressPos).manhattanLength() <
+                QApplication::startDragDistance())
+                return;
+            clearExtraCursors();
+            blockSelection.setTabWidth(tabStopDistance() / columnAdvance());
+            blockSelection.start(cursorForPosition(altPressPos).blockNumber(),
+                                 columnAt(altPressPos));
+        }
+        extendBlockSelection(cursorForPosition(event->pos()).blockNumber(),
+                             columnAt(event->pos()));
+        return;
+    }
+    QPlainTextEdit::mouseMoveEvent(event);
+}
+
+void CodeEditor::mouseReleaseEvent(QMouseEvent *event) {
+    if (altPressed) {
+        altPressed = false;
+        if (!blockSelection.isActive())
+            addExtraCursor(cursorForPosition(altPressPos));
+        return;
+    }
+    QPlainTextEdit::mouseReleaseEvent(event);
+}
+
+qreal CodeEditor::columnAdvance() const {
+    return QFontMetricsF(font()).horizontalAdvance(QLatin1Char(' '));
+}
+
+int CodeEditor::columnAt(const QPoint &pos) const {
+    // The nearest character boundary, so a click inside a tab lands on one
+    // of its edges; past the end of the row every space width is a column
+    const QTextCursor c = cursorForPosition(pos);
+    const int column = blockSelection.column(c.block().text(), c.positionInBlock());
+    const qreal beyond = pos.x() - cursorRect(c).left();
+    if (c.atBlockEnd() && beyond > 0)
+        return column + qRound(beyond / columnAdvance());
+    return column;
+}
+
+void CodeEditor::extendBlockSelection(int line, int column) {
+    line = qBound(0, line, blockCount() - 1);
+    blockSelection.extendTo(line, column);
+
+    // The real cursor follows the moving corner for the status bar and
+    // scrolling; it stops at the end of short rows.
+    const QTextBlock block = document()->findBlockByNumber(line);
+    QTextCursor c(block);
+    c.setPosition(block.position() + blockSelection.position(block.text(),
+                                                             blockSelection.cursorColumn()));
+    setTextCursor(c);
+    ensureCursorVisible();
+    viewport()->update();
+}
+
+bool CodeEditor::blockSelectionKey(QKeyEvent *event) {
+    const Qt::KeyboardModifiers mods = event->modifiers() & ~Qt::KeypadModifier;
+    if (mods == (Qt::AltModifier | Qt::ShiftModifier)) {
+        int dLine = 0;
+        int dColumn = 0;
+        switch (event->key()) {
+        case Qt::Key_Up:    dLine = -1;   break;
+        case Qt::Key_Down:  dLine = 1;    break;
+        case Qt::Key_Left:  dColumn = -1; break;
+        case Qt::Key_Right: dColumn = 1;  break;
+        default: return false;
+        }
+        if (!blockSelection.isActive()) {
+            clearExtraCursors();
+            blockSelection.setTabWidth(tabStopDistance() / columnAdvance());
+            const QTextCursor c = textCursor();
+            blockSelection.start(c.blockNumber(),
+                                 blockSelection.column(c.block().text(), c.positionInBlock()));
+        }
+        extendBlockSelection(blockSelection.cursorLine() + dLine,
+                             blockSelection.cursorColumn() + dColumn);
+        return true;
+    }
+    if (!blockSelection.isActive())
+        return false;
+
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        return true;
+    }
+    if (event->matches(QKeySequence::Cut)) {
+        cutSelection();
+        return true;
+    }
+    if (event->matches(QKeySequence::Paste)) {
+        pasteClipboard();
+        return true;
+    }
+
+    if (!(mods & (Qt::ControlModifier | Qt::AltModifier))) {
+        const QString typed = event->text();
+        bool edited = true;
+        if (event->key() == Qt::Key_Escape) {
+            blockSelection.clear();
+            viewport()->update();
+            return true;
+        } else if (isReadOnly()) {
+            edited = false;
+        } else if (event->key() == Qt::Key_Backspace) {
+            blockSelection.deletePrevious(document());
+        } else if (event->key() == Qt::Key_Delete) {
+            blockSelection.deleteNext(document());
+        } else if (!typed.isEmpty() && typed[0].isPrint()) {
+            emit characterTyped();
+            blockSelection.replace(document(), {typed});
+        } else {
+            edited = false;
+        }
+        if (edited) {
+            extendBlockSelection(blockSelection.cursorLine(), blockSelection.cursorColumn());
+            return true;
+        }
+    }
+
+    // Any other key drops the block and behaves as usual
+    blockSelection.clear();
+    viewport()->update();
+    return false;
+}
+
+void CodeEditor::copySelection() {
+    if (!blockSelection.isActive()) {
+        copy();
+        return;
+    }
+    QApplication::clipboard()->setText(blockSelection.text(document()));
+}
+
+void CodeEditor::cutSelection() {
+    if (!blockSelection.isActive()) {
+        cut();
+        return;
+    }
+    copySelection();
+    if (isReadOnly())
+        return;
+    blockSelection.replace(document(), {QString()});
+    extendBlockSelection(blockSelection.cursorLine(), blockSelection.cursorColumn());
+}
+
+void CodeEditor::pasteClipboard() {
+    if (!blockSelection.isActive()) {
+        paste();
+        return;
+    }
+    if (isReadOnly())
+        return;
+    // One clipboard line per row, or a single line repeated on every row
+    QString text = QApplication::clipboard()->text();
+    text.remove('\r');
+    QStringList rows = text.split('\n');
+    if (rows.size() > 1 && rows.last().isEmpty())
+        rows.removeLast();
+    blockSelection.replace(document(), rows);
+    extendBlockSelection(blockSelection.cursorLine(), blockSelection.cursorColumn());
+}
+
+void CodeEditor::paintBlockSelection(QPainter &painter, bool carets) {
+    if (!blockSelection.isActive())
+        return;
+    const qreal advance = columnAdvance();
+    const QColor color = decorationColor(carets ? DecoExtraCaret : DecoSelection);
+    painter.setPen(color);
+
+    // Only the visible rows are touched, however tall the block is.  They
+    // are laid out, so columns map to x through the row's own line, tabs
+    // included; columns past the end of the row are a space wide.
+    const QPointF offset = contentOffset();
+    for (QTextBlock block = firstVisibleBlock(); block.isValid(); block = block.next()) {
+        const QRectF r = blockBoundingGeometry(block).translated(offset);
+        if (r.top() > viewport()->height() || block.blockNumber() > blockSelection.bottomLine())
+            break;
+        if (block.blockNumber() < blockSelection.topLine() || !block.isVisible())
+            continue;
+        if (block.layout()->lineCount() == 0)
+            continue;
+        const QTextLine line = block.layout()->lineAt(0);
+        const QString text = block.text();
+        auto columnX = [&](int column) {
+            int padding = 0;
+            const int position = blockSelection.position(text, column, &padding);
+            return r.left() + line.cursorToX(position) + padding * advance;
+        };
+        const qreal h = line.height();
+        if (carets) {
+            const qreal x = columnX(blockSelection.cursorColumn());
+            painter.drawLine(QPointF(x, r.top()), QPointF(x, r.top() + h));
+        } else {
+            const qreal left = columnX(blockSelection.leftColumn());
+            painter.fillRect(QRectF(left, r.top(), columnX(blockSelection.rightColumn()) - left, h),
+                             color);
+        }
+    }
+}
+
 void CodeEditor::keyPressEvent(QKeyEvent *event) {
-  if (event->key() == Qt::Key_Escape && !extraCursors.isEmpty()) {
+  // Modifiers and navigation keys never edit, so they are not timed
+  if (!event->text().isEmpty() || event->key() == Qt::Key_Backspace ||
+      event->key() == Qt::Key_Delete)
+    PerfMonitor::instance().keyPressed();
+  if (event->key() == Qt::Key_Escape && !multiCursor.isEmpty()) {
       clearExtraCursors();
       return;
   }
 
+  if (blockSelectionKey(event))
+    return;
+
+  // Backspace/Delete across a chunk boundary edit the neighbouring character
+  // instead of merging the display chunks.
+  if (chunked && !textCursor().hasSelection() &&
+      event->modifiers() == Qt::NoModifier) {
+    QTextCursor c = textCursor();
+    if (event->key() == Qt::Key_Backspace && c.atBlockStart() &&
+        isContinuation(c.block()) && c.block().previous().length() > 1) {
+      c.setPosition(c.position() - 2);
+      c.deleteChar();
+      return;
+    }
+    if (event->key() == Qt::Key_Delete && c.atBlockEnd() &&
+        isContinuation(c.block().next()) && c.block().next().length() > 1) {
+      c.setPosition(c.block().next().position());
+      c.deleteChar();
+      return;
+    }
+  }
+
+  // With extra carets, typing goes to every caret as one edit; the
+  // single-cursor conveniences below (auto-pairs, indent) are skipped.
+  if (!multiCursor.isEmpty() && !isReadOnly() &&
+      !(event->modifiers() & (Qt::ControlModifier | Qt::AltModifier))) {
+    const QString typed = event->text();
+    switch (event->key()) {
+    case Qt::Key_Backspace:
+      editAllCarets(MultiCursor::DeletePrevious);
+      return;
+    case Qt::Key_Delete:
+      editAllCarets(MultiCursor::DeleteNext);
+      return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+      emit characterTyped();
+      editAllCarets(MultiCursor::InsertText, "\n");
+      return;
+    case Qt::Key_Tab:
+      emit characterTyped();
+      editAllCarets(MultiCursor::InsertText, "\t");
+      return;
+    default:
+      if (!typed.isEmpty() && typed[0].isPrint()) {
+        emit characterTyped();
+        editAllCarets(MultiCursor::InsertText, typed);
+        return;
+      }
+    }
+  }
+
   if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) {
     emit characterTyped();
     autoIndent();
@@ -516,19 +1413,6 @@ void CodeEditor::keyPressEvent(QKeyEvent *event) {
 
   emit characterTyped();
 
-  if (!extraCursors.isEmpty()) {
-      QTextCursor mainCursor = textCursor();
-      mainCursor.beginEditBlock();
-      int key = event->key();
-      for (int i=0; i<extraCursors.size(); i++) {
-          QTextCursor &c = extraCursors[i];
-          if (key == Qt::Key_Backspace) c.deletePreviousChar();
-          else if (key == Qt::Key_Delete) c.deleteChar();
-          else if (text[0].isPrint()) c.insertText(text);
-      }
-      mainCursor.endEditBlock();
-  }
-
   QTextCursor cursor = textCursor();
   QChar ch = text[0];
 
@@ -610,26 +1494,64 @@ void CodeEditor::keyPressEvent(QKeyEvent *event) {
 
 void CodeEditor::autoIndent() {
   QTextCursor cursor = textCursor();
-  QString previousLine = cursor.block().text();
-  int indent = 0;
-  for (QChar c : previousLine) {
-    if (c == ' ')
-      indent++;
-    else if (c == '\t')
-      indent += 4;
-    else
-      break;
-  }
-  if (previousLine.trimmed().endsWith('{') ||
-      previousLine.trimmed().endsWith(':'))
-    indent += 4;
+  const int indent = syntax.indentAfter(cursor.blockNumber());
   cursor.insertText("\n" + QString(" ").repeated(indent));
   setTextCursor(cursor);
 }
 
-void CodeEditor::matchBrackets() {}
+void CodeEditor::matchBrackets() {
+  QVector<Decoration> marks;
+  const QTextCursor cursor = textCursor();
+  if (!cursor.hasSelection()) {
+    // Bracket after the cursor wins, then the one just before it
+    int pos = cursor.position();
+    int match = matchingBracket(pos);
+    if (match < 0 && pos > 0)
+      match = matchingBracket(--pos);
+    if (match >= 0) {
+      marks.append({qMin(pos, match), 1, DecoBracketMatch});
+      marks.append({qMax(pos, match), 1, DecoBracketMatch});
+    }
+  }
+  setDecorations(BracketLayer, marks);
+}
+
+int CodeEditor::matchingBracket(int pos) const {
+  static const QString opening = QStringLiteral("([{");
+  static const QString closing = QStringLiteral(")]}");
+  const QChar self = document()->characterAt(pos);
+  int kind = opening.indexOf(self);
+  const bool forward = kind >= 0;
+  if (!forward)
+    kind = closing.indexOf(self);
+  if (kind < 0)
+    return -1;
+  const QChar other = forward ? closing[kind] : opening[kind];
+  const int step = forward ? 1 : -1;
+
+  // Walk block text rather than characterAt() so the scan stays linear
+  QTextBlock block = document()->findBlock(pos);
+  int i = pos - block.position();
+  int depth = 0;
+  int budget = BracketScanLimit;
+  while (block.isValid()) {
+    const QString text = block.text();
+    for (; i >= 0 && i < text.size(); i += step) {
+      if (--budget < 0)
+        return -1;
+      if (text[i] == self)
+        ++depth;
+      else if (text[i] == other && --depth == 0)
+        return block.position() + i;
+    }
+    block = forward ? block.next() : block.previous();
+    i = forward ? 0 : block.length() - 2;
+  }
+  return -1;
+}
 
 void CodeEditor::miniMapPaintEvent(QPaintEvent *event) {
+  PerfMonitor::Scope perf(PerfMonitor::MiniMapPaint);
   QPainter painter(miniMap);
   painter.fillRect(event->rect(), QColor(40, 40, 40));
   int totalLines = document()->blockCount();
@@ -774,11 +1696,7 @@ void CodeEditor::toggleComment() {
   QTextCursor cursor = textCursor();
   cursor.beginEditBlock();
 
-  QString prefix = "//";
-  if (currentLanguage == Language::Python || currentLanguage == Language::YAML)
-    prefix = "#";
-  else if (currentLanguage == Language::HTML)
-    prefix = "<!--";
+  const QString prefix = syntax.commentPrefix();
 
   int startBlock = cursor.selectionStart();
   int endBlock = cursor.selectionEnd();
@@ -791,16 +1709,15 @@ void CodeEditor::toggleComment() {
   // Check if commenting or uncommenting
   bool allCommented = true;
   for (int i = firstBlockNum; i <= lastBlockNum; ++i) {
-    QTextBlock block = document()->findBlockByLineNumber(i);
-    QString text = block.text().trimmed();
-    if (!text.isEmpty() && !text.startsWith(prefix)) {
+    if (!document()->findBlockByNumber(i).text().trimmed().isEmpty() &&
+        !syntax.isCommented(i)) {
       allCommented = false;
       break;
     }
   }
 
   for (int i = firstBlockNum; i <= lastBlockNum; ++i) {
-    QTextBlock block = document()->findBlockByLineNumber(i);
+    QTextBlock block = document()->findBlockByNumber(i);
     QString text = block.text();
     if (text.trimmed().isEmpty())
       continue;
@@ -1651,6 +2568,12 @@ FindBar::FindBar(QWidget *parent) : QWidget(parent) {
   matchLabel->setStyleSheet("color: #999999; font-size: 11px;");
   layout->addWidget(matchLabel);
 
+  modeBox = new QComboBox(this);
+  modeBox->addItems(HexSearch::modeNames());
+  modeBox->setStyleSheet("QComboBox { background-color: #3c3c3c; color: #cccccc; border: 1px solid #555555; padding: 1px 5px; }");
+  modeBox->hide();
+  layout->addWidget(modeBox);
+
   prevBtn = new QPushButton("\xE2\x86\x91", this); // Up arrow
   nextBtn = new QPushButton("\xE2\x86\x93", this); // Down arrow
   closeBtn = new QPushButton("\xE2\x9C\x95", this); // Close icon
@@ -1673,6 +2596,7 @@ FindBar::FindBar(QWidget *parent) : QWidget(parent) {
   connect(prevBtn, &QPushButton::clicked, this, [this]() { emit findPreviousRequested(findInput->text()); });
   connect(nextBtn, &QPushButton::clicked, this, [this]() { emit findNextRequested(findInput->text()); });
   connect(closeBtn, &QPushButton::clicked, this, &FindBar::closeRequested);
+  connect(modeBox, &QComboBox::currentIndexChanged, this, [this]() { emit textChanged(findInput->text()); });
   
   hide();
 }
@@ -1689,10 +2613,23 @@ void FindBar::setMatchCount(int current, int total) {
   else matchLabel->setText(QString("%1/%2").arg(current).arg(total));
 }
 
+void FindBar::setStatusText(const QString &text) {
+  matchLabel->setText(text);
+}
+
 QString FindBar::getSearchText() const {
   return findInput->text();
 }
 
+void FindBar::setHexMode(bool hex) {
+  modeBox->setVisible(hex);
+  findInput->setPlaceholderText(hex ? "Find bytes (DE AD ?? EF), text or a number..." : "Find...");
+}
+
+int FindBar::hexSearchMode() const {
+  return modeBox->currentIndex();
+}
+
 // ============================================================
 // AnimationWidget Implementation
 // ============================================================
@@ -2149,25 +3086,54 @@ void TerminalWidget::appendOutput(const QString &text) {
 TextEditor::TextEditor(QWidget *parent)
     : QMainWindow(parent), wordWrapEnabled(false), splitViewEnabled(false),
       fontSize(11), currentThemeIndex(0), currentMatchIndex(-1) {
-  fileWatcher = new QFileSystemWatcher(this);
-  connect(fileWatcher, &QFileSystemWatcher::fileChanged, this,
-          &TextEditor::onFileChangedExternally);
+  StartupProfiler &profiler = StartupProfiler::instance();
 
   // Frameless window with custom title bar
   setWindowFlags(Qt::FramelessWindowHint | Qt::WindowSystemMenuHint |
                  Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint |
                  Qt::WindowCloseButtonHint);
 
-  setupUI();
-  initializeThemes();
-  createActions();
-  createMenus();
-  createStatusBar();
-  applyModernStyle();
+  uiUpdates = new UiUpdateScheduler(this);
+  uiUpdates->setTask(UpdateStatusBar, [this]() { updateStatusBar(); });
+  uiUpdates->setTask(UpdateBreadcrumb, [this]() { updateBreadcrumb(); });
+  uiUpdates->setTask(UpdateAI, [this]() {
+    if (aiAutocomplete && aiPendingEditor)
+      aiAutocomplete->trigger(aiPendingEditor);
+    aiPendingEditor = nullptr;
+  });
+  uiUpdates->setTask(UpdateSound, [this]() {
+    if (typingSoundEnabled && typingSound)
+      typingSound->play();
+  });
+  uiUpdates->setTask(UpdateMarkdown, [this]() {
+    if (markdownTimer)
+      markdownTimer->start();
+  });
+
+  symbolIndex = new SymbolIndex(this);
+  connect(symbolIndex, &SymbolIndex::indexingStarted, this, [this]() {
+    statusBar()->showMessage("Indexing symbols...", 2000);
+  });
+  connect(symbolIndex, &SymbolIndex::indexed, this, [this](int files, int symbols) {
+    statusBar()->showMessage(
+        QString("Indexed %1 symbols in %2 files").arg(symbols).arg(files), 3000);
+  });
+
+  setupUI();
+  profiler.mark("setupUI");
+  initializeThemes();
+  createActions();
+  createMenus();
+  createStatusBar();
+  profiler.mark("actions, menus, status bar");
+  applyModernStyle();
+  profiler.mark("applyModernStyle");
   readSettings();
   setWindowTitle("Jim");
   resize(1200, 800);
-  showWelcomeScreen();
+  // No fade on the very first frame; it only delays the window being usable
+  showWelcomeScreen(false);
+  profiler.mark("welcome screen");
 }
 
 TextEditor::~TextEditor() { writeSettings(); }
@@ -2223,20 +3189,6 @@ void TextEditor::setupUI() {
           &TextEditor::closeTab);
   connect(tabWidget, &QTabWidget::currentChanged, this,
           &TextEditor::tabChanged);
-  
-  aiAutocomplete = new AIAutocomplete(this);
-  connect(aiAutocomplete, &AIAutocomplete::suggestionReady, this, &TextEditor::onAISuggestion);
-  
-  connect(tabWidget, &QTabWidget::currentChanged, this, [this](int index) {
-      if (index >= 0) {
-          CodeEditor *ed = qobject_cast<CodeEditor*>(tabWidget->widget(index));
-          if (ed) {
-              connect(ed, &QPlainTextEdit::textChanged, this, [this, ed]() {
-                  aiAutocomplete->trigger(ed);
-              }, Qt::UniqueConnection);
-          }
-      }
-  });
 
   editorLayout->addWidget(mainSplitter);
   verticalSplitter->addWidget(editorContainer);
@@ -2250,36 +3202,14 @@ void TextEditor::setupUI() {
   connect(welcomeWidget, &WelcomeWidget::recentFileClicked, this,
           [this](const QString &path) { loadFile(path); });
 
-  // Terminal widget (hidden by default)
-  terminalWidget = new TerminalWidget();
-  terminalWidget->setMinimumHeight(100);
-  terminalWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-  terminalWidget->hide();
-  verticalSplitter->addWidget(terminalWidget);
-  verticalSplitter->setStretchFactor(0, 3);
-  verticalSplitter->setStretchFactor(1, 1);
+  // The terminal goes below the editor once ensureTerminal() creates it
   verticalSplitter->setHandleWidth(6);
   verticalSplitter->setChildrenCollapsible(false);
-  
-  // Set initial sizes for the splitter (70% editor, 30% terminal)
-  QList<int> sizes;
-  sizes << 700 << 300;
-  verticalSplitter->setSizes(sizes);
 
   mainLayout->addWidget(verticalSplitter, 1); // stretch to fill
   
   setCentralWidget(mainContainer);
 
-  // Animation widget as a dockable pane
-  animationDock = new QDockWidget("Animation", this);
-  animationDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
-  animationWidget = new AnimationWidget(animationDock);
-  animationDock->setWidget(animationWidget);
-  animationDock->setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable);
-  animationDock->setMinimumWidth(300); // Increased initial width
-  addDockWidget(Qt::RightDockWidgetArea, animationDock);
-  animationDock->hide();
-
   // File tree dock
   fileTreeDock = new QDockWidget("Explorer", this);
   fileTreeDock->setFeatures(QDockWidget::DockWidgetMovable |
@@ -2333,13 +3263,95 @@ void TextEditor::setupUI() {
   addDockWidget(Qt::LeftDockWidgetArea, fileTreeDock);
 }
 
-void TextEditor::showWelcomeScreen() {
+void TextEditor::ensureTerminal() {
+  if (terminalWidget)
+    return;
+  terminalWidget = new TerminalWidget();
+  terminalWidget->setMinimumHeight(100);
+  terminalWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+  terminalWidget->hide();
+  if (!currentFolder.isEmpty())
+    terminalWidget->setWorkingDirectory(currentFolder);
+  verticalSplitter->addWidget(terminalWidget);
+  verticalSplitter->setStretchFactor(0, 3);
+  verticalSplitter->setStretchFactor(1, 1);
+
+  // Set initial sizes for the splitter (70% editor, 30% terminal)
+  QList<int> sizes;
+  sizes << 700 << 300;
+  verticalSplitter->setSizes(sizes);
+}
+
+void TextEditor::ensureAnimationDock() {
+  if (animationDock)
+    return;
+  animationDock = new QDockWidget("Animation", this);
+  animationDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+  animationWidget = new AnimationWidget(animationDock);
+  animationDock->setWidget(animationWidget);
+  animationDock->setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable);
+  animationDock->setMinimumWidth(300); // Increased initial width
+  addDockWidget(Qt::RightDockWidgetArea, animationDock);
+  animationDock->hide();
+}
+
+void TextEditor::ensureTemplateDock() {
+  if (templateDock)
+    return;
+  templateDock = new QDockWidget("Template", this);
+  templateDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+  templateView = new HexTemplateView(templateDock);
+  templateDock->setWidget(templateView);
+  templateDock->setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable);
+  templateDock->setMinimumWidth(320);
+  // Hidden, the panel lets go of its editor and the overlay with it
+  connect(templateDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+    templateView->setEditor(visible ? qobject_cast<HexEditor *>(tabWidget->currentWidget()) : nullptr);
+  });
+  addDockWidget(Qt::RightDockWidgetArea, templateDock);
+  templateDock->hide();
+}
+
+void TextEditor::ensureInspectorDock() {
+  if (inspectorDock)
+    return;
+  inspectorDock = new QDockWidget("Data Inspector", this);
+  inspectorDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+  inspector = new HexInspector(inspectorDock);
+  inspectorDock->setWidget(inspector);
+  inspectorDock->setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable);
+  inspectorDock->setMinimumWidth(280);
+  connect(inspectorDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+    inspector->setEditor(visible ? qobject_cast<HexEditor *>(tabWidget->currentWidget()) : nullptr);
+  });
+  addDockWidget(Qt::RightDockWidgetArea, inspectorDock);
+  inspectorDock->hide();
+}
+
+void TextEditor::ensureAIAutocomplete() {
+  if (aiAutocomplete)
+    return;
+  aiAutocomplete = new AIAutocomplete(this);
+  connect(aiAutocomplete, &AIAutocomplete::suggestionReady, this, &TextEditor::onAISuggestion);
+  QSettings settings;
+  aiAutocomplete->setProvider(settings.value("ai/baseUrl").toString(),
+                              settings.value("ai/apiKey").toString(),
+                              settings.value("ai/model").toString());
+}
+
+void TextEditor::showWelcomeScreen(bool animate) {
   welcomeWidget->setRecentFiles(recentFiles);
   int idx = tabWidget->indexOf(welcomeWidget);
   if (idx == -1)
     idx = tabWidget->addTab(welcomeWidget, "Welcome");
   tabWidget->setCurrentIndex(idx);
 
+  if (!animate) {
+    if (welcomeOpacity)
+      welcomeOpacity->setOpacity(1.0);
+    return;
+  }
+
   // Fade in
   if (!welcomeOpacity) {
     welcomeOpacity = new QGraphicsOpacityEffect(welcomeWidget);
@@ -2385,20 +3397,33 @@ void TextEditor::hideWelcomeScreen() {
 }
 
 void TextEditor::watchFile(const QString &filePath) {
-  if (!filePath.isEmpty() && QFileInfo::exists(filePath))
-    fileWatcher->addPath(filePath);
+  if (filePath.isEmpty() || !QFileInfo::exists(filePath))
+    return;
+  if (!fileWatcher) {
+    fileWatcher = new QFileSystemWatcher(this);
+    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this,
+            &TextEditor::onFileChangedExternally);
+  }
+  fileWatcher->addPath(filePath);
 }
 
 void TextEditor::unwatchFile(const QString &filePath) {
-  if (!filePath.isEmpty() && fileWatcher->files().contains(filePath))
+  if (fileWatcher && !filePath.isEmpty() &&
+      fileWatcher->files().contains(filePath))
     fileWatcher->removePath(filePath);
 }
 
 void TextEditor::onFileChangedExternally(const QString &path) {
+  symbolIndex->fileChanged(path);
   // Find the editor with this file
   for (int i = 0; i < tabWidget->count(); ++i) {
     CodeEditor *editor = qobject_cast<CodeEditor *>(tabWidget->widget(i));
     if (editor && editor->getFileName() == path) {
+      if (editor->isTailFollowing()) {
+        editor->scheduleTailRead();
+        watchFile(path);
+        break;
+      }
       QMessageBox::StandardButton reply = QMessageBox::question(
           this, "File Changed",
           QString("The file '%1' has been modified externally.\nDo you want to "
@@ -2407,14 +3432,33 @@ void TextEditor::onFileChangedExternally(const QString &path) {
           QMessageBox::Yes | QMessageBox::No);
       if (reply == QMessageBox::Yes) {
         QFile file(path);
-        if (file.open(QFile::ReadOnly | QFile::Text)) {
-          int cursorPos = editor->textCursor().position();
-          editor->setPlainText(QTextStream(&file).readAll());
-          editor->document()->setModified(false);
-          QTextCursor cursor = editor->textCursor();
-          cursor.setPosition(
-              qMin(cursorPos, editor->document()->characterCount() - 1));
-          editor->setTextCursor(cursor);
+        if (file.open(QFile::ReadOnly)) {
+          const QByteArray data = file.readAll();
+          if (LargeFilePolicy::isLean(editor->enabledFeatures()) ||
+              LargeFilePolicy::isLean(LargeFilePolicy::featuresFor(data))) {
+            // Lean documents are chunked, so their blocks are not the
+            // file's lines; reload through the same path as opening
+            const int position = editor->textCursor().position();
+            const int scroll = editor->verticalScrollBar()->value();
+            QApplication::setOverrideCursor(Qt::WaitCursor);
+            detachLanguageServer(editor);
+            setEditorContents(editor, path, data);
+            QTextCursor cursor(editor->document());
+            cursor.setPosition(qBound(
+                0, position, editor->document()->characterCount() - 1));
+            editor->setTextCursor(cursor);
+            editor->verticalScrollBar()->setValue(scroll);
+            QApplication::restoreOverrideCursor();
+            if (editor == currentEditor())
+              updateLeanBadge();
+          } else {
+            // Diff against the open document instead of setPlainText() so
+            // the cursor, scroll position, folds and undo history are kept.
+            QString text = QString::fromUtf8(data);
+            text.replace("\r\n", "\n");
+            editor->applyExternalText(text);
+            editor->document()->setModified(false);
+          }
         }
       }
       // Re-watch (Qt removes paths after change signal)
@@ -2427,64 +3471,11 @@ void TextEditor::onFileChangedExternally(const QString &path) {
 QString TextEditor::detectCurrentSymbol(CodeEditor *editor) {
   if (!editor)
     return "";
-  QTextBlock block = editor->textCursor().block();
-  
-  // For C++, walk up to find the closest scopes
-  Language lang = editor->getLanguage();
-  
-  QRegularExpression funcRe;
-  QRegularExpression classRe("(?:class|struct|enum|interface|trait|impl|namespace)\\s+([A-Za-z_][A-Za-z0-9_]*)");
-
-  if (lang == Language::CPP) {
-      // Improved C++ regex: captures return type (optional), scope (optional), and function name
-      // Handles: void Class::Func(), int* ptr(), std::vector<int> some_func(), etc.
-      // We make the trailing brace optional to handle "brace on next line"
-      funcRe = QRegularExpression("(?xi)"
-                                  "(?: [A-Za-z_][A-Za-z0-9_<>:\\*&\\s]* \\s+ )?" // Return type (optional)
-                                  " ( [A-Za-z_][A-Za-z0-9_\\s]* :: )? "           // Class/Namespace scope (optional)
-                                  " ( [A-Za-z_][A-Za-z0-9_]* ) "                  // Function name
-                                  " \\s* \\( [^\\)]* \\) "                       // Parameters
-                                  " \\s* (?: const )? \\s* (?: [{;]|$) ");        // End of signature (brace, semi, or EOL)
-  } else if (lang == Language::Python) {
-      funcRe = QRegularExpression("^\\s*def\\s+([A-Za-z_][A-Za-z0-9_]*)\\s*\\(");
-      classRe = QRegularExpression("^\\s*class\\s+([A-Za-z_][A-Za-z0-9_]*)");
-  } else {
-      funcRe = QRegularExpression("(?:fn|func|def|function)\\s+([A-Za-z_][A-Za-z0-9_]*)\\s*\\(");
-  }
-
-  // Keywords to exclude in C++
-  static const QStringList cppKeywords = {"if", "while", "for", "switch", "catch", "else", "foreach"};
-
-  while (block.isValid()) {
-    QString text = block.text().trimmed();
-    if (text.isEmpty()) {
-        block = block.previous();
-        continue;
-    }
-
-    QRegularExpressionMatch m;
-    
-    if (lang == Language::CPP) {
-        m = funcRe.match(text);
-        if (m.hasMatch()) {
-            QString name = m.captured(2);
-            // Verify it's not a control flow keyword
-            if (!cppKeywords.contains(name)) {
-                QString scope = m.captured(1);
-                return (scope.isEmpty() ? "" : scope) + name + "()";
-            }
-        }
-    } else {
-        m = funcRe.match(text);
-        if (m.hasMatch()) return m.captured(1) + "()";
-    }
-    
-    m = classRe.match(text);
-    if (m.hasMatch()) return m.captured(1);
-    
-    block = block.previous();
-  }
-  return "";
+  // Declarations and their scopes are tracked incrementally by the editor's
+  // syntax tree; no backward regex scan per cursor move
+  return editor->syntaxTree()
+      .enclosingSymbol(editor->textCursor().blockNumber())
+      .name;
 }
 
 void TextEditor::updateBreadcrumb() {
@@ -2493,10 +3484,63 @@ void TextEditor::updateBreadcrumb() {
     breadcrumbBar->updatePath("", "");
     return;
   }
+  if (!editor->hasFeature(FeatureBreadcrumbs)) {
+    breadcrumbBar->updatePath(editor->getFileName(), "");
+    return;
+  }
   QString symbol = detectCurrentSymbol(editor);
   breadcrumbBar->updatePath(editor->getFileName(), symbol);
 }
 
+void TextEditor::applyEditorFeatures(CodeEditor *editor, int features) {
+  const int changed = editor->enabledFeatures() ^ features;
+
+  if (changed & FeatureLongLines) {
+    if (editor->isModified()) {
+      QMessageBox::warning(this, "Jim",
+                           "Save or discard your changes before re-splitting "
+                           "long lines.");
+      features ^= FeatureLongLines;
+    } else {
+      QFile file(editor->getFileName());
+      if (file.open(QFile::ReadOnly)) {
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        QString text = QString::fromUtf8(file.readAll());
+        QVector<int> continuations;
+        if (!(features & FeatureLongLines))
+          text = LargeFilePolicy::chunkLongLines(text, &continuations);
+        editor->setChunkedText(text, continuations);
+        editor->document()->setModified(false);
+        QApplication::restoreOverrideCursor();
+      }
+    }
+  }
+
+  // Detaching the highlighter drops all per-block work; re-attaching
+  // rehighlights the whole document, which is what the user opted into.
+  if (SyntaxHighlighter *hl = highlighters.value(editor)) {
+    QTextDocument *target =
+        (features & FeatureHighlighting) ? editor->document() : nullptr;
+    if (hl->document() != target)
+      hl->setDocument(target);
+  }
+
+  editor->setEnabledFeatures(features);
+  if ((changed & FeatureMiniMap) && (features & FeatureMiniMap) &&
+      miniMapAct->isChecked())
+    toggleMiniMap();
+  if (editor == currentEditor()) {
+    updateBreadcrumb();
+    updateLeanBadge();
+  }
+}
+
+void TextEditor::updateLeanBadge() {
+  CodeEditor *editor = currentEditor();
+  leanBadge->setVisible(editor &&
+                        LargeFilePolicy::isLean(editor->enabledFeatures()));
+}
+
 void TextEditor::createActions() {
   newAct = new QAction("&New", this);
   newAct->setShortcuts(QKeySequence::New);
@@ -2531,21 +3575,23 @@ void TextEditor::createActions() {
   cutAct->setShortcuts(QKeySequence::Cut);
   connect(cutAct, &QAction::triggered, this, [this]() {
     if (currentEditor())
-      currentEditor()->cut();
+      currentEditor()->cutSelection();
   });
 
   copyAct = new QAction("&Copy", this);
   copyAct->setShortcuts(QKeySequence::Copy);
   connect(copyAct, &QAction::triggered, this, [this]() {
     if (currentEditor())
-      currentEditor()->copy();
+      currentEditor()->copySelection();
   });
 
   pasteAct = new QAction("&Paste", this);
   pasteAct->setShortcuts(QKeySequence::Paste);
   connect(pasteAct, &QAction::triggered, this, [this]() {
     if (currentEditor())
-      currentEditor()->paste();
+      currentEditor()->pasteClipboard();
+    else if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget()))
+      hex->pasteClipboard();
   });
 
   undoAct = new QAction("&Undo", this);
@@ -2553,6 +3599,8 @@ void TextEditor::createActions() {
   connect(undoAct, &QAction::triggered, this, [this]() {
     if (currentEditor())
       currentEditor()->undo();
+    else if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget()))
+      hex->undo();
   });
 
   redoAct = new QAction("&Redo", this);
@@ -2560,6 +3608,8 @@ void TextEditor::createActions() {
   connect(redoAct, &QAction::triggered, this, [this]() {
     if (currentEditor())
       currentEditor()->redo();
+    else if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget()))
+      hex->redo();
   });
 
   selectAllAct = new QAction("Select &All", this);
@@ -2590,6 +3640,14 @@ void TextEditor::createActions() {
   goToLineAct->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_G));
   connect(goToLineAct, &QAction::triggered, this, &TextEditor::goToLine);
 
+  goToSymbolAct = new QAction("Go to &Symbol in Folder...", this);
+  goToSymbolAct->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_G));
+  connect(goToSymbolAct, &QAction::triggered, this, &TextEditor::goToSymbol);
+
+  goToDefinitionAct = new QAction("Go to &Definition", this);
+  goToDefinitionAct->setShortcut(QKeySequence(Qt::Key_F12));
+  connect(goToDefinitionAct, &QAction::triggered, this, &TextEditor::goToDefinition);
+
   // Line editing actions
   duplicateLineAct = new QAction("Duplicate Line", this);
   duplicateLineAct->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_D));
@@ -2598,13 +3656,18 @@ void TextEditor::createActions() {
       currentEditor()->duplicateLine();
   });
 
-  QAction *selectNextAct = new QAction("Select Next Occurrence", this);
+  selectNextAct = new QAction("Select Next Occurrence", this);
   selectNextAct->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_D));
   connect(selectNextAct, &QAction::triggered, this, [this]() {
     if (currentEditor())
       currentEditor()->selectNextOccurrence();
   });
 
+  selectAllOccurrencesAct = new QAction("Select All Occurrences", this);
+  selectAllOccurrencesAct->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_L));
+  connect(selectAllOccurrencesAct, &QAction::triggered, this,
+          &TextEditor::selectAllOccurrences);
+
   moveLineUpAct = new QAction("Move Line Up", this);
   moveLineUpAct->setShortcut(QKeySequence(Qt::ALT | Qt::Key_Up));
   connect(moveLineUpAct, &QAction::triggered, this, [this]() {
@@ -2675,6 +3738,46 @@ void TextEditor::createActions() {
   miniMapAct->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_M));
   connect(miniMapAct, &QAction::triggered, this, &TextEditor::toggleMiniMap);
 
+  entropyMapAct = new QAction("Entropy Map", this);
+  entropyMapAct->setCheckable(true);
+  entropyMapAct->setChecked(true);
+  entropyMapAct->setStatusTip("Show entropy and byte mix beside hex tabs; click to jump");
+  connect(entropyMapAct, &QAction::triggered, this, &TextEditor::toggleEntropyMap);
+
+  auto makeGroup = [this](std::initializer_list<std::pair<const char *, int>> items, int checked) {
+    auto *group = new QActionGroup(this);
+    for (const auto &item : items) {
+      QAction *act = group->addAction(item.first);
+      act->setCheckable(true);
+      act->setData(item.second);
+      act->setChecked(item.second == checked);
+    }
+    connect(group, &QActionGroup::triggered, this, &TextEditor::updateHexLayout);
+    return group;
+  };
+  hexBytesGroup = makeGroup({{"Fit to Width", 0}, {"8 Bytes per Line", 8},
+                             {"16 Bytes per Line", 16}, {"32 Bytes per Line", 32}}, 0);
+  hexGroupingGroup = makeGroup({{"Group by 1 Byte", 1}, {"Group by 2 Bytes", 2},
+                                {"Group by 4 Bytes", 4}, {"Group by 8 Bytes", 8}}, 1);
+  hexAddressGroup = makeGroup({{"8-Digit Addresses", 8}, {"12-Digit Addresses", 12},
+                               {"16-Digit Addresses", 16}}, 8);
+
+  perfOverlayAct = new QAction("Performance Overlay", this);
+  perfOverlayAct->setCheckable(true);
+  perfOverlayAct->setShortcut(QKeySequence("Ctrl+Shift+P"));
+  connect(perfOverlayAct, &QAction::triggered, this,
+          &TextEditor::togglePerfOverlay);
+
+  exportPerfTraceAct = new QAction("Export Performance Trace...", this);
+  connect(exportPerfTraceAct, &QAction::triggered, this,
+          &TextEditor::exportPerfTrace);
+
+  tailFollowAct = new QAction("Follow Tail", this);
+  tailFollowAct->setCheckable(true);
+  tailFollowAct->setChecked(false);
+  connect(tailFollowAct, &QAction::triggered, this,
+          &TextEditor::toggleTailFollow);
+
   terminalAct = new QAction("Terminal", this);
   terminalAct->setCheckable(true);
   terminalAct->setChecked(false);
@@ -2735,23 +3838,40 @@ void TextEditor::createActions() {
   binaryInspectAct->setStatusTip("Inspect ELF/PE headers, sections and imports");
   connect(binaryInspectAct, &QAction::triggered, this, &TextEditor::openBinaryInspector);
 
+  checksumAct = new QAction("&Checksums...", this);
+  checksumAct->setStatusTip("MD5, SHA-1, SHA-256, CRC32 and XXH64 of the hex selection or a file");
+  connect(checksumAct, &QAction::triggered, this, &TextEditor::showChecksums);
+
+  compareBinaryAct = new QAction("Co&mpare Binary Files...", this);
+  compareBinaryAct->setStatusTip("Side-by-side hex diff of two files");
+  connect(compareBinaryAct, &QAction::triggered, this, &TextEditor::compareBinaryFiles);
+
+  templateAct = new QAction("Structure &Template...", this);
+  templateAct->setStatusTip("Decode the hex tab with an ELF, PE or custom struct template");
+  connect(templateAct, &QAction::triggered, this, &TextEditor::showStructureTemplate);
+
+  inspectorAct = new QAction("Data &Inspector", this);
+  inspectorAct->setStatusTip("Decode the bytes at the hex cursor as integers, floats, time_t, GUID and more");
+  connect(inspectorAct, &QAction::triggered, this, &TextEditor::showDataInspector);
+
   openHexAct = new QAction("🗂 Open in &Hex Editor", this);
   openHexAct->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_H));
   openHexAct->setStatusTip("Re-open the current file in the built-in hex editor");
   connect(openHexAct, &QAction::triggered, this, [this]() {
       CodeEditor *ed = currentEditor();
       if (ed && !ed->getFileName().isEmpty()) {
-          QFile f(ed->getFileName());
-          if (f.open(QIODevice::ReadOnly)) {
-              QByteArray bytes = f.readAll();
-              HexEditor *hex = new HexEditor();
-              hex->setData(bytes);
+          HexEditor *hex = new HexEditor();
+          if (hex->loadFile(ed->getFileName())) {
               hex->setProperty("fileName", ed->getFileName());
+              hex->setEntropyMapVisible(entropyMapAct->isChecked());
+              applyHexLayout(hex);
               connect(hex, &HexEditor::modificationChanged,
                       this, &TextEditor::documentWasModified);
               int idx = tabWidget->addTab(hex, "[HEX] " + strippedName(ed->getFileName()));
               tabWidget->setCurrentIndex(idx);
               flashTabLabel(idx);
+          } else {
+              delete hex;
           }
       }
   });
@@ -2779,20 +3899,32 @@ void TextEditor::createMenus() {
   editMenu->addAction(pasteAct);
   editMenu->addSeparator();
   editMenu->addAction(selectAllAct);
+  editMenu->addAction(selectNextAct);
+  editMenu->addAction(selectAllOccurrencesAct);
 
   searchMenu = customMenuBar->addMenu("&Search");
   searchMenu->addAction(findAct);
   searchMenu->addAction(findNextAct);
   searchMenu->addAction(replaceAct);
   searchMenu->addAction(goToLineAct);
+  searchMenu->addAction(goToSymbolAct);
+  searchMenu->addAction(goToDefinitionAct);
 
   viewMenu = customMenuBar->addMenu("&View");
   viewMenu->addAction(fileTreeAct);
   viewMenu->addAction(miniMapAct);
+  viewMenu->addAction(entropyMapAct);
+  QMenu *hexLayoutMenu = viewMenu->addMenu("Hex Layout");
+  hexLayoutMenu->addActions(hexBytesGroup->actions());
+  hexLayoutMenu->addSeparator();
+  hexLayoutMenu->addActions(hexGroupingGroup->actions());
+  hexLayoutMenu->addSeparator();
+  hexLayoutMenu->addActions(hexAddressGroup->actions());
   viewMenu->addAction(terminalAct);
   viewMenu->addAction(toggleAnimationDockAct);
   viewMenu->addAction(animationAct);
   viewMenu->addAction(splitViewAct);
+  viewMenu->addAction(tailFollowAct);
   viewMenu->addSeparator();
   viewMenu->addAction(increaseFontAct);
   viewMenu->addAction(decreaseFontAct);
@@ -2812,7 +3944,13 @@ void TextEditor::createMenus() {
   toolsMenu->addAction(openHexAct);
   toolsMenu->addAction(disassembleAct);
   toolsMenu->addAction(binaryInspectAct);
+  toolsMenu->addAction(checksumAct);
+  toolsMenu->addAction(compareBinaryAct);
+  toolsMenu->addAction(templateAct);
+  toolsMenu->addAction(inspectorAct);
   toolsMenu->addSeparator();
+  toolsMenu->addAction(perfOverlayAct);
+  toolsMenu->addAction(exportPerfTraceAct);
   toolsMenu->setStyleSheet(
       "QMenu { background-color: #252526; color: #d4d4d4; border: 1px solid #3c3c3c; }"
       "QMenu::item:selected { background-color: #094771; }"
@@ -2826,6 +3964,11 @@ void TextEditor::createMenus() {
   connect(aiSettingsAct, &QAction::triggered, this, &TextEditor::showAISettings);
   pluginsMenu->addAction(aiSettingsAct);
 
+  languageServerAct = new QAction("Language Server for Current Language...", this);
+  connect(languageServerAct, &QAction::triggered, this,
+          &TextEditor::configureLanguageServer);
+  pluginsMenu->addAction(languageServerAct);
+
   aiToggleAct = new QAction("Enable AI Autocomplete", this);
   aiToggleAct->setCheckable(true);
   connect(aiToggleAct, &QAction::toggled, this, &TextEditor::toggleAIAutocomplete);
@@ -2840,13 +3983,14 @@ void TextEditor::showAISettings() {
     dialog.setSettings(settings.value("ai/baseUrl").toString(),
                        settings.value("ai/apiKey").toString(),
                        settings.value("ai/model").toString(),
-                       aiAutocomplete->isEnabled());
+                       aiAutocomplete && aiAutocomplete->isEnabled());
     
     if (dialog.exec() == QDialog::Accepted) {
         settings.setValue("ai/baseUrl", dialog.getBaseUrl());
         settings.setValue("ai/apiKey", dialog.getApiKey());
         settings.setValue("ai/model", dialog.getModel());
         
+        ensureAIAutocomplete();
         aiAutocomplete->setProvider(dialog.getBaseUrl(), dialog.getApiKey(), dialog.getModel());
         toggleAIAutocomplete(dialog.isEnabled());
         aiToggleAct->setChecked(dialog.isEnabled());
@@ -2854,6 +3998,10 @@ void TextEditor::showAISettings() {
 }
 
 void TextEditor::toggleAIAutocomplete(bool enabled) {
+    // The network client is only worth creating once someone turns AI on
+    if (!enabled && !aiAutocomplete)
+        return;
+    ensureAIAutocomplete();
     aiAutocomplete->setEnabled(enabled);
 }
 
@@ -2874,12 +4022,42 @@ void TextEditor::createStatusBar() {
   sessionTimeLabel->setStyleSheet("color: #888; padding: 0 10px;");
   statusBar()->addPermanentWidget(sessionTimeLabel);
   
+  // Shown for files opened in lean mode; the menu re-enables features one
+  // at a time for the current tab.
+  leanBadge = new QToolButton(this);
+  leanBadge->setText("⚡ Lean Mode");
+  leanBadge->setToolTip("Large file: some features are off for speed");
+  leanBadge->setPopupMode(QToolButton::InstantPopup);
+  leanBadge->setAutoRaise(true);
+  leanBadge->setStyleSheet("color: #e5c07b; padding: 0 6px;");
+  QMenu *leanMenu = new QMenu(leanBadge);
+  connect(leanMenu, &QMenu::aboutToShow, this, [this, leanMenu]() {
+    leanMenu->clear();
+    CodeEditor *editor = currentEditor();
+    if (!editor)
+      return;
+    const EditorFeature all[] = {FeatureHighlighting, FeatureColorSwatches,
+                                 FeatureBreadcrumbs,  FeatureFolding,
+                                 FeatureMiniMap,      FeatureLongLines};
+    for (EditorFeature f : all) {
+      QAction *act = leanMenu->addAction(LargeFilePolicy::featureName(f));
+      act->setCheckable(true);
+      act->setChecked(editor->hasFeature(f));
+      connect(act, &QAction::toggled, this, [this, editor, f](bool on) {
+        int features = editor->enabledFeatures();
+        applyEditorFeatures(editor, on ? (features | f) : (features & ~f));
+      });
+    }
+  });
+  leanBadge->setMenu(leanMenu);
+  leanBadge->hide();
+  statusBar()->addPermanentWidget(leanBadge);
+
   statusBar()->addPermanentWidget(statusLabel);
   statusBar()->showMessage("Ready");
 }
 
-void TextEditor::newFile() {
-  hideWelcomeScreen();
+CodeEditor *TextEditor::createCodeEditor() {
   CodeEditor *editor = new CodeEditor();
   SyntaxHighlighter *highlighter = new SyntaxHighlighter(editor->document());
   highlighters[editor] = highlighter;
@@ -2890,16 +4068,145 @@ void TextEditor::newFile() {
   applyThemeToEditor(editor, highlighter);
   connect(editor->document(), &QTextDocument::modificationChanged, this,
           &TextEditor::documentWasModified);
-  connect(editor, &QPlainTextEdit::cursorPositionChanged, this,
-          &TextEditor::updateStatusBar);
-  connect(editor, &QPlainTextEdit::cursorPositionChanged, this,
-          &TextEditor::updateBreadcrumb);
+  // Everything below runs per keystroke, so it only marks work dirty
+  connect(editor, &QPlainTextEdit::cursorPositionChanged, this, [this]() {
+    uiUpdates->schedule(UpdateStatusBar);
+    uiUpdates->schedule(UpdateBreadcrumb);
+  });
   connect(editor, &QPlainTextEdit::textChanged, this, [this, editor]() {
-      aiAutocomplete->trigger(editor);
+    aiPendingEditor = editor;
+    uiUpdates->schedule(UpdateAI);
   });
-  if (typingSoundEnabled && typingSound) {
-      connect(editor, &CodeEditor::characterTyped, typingSound, &QSoundEffect::play);
+  connect(editor, &CodeEditor::characterTyped, this,
+          [this]() { uiUpdates->schedule(UpdateSound); });
+  return editor;
+}
+
+Language TextEditor::setEditorContents(CodeEditor *editor,
+                                       const QString &fileName,
+                                       const QByteArray &data,
+                                       int *chunkedLines) {
+  // Huge or minified files start in lean mode with overlong lines split into
+  // display chunks; the status-bar badge opts features back in.
+  const int features = LargeFilePolicy::featuresFor(data);
+  QString text = QString::fromUtf8(data);
+  QVector<int> continuations;
+  if (!(features & FeatureLongLines))
+    text = LargeFilePolicy::chunkLongLines(text, &continuations);
+  if (chunkedLines)
+    *chunkedLines = continuations.size();
+
+  Language lang = detectLanguage(fileName);
+  editor->setLanguage(lang);
+  SyntaxHighlighter *highlighter = highlighters.value(editor);
+  // Detach before the text goes in so lean files never get highlighted; a
+  // reload that is no longer lean attaches again
+  QTextDocument *target =
+      (features & FeatureHighlighting) ? editor->document() : nullptr;
+  if (highlighter->document() != target)
+    highlighter->setDocument(target);
+  highlighter->setLanguage(lang);
+  editor->setEnabledFeatures(features);
+
+  editor->setChunkedText(text, continuations);
+  editor->setFileName(fileName);
+  editor->document()->setModified(false);
+  attachLanguageServer(editor);
+  return lang;
+}
+
+QString TextEditor::lspLanguageId(Language lang) {
+  switch (lang) {
+  case Language::CPP:        return "cpp";
+  case Language::Python:     return "python";
+  case Language::JavaScript: return "javascript";
+  case Language::HTML:       return "html";
+  case Language::CSS:        return "css";
+  case Language::Rust:       return "rust";
+  case Language::Go:         return "go";
+  case Language::JSON:       return "json";
+  case Language::YAML:       return "yaml";
+  case Language::Markdown:   return "markdown";
+  default:                   return "plaintext";
+  }
+}
+
+LspClient *TextEditor::languageServerFor(Language lang) {
+  if (LspClient *client = lspClients.value(int(lang)))
+    return client;
+  // Nothing runs unless the user configured a server for the language
+  const QString command =
+      QSettings().value("lsp/" + lspLanguageId(lang)).toString().trimmed();
+  QStringList arguments = QProcess::splitCommand(command);
+  if (arguments.isEmpty())
+    return nullptr;
+  const QString program = arguments.takeFirst();
+
+  LspClient *client = new LspClient(this);
+  connect(client, &LspClient::diagnosticsChanged, this,
+          [this](QTextDocument *doc, const QVector<LspDiagnostic> &list) {
+            for (int i = 0; i < tabWidget->count(); ++i) {
+              CodeEditor *editor = qobject_cast<CodeEditor *>(tabWidget->widget(i));
+              if (editor && editor->document() == doc)
+                editor->setDiagnostics(list);
+            }
+          });
+  connect(client, &LspClient::serverFailed, this, [this, lang](const QString &error) {
+    statusBar()->showMessage(lspLanguageId(lang) + " language server: " + error, 5000);
+    if (LspClient *failed = lspClients.take(int(lang)))
+      failed->deleteLater();
+  });
+  client->start(program, arguments,
+                currentFolder.isEmpty() ? QDir::currentPath() : currentFolder);
+  lspClients.insert(int(lang), client);
+  return client;
+}
+
+void TextEditor::attachLanguageServer(CodeEditor *editor) {
+  // Chunked (lean) documents do not map onto the file's lines
+  if (editor->getFileName().isEmpty() ||
+      LargeFilePolicy::isLean(editor->enabledFeatures()))
+    return;
+  if (LspClient *client = languageServerFor(editor->getLanguage()))
+    client->openDocument(editor->document(), editor->getFileName(),
+                         lspLanguageId(editor->getLanguage()));
+}
+
+void TextEditor::detachLanguageServer(CodeEditor *editor) {
+  for (LspClient *client : std::as_const(lspClients))
+    client->closeDocument(editor->document());
+  editor->setDiagnostics({});
+}
+
+void TextEditor::configureLanguageServer() {
+  CodeEditor *editor = currentEditor();
+  const Language lang = editor ? editor->getLanguage() : Language::CPP;
+  const QString id = lspLanguageId(lang);
+  QSettings settings;
+  bool ok;
+  const QString command = QInputDialog::getText(
+      this, "Language Server",
+      QString("Command for %1 files (empty to disable):").arg(id),
+      QLineEdit::Normal, settings.value("lsp/" + id).toString(), &ok);
+  if (!ok)
+    return;
+  settings.setValue("lsp/" + id, command.trimmed());
+
+  // Restart with the new command and reopen the matching tabs
+  if (LspClient *client = lspClients.take(int(lang)))
+    delete client;
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    CodeEditor *ed = qobject_cast<CodeEditor *>(tabWidget->widget(i));
+    if (ed && ed->getLanguage() == lang) {
+      ed->setDiagnostics({});
+      attachLanguageServer(ed);
+    }
   }
+}
+
+void TextEditor::newFile() {
+  hideWelcomeScreen();
+  CodeEditor *editor = createCodeEditor();
   int index = tabWidget->addTab(editor, "Untitled");
   tabWidget->setCurrentIndex(index);
   editor->setFocus();
@@ -2971,7 +4278,10 @@ void TextEditor::closeTab(int index) {
     CodeEditor *editor = qobject_cast<CodeEditor *>(tabWidget->widget(index));
     if (editor) {
       unwatchFile(editor->getFileName());
+      detachLanguageServer(editor);
       highlighters.remove(editor);
+      pendingTabs.remove(editor);
+      tabsLoading.remove(editor);
     }
     tabWidget->removeTab(index);
     if (tabWidget->count() == 0)
@@ -2980,8 +4290,13 @@ void TextEditor::closeTab(int index) {
 }
 
 void TextEditor::tabChanged(int) {
+  if (CodeEditor *ed = currentEditor())
+    ensureTabLoaded(ed);
   updateStatusBar();
   updateBreadcrumb();
+  updateLeanBadge();
+  tailFollowAct->setChecked(currentEditor() &&
+                            currentEditor()->isTailFollowing());
 
   // Keep markdown preview in sync when switching tabs
   if (markdownPreview && markdownPreview->isVisible()) {
@@ -2995,6 +4310,11 @@ void TextEditor::tabChanged(int) {
 
   CodeEditor *editor = currentEditor();
   HexEditor *hexEditor = qobject_cast<HexEditor *>(tabWidget->currentWidget());
+  // The template panel follows whichever hex tab is in front
+  if (templateView && templateDock->isVisible())
+    templateView->setEditor(hexEditor);
+  if (inspector && inspectorDock->isVisible())
+    inspector->setEditor(hexEditor);
   if (editor) {
     QString title = "Jim";
     if (!editor->getFileName().isEmpty())
@@ -3035,10 +4355,20 @@ void TextEditor::tabChanged(int) {
     tabWidget->setTabText(currentIdx, tabText);
 
     languageLabel->setText("Binary (Hex)");
+    if (hexEditor->isEntropyMapVisible() != entropyMapAct->isChecked())
+      hexEditor->setEntropyMapVisible(entropyMapAct->isChecked());
   }
 }
 
 void TextEditor::findText() {
+    if (qobject_cast<HexEditor *>(tabWidget->currentWidget())) {
+        findBar->setHexMode(true);
+        findBar->showAndFocus();
+        onFindTextChanged(findBar->getSearchText());
+        return;
+    }
+    findBar->setHexMode(false);
+
     CodeEditor *editor = currentEditor();
     if (!editor) return;
     
@@ -3050,6 +4380,21 @@ void TextEditor::findText() {
 }
 
 void TextEditor::onFindTextChanged(const QString &text) {
+    if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget())) {
+        QString error;
+        const HexSearch::Pattern pattern = HexSearch::parse(
+            text, HexSearch::Mode(findBar->hexSearchMode()), &error);
+        connect(hex, &HexEditor::searchUpdated, this, &TextEditor::onHexSearchUpdated,
+                Qt::UniqueConnection);
+        if (pattern.isValid()) {
+            hex->find(pattern);
+        } else {
+            hex->clearSearch();
+            findBar->setStatusText(text.isEmpty() ? "0/0" : error);
+        }
+        return;
+    }
+
     lastSearchText = text;
     currentMatches.clear();
     currentMatchIndex = -1;
@@ -3061,7 +4406,9 @@ void TextEditor::onFindTextChanged(const QString &text) {
         return;
     }
 
-    QString content = editor->toPlainText();
+    // Searched as logical text, so matches may run across the chunk
+    // boundaries of a lean document
+    QString content = editor->logicalText();
     QRegularExpression re(QRegularExpression::escape(text), QRegularExpression::CaseInsensitiveOption);
     QRegularExpressionMatchIterator i = re.globalMatch(content);
     
@@ -3069,12 +4416,14 @@ void TextEditor::onFindTextChanged(const QString &text) {
     
     while (i.hasNext()) {
         QRegularExpressionMatch match = i.next();
+        const int start = editor->documentPosition(match.capturedStart());
+        const int end = editor->documentPosition(match.capturedEnd() - 1) + 1;
         QTextCursor cursor(editor->document());
-        cursor.setPosition(match.capturedStart());
-        cursor.setPosition(match.capturedEnd(), QTextCursor::KeepAnchor);
+        cursor.setPosition(start);
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
         currentMatches.append(cursor);
         
-        if (currentMatchIndex == -1 && match.capturedStart() >= currentPos) {
+        if (currentMatchIndex == -1 && start >= currentPos) {
             currentMatchIndex = currentMatches.size() - 1;
         }
     }
@@ -3093,6 +4442,10 @@ void TextEditor::onFindTextChanged(const QString &text) {
 }
 
 void TextEditor::findNext() {
+    if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget())) {
+        hex->findNext();
+        return;
+    }
     if (currentMatches.isEmpty()) return;
     currentMatchIndex = (currentMatchIndex + 1) % currentMatches.size();
     CodeEditor *editor = currentEditor();
@@ -3105,6 +4458,10 @@ void TextEditor::findNext() {
 }
 
 void TextEditor::findPrevious() {
+    if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget())) {
+        hex->findPrevious();
+        return;
+    }
     if (currentMatches.isEmpty()) return;
     currentMatchIndex = (currentMatchIndex - 1 + currentMatches.size()) % currentMatches.size();
     CodeEditor *editor = currentEditor();
@@ -3116,8 +4473,31 @@ void TextEditor::findPrevious() {
     }
 }
 
+void TextEditor::selectAllOccurrences() {
+    CodeEditor *editor = currentEditor();
+    if (!editor) return;
+
+    // Reuse the find bar's matches when they belong to this document
+    if (findBar->isVisible() && !currentMatches.isEmpty() &&
+        currentMatches.first().document() == editor->document()) {
+        QVector<MultiCursor::Caret> carets;
+        carets.reserve(currentMatches.size());
+        for (const QTextCursor &m : std::as_const(currentMatches))
+            carets.append({m.selectionStart(), m.selectionEnd()});
+        editor->selectRanges(std::move(carets), currentMatchIndex);
+    } else {
+        editor->selectAllOccurrences();
+    }
+    editor->setFocus();
+    statusBar()->showMessage(QString("%1 cursors").arg(editor->cursorCount()), 2000);
+}
+
 void TextEditor::closeFindBar() {
     findBar->hide();
+    if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget())) {
+        hex->clearSearch();
+        hex->setFocus();
+    }
     currentMatches.clear();
     currentMatchIndex = -1;
     updateSearchHighlights();
@@ -3126,6 +4506,15 @@ void TextEditor::closeFindBar() {
     }
 }
 
+void TextEditor::onHexSearchUpdated(int current, int total, bool finished) {
+    if (sender() != tabWidget->currentWidget())
+        return;
+    if (total == 0)
+        findBar->setStatusText(finished ? "No results" : "Searching...");
+    else
+        findBar->setStatusText(QString("%1/%2%3").arg(current).arg(total).arg(finished ? "" : "+"));
+}
+
 void TextEditor::updateSearchHighlights() {
     CodeEditor *editor = currentEditor();
     if (editor) {
@@ -3147,9 +4536,14 @@ void TextEditor::replaceText() {
   if (!ok)
     return;
   lastSearchText = findStr;
-  QString content = editor->toPlainText();
+  // Replaced on logical lines and chunked again, so a match may straddle a
+  // chunk boundary
+  QString content = editor->logicalText();
   content.replace(findStr, replaceStr);
-  editor->setPlainText(content);
+  QVector<int> continuations;
+  if (!editor->hasFeature(FeatureLongLines))
+    content = LargeFilePolicy::chunkLongLines(content, &continuations);
+  editor->setChunkedText(content, continuations);
 }
 
 void TextEditor::goToLine() {
@@ -3166,6 +4560,166 @@ void TextEditor::goToLine() {
   }
 }
 
+void TextEditor::goToSymbol() {
+  if (symbolIndex->root().isEmpty()) {
+    statusBar()->showMessage("Open a folder to search its symbols", 3000);
+    return;
+  }
+  QString word;
+  if (CodeEditor *editor = currentEditor()) {
+    QTextCursor cursor = editor->textCursor();
+    if (!cursor.hasSelection())
+      cursor.select(QTextCursor::WordUnderCursor);
+    word = cursor.selectedText();
+  }
+  showSymbolPicker("Go to Symbol", word);
+}
+
+void TextEditor::goToDefinition() {
+  CodeEditor *editor = currentEditor();
+  if (!editor)
+    return;
+  QTextCursor cursor = editor->textCursor();
+  cursor.select(QTextCursor::WordUnderCursor);
+  const QString word = cursor.selectedText();
+  if (word.isEmpty())
+    return;
+
+  // A language server knows overloads and scopes; editing the document
+  // again before it answers cancels the request
+  LspClient *client = lspClients.value(int(editor->getLanguage()));
+  if (client && client->hasDocument(editor->document())) {
+    const QTextCursor at = editor->textCursor();
+    QPointer<CodeEditor> origin = editor;
+    client->request(
+        editor->document(), "textDocument/definition",
+        {{"textDocument", LspClient::documentIdentifier(editor->getFileName())},
+         {"position", LspClient::position(at.blockNumber(), at.positionInBlock())}},
+        [this, origin, word](const QJsonValue &result) {
+          // Location, Location[] or LocationLink[]
+          const QJsonArray all = result.toArray();
+          const QJsonObject first = result.isArray()
+                                        ? (all.isEmpty() ? QJsonObject() : all.first().toObject())
+                                        : result.toObject();
+          const QString uri = first.contains("targetUri")
+                                  ? first.value("targetUri").toString()
+                                  : first.value("uri").toString();
+          const QJsonObject range =
+              first.value(first.contains("targetSelectionRange") ? "targetSelectionRange"
+                                                                 : "range")
+                  .toObject();
+          if (!uri.isEmpty()) {
+            openLocation(QUrl(uri).toLocalFile(),
+                         range.value("start").toObject().value("line").toInt());
+          } else if (origin && origin == currentEditor()) {
+            goToIndexedDefinition(word);
+          }
+        });
+    return;
+  }
+  goToIndexedDefinition(word);
+}
+
+void TextEditor::goToIndexedDefinition(const QString &word) {
+  const QVector<SymbolIndex::Entry> found = symbolIndex->definitions(word);
+  if (found.isEmpty()) {
+    statusBar()->showMessage(
+        symbolIndex->root().isEmpty()
+            ? QString("Open a folder to look up definitions")
+            : QString("No definition found for '%1'").arg(word),
+        3000);
+    return;
+  }
+  if (found.size() == 1)
+    openLocation(found.first().file, found.first().line);
+  else
+    showSymbolPicker("Definitions of " + word, word, found);
+}
+
+void TextEditor::showSymbolPicker(const QString &title, const QString &query,
+                                  const QVector<SymbolIndex::Entry> &fixed) {
+  QDialog dialog(this);
+  dialog.setWindowTitle(title);
+  dialog.resize(640, 420);
+  QVBoxLayout *layout = new QVBoxLayout(&dialog);
+  QLineEdit *filter = new QLineEdit(&dialog);
+  filter->setPlaceholderText("Symbol name");
+  QListWidget *list = new QListWidget(&dialog);
+  layout->addWidget(filter);
+  layout->addWidget(list);
+
+  // With no fixed list typing queries the index.  Prefix matches are a
+  // binary search, but substring matches scan every symbol, so the query
+  // waits for a pause in typing.
+  QVector<SymbolIndex::Entry> shown;
+  auto refresh = [&]() {
+    shown = fixed.isEmpty() ? symbolIndex->find(filter->text()) : fixed;
+    list->clear();
+    const QString root = symbolIndex->root() + '/';
+    for (const SymbolIndex::Entry &e : std::as_const(shown)) {
+      QString file = e.file;
+      if (file.startsWith(root))
+        file = file.mid(root.size());
+      list->addItem(QString("%1    %2:%3").arg(e.display(), file).arg(e.line + 1));
+    }
+    list->setCurrentRow(0);
+  };
+  QTimer *filterTimer = new QTimer(&dialog);
+  filterTimer->setSingleShot(true);
+  filterTimer->setInterval(150);
+  connect(filterTimer, &QTimer::timeout, &dialog, refresh);
+  auto accept = [&]() {
+    // Enter right after typing picks from the query just typed
+    if (filterTimer->isActive()) {
+      filterTimer->stop();
+      refresh();
+    }
+    if (list->currentRow() >= 0)
+      dialog.accept();
+  };
+  connect(filter, &QLineEdit::textChanged, filterTimer,
+          qOverload<>(&QTimer::start));
+  connect(filter, &QLineEdit::returnPressed, &dialog, accept);
+  connect(list, &QListWidget::itemActivated, &dialog, accept);
+  connect(symbolIndex, &SymbolIndex::indexed, &dialog, refresh);
+
+  filter->setText(query);
+  filter->selectAll();
+  if (!fixed.isEmpty())
+    filter->hide();
+  filterTimer->stop();
+  refresh();
+
+  if (dialog.exec() == QDialog::Accepted) {
+    const int row = list->currentRow();
+    if (row >= 0 && row < shown.size())
+      openLocation(shown[row].file, shown[row].line);
+  }
+}
+
+void TextEditor::openLocation(const QString &filePath, int line) {
+  CodeEditor *editor = nullptr;
+  for (int i = 0; i < tabWidget->count() && !editor; ++i) {
+    CodeEditor *ed = qobject_cast<CodeEditor *>(tabWidget->widget(i));
+    if (ed && QFileInfo(ed->getFileName()) == QFileInfo(filePath)) {
+      tabWidget->setCurrentIndex(i);
+      editor = ed;
+    }
+  }
+  if (!editor) {
+    loadFile(filePath);
+    editor = currentEditor();
+  }
+  if (!editor)
+    return;
+  QTextBlock block = editor->blockForLogicalLine(line);
+  if (!block.isValid())
+    return;
+  editor->setTextCursor(QTextCursor(block));
+  editor->centerCursor();
+  editor->setFocus();
+}
+
 void TextEditor::documentWasModified() {
   tabChanged(tabWidget->currentIndex());
 }
@@ -3175,8 +4729,8 @@ void TextEditor::updateStatusBar() {
   if (editor) {
     QTextCursor cursor = editor->textCursor();
     statusLabel->setText(QString("Ln %1, Col %2")
-                             .arg(cursor.blockNumber() + 1)
-                             .arg(cursor.columnNumber() + 1));
+                             .arg(editor->logicalLineNumber(cursor.block()) + 1)
+                             .arg(editor->logicalColumn(cursor) + 1));
   }
 }
 
@@ -3218,6 +4772,7 @@ void TextEditor::toggleWordWrap() {
 }
 
 void TextEditor::animateTerminalShow() {
+  ensureTerminal();
   terminalWidget->show();
   if (!terminalAnim) {
     terminalAnim = new QVariantAnimation(this);
@@ -3276,7 +4831,7 @@ void TextEditor::animateTerminalHide() {
 }
 
 void TextEditor::toggleTerminal() {
-  bool currentlyVisible = terminalWidget->isVisible() &&
+  bool currentlyVisible = terminalWidget && terminalWidget->isVisible() &&
                           verticalSplitter->sizes().value(1, 0) > 5;
   if (currentlyVisible) {
     animateTerminalHide();
@@ -3288,6 +4843,7 @@ void TextEditor::toggleTerminal() {
 }
 
 void TextEditor::cycleAnimation() {
+  ensureAnimationDock();
   animationWidget->cycleAnimation();
   
   AnimationWidget::AnimationType currentType = animationWidget->getCurrentType();
@@ -3316,6 +4872,7 @@ void TextEditor::cycleAnimation() {
 }
 
 void TextEditor::toggleAnimationDock() {
+    ensureAnimationDock();
     if (animationDock->isVisible()) {
         animationDock->hide();
         animationWidget->setAnimationType(AnimationWidget::None);
@@ -3341,8 +4898,8 @@ void TextEditor::toggleZenMode() {
     applyZen(breadcrumbBar, zenModeActive);
     
     if (zenModeActive) {
-        if (terminalWidget->isVisible()) terminalWidget->hide();
-        if (animationDock->isVisible()) animationDock->hide();
+        if (terminalWidget && terminalWidget->isVisible()) terminalWidget->hide();
+        if (animationDock && animationDock->isVisible()) animationDock->hide();
         if (fileTreeDock->isVisible()) fileTreeDock->hide();
         // Don't hide DJ visualizer dock - keep it visible in fullscreen
         setWindowState(windowState() | Qt::WindowFullScreen);
@@ -3370,16 +4927,6 @@ void TextEditor::toggleTypingSound() {
         }
         typingSound->setSource(QUrl::fromLocalFile(tempPath));
         typingSound->setVolume(0.5f);
-        
-        for (int i=0; i<tabWidget->count(); i++) {
-            CodeEditor *ed = qobject_cast<CodeEditor*>(tabWidget->widget(i));
-            if (ed) connect(ed, &CodeEditor::characterTyped, typingSound, &QSoundEffect::play);
-        }
-    } else if (!typingSoundEnabled && typingSound) {
-        for (int i=0; i<tabWidget->count(); i++) {
-            CodeEditor *ed = qobject_cast<CodeEditor*>(tabWidget->widget(i));
-            if (ed) disconnect(ed, &CodeEditor::characterTyped, typingSound, &QSoundEffect::play);
-        }
     }
 }
 
@@ -3422,7 +4969,8 @@ void TextEditor::toggleDJMode() {
             djVisualizerDock->setVisible(false);
         }
         // Reset the dock animation widget to Matrix mode
-        animationWidget->setAnimationType(AnimationWidget::Matrix);
+        if (animationWidget)
+            animationWidget->setAnimationType(AnimationWidget::Matrix);
     }
 }
 
@@ -3457,9 +5005,210 @@ void TextEditor::closeEvent(QCloseEvent *event) {
   settings.setValue("sessionSeconds", secs);
   
   writeSettings();
+  writeSession();
   event->accept();
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Session
+//  A small QDataStream snapshot of the open text tabs (path, cursor, scroll,
+//  collapsed folds), the current tab and the split state.  Restoring creates
+//  empty tab shells first so the window is interactive immediately.
+// ─────────────────────────────────────────────────────────────────────────────
+
+static const quint32 SessionMagic = 0x4A494D53; // "JIMS"
+static const quint16 SessionVersion = 1;
+
+QString TextEditor::sessionFilePath() {
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+         "/session.bin";
+}
+
+void TextEditor::writeSession() {
+  QList<SessionTab> tabs;
+  int current = -1;
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    CodeEditor *editor = qobject_cast<CodeEditor *>(tabWidget->widget(i));
+    if (!editor || editor->getFileName().isEmpty())
+      continue;
+    if (tabWidget->currentIndex() == i)
+      current = tabs.size();
+
+    // Shells that were never opened keep the state they were restored with
+    if (pendingTabs.contains(editor)) {
+      tabs.append(pendingTabs.value(editor));
+      continue;
+    }
+    SessionTab tab;
+    tab.path = editor->getFileName();
+    tab.cursor = editor->textCursor().position();
+    tab.scroll = editor->verticalScrollBar()->value();
+    if (editor->hasFeature(FeatureFolding)) {
+      for (QTextBlock b = editor->document()->begin(); b.isValid();
+           b = b.next()) {
+        if (b.isVisible() && editor->isFolded(b))
+          tab.folds.append(b.blockNumber());
+      }
+    }
+    tabs.append(tab);
+  }
+
+  QDir().mkpath(QFileInfo(sessionFilePath()).absolutePath());
+  QSaveFile file(sessionFilePath());
+  if (!file.open(QFile::WriteOnly))
+    return;
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_6_0);
+  out << SessionMagic << SessionVersion;
+  out << qint32(tabs.size());
+  for (const SessionTab &tab : tabs)
+    out << tab.path << tab.cursor << tab.scroll << tab.folds;
+  out << qint32(current) << splitViewEnabled << mainSplitter->sizes();
+  file.commit();
+}
+
+void TextEditor::restoreSession() {
+  QFile file(sessionFilePath());
+  if (!file.open(QFile::ReadOnly))
+    return;
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_6_0);
+  quint32 magic = 0;
+  quint16 version = 0;
+  in >> magic >> version;
+  if (magic != SessionMagic || version != SessionVersion)
+    return;
+
+  qint32 count = 0;
+  in >> count;
+  QList<SessionTab> tabs;
+  for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    SessionTab tab;
+    in >> tab.path >> tab.cursor >> tab.scroll >> tab.folds;
+    tabs.append(tab);
+  }
+  qint32 current = -1;
+  bool split = false;
+  QList<int> sizes;
+  in >> current >> split >> sizes;
+  if (in.status() != QDataStream::Ok)
+    return;
+
+  // Shells only: no file I/O here, so 60 tabs cost 60 empty widgets
+  CodeEditor *currentShell = nullptr;
+  for (int i = 0; i < tabs.size(); ++i) {
+    const SessionTab &tab = tabs[i];
+    if (!QFileInfo::exists(tab.path))
+      continue;
+    CodeEditor *editor = createCodeEditor();
+    editor->setFileName(tab.path);
+    pendingTabs.insert(editor, tab);
+    tabWidget->addTab(editor, strippedName(tab.path));
+    if (i == current)
+      currentShell = editor;
+  }
+  if (pendingTabs.isEmpty())
+    return;
+
+  hideWelcomeScreen();
+  if (split != splitViewEnabled)
+    toggleSplitView();
+  if (!sizes.isEmpty())
+    mainSplitter->setSizes(sizes);
+
+  // Activating the current tab starts loading it through tabChanged()
+  tabWidget->setCurrentWidget(currentShell ? currentShell
+                                           : tabWidget->widget(0));
+
+  if (!sessionLoadTimer) {
+    sessionLoadTimer = new QTimer(this);
+    sessionLoadTimer->setInterval(15);
+    connect(sessionLoadTimer, &QTimer::timeout, this,
+            &TextEditor::loadNextPendingTab);
+  }
+  sessionLoadTimer->start();
+}
+
+void TextEditor::loadNextPendingTab() {
+  // The rest follow in tab order, one read at a time
+  if (!tabsLoading.isEmpty())
+    return;
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    CodeEditor *editor = qobject_cast<CodeEditor *>(tabWidget->widget(i));
+    if (editor && pendingTabs.contains(editor)) {
+      ensureTabLoaded(editor);
+      return;
+    }
+  }
+  sessionLoadTimer->stop();
+}
+
+void TextEditor::ensureTabLoaded(CodeEditor *editor) {
+  auto it = pendingTabs.find(editor);
+  if (it == pendingTabs.end() || tabsLoading.contains(editor))
+    return;
+  const QString path = it->path;
+  tabsLoading.insert(editor);
+  // The shell stays empty until the text arrives; keep it from being typed
+  // into and saved over the file
+  editor->setReadOnly(true);
+
+  struct Read {
+    bool ok = false;
+    QByteArray data;
+    QString error;
+  };
+  auto read = std::make_shared<Read>();
+  QThread *reader = QThread::create([path, read]() {
+    QFile file(path);
+    read->ok = file.open(QFile::ReadOnly);
+    if (read->ok)
+      read->data = file.readAll();
+    else
+      read->error = file.errorString();
+  });
+  QPointer<CodeEditor> target(editor);
+  connect(reader, &QThread::finished, this, [this, editor, target, read]() {
+    tabsLoading.remove(editor);
+    if (target)
+      applyLoadedTab(target, read->data, read->ok ? QString() : read->error);
+  });
+  connect(reader, &QThread::finished, reader, &QObject::deleteLater);
+  reader->start();
+}
+
+void TextEditor::applyLoadedTab(CodeEditor *editor, const QByteArray &data,
+                                const QString &error) {
+  auto it = pendingTabs.find(editor);
+  if (it == pendingTabs.end())
+    return;
+  const SessionTab tab = it.value();
+  pendingTabs.erase(it);
+  editor->setReadOnly(false);
+
+  if (!error.isEmpty()) {
+    statusBar()->showMessage(
+        QString("Cannot restore %1: %2").arg(tab.path, error), 3000);
+    return;
+  }
+  setEditorContents(editor, tab.path, data);
+
+  for (int fold : tab.folds)
+    editor->toggleFoldAt(fold);
+  QTextCursor cursor(editor->document());
+  cursor.setPosition(
+      qBound(0, int(tab.cursor), editor->document()->characterCount() - 1));
+  editor->setTextCursor(cursor);
+  editor->verticalScrollBar()->setValue(tab.scroll);
+
+  watchFile(tab.path);
+  if (editor == currentEditor()) {
+    updateStatusBar();
+    updateBreadcrumb();
+    updateLeanBadge();
+  }
+}
+
 void TextEditor::readSettings() {
   QSettings settings("TextEditor", "Settings");
   recentFiles = settings.value("recentFiles").toStringList();
@@ -3515,15 +5264,15 @@ void TextEditor::loadFile(const QString &fileName) {
     return;
   }
 
-  // Check if file is binary
-  QByteArray fileData = file.readAll();
-  file.close();
+  // Check if file is binary from its first bytes only; binaries are mapped,
+  // so only text files are read whole
+  const QByteArray sample = file.peek(512);
 
   bool isBinary = false;
   int nullCount = 0;
-  int sampleSize = qMin(512, fileData.size());
+  int sampleSize = sample.size();
   for (int i = 0; i < sampleSize; ++i) {
-    if (fileData[i] == 0) {
+    if (sample[i] == 0) {
       nullCount++;
       if (nullCount > 1) {
         isBinary = true;
@@ -3536,12 +5285,17 @@ void TextEditor::loadFile(const QString &fileName) {
   QApplication::setOverrideCursor(Qt::WaitCursor);
 
   Language lang = Language::PlainText; // Default language
+  int chunkedLines = 0;
 
   if (isBinary) {
     // Open in hex editor
     HexEditor *hexEditor = new HexEditor();
-    hexEditor->setData(fileData);
+    if (!hexEditor->loadFile(fileName))
+      hexEditor->setData(file.readAll());
+    file.close();
     hexEditor->setProperty("fileName", fileName);
+    hexEditor->setEntropyMapVisible(entropyMapAct->isChecked());
+    applyHexLayout(hexEditor);
 
     connect(hexEditor, &HexEditor::modificationChanged, this,
             &TextEditor::documentWasModified);
@@ -3549,37 +5303,16 @@ void TextEditor::loadFile(const QString &fileName) {
     int index = tabWidget->addTab(hexEditor, "[HEX] " + strippedName(fileName));
     tabWidget->setCurrentIndex(index);
   } else {
-    // Open in text editor
-    CodeEditor *editor = new CodeEditor();
-    editor->setPlainText(QString::fromUtf8(fileData));
-    editor->setFileName(fileName);
-    editor->document()->setModified(false);
-
-    // Auto-detect language
-    lang = detectLanguage(fileName);
-    editor->setLanguage(lang);
-
-    SyntaxHighlighter *highlighter = new SyntaxHighlighter(editor->document());
-    highlighter->setLanguage(lang);
-    highlighters[editor] = highlighter;
-
-    QFont font("Consolas", fontSize);
-    editor->setFont(font);
-    editor->setLineWrapMode(wordWrapEnabled ? QPlainTextEdit::WidgetWidth
-                                            : QPlainTextEdit::NoWrap);
-    applyThemeToEditor(editor, highlighter);
-
-    connect(editor->document(), &QTextDocument::modificationChanged, this,
-            &TextEditor::documentWasModified);
-    connect(editor, &QPlainTextEdit::cursorPositionChanged, this,
-            &TextEditor::updateStatusBar);
-    connect(editor, &QPlainTextEdit::cursorPositionChanged, this,
-            &TextEditor::updateBreadcrumb);
+    QByteArray fileData = file.readAll();
+    file.close();
+    CodeEditor *editor = createCodeEditor();
+    lang = setEditorContents(editor, fileName, fileData, &chunkedLines);
 
     int index = tabWidget->addTab(editor, strippedName(fileName));
     tabWidget->setCurrentIndex(index);
 
     watchFile(fileName);
+    updateLeanBadge();
   }
 
   QApplication::restoreOverrideCursor();
@@ -3595,10 +5328,33 @@ void TextEditor::loadFile(const QString &fileName) {
     languageLabel->setText(langNames[static_cast<int>(lang)]);
   }
 
-  statusBar()->showMessage("File loaded", 2000);
+  if (chunkedLines > 0)
+    statusBar()->showMessage(
+        QString("Lean mode: long lines split into %1 display chunk(s)")
+            .arg(chunkedLines),
+        5000);
+  else
+    statusBar()->showMessage("File loaded", 2000);
 }
 
 bool TextEditor::saveFileToPath(const QString &fileName) {
+  // A restored tab still being read holds none of its text yet
+  if (currentEditor() && pendingTabs.contains(currentEditor())) {
+    statusBar()->showMessage("The file is still loading", 3000);
+    return false;
+  }
+  // Neither the tab being saved nor a tab following the target file may be
+  // tailing: one holds only the last lines, the other reads the writes back
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    CodeEditor *editor = qobject_cast<CodeEditor *>(tabWidget->widget(i));
+    if (editor && editor->isTailFollowing() &&
+        (editor == currentEditor() || editor->getFileName() == fileName)) {
+      statusBar()->showMessage("Stop following the file before saving it",
+                               3000);
+      return false;
+    }
+  }
+
   QGuiApplication::setOverrideCursor(Qt::WaitCursor);
   
   // Temporarily unwatch to prevent false "modified externally" alert
@@ -3610,8 +5366,8 @@ bool TextEditor::saveFileToPath(const QString &fileName) {
     HexEditor *hexEditor =
         qobject_cast<HexEditor *>(tabWidget->currentWidget());
     if (editor) {
-      // Trim trailing whitespace
-      QString text = editor->toPlainText();
+      // Trim trailing whitespace (on logical lines, so chunks join back up)
+      QString text = editor->logicalText();
       QStringList lines = text.split('\n');
       for (int i = 0; i < lines.size(); ++i) {
         while (lines[i].endsWith(' ') || lines[i].endsWith('\t')) {
@@ -3632,8 +5388,7 @@ bool TextEditor::saveFileToPath(const QString &fileName) {
         return false;
       }
     } else if (hexEditor) {
-      file.write(hexEditor->data());
-      if (!file.commit()) {
+      if (!hexEditor->write(&file) || !file.commit()) {
         QGuiApplication::restoreOverrideCursor();
         watchFile(fileName); // Re-watch on failure
         QMessageBox::warning(this, "Jim",
@@ -3642,7 +5397,7 @@ bool TextEditor::saveFileToPath(const QString &fileName) {
                                  .arg(file.errorString()));
         return false;
       }
-      hexEditor->setModified(false);
+      hexEditor->fileSaved(fileName);
       hexEditor->setProperty("fileName", fileName);
     }
   } else {
@@ -3658,6 +5413,7 @@ bool TextEditor::saveFileToPath(const QString &fileName) {
   
   // Re-watch after successful save
   watchFile(fileName);
+  symbolIndex->fileChanged(fileName);
   
   setCurrentFile(fileName);
   updateRecentFiles(fileName);
@@ -3670,11 +5426,16 @@ void TextEditor::setCurrentFile(const QString &fileName) {
   if (!editor)
     return;
   unwatchFile(editor->getFileName());
+  const bool renamed = editor->getFileName() != fileName;
+  if (renamed)
+    detachLanguageServer(editor);
   editor->setFileName(fileName);
   editor->document()->setModified(false);
   // Re-detect language
   Language lang = detectLanguage(fileName);
   editor->setLanguage(lang);
+  if (renamed)
+    attachLanguageServer(editor);
   SyntaxHighlighter *hl = highlighters.value(editor);
   if (hl) {
     hl->setLanguage(lang);
@@ -3832,6 +5593,7 @@ void TextEditor::openFolder() {
       QFileDialog::getExistingDirectory(this, "Open Folder", QDir::homePath());
   if (!folder.isEmpty()) {
     currentFolder = folder;
+    symbolIndex->setRoot(folder);
     fileSystemModel->setRootPath(folder);
     fileTree->setRootIndex(fileSystemModel->index(folder));
 
@@ -3898,6 +5660,7 @@ void TextEditor::openFolderPath(const QString &folderPath) {
   QFileInfo fileInfo(folderPath);
   if (fileInfo.exists() && fileInfo.isDir()) {
     currentFolder = folderPath;
+    symbolIndex->setRoot(folderPath);
     fileTree->setRootIndex(fileSystemModel->index(folderPath));
     fileTreeDock->show();
     statusBar()->showMessage("Opened folder: " + folderPath, 2000);
@@ -3910,7 +5673,7 @@ void TextEditor::toggleMiniMap() {
     if (editor) {
       MiniMap *miniMap = editor->getMiniMap();
       if (miniMap) {
-        if (miniMapAct->isChecked())
+        if (miniMapAct->isChecked() && editor->hasFeature(FeatureMiniMap))
           miniMap->show();
         else
           miniMap->hide();
@@ -3921,6 +5684,100 @@ void TextEditor::toggleMiniMap() {
   }
 }
 
+void TextEditor::toggleEntropyMap() {
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->widget(i)))
+      hex->setEntropyMapVisible(entropyMapAct->isChecked());
+  }
+}
+
+void TextEditor::applyHexLayout(HexEditor *hex) {
+  const int bytes = hexBytesGroup->checkedAction()->data().toInt();
+  const int group = hexGroupingGroup->checkedAction()->data().toInt();
+  const int digits = hexAddressGroup->checkedAction()->data().toInt();
+  // Setters reflow, so skip the ones already in effect
+  if (hex->groupSize() != group)
+    hex->setGroupSize(group);
+  if (hex->addressWidth() != digits)
+    hex->setAddressWidth(digits);
+  if (bytes == 0 && !hex->autoFit())
+    hex->setAutoFit(true);
+  else if (bytes > 0 && (hex->autoFit() || hex->bytesPerLine() != bytes))
+    hex->setBytesPerLine(bytes);
+}
+
+void TextEditor::updateHexLayout() {
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->widget(i)))
+      applyHexLayout(hex);
+  }
+}
+
+void TextEditor::toggleTailFollow() {
+  CodeEditor *editor = currentEditor();
+  if (!editor || editor->getFileName().isEmpty()) {
+    tailFollowAct->setChecked(false);
+    statusBar()->showMessage("Follow Tail needs a tab backed by a file", 3000);
+    return;
+  }
+
+  if (!tailFollowAct->isChecked()) {
+    editor->stopTailFollow();
+    statusBar()->showMessage("Stopped following " +
+                                 strippedName(editor->getFileName()),
+                             3000);
+    return;
+  }
+
+  if (editor->isModified()) {
+    tailFollowAct->setChecked(false);
+    QMessageBox::warning(this, "Jim",
+                         "Save or discard your changes before following "
+                         "this file.");
+    return;
+  }
+
+  // 0 keeps every line; the default keeps long-running logs bounded
+  QSettings settings("TextEditor", "Settings");
+  int maxLines = settings.value("tailMaxLines", 100000).toInt();
+  if (!editor->startTailFollow(maxLines)) {
+    tailFollowAct->setChecked(false);
+    QMessageBox::warning(this, "Jim",
+                         QString("Cannot read file %1.")
+                             .arg(editor->getFileName()));
+    return;
+  }
+  statusBar()->showMessage("Following " + strippedName(editor->getFileName()),
+                           3000);
+}
+
+void TextEditor::togglePerfOverlay() {
+  const bool on = perfOverlayAct->isChecked();
+  PerfMonitor::instance().setEnabled(on);
+  if (!perfOverlay)
+    perfOverlay = new PerfOverlay(this);
+  perfOverlay->setVisible(on);
+}
+
+void TextEditor::exportPerfTrace() {
+  if (!PerfMonitor::isEnabled()) {
+    statusBar()->showMessage(
+        "Turn on Performance Overlay first to record a trace", 3000);
+    return;
+  }
+  QString path = QFileDialog::getSaveFileName(
+      this, "Export Performance Trace", "jim-trace.json",
+      "Chrome Trace (*.json)");
+  if (path.isEmpty())
+    return;
+  if (!PerfMonitor::instance().exportChromeTrace(path)) {
+    QMessageBox::warning(this, "Jim",
+                         QString("Cannot write file %1.").arg(path));
+    return;
+  }
+  statusBar()->showMessage("Trace written to " + path, 3000);
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Markdown Preview
 // ─────────────────────────────────────────────────────────────────────────────
@@ -3986,7 +5843,7 @@ void TextEditor::connectMarkdownPreview(CodeEditor *editor)
     markdownEditor = editor;
     if (editor) {
         connect(editor->document(), &QTextDocument::contentsChanged,
-                markdownTimer,       qOverload<>(&QTimer::start));
+                this, &TextEditor::scheduleMarkdownUpdate);
     }
 }
 
@@ -3994,11 +5851,16 @@ void TextEditor::disconnectMarkdownPreview()
 {
     if (markdownEditor) {
         disconnect(markdownEditor->document(), &QTextDocument::contentsChanged,
-                   markdownTimer, qOverload<>(&QTimer::start));
+                   this, &TextEditor::scheduleMarkdownUpdate);
         markdownEditor = nullptr;
     }
 }
 
+void TextEditor::scheduleMarkdownUpdate()
+{
+    uiUpdates->schedule(UpdateMarkdown);
+}
+
 void TextEditor::updateMarkdownPreview()
 {
     if (!markdownPreview || !markdownPreview->isVisible()) return;
@@ -4150,6 +6012,102 @@ void TextEditor::openBinaryInspector() {
         openInBinaryInspector(path);
 }
 
+void TextEditor::showChecksums() {
+    // Hex tabs hash their buffer, unsaved edits included; anything else
+    // hashes a file through a mapping
+    if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget())) {
+        const QString name = strippedName(hex->property("fileName").toString());
+        if (hex->hasSelection()) {
+            (new ChecksumDialog(name + " (selection)", hex->snapshot(),
+                                hex->selectionStart(), hex->selectionLength(), this))->show();
+        } else {
+            (new ChecksumDialog(name, hex->snapshot(), 0, hex->size(), this))->show();
+        }
+        return;
+    }
+
+    QString path;
+    if (CodeEditor *ed = currentEditor())
+        path = ed->getFileName();
+    if (path.isEmpty())
+        path = QFileDialog::getOpenFileName(this, "Select File to Hash");
+    if (path.isEmpty())
+        return;
+    // Opened off the GUI thread: mapping is quick, but a file that cannot be
+    // mapped is read instead.  The snapshot keeps the mapping alive after
+    // the table goes away.
+    struct Opened {
+        PieceTable::Snapshot snapshot;
+        QString error;
+        bool ok = false;
+    };
+    auto opened = std::make_shared<Opened>();
+    QThread *opener = QThread::create([path, opened]() {
+        PieceTable file;
+        opened->ok = file.open(path, &opened->error, PieceTable::ReadOnly);
+        opened->snapshot = file.snapshot();
+    });
+    connect(opener, &QThread::finished, this, [this, path, opened]() {
+        if (!opened->ok) {
+            QMessageBox::warning(this, "Jim",
+                                 QString("Cannot read file %1:\n%2.").arg(path).arg(opened->error));
+            return;
+        }
+        const PieceTable::Snapshot &snapshot = opened->snapshot;
+        (new ChecksumDialog(strippedName(path), snapshot, 0, snapshot.size(), this))->show();
+    });
+    connect(opener, &QThread::finished, opener, &QObject::deleteLater);
+    opener->start();
+}
+
+void TextEditor::compareBinaryFiles() {
+    // The current file is the left side when there is one
+    QString left;
+    if (CodeEditor *ed = currentEditor()) {
+        left = ed->getFileName();
+    } else if (HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget())) {
+        left = hex->property("fileName").toString();
+    }
+    if (left.isEmpty())
+        left = QFileDialog::getOpenFileName(this, "Select First File to Compare");
+    if (left.isEmpty())
+        return;
+    const QString right = QFileDialog::getOpenFileName(
+        this, "Compare " + strippedName(left) + " With", QFileInfo(left).absolutePath());
+    if (right.isEmpty())
+        return;
+
+    hideWelcomeScreen();
+    auto *view = new HexDiffView();
+    if (!view->loadFiles(left, right)) {
+        delete view;
+        QMessageBox::warning(this, "Jim", "Cannot open both files for comparison.");
+        return;
+    }
+    int idx = tabWidget->addTab(view, "[DIFF] " + strippedName(left) + " ↔ " + strippedName(right));
+    tabWidget->setCurrentIndex(idx);
+    flashTabLabel(idx);
+}
+
+void TextEditor::showStructureTemplate() {
+    ensureTemplateDock();
+    HexEditor *hex = qobject_cast<HexEditor *>(tabWidget->currentWidget());
+    if (!hex) {
+        openHexAct->trigger();
+        hex = qobject_cast<HexEditor *>(tabWidget->currentWidget());
+    }
+    templateDock->show();
+    templateDock->raise();
+    templateView->setEditor(hex);
+}
+
+void TextEditor::showDataInspector() {
+    ensureInspectorDock();
+    inspectorDock->show();
+    inspectorDock->raise();
+    inspector->setEditor(qobject_cast<HexEditor *>(tabWidget->currentWidget()));
+}
+
 // ── File-tree context menu ────────────────────────────────────────────────────
 
 void TextEditor::onFileTreeContextMenu(const QPoint &pos) {
@@ -4182,18 +6140,19 @@ void TextEditor::onFileTreeContextMenu(const QPoint &pos) {
     if (chosen == openAct) {
         loadFile(filePath);
     } else if (chosen == openHexMenuAct) {
-        QFile f(filePath);
-        if (f.open(QIODevice::ReadOnly)) {
-            QByteArray bytes = f.readAll();
-            HexEditor *hex = new HexEditor();
-            hex->setData(bytes);
+        HexEditor *hex = new HexEditor();
+        if (hex->loadFile(filePath)) {
             hex->setProperty("fileName", filePath);
+            hex->setEntropyMapVisible(entropyMapAct->isChecked());
+            applyHexLayout(hex);
             connect(hex, &HexEditor::modificationChanged,
                     this, &TextEditor::documentWasModified);
             hideWelcomeScreen();
             int tabIdx = tabWidget->addTab(hex, "[HEX] " + fi.fileName());
             tabWidget->setCurrentIndex(tabIdx);
             flashTabLabel(tabIdx);
+        } else {
+            delete hex;
         }
     } else if (chosen == disasmAct) {
         openInDisassembler(filePath);
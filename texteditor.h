@@ -10,6 +10,8 @@
 #include <QTabWidget>
 #include <QStackedWidget>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 #include <QSplitter>
 #include <QColor>
 #include <QTreeView>
@@ -25,19 +27,36 @@
 #include <QVariantAnimation>
 #include <QGraphicsOpacityEffect>
 #include <QSplitter>
+#include <QStringDecoder>
+#include <QPointer>
+#include "largefilepolicy.h"
+#include "decorationlayer.h"
+#include "multicursor.h"
+#include "blockselection.h"
+#include "syntaxtree.h"
+#include "symbolindex.h"
+#include "lspclient.h"
 
 class LineNumberArea;
 class FoldingArea;
 class MiniMap;
 class QPropertyAnimation;
+class QPainter;
 class HexEditor;
+class QComboBox;
 class DisassemblerWidget;
 class BinaryInspectorWidget;
+class HexTemplateView;
+class HexInspector;
+class QActionGroup;
 class MarkdownPreviewWidget;
 class WelcomeWidget;
+class UiUpdateScheduler;
 class BreadcrumbBar;
 class TerminalWidget;
 class TitleBar;
+class QToolButton;
+class PerfOverlay;
 class AnimationWidget;
 class DJVisualizerWindow;
 class AIAutocomplete;
@@ -177,7 +196,11 @@ public:
     explicit FindBar(QWidget *parent = nullptr);
     void showAndFocus(const QString &text = "");
     void setMatchCount(int current, int total);
+    void setStatusText(const QString &text);
     QString getSearchText() const;
+    // Hex tabs search bytes: shows the HexSearch::Mode picker
+    void setHexMode(bool hex);
+    int hexSearchMode() const;
 
 signals:
     void findNextRequested(const QString &text);
@@ -188,6 +211,7 @@ signals:
 private:
     QLineEdit *findInput;
     QLabel *matchLabel;
+    QComboBox *modeBox;
     QPushButton *prevBtn;
     QPushButton *nextBtn;
     QPushButton *closeBtn;
@@ -220,14 +244,58 @@ public:
     
     void setLanguage(Language lang);
     Language getLanguage() const { return currentLanguage; }
+    const SyntaxTree &syntaxTree() const { return syntax; }
+
+    // Lean mode: features shed for huge or minified files (LargeFilePolicy)
+    void setEnabledFeatures(int features);
+    int enabledFeatures() const { return features; }
+    bool hasFeature(EditorFeature feature) const { return features & feature; }
+
+    // Long-line chunking: overlong lines are split into several blocks for
+    // layout, highlighting and painting.  Continuation blocks carry a marker
+    // so numbering, columns, copying, searching and saving still see
+    // logical lines.
+    void setChunkedText(const QString &text, const QVector<int> &continuations);
+    static bool isContinuation(const QTextBlock &block);
+    int logicalLineNumber(const QTextBlock &block) const;
+    QTextBlock blockForLogicalLine(int line) const;
+    int logicalColumn(const QTextCursor &cursor) const;
+    QString logicalText() const;
+    // Document position of an offset into logicalText()
+    int documentPosition(int logical) const;
     
     // Search Highlighting
     void setSearchSelections(const QList<QTextCursor> &selections);
 
+    // Language server diagnostics, underlined; hovering shows the message
+    void setDiagnostics(const QVector<LspDiagnostic> &diagnostics);
+
+    // Brings the document in line with text by editing only the changed lines,
+    // so undo history, folds and highlighter state of the rest survive.
+    void applyExternalText(const QString &text);
+
+    // Tail-follow for growing log files: only appended bytes are read and the
+    // document is kept read-only, optionally capped to maxLines blocks.
+    bool startTailFollow(int maxLines);
+    void stopTailFollow();
+    bool isTailFollowing() const { return tailFollowing; }
+    void scheduleTailRead();
+
     // Multi-cursor
     void addExtraCursor(const QTextCursor &c);
     void clearExtraCursors();
     void selectNextOccurrence();
+    void selectAllOccurrences();
+    // Puts a caret on every range; ranges[primary] becomes the main cursor
+    void selectRanges(QVector<MultiCursor::Caret> ranges, int primary);
+    int cursorCount() const { return multiCursor.size() + 1; }
+
+    // Rectangular selection (Alt+drag, Alt+Shift+arrows).  These route the
+    // clipboard through it when one is active.
+    bool hasBlockSelection() const { return blockSelection.isActive(); }
+    void copySelection();
+    void cutSelection();
+    void pasteClipboard();
 
 signals:
     void characterTyped();
@@ -246,6 +314,10 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
+    QMimeData *createMimeDataFromSelection() const override;
 
 private slots:
     void updateLineNumberAreaWidth(int newBlockCount);
@@ -264,8 +336,48 @@ private:
     QPropertyAnimation *scrollAnimation;
     int targetScrollValue;
     Language currentLanguage;
-    QList<QTextCursor> searchSelections;
-    QList<QTextCursor> extraCursors;
+    SyntaxTree syntax;
+    MultiCursor multiCursor;
+    void editAllCarets(MultiCursor::EditKind kind, const QString &text = QString());
+    BlockSelection blockSelection;
+    bool altPressed = false;        // Alt+press: click adds a caret, drag a block
+    QPoint altPressPos;
+    qreal columnAdvance() const;
+    int columnAt(const QPoint &pos) const;
+    void extendBlockSelection(int line, int column);
+    bool blockSelectionKey(QKeyEvent *event);
+    void paintBlockSelection(QPainter &painter, bool carets);
+
+    // Current line, search hits, brackets and extra carets, painted directly
+    // by paintEvent instead of going through setExtraSelections()
+    enum DecorationLayerId {
+        CurrentLineLayer, SearchLayer, BracketLayer, DiagnosticLayer, CaretLayer,
+        LayerCount
+    };
+    DecorationLayer decorations[LayerCount];
+    int currentSearchHit = -1;
+    QVector<LspDiagnostic> diagnostics;     // as published, for tooltips
+    static constexpr int BracketScanLimit = 100000;   // characters
+    void setDecorations(DecorationLayerId layer, QVector<Decoration> ranges);
+    void updateDecorationRows(const QVector<Decoration> &ranges);
+    void paintDecorations(QPainter &painter, const QRect &clip, bool carets);
+    QColor decorationColor(DecorationStyle style) const;
+    QPair<int, int> visibleRange() const;
+    int matchingBracket(int pos) const;
+    void refreshCaretDecorations();
+    // Cursor-driven refreshes, run at most once per frame
+    enum UpdateTask { UpdateCurrentLine };
+    UiUpdateScheduler *updates;
+    int features = AllEditorFeatures;
+    bool chunked = false;
+    QVector<int> continuationBlocks;    // sorted block numbers
+    int chunkBlockCount = 0;
+    void followContinuations(int pos, int added);
+    bool tailFollowing = false;
+    qint64 tailOffset = 0;
+    QStringDecoder tailDecoder;
+    QTimer *tailTimer = nullptr;
+    void readTail();
     void autoIndent();
     void matchBrackets();
 };
@@ -373,6 +485,7 @@ private:
 
 class TextEditor : public QMainWindow {
     Q_OBJECT
+    friend class JimBench;   // bench/jimbench.cpp drives private entry points
 
 public:
     TextEditor(QWidget *parent = nullptr);
@@ -380,6 +493,12 @@ public:
     
     void openFilePath(const QString &filePath);
     void openFolderPath(const QString &folderPath);
+
+    // Reopens the tabs of the previous session as shells; contents load when
+    // a tab is activated or in the background, one tab per idle tick.
+    void restoreSession();
+
+    static Language detectLanguage(const QString &fileName);
     
     QAction *djModeAct = nullptr; // Make public for DJVisualizerWindow access
     void toggleDJMode(); // Make public for DJVisualizerWindow access
@@ -399,10 +518,14 @@ private slots:
     void findText();
     void findNext();
     void findPrevious();
+    void selectAllOccurrences();
     void onFindTextChanged(const QString &text);
     void closeFindBar();
+    void onHexSearchUpdated(int current, int total, bool finished);
     void replaceText();
     void goToLine();
+    void goToSymbol();
+    void goToDefinition();
     void documentWasModified();
     void updateStatusBar();
     void increaseFontSize();
@@ -411,6 +534,11 @@ private slots:
     void toggleSplitView();
     void toggleFileTree();
     void toggleMiniMap();
+    void toggleEntropyMap();
+    void updateHexLayout();
+    void toggleTailFollow();
+    void togglePerfOverlay();
+    void exportPerfTrace();
     void toggleTerminal();
     void cycleAnimation();
     void toggleAnimationDock();
@@ -423,14 +551,22 @@ private slots:
     void onFileTreeContextMenu(const QPoint &pos);
     void toggleMarkdownPreview();
     void updateMarkdownPreview();
+    void scheduleMarkdownUpdate();
     void onFileChangedExternally(const QString &path);
     void updateBreadcrumb();
+    void applyEditorFeatures(CodeEditor *editor, int features);
+    void updateLeanBadge();
     void showAISettings();
+    void configureLanguageServer();
     void toggleAIAutocomplete(bool enabled);
     void onAISuggestion(const QString &suggestion);
     // Tools
     void openDisassembler();
     void openBinaryInspector();
+    void showChecksums();
+    void compareBinaryFiles();
+    void showStructureTemplate();
+    void showDataInspector();
 
 private:
     void createActions();
@@ -440,6 +576,10 @@ private:
     void writeSettings();
     bool maybeSave(int tabIndex);
     void loadFile(const QString &fileName);
+    CodeEditor *createCodeEditor();
+    Language setEditorContents(CodeEditor *editor, const QString &fileName,
+                               const QByteArray &data,
+                               int *chunkedLines = nullptr);
     bool saveFileToPath(const QString &fileName);
     void setCurrentFile(const QString &fileName);
     QString strippedName(const QString &fullFileName);
@@ -452,11 +592,16 @@ private:
     void applyThemeToAllEditors();
     void setupUI();
     void applyModernStyle();
-    void showWelcomeScreen();
+    void showWelcomeScreen(bool animate = true);
+    void ensureTerminal();
+    void ensureAnimationDock();
+    void ensureTemplateDock();
+    void ensureInspectorDock();
+    void applyHexLayout(HexEditor *hex);
+    void ensureAIAutocomplete();
     void hideWelcomeScreen();
     void watchFile(const QString &filePath);
     void unwatchFile(const QString &filePath);
-    static Language detectLanguage(const QString &fileName);
     QString detectCurrentSymbol(CodeEditor *editor);
     void updateSearchHighlights();
 
@@ -474,6 +619,24 @@ private:
     void connectMarkdownPreview(CodeEditor *editor);
     void disconnectMarkdownPreview();
 
+    // Session persistence
+    struct SessionTab {
+        QString path;
+        qint32 cursor = 0;
+        qint32 scroll = 0;
+        QVector<qint32> folds;   // header block numbers of collapsed folds
+    };
+    QHash<CodeEditor *, SessionTab> pendingTabs;   // shells not loaded yet
+    QSet<CodeEditor *> tabsLoading;                // being read on a worker
+    QTimer *sessionLoadTimer = nullptr;
+    static QString sessionFilePath();
+    void writeSession();
+    // Reads the file on a worker; the text goes in on the GUI thread
+    void ensureTabLoaded(CodeEditor *editor);
+    void applyLoadedTab(CodeEditor *editor, const QByteArray &data,
+                        const QString &error);
+    void loadNextPendingTab();
+
     QSplitter *mainSplitter;
     QSplitter *verticalSplitter;
     QTabWidget *tabWidget;
@@ -497,6 +660,15 @@ private:
     
     // Session Time Tracker
     QLabel *sessionTimeLabel;
+    QToolButton *leanBadge = nullptr;
+    PerfOverlay *perfOverlay = nullptr;
+
+    // Per-keystroke consumers, coalesced to one run per frame in this order
+    enum UpdateTask {
+        UpdateStatusBar, UpdateBreadcrumb, UpdateAI, UpdateSound, UpdateMarkdown
+    };
+    UiUpdateScheduler *uiUpdates = nullptr;
+    QPointer<CodeEditor> aiPendingEditor;   // last editor edited since the AI ran
     QTimer *sessionTimer;
     QDateTime sessionStart;
     int sessionSecondsAccumulated = 0;
@@ -510,13 +682,30 @@ private:
     
     WelcomeWidget *welcomeWidget;
     BreadcrumbBar *breadcrumbBar;
-    TerminalWidget *terminalWidget;
-    AnimationWidget *animationWidget;
-    QDockWidget *animationDock;
+    // Created on first use (ensureTerminal() etc.) to keep cold start cheap
+    TerminalWidget *terminalWidget = nullptr;
+    AnimationWidget *animationWidget = nullptr;
+    QDockWidget *animationDock = nullptr;
+    HexTemplateView *templateView = nullptr;
+    QDockWidget *templateDock = nullptr;
+    HexInspector *inspector = nullptr;
+    QDockWidget *inspectorDock = nullptr;
     DJVisualizerWidget *djVisualizerWidget = nullptr;
     QDockWidget *djVisualizerDock = nullptr;
-    AIAutocomplete *aiAutocomplete;
-    QFileSystemWatcher *fileWatcher;
+    AIAutocomplete *aiAutocomplete = nullptr;
+    QFileSystemWatcher *fileWatcher = nullptr;
+    SymbolIndex *symbolIndex = nullptr;
+    // One language server per language, started on first use from the
+    // command configured under "lsp/<languageId>"
+    QHash<int, LspClient *> lspClients;
+    static QString lspLanguageId(Language lang);
+    LspClient *languageServerFor(Language lang);
+    void attachLanguageServer(CodeEditor *editor);
+    void detachLanguageServer(CodeEditor *editor);
+    void showSymbolPicker(const QString &title, const QString &query,
+                          const QVector<SymbolIndex::Entry> &fixed = {});
+    void openLocation(const QString &filePath, int line);
+    void goToIndexedDefinition(const QString &word);
 
     QAction *zenModeAct = nullptr;
     QAction *typingSoundAct = nullptr;
@@ -570,6 +759,8 @@ private:
     QAction *findNextAct;
     QAction *replaceAct;
     QAction *goToLineAct;
+    QAction *goToSymbolAct;
+    QAction *goToDefinitionAct;
     
     // Line editing actions
     QAction *duplicateLineAct;
@@ -578,6 +769,8 @@ private:
     QAction *deleteLineAct;
     QAction *toggleCommentAct;
     QAction *smartHomeAct; // Added smartHomeAct
+    QAction *selectNextAct;
+    QAction *selectAllOccurrencesAct;
 
     // View actions
     QAction *wordWrapAct;
@@ -586,18 +779,31 @@ private:
     QAction *splitViewAct;
     QAction *fileTreeAct;
     QAction *miniMapAct;
+    QAction *entropyMapAct;
+    // Hex Layout submenu; each action's data is its value (0 = fit to width)
+    QActionGroup *hexBytesGroup;
+    QActionGroup *hexGroupingGroup;
+    QActionGroup *hexAddressGroup;
+    QAction *tailFollowAct;
+    QAction *perfOverlayAct;
+    QAction *exportPerfTraceAct;
     QAction *terminalAct;
     QAction *animationAct;
     QAction *toggleAnimationDockAct;
     QAction *themeAct;
     QAction *customizeColorsAct;
     QAction *aiSettingsAct;
+    QAction *languageServerAct;
     QAction *aiToggleAct;
     QAction *aboutAct;
 
     // Tools actions
     QAction *disassembleAct;
     QAction *binaryInspectAct;
+    QAction *checksumAct;
+    QAction *compareBinaryAct;
+    QAction *templateAct;
+    QAction *inspectorAct;
     QAction *openHexAct;
 
     // Markdown preview action
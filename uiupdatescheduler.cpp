@@ -0,0 +1,47 @@
+#include "uiupdatescheduler.h"
+
+#include <QTimer>
+
+UiUpdateScheduler::UiUpdateScheduler(QObject *parent)
+    : QObject(parent), m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &UiUpdateScheduler::flush);
+    m_sinceFlush.start();
+    m_tasks.resize(MaxTasks);
+}
+
+void UiUpdateScheduler::setTask(int id, std::function<void()> fn)
+{
+    Q_ASSERT(id >= 0 && id < MaxTasks);
+    m_tasks[id] = std::move(fn);
+}
+
+void UiUpdateScheduler::schedule(int id)
+{
+    Q_ASSERT(id >= 0 && id < MaxTasks);
+    m_dirty |= 1u << id;
+    if (m_timer->isActive())
+        return;
+
+    // After an idle spell the update goes out on the next loop turn, which
+    // still folds together everything already queued; while busy, flushes
+    // are paced to one per frame.
+    const qint64 wait = FrameMs - m_sinceFlush.elapsed();
+    m_timer->start(int(qMax<qint64>(0, wait)));
+}
+
+void UiUpdateScheduler::flush()
+{
+    m_timer->stop();
+    quint32 dirty = m_dirty;
+    m_dirty = 0;
+    m_sinceFlush.restart();
+
+    // Tasks scheduled by a running task land in the next frame
+    for (int id = 0; dirty; ++id, dirty >>= 1) {
+        if ((dirty & 1u) && m_tasks[id])
+            m_tasks[id]();
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef UIUPDATESCHEDULER_H
+#define UIUPDATESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+#include <functional>
+
+class QTimer;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  UiUpdateScheduler
+//  Coalesces UI refreshes driven by cursor and text signals.  Signal handlers
+//  only set a dirty bit; the scheduler runs each dirty task once per frame,
+//  lowest id first, so holding down a key queues one status bar refresh per
+//  frame instead of one per auto-repeat.  Owners define their own task ids.
+// ─────────────────────────────────────────────────────────────────────────────
+class UiUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int FrameMs  = 16;
+    static constexpr int MaxTasks = 32;
+
+    explicit UiUpdateScheduler(QObject *parent = nullptr);
+
+    // Ids double as priority: lower ids run first within a frame
+    void setTask(int id, std::function<void()> fn);
+
+    void schedule(int id);
+    bool isPending(int id) const { return m_dirty & (1u << id); }
+
+    // Runs whatever is dirty right now instead of waiting for the frame
+    void flush();
+
+private:
+    QTimer *m_timer;
+    QElapsedTimer m_sinceFlush;
+    quint32 m_dirty = 0;
+    QVector<std::function<void()>> m_tasks;
+};
+
+#endif // UIUPDATESCHEDULER_H